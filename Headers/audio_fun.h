@@ -0,0 +1,95 @@
+/**
+ * @file audio_fun.h
+ * @brief This file contains the API of the sound effect mixer, a real-time thread mixing preloaded samples into small blocks
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef AUDIO_FUN_H
+#define AUDIO_FUN_H
+
+#include "std_c.h"
+
+/*
+ * Sounds are mono float samples loaded before the mixer starts. The game
+ * thread pushes play commands in a single producer, single consumer ring,
+ * without lock nor allocation, and the mixer thread, at real-time priority
+ * when the system allows it, starts them at the next block. Every
+ * AUDIO_BLOCK_FRAMES frames (2.7 ms at 48 kHz) the active voices are mixed
+ * four samples at a time into planar float accumulators, then packed to
+ * interleaved 16 bits stereo for the sink. The ALSA sink paces the thread
+ * with its blocking writes and reports underruns; the null and WAV sinks
+ * pace it with absolute sleeps and report the blocks mixed after their
+ * deadline. The command latency is the time between a play command and
+ * the start of the block that mixes it.
+ */
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_CHANNEL_NUMBER 2
+#define AUDIO_BLOCK_FRAMES 128
+#define AUDIO_DEVICE_BLOCKS 3
+#define AUDIO_MAX_SOUNDS 16
+#define AUDIO_MAX_VOICES 32
+#define AUDIO_QUEUE_SIZE 64
+#define AUDIO_INVALID_SOUND UINT32_MAX
+
+/**
+ * @brief Where the mixed blocks go
+ */
+typedef enum AudioSinkType {
+	AUDIO_SINK_NULL = 0,
+	AUDIO_SINK_WAV,
+	AUDIO_SINK_ALSA
+} AudioSinkType;
+
+typedef struct AudioMixer AudioMixer;
+
+/**
+ * @brief Open the sink of the mixer, the thread is started by startAudioMixer once the sounds are loaded
+ * @param sinkType Sink receiving the mixed blocks, AUDIO_SINK_ALSA needs VK_PONG_ALSA
+ * @param fileName WAV file written by AUDIO_SINK_WAV, ignored by the other sinks
+ * @return The mixer, NULL on failure
+ */
+AudioMixer *createAudioMixer(AudioSinkType sinkType, const char *fileName);
+
+/**
+ * @brief Stop the mixer thread, close the sink and print the block and latency statistics
+ * @param ppAudioMixer The mixer to be destroyed
+ */
+void deleteAudioMixer(AudioMixer **ppAudioMixer);
+
+/**
+ * @brief Copy a mono sound into the mixer, must be called before startAudioMixer
+ * @param pAudioMixer Target mixer
+ * @param pSamples Samples between -1.0 and 1.0 at AUDIO_SAMPLE_RATE
+ * @param frameNumber Number of samples
+ * @return The index of the sound, AUDIO_INVALID_SOUND on failure
+ */
+uint32_t addAudioSound(AudioMixer *pAudioMixer, const float *pSamples, uint32_t frameNumber);
+
+/**
+ * @brief Synthesize a sine sweep with an exponential decay and add it as a sound
+ * @param pAudioMixer Target mixer
+ * @param startFrequency Frequency at the start of the sound in Hz
+ * @param endFrequency Frequency at the end of the sound in Hz
+ * @param duration Length of the sound in seconds
+ * @return The index of the sound, AUDIO_INVALID_SOUND on failure
+ */
+uint32_t addAudioTone(AudioMixer *pAudioMixer, float startFrequency, float endFrequency, float duration);
+
+/**
+ * @brief Start the mixer thread, at real-time priority when the process is allowed to
+ * @param pAudioMixer Target mixer
+ * @return 0 on success, -1 on failure
+ */
+int startAudioMixer(AudioMixer *pAudioMixer);
+
+/**
+ * @brief Queue a sound to be started at the next block, always from the same thread, never blocks
+ * @param pAudioMixer Target mixer
+ * @param sound Index returned by addAudioSound
+ * @param gain Volume of the sound, 1.0 to keep it as loaded
+ * @param pan Position from -1.0 for the left speaker to 1.0 for the right one
+ * @return 0 on success, -1 when the queue is full and the command is dropped
+ */
+int playAudioSound(AudioMixer *pAudioMixer, uint32_t sound, float gain, float pan);
+
+#endif // AUDIO_FUN_H
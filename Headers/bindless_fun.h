@@ -0,0 +1,80 @@
+/**
+ * @file bindless_fun.h
+ * @brief This file contains the API of the bindless table, a single descriptor set holding every texture and storage buffer indexed by the shaders
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef BINDLESS_FUN_H
+#define BINDLESS_FUN_H
+
+#include "vk_fun.h"
+
+/*
+ * The table is one descriptor set of two runtime sized arrays: combined
+ * image samplers at binding 0, read by the fragment stage, and storage
+ * buffers at binding 1, read by the vertex and fragment stages. Both are
+ * partially bound and update-after-bind, so a slot is written once when its
+ * resource is added, even while command buffers using the other slots are
+ * pending, and the set is bound once per command buffer whatever the number
+ * of textures. Shaders pick a slot with an index from their instance data,
+ * wrapped in nonuniformEXT, so quads with different textures share a draw.
+ *
+ * The array sizes are BINDLESS_MAX_TEXTURES and BINDLESS_MAX_BUFFERS,
+ * lowered to the update-after-bind limits of the device. Slots are never
+ * released, resources added to the table must outlive it.
+ */
+#define BINDLESS_MAX_TEXTURES 1024
+#define BINDLESS_MAX_BUFFERS 64
+#define BINDLESS_TEXTURE_BINDING 0
+#define BINDLESS_BUFFER_BINDING 1
+#define BINDLESS_INVALID_INDEX UINT32_MAX
+
+typedef struct BindlessTable BindlessTable;
+
+/**
+ * @brief Create the update-after-bind descriptor set of the table
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device, created with the descriptor indexing features
+ * @return The bindless table, VK_NULL_HANDLE when descriptor indexing is not supported or on failure
+ */
+BindlessTable *createBindlessTable(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice);
+
+/**
+ * @brief Destroy the descriptor set of the table and print its occupancy, the resources it points to are left untouched
+ * @param pDevice Target logical device
+ * @param ppBindlessTable The bindless table to be destroyed
+ */
+void deleteBindlessTable(VkDevice *pDevice, BindlessTable **ppBindlessTable);
+
+/**
+ * @brief Write a texture in the next free slot, the slot can be used by commands recorded from now on
+ * @param pBindlessTable Target bindless table
+ * @param pImageInfo Sampler, view and layout of the texture, in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when it is sampled
+ * @return The index of the texture in the array, BINDLESS_INVALID_INDEX when the table is full
+ */
+uint32_t addBindlessTexture(BindlessTable *pBindlessTable, VkDescriptorImageInfo *pImageInfo);
+
+/**
+ * @brief Write a storage buffer range in the next free slot, the slot can be used by commands recorded from now on
+ * @param pBindlessTable Target bindless table
+ * @param pBufferInfo Buffer, offset and range read by the shaders
+ * @return The index of the buffer in the array, BINDLESS_INVALID_INDEX when the table is full
+ */
+uint32_t addBindlessBuffer(BindlessTable *pBindlessTable, VkDescriptorBufferInfo *pBufferInfo);
+
+/**
+ * @brief Fetch the layout of the table, to be placed at set 0 of the pipeline layouts that index it
+ * @param pBindlessTable Target bindless table
+ * @return The descriptor set layout, owned by the table
+ */
+VkDescriptorSetLayout *getBindlessSetLayout(BindlessTable *pBindlessTable);
+
+/**
+ * @brief Bind the table at set 0, it stays bound for every following pipeline of a compatible layout
+ * @param pBindlessTable Target bindless table
+ * @param pCommandBuffer Command buffer being recorded
+ * @param pPipelineLayout Pipeline layout created with the table layout at set 0
+ */
+void recordBindlessTable(BindlessTable *pBindlessTable, VkCommandBuffer *pCommandBuffer, VkPipelineLayout *pPipelineLayout);
+
+#endif // BINDLESS_FUN_H
@@ -0,0 +1,71 @@
+/**
+ * @file capture_fun.h
+ * @brief This file contains the API of the frame capture, streaming the rendered images to a Y4M or raw RGBA video file
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef CAPTURE_FUN_H
+#define CAPTURE_FUN_H
+
+#include "graph_fun.h"
+
+/*
+ * The last pass of the graph copies the swapchain image into one slot of a
+ * host-visible readback buffer. A slot is only handed to the writer thread once
+ * the fence of the submission that filled it has been waited by the main loop,
+ * the thread converts it and writes it to disk while the renderer goes on. When
+ * every slot is still owned by the writer the frame is not copied: it is
+ * counted and reported as dropped, the renderer never waits for the disk.
+ *
+ * The video is resampled to its own frame rate from the time each frame is
+ * prepared. A frame that starts no new video period is not copied at all, and
+ * a frame written after a gap, a slow frame or a dropped one, is repeated
+ * for every period it covers. The video then plays at the speed of the game
+ * whatever the rendering rate.
+ */
+#define CAPTURE_FORMAT_RAW 0
+#define CAPTURE_FORMAT_Y4M 1
+#define CAPTURE_MAX_SLOTS 16
+#define CAPTURE_SLOT_FREE 0
+#define CAPTURE_SLOT_COPYING 1
+#define CAPTURE_SLOT_WRITING 2
+
+typedef struct FrameCapture FrameCapture;
+
+/**
+ * @brief Create the readback buffer, open the video file and start the writer thread
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device
+ * @param format Format of the captured images, 8 bits per channel RGBA or BGRA
+ * @param pExtent Extent of the captured images
+ * @param fileName Video file, written as Y4M when it ends with .y4m and as raw RGBA otherwise
+ * @param frameRate Frame rate of the video, the rendered frames are skipped or repeated to match it
+ * @param slotNumber Number of readback slots, up to CAPTURE_MAX_SLOTS
+ * @return The frame capture, VK_NULL_HANDLE on failure
+ */
+FrameCapture *createFrameCapture(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkFormat format, VkExtent2D *pExtent, const char *fileName, uint32_t frameRate, uint32_t slotNumber);
+
+/**
+ * @brief Write the frames still in flight, stop the writer thread and print the captured and dropped frame counts, the GPU must be idle
+ * @param pDevice Target logical device
+ * @param ppFrameCapture The frame capture to be removed
+ */
+void deleteFrameCapture(VkDevice *pDevice, FrameCapture **ppFrameCapture);
+
+/**
+ * @brief Append the pass copying an image into the readback buffer, must be the last pass writing the image
+ * @param pFrameCapture Target frame capture
+ * @param pRenderGraph Render graph being built
+ * @param image Image resource to capture, the swapchain images for example
+ * @return The pass index, GRAPH_INVALID_INDEX on failure
+ */
+uint32_t addFrameCapturePass(FrameCapture *pFrameCapture, RenderGraph *pRenderGraph, uint32_t image);
+
+/**
+ * @brief Hand the previous copy of an image to the writer and choose the slot of the next one, the command buffer of the image must then be recorded again
+ * @param pFrameCapture Target frame capture
+ * @param imageIndex Swapchain image index, its previous submission must have completed, as in UpdateFrameCallback
+ */
+void updateFrameCapture(FrameCapture *pFrameCapture, uint32_t imageIndex);
+
+#endif // CAPTURE_FUN_H
@@ -0,0 +1,327 @@
+/**
+ * @file graph_fun.h
+ * @brief This file contains the API of the render graph, passes declare the resources they use and the graph records the barriers between them
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef GRAPH_FUN_H
+#define GRAPH_FUN_H
+
+#include "vk_fun.h"
+
+/*
+ * Passes are executed in the order they are added. Compiling the graph drops the
+ * passes whose results never reach an output, computes for every remaining pass
+ * the synchronization2 barriers it needs (read after read needs none), creates
+ * the render passes and framebuffers of the graphics passes unless they begin
+ * dynamic rendering on the attachment views, and places the transient images
+ * whose lifetimes do not overlap in the same memory. Transient
+ * images only used as attachments are created with TRANSIENT_ATTACHMENT usage in
+ * lazily allocated memory when the device has such a memory type. When the device
+ * supports timestamps in graphics and compute queues, each kept pass is timed.
+ * A graphics pass with a view mask draws every view of the mask at once into
+ * the matching layers of its attachments, which need as many layers.
+ */
+#define GRAPH_MAX_RESOURCES 32
+#define GRAPH_MAX_PASSES 32
+#define GRAPH_MAX_PASS_USES 8
+#define GRAPH_MAX_IMAGES 8
+#define GRAPH_MAX_BARRIERS (GRAPH_MAX_PASSES * GRAPH_MAX_PASS_USES + GRAPH_MAX_RESOURCES)
+#define GRAPH_INVALID_INDEX UINT32_MAX
+
+/**
+ * @brief How a pass uses a resource, each use maps to a stage, an access and an image layout
+ */
+typedef enum GraphUse {
+	GRAPH_USE_COLOR_ATTACHMENT = 0,
+	GRAPH_USE_FRAGMENT_SAMPLED,
+	GRAPH_USE_COMPUTE_SAMPLED,
+	GRAPH_USE_COMPUTE_STORAGE_READ,
+	GRAPH_USE_COMPUTE_STORAGE_WRITE,
+	GRAPH_USE_VERTEX_STORAGE_READ,
+	GRAPH_USE_INDIRECT_READ,
+	GRAPH_USE_TRANSFER_READ,
+	GRAPH_USE_TRANSFER_WRITE,
+	GRAPH_USE_NUMBER
+} GraphUse;
+
+/**
+ * @brief Last known synchronization state of a resource while the graph is compiled
+ */
+typedef struct GraphResourceState {
+	VkPipelineStageFlags2KHR writeStages;
+	VkAccessFlags2KHR writeAccess;
+	VkPipelineStageFlags2KHR readStages;
+	VkPipelineStageFlags2KHR visibleStages;
+	VkAccessFlags2KHR visibleAccess;
+	VkImageLayout layout;
+} GraphResourceState;
+
+/**
+ * @brief Image or buffer known by the graph, imported or owned as a transient image
+ */
+typedef struct GraphResource {
+	const char *name;
+	VkBool32 isImage;
+	VkBool32 isTransient;
+	VkFormat format;
+	VkExtent2D extent;
+	uint32_t layerNumber;
+	VkImageUsageFlags usage;
+	VkImageLayout initialLayout;
+	VkImageLayout finalLayout;
+	uint32_t imageNumber;
+	VkImage images[GRAPH_MAX_IMAGES];
+	VkImageView imageViews[GRAPH_MAX_IMAGES];
+	VkBuffer buffer;
+	VkBool32 isOutput;
+	VkBool32 isNeeded;
+	uint32_t firstPass;
+	uint32_t lastPass;
+	uint32_t memoryBlock;
+	uint32_t aliasPredecessor;
+	GraphResourceState state;
+	GraphResourceState finalState;
+} GraphResource;
+
+/**
+ * @brief One resource use declared by a pass
+ */
+typedef struct GraphPassUse {
+	uint32_t resource;
+	GraphUse use;
+	VkAttachmentLoadOp loadOp;
+	VkClearValue clearValue;
+} GraphPassUse;
+
+/**
+ * @brief Pass of the graph, graphics passes are recorded inside a render pass created by the graph or a dynamic rendering scope
+ */
+typedef struct GraphPass {
+	const char *name;
+	VkPipelineBindPoint bindPoint;
+	RecordDrawsCallback record;
+	void *pUserData;
+	uint32_t useNumber;
+	GraphPassUse uses[GRAPH_MAX_PASS_USES];
+	VkBool32 isCulled;
+	uint32_t barrierFirst;
+	uint32_t barrierNumber;
+	VkRenderPass renderPass;
+	uint32_t framebufferNumber;
+	VkFramebuffer framebuffers[GRAPH_MAX_IMAGES];
+	VkExtent2D extent;
+	VkExtent2D renderArea;
+	uint32_t viewMask;
+	uint32_t clearValueNumber;
+	VkClearValue clearValues[GRAPH_MAX_PASS_USES];
+	uint32_t attachmentResources[GRAPH_MAX_PASS_USES];
+	VkAttachmentLoadOp loadOps[GRAPH_MAX_PASS_USES];
+	VkAttachmentStoreOp storeOps[GRAPH_MAX_PASS_USES];
+	uint32_t timestampQuery;
+	float gpuTime;
+} GraphPass;
+
+/**
+ * @brief Barrier computed at compile time, the image or buffer handle is resolved when recording
+ */
+typedef struct GraphBarrier {
+	uint32_t resource;
+	VkPipelineStageFlags2KHR srcStages;
+	VkAccessFlags2KHR srcAccess;
+	VkPipelineStageFlags2KHR dstStages;
+	VkAccessFlags2KHR dstAccess;
+	VkImageLayout oldLayout;
+	VkImageLayout newLayout;
+} GraphBarrier;
+
+/**
+ * @brief Render graph, passes and resources live in fixed arrays so recording never allocates
+ */
+typedef struct RenderGraph {
+	VkDevice device;
+	VkBool32 synchronization2;
+	PFN_vkCmdPipelineBarrier2KHR cmdPipelineBarrier2;
+	VkBool32 dynamicRendering;
+	PFN_vkCmdBeginRenderingKHR cmdBeginRendering;
+	PFN_vkCmdEndRenderingKHR cmdEndRendering;
+	uint32_t resourceNumber;
+	GraphResource resources[GRAPH_MAX_RESOURCES];
+	uint32_t passNumber;
+	GraphPass passes[GRAPH_MAX_PASSES];
+	uint32_t barrierNumber;
+	GraphBarrier barriers[GRAPH_MAX_BARRIERS];
+	uint32_t finalBarrierFirst;
+	uint32_t finalBarrierNumber;
+	uint32_t memoryBlockNumber;
+	VkDeviceMemory memoryBlocks[GRAPH_MAX_RESOURCES];
+	VkDeviceSize memoryBlockSizes[GRAPH_MAX_RESOURCES];
+	uint32_t memoryBlockTypes[GRAPH_MAX_RESOURCES];
+	VkBool32 memoryBlockLazy[GRAPH_MAX_RESOURCES];
+	VkQueryPool queryPool;
+	uint32_t queryNumber;
+	uint32_t timestampImageNumber;
+	float timestampPeriod;
+	uint32_t timestampFrames[GRAPH_MAX_IMAGES];
+	float gpuTime;
+	VkBool32 isCompiled;
+} RenderGraph;
+
+/**
+ * @brief Create an empty render graph
+ * @param pDevice Target logical device
+ * @param synchronization2 VK_TRUE if VK_KHR_synchronization2 is enabled on the device, barriers fall back to vkCmdPipelineBarrier otherwise
+ * @param dynamicRendering VK_TRUE to begin the graphics passes with VK_KHR_dynamic_rendering, the pipelines must then come from render targets without render pass
+ * @return The render graph, VK_NULL_HANDLE on failure
+ */
+RenderGraph *createRenderGraph(VkDevice *pDevice, VkBool32 synchronization2, VkBool32 dynamicRendering);
+
+/**
+ * @brief Destroy a render graph and the render passes, framebuffers, images and memory it owns
+ * @param pDevice Target logical device
+ * @param ppRenderGraph The render graph to be destroyed
+ */
+void deleteRenderGraph(VkDevice *pDevice, RenderGraph **ppRenderGraph);
+
+/**
+ * @brief Import images owned by the application, such as the swapchain images
+ * @param pRenderGraph Target render graph
+ * @param name Resource name
+ * @param format Image format
+ * @param pExtent Image extent
+ * @param pImages One image for each swapchain image, or a single image
+ * @param pImageViews Views of the given images
+ * @param imageNumber Number of images, the image used when recording is selected by the swapchain image index
+ * @param initialLayout Layout at the start of the frame, VK_IMAGE_LAYOUT_UNDEFINED discards the content
+ * @param finalLayout Layout required at the end of the frame, the image is an output of the graph unless it is VK_IMAGE_LAYOUT_UNDEFINED
+ * @return The resource index, GRAPH_INVALID_INDEX on failure
+ */
+uint32_t importGraphImage(RenderGraph *pRenderGraph, const char *name, VkFormat format, VkExtent2D *pExtent, VkImage *pImages, VkImageView *pImageViews, uint32_t imageNumber, VkImageLayout initialLayout, VkImageLayout finalLayout);
+
+/**
+ * @brief Import a buffer owned by the application, its content is kept from one frame to the next
+ * @param pRenderGraph Target render graph
+ * @param name Resource name
+ * @param buffer The imported buffer
+ * @return The resource index, GRAPH_INVALID_INDEX on failure
+ */
+uint32_t importGraphBuffer(RenderGraph *pRenderGraph, const char *name, VkBuffer buffer);
+
+/**
+ * @brief Mark a resource as an output of the graph, the passes writing it are kept, such as a buffer read back by the host
+ * @param pRenderGraph Target render graph
+ * @param resource Resource index
+ */
+void addGraphOutput(RenderGraph *pRenderGraph, uint32_t resource);
+
+/**
+ * @brief Declare a transient image created by the graph, its content only lives during the frame
+ * @param pRenderGraph Target render graph
+ * @param name Resource name
+ * @param format Image format
+ * @param pExtent Image extent
+ * @param layerNumber Number of array layers, one per view when the image is the attachment of a multiview pass
+ * @return The resource index, GRAPH_INVALID_INDEX on failure
+ */
+uint32_t createGraphImage(RenderGraph *pRenderGraph, const char *name, VkFormat format, VkExtent2D *pExtent, uint32_t layerNumber);
+
+/**
+ * @brief Append a pass
+ * @param pRenderGraph Target render graph
+ * @param name Pass name
+ * @param bindPoint VK_PIPELINE_BIND_POINT_GRAPHICS to record inside a render pass, VK_PIPELINE_BIND_POINT_COMPUTE otherwise
+ * @param record Records the commands of the pass
+ * @param pUserData User data given to record
+ * @return The pass index, GRAPH_INVALID_INDEX on failure
+ */
+uint32_t addGraphPass(RenderGraph *pRenderGraph, const char *name, VkPipelineBindPoint bindPoint, RecordDrawsCallback record, void *pUserData);
+
+/**
+ * @brief Declare a resource use of a pass
+ * @param pRenderGraph Target render graph
+ * @param pass Pass index
+ * @param resource Resource index
+ * @param use How the pass uses the resource
+ */
+void addGraphPassUse(RenderGraph *pRenderGraph, uint32_t pass, uint32_t resource, GraphUse use);
+
+/**
+ * @brief Declare a color attachment of a graphics pass, attachments are numbered in declaration order
+ * @param pRenderGraph Target render graph
+ * @param pass Pass index
+ * @param resource Image resource index
+ * @param loadOp Load operation of the attachment
+ * @param pClearValue Clear value used with VK_ATTACHMENT_LOAD_OP_CLEAR, may be VK_NULL_HANDLE
+ */
+void addGraphColorAttachment(RenderGraph *pRenderGraph, uint32_t pass, uint32_t resource, VkAttachmentLoadOp loadOp, VkClearValue *pClearValue);
+
+/**
+ * @brief Make a graphics pass draw several views at once with multiview, the device must have the multiview feature enabled
+ * @param pRenderGraph Target render graph
+ * @param pass Pass index
+ * @param viewMask Bit i renders layer i of every attachment, pipelines drawn in the pass are created with the same mask
+ */
+void setGraphPassViewMask(RenderGraph *pRenderGraph, uint32_t pass, uint32_t viewMask);
+
+/**
+ * @brief Cull the passes, compute the barriers and create the transient images, and the render passes and framebuffers without dynamic rendering
+ * @param pPhysicalDevice Target physical device
+ * @param pRenderGraph Target render graph
+ * @return 0 on success, -1 on failure
+ */
+int compileRenderGraph(VkPhysicalDevice *pPhysicalDevice, RenderGraph *pRenderGraph);
+
+/**
+ * @brief Render pass created for a graphics pass, pipelines drawn in the pass must be compatible with it
+ * @param pRenderGraph Compiled render graph
+ * @param pass Pass index
+ * @return The render pass, VK_NULL_HANDLE for compute or culled passes and with dynamic rendering
+ */
+VkRenderPass getGraphRenderPass(RenderGraph *pRenderGraph, uint32_t pass);
+
+/**
+ * @brief Restrict the rendering of a graphics pass to the top left corner of its attachments, the viewport and scissor follow
+ * @param pRenderGraph Compiled render graph
+ * @param pass Pass index
+ * @param pExtent Size of the rendered area, clamped to the attachment extent, applies to the command buffers recorded afterwards
+ */
+void setGraphPassRenderArea(RenderGraph *pRenderGraph, uint32_t pass, VkExtent2D *pExtent);
+
+/**
+ * @brief Record every pass that was kept with its barriers
+ * @param pRenderGraph Compiled render graph
+ * @param pCommandBuffer Command buffer being recorded, outside of any render pass
+ * @param imageIndex Swapchain image index, selects the imported image and its view or framebuffer
+ */
+void recordRenderGraph(RenderGraph *pRenderGraph, VkCommandBuffer *pCommandBuffer, uint32_t imageIndex);
+
+/**
+ * @brief Record the whole graph into a command buffer, its previous content is discarded
+ * @param pRenderGraph Compiled render graph
+ * @param pCommandBuffer Command buffer no longer used by the GPU
+ * @param imageIndex Swapchain image index, selects the imported image and framebuffer
+ */
+void recordRenderGraphCommandBuffer(RenderGraph *pRenderGraph, VkCommandBuffer *pCommandBuffer, uint32_t imageIndex);
+
+/**
+ * @brief Record the whole graph into one command buffer per swapchain image
+ * @param pRenderGraph Compiled render graph
+ * @param ppCommandBuffers Pointer to an array of command buffers
+ * @param commandBufferNumber Number of command buffers, one for each swapchain image
+ */
+void recordRenderGraphCommandBuffers(RenderGraph *pRenderGraph, VkCommandBuffer **ppCommandBuffers, uint32_t commandBufferNumber);
+
+/**
+ * @brief Read back the timestamps of the last completed submission of an image, pass gpuTime and graph gpuTime hold smoothed durations in milliseconds
+ * @param pRenderGraph Compiled render graph
+ * @param imageIndex Swapchain image index, its previous submission must have completed, as in UpdateFrameCallback
+ */
+void readRenderGraphTimestamps(RenderGraph *pRenderGraph, uint32_t imageIndex);
+
+/**
+ * @brief Print the kept passes with their barriers and GPU time, and the memory blocks shared by transient images
+ * @param pRenderGraph Compiled render graph
+ */
+void printRenderGraph(RenderGraph *pRenderGraph);
+
+#endif // GRAPH_FUN_H
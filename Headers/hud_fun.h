@@ -0,0 +1,118 @@
+/**
+ * @file hud_fun.h
+ * @brief This file contains the API of the performance overlay, frame time graphs and counters drawn over the final image
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef HUD_FUN_H
+#define HUD_FUN_H
+
+#include "graph_fun.h"
+#include "text_fun.h"
+
+/*
+ * The overlay keeps the last HUD_HISTORY_LENGTH samples of the CPU frame
+ * time, the GPU time, the simulation tick time and the present interval,
+ * and draws each series as a scrolling bar graph with a line at the frame
+ * budget. Bars, backgrounds and labels are solid rects and glyphs of its own
+ * text renderer, so the whole overlay is a single instanced draw read from
+ * the per-image ring of that renderer. It is a last graph pass loading the
+ * backbuffer, after the post-processing, and keeps the size of the window
+ * whatever the render scale. Its CPU cost, measured around the filling of
+ * the ring, and the GPU time of its pass are shown in the overlay.
+ */
+#define HUD_HISTORY_LENGTH 120
+#define HUD_QUAD_CAPACITY 1024
+#define HUD_BAR_WIDTH 2.0f
+#define HUD_GRAPH_HEIGHT 40.0f
+#define HUD_GRAPH_RANGE 33.3f
+#define HUD_FRAME_BUDGET 16.7f
+#define HUD_TEXT_SCALE 2.0f
+
+/**
+ * @brief Series drawn as graphs by the overlay, in milliseconds
+ */
+typedef enum HudGraph {
+	HUD_GRAPH_CPU = 0,
+	HUD_GRAPH_GPU,
+	HUD_GRAPH_SIMULATION,
+	HUD_GRAPH_PRESENT,
+	HUD_GRAPH_NUMBER
+} HudGraph;
+
+/**
+ * @brief Measures of one frame given to the overlay
+ */
+typedef struct HudFrame {
+	float times[HUD_GRAPH_NUMBER];
+	uint32_t drawNumber;
+	uint32_t instanceNumber;
+	uint64_t allocationNumber;
+} HudFrame;
+
+/**
+ * @brief Sample history, counters and text renderer of the overlay
+ */
+typedef struct PerfHud {
+	TextRenderer textRenderer;
+	float history[HUD_GRAPH_NUMBER][HUD_HISTORY_LENGTH];
+	uint32_t historyIndex;
+	HudFrame frame;
+	float cpuTime;
+	float maxCpuTime;
+	uint32_t pass;
+	VkBool32 isVisible;
+} PerfHud;
+
+/**
+ * @brief Create the text renderer of the overlay
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device
+ * @param pQueue Queue used to upload the glyph atlas
+ * @param pCommandPool Command pool of the given queue family
+ * @param pRenderTarget Target without multiview, one color attachment in the backbuffer format
+ * @param pExtent Extent of the backbuffer
+ * @param pShaderModules Text vertex and fragment shaders
+ * @param frameNumber Number of per-image quad buffers, one for each swapchain image
+ * @return The overlay, the pipeline of its text renderer is VK_NULL_HANDLE on failure
+ */
+PerfHud createPerfHud(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules, uint32_t frameNumber);
+
+/**
+ * @brief Destroy the overlay and its text renderer
+ * @param pDevice Target logical device
+ * @param pPerfHud The overlay to be destroyed
+ */
+void deletePerfHud(VkDevice *pDevice, PerfHud *pPerfHud);
+
+/**
+ * @brief Append the overlay pass, drawn over the previous content of the image
+ * @param pPerfHud Target overlay
+ * @param pRenderGraph Render graph being built
+ * @param output Image the overlay is drawn on, the backbuffer for example
+ * @return The index of the pass, GRAPH_INVALID_INDEX on failure
+ */
+uint32_t addPerfHudPass(PerfHud *pPerfHud, RenderGraph *pRenderGraph, uint32_t output);
+
+/**
+ * @brief Add the measures of a frame to the history
+ * @param pPerfHud Target overlay
+ * @param pFrame Times in milliseconds and counters of the frame
+ */
+void pushPerfHudFrame(PerfHud *pPerfHud, HudFrame *pFrame);
+
+/**
+ * @brief Write the quads of the overlay in the buffer of a swapchain image, nothing when the overlay is hidden
+ * @param pPerfHud Target overlay
+ * @param pRenderGraph Compiled render graph, the GPU time of the overlay pass is read from it
+ * @param frameIndex Swapchain image index, its previous submission must be complete
+ */
+void updatePerfHud(PerfHud *pPerfHud, RenderGraph *pRenderGraph, uint32_t frameIndex);
+
+/**
+ * @brief Print the average and worst CPU cost of the overlay
+ * @param pPerfHud Target overlay
+ */
+void printPerfHud(PerfHud *pPerfHud);
+
+#endif // HUD_FUN_H
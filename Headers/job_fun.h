@@ -0,0 +1,153 @@
+/**
+ * @file job_fun.h
+ * @brief This file contains the API of the job system, a work-stealing scheduler of short CPU tasks on a fixed set of worker threads
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef JOB_FUN_H
+#define JOB_FUN_H
+
+#include "std_c.h"
+
+/*
+ * Every worker owns a Chase-Lev deque of JOB_DEQUE_CAPACITY jobs, stored by
+ * value so pushing a job allocates nothing: the owner pushes and pops at the
+ * bottom without any lock nor compare-and-swap, except for the last job,
+ * while idle workers steal the oldest job at the top with a single
+ * compare-and-swap. When the deque is full the job is run at once by the
+ * pusher. The thread creating the job system is worker 0 and only runs jobs
+ * while it waits on a counter, the others spin for JOB_SPIN_NUMBER failed
+ * steals then sleep until a job is pushed.
+ *
+ * A parallel for is a single job on the whole range: the worker running it
+ * pushes the upper half back as a new job until at most grain indices are
+ * left, so thieves always take the largest pieces first.
+ *
+ * A counter is incremented by every job started with it and decremented when
+ * the job returns. waitJobCounter runs pending jobs until the counter drops
+ * to zero, so a job may wait for the jobs it depends on without blocking its
+ * worker. Jobs may only be pushed and waited on from worker threads, the
+ * creating thread or the jobs themselves: a job pushed from any other thread
+ * would race the owner of a deque on its bottom, so it is run at once by
+ * that thread instead, and waiting there only yields.
+ *
+ * Long jobs that must not delay the creating thread, such as file decoding,
+ * go through runBackgroundJob instead: a queue of JOB_DEQUE_CAPACITY jobs
+ * under the job system lock, emptied only by the other workers once they
+ * find nothing to pop nor steal. The creating thread never takes them while
+ * it waits on a counter, and any thread may push to it.
+ *
+ * Once deleteJobSystem is called the workers keep running jobs until they
+ * find none, then the creating thread runs what is left, so no job is
+ * dropped and no counter stays raised.
+ */
+#define JOB_DEQUE_CAPACITY 4096
+#define JOB_MAX_WORKERS 64
+#define JOB_SPIN_NUMBER 256
+#define JOB_INVALID_WORKER UINT32_MAX
+
+typedef struct JobSystem JobSystem;
+
+/**
+ * @brief Number of started jobs that have not returned yet, to be zero initialized
+ */
+typedef struct JobCounter {
+	uint32_t value;
+} JobCounter;
+
+/**
+ * @brief Function run by a job
+ * @param pData Data given when the job was started
+ */
+typedef void (*JobFunction)(void *pData);
+
+/**
+ * @brief Function run by a parallel for on a range of indices
+ * @param pData Data given to the parallel for
+ * @param begin First index of the range
+ * @param end Index following the last one of the range
+ */
+typedef void (*JobRangeFunction)(void *pData, uint32_t begin, uint32_t end);
+
+/**
+ * @brief Create the deques and start the worker threads, the calling thread becomes worker 0
+ * @param workerNumber Number of workers including the calling thread, 0 to use every hardware thread, at most JOB_MAX_WORKERS
+ * @return The job system, NULL on failure
+ */
+JobSystem *createJobSystem(uint32_t workerNumber);
+
+/**
+ * @brief Run the jobs still pending, then stop and join the worker threads
+ * @param ppJobSystem The job system to be removed
+ */
+void deleteJobSystem(JobSystem **ppJobSystem);
+
+/**
+ * @brief Push a job to the deque of the calling worker, an idle worker may steal it at once, from any other thread the job is run at once
+ * @param pJobSystem Target job system
+ * @param function Function of the job
+ * @param pData Data given to the function, it must stay valid until the job returns
+ * @param pCounter Counter incremented now and decremented when the job returns, may be NULL
+ */
+void runJob(JobSystem *pJobSystem, JobFunction function, void *pData, JobCounter *pCounter);
+
+/**
+ * @brief Queue a job that only the workers other than the creating thread run, from any thread, it is run at once without such worker or when JOB_DEQUE_CAPACITY background jobs are already queued
+ * @param pJobSystem Target job system
+ * @param function Function of the job
+ * @param pData Data given to the function, it must stay valid until the job returns
+ * @param pCounter Counter incremented now and decremented when the job returns, may be NULL
+ */
+void runBackgroundJob(JobSystem *pJobSystem, JobFunction function, void *pData, JobCounter *pCounter);
+
+/**
+ * @brief Run pending jobs, its own first then stolen ones, until a counter drops to zero
+ * @param pJobSystem Target job system
+ * @param pCounter Counter to wait on
+ */
+void waitJobCounter(JobSystem *pJobSystem, JobCounter *pCounter);
+
+/**
+ * @brief Call a function on every index of a range split among the workers, and wait for all of them
+ * @param pJobSystem Target job system
+ * @param count Number of indices, from 0 to count - 1
+ * @param grain Maximum number of indices of a single call, at least 1
+ * @param function Function called on each piece of the range
+ * @param pData Data given to the function
+ */
+void parallelFor(JobSystem *pJobSystem, uint32_t count, uint32_t grain, JobRangeFunction function, void *pData);
+
+/**
+ * @brief Fetch the number of hardware threads of the machine
+ * @return Number of logical cores, at least 1
+ */
+uint32_t getHardwareThreadNumber();
+
+/**
+ * @brief Fetch the number of workers, including the creating thread
+ * @param pJobSystem Target job system
+ * @return Number of workers
+ */
+uint32_t getJobWorkerNumber(JobSystem *pJobSystem);
+
+/**
+ * @brief Fetch the index of the calling worker, to pick per-worker data such as a command pool
+ * @param pJobSystem Target job system
+ * @return Index from 0 to getJobWorkerNumber - 1, 0 for the creating thread, JOB_INVALID_WORKER for any other thread
+ */
+uint32_t getJobWorkerIndex(JobSystem *pJobSystem);
+
+/**
+ * @brief Fetch the number of jobs taken from the deque of another worker since the creation
+ * @param pJobSystem Target job system
+ * @return Number of successful steals
+ */
+uint64_t getJobStealNumber(JobSystem *pJobSystem);
+
+/**
+ * @brief Print the number of jobs run, stolen and the number of times a worker went to sleep since the creation
+ * @param pJobSystem Target job system
+ */
+void printJobSystem(JobSystem *pJobSystem);
+
+#endif // JOB_FUN_H
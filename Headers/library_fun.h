@@ -0,0 +1,120 @@
+/**
+ * @file library_fun.h
+ * @brief This file contains the API of the pipeline library, graphics pipeline variants linked from parts compiled once
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef LIBRARY_FUN_H
+#define LIBRARY_FUN_H
+
+#include "vk_fun.h"
+
+/*
+ * With VK_EXT_graphics_pipeline_library a graphics pipeline is split in four
+ * parts: the vertex input interface (one per topology), the pre-rasterization
+ * shaders and the fragment shader (one pair per registered shader set) and the
+ * fragment output interface (one per blend mode). Each part is compiled the
+ * first time a variant needs it, a variant is then a fast link of four parts.
+ * A background thread links the same parts again with link time optimization
+ * and the optimized pipeline replaces the fast one between two frames.
+ *
+ * Without the extension every variant is a plain monolithic compile of the
+ * shader set, the API stays the same.
+ *
+ * Variants belong to the caller like any pipeline made by
+ * createGraphicsPipeline, the library only owns its parts.
+ */
+#define PIPELINE_BLEND_OPAQUE 0
+#define PIPELINE_BLEND_ALPHA 1
+#define PIPELINE_BLEND_ADDITIVE 2
+#define PIPELINE_BLEND_MODE_NUMBER 3
+#define PIPELINE_TOPOLOGY_NUMBER (VK_PRIMITIVE_TOPOLOGY_PATCH_LIST + 1)
+#define PIPELINE_LIBRARY_MAX_SHADERS 32
+#define PIPELINE_LIBRARY_MAX_UPGRADES 64
+#define PIPELINE_LIBRARY_MAX_RETIRED 64
+#define PIPELINE_LIBRARY_INVALID_INDEX UINT32_MAX
+
+/**
+ * @brief Shader set a variant is linked from, with its pre-rasterization and fragment shader parts
+ */
+typedef struct PipelineShaders {
+	VkPipelineLayout pipelineLayout;
+	RenderTarget renderTarget;
+	VkShaderModule vertexShaderModule;
+	VkShaderModule fragmentShaderModule;
+	VkPipeline preRasterizationPart;
+	VkPipeline fragmentShaderPart;
+} PipelineShaders;
+
+/**
+ * @brief Fast linked variant waiting for its optimized link
+ */
+typedef struct PipelineUpgrade {
+	uint32_t shaders;
+	VkPrimitiveTopology topology;
+	uint32_t blendMode;
+	VkPipeline *pPipeline;
+	VkPipeline linkedPipeline;
+	VkPipeline optimizedPipeline;
+	VkBool32 isDone;
+} PipelineUpgrade;
+
+typedef struct PipelineLibrary PipelineLibrary;
+
+/**
+ * @brief Create a pipeline library, its link thread only starts when the extension is supported
+ * @param pPhysicalDevice Physical device the logical device was created from
+ * @param pDevice Target logical device
+ * @return The pipeline library, VK_NULL_HANDLE on failure
+ */
+PipelineLibrary *createPipelineLibrary(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice);
+
+/**
+ * @brief Stop the link thread and destroy the parts, the GPU must be idle, variants still belong to their owner
+ * @param pDevice Target logical device
+ * @param ppPipelineLibrary The pipeline library to be removed
+ */
+void deletePipelineLibrary(VkDevice *pDevice, PipelineLibrary **ppPipelineLibrary);
+
+/**
+ * @brief Register a shader set, the library takes ownership of the shader modules
+ * @param pPipelineLibrary Target pipeline library
+ * @param pPipelineLayout Layout of every variant of the shader set
+ * @param pRenderTarget Target the variants are drawn into, one color attachment without depth
+ * @param pVertexShaderModule Vertex shader module
+ * @param pFragmentShaderModule Fragment shader module
+ * @return Index of the shader set, PIPELINE_LIBRARY_INVALID_INDEX on failure
+ */
+uint32_t addPipelineShaders(PipelineLibrary *pPipelineLibrary, VkPipelineLayout *pPipelineLayout, RenderTarget *pRenderTarget, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule);
+
+/**
+ * @brief Link a variant of a shader set, its optimized link is queued when the extension is supported
+ * @param pPipelineLibrary Target pipeline library
+ * @param shaders Index of the shader set
+ * @param topology Primitive topology of the variant
+ * @param blendMode One of the PIPELINE_BLEND_* modes
+ * @param pPipeline Receives the variant, VK_NULL_HANDLE on failure, applyPipelineLibrary overwrites it with the optimized one
+ */
+void createPipelineVariant(PipelineLibrary *pPipelineLibrary, uint32_t shaders, VkPrimitiveTopology topology, uint32_t blendMode, VkPipeline *pPipeline);
+
+/**
+ * @brief Swap in the optimized variants linked since the last call, must be called between two frames on the render thread
+ * @param pPipelineLibrary Target pipeline library
+ * @return VK_TRUE if a variant changed, the command buffers must then be recorded again
+ */
+VkBool32 applyPipelineLibrary(PipelineLibrary *pPipelineLibrary);
+
+/**
+ * @brief Hand the fast linked variants replaced by applyPipelineLibrary to a deletion queue, once every command buffer has been recorded again
+ * @param pPipelineLibrary Target pipeline library
+ * @param pDeletionQueue Deletion queue destroying them after the submissions in flight
+ */
+void releasePipelineLibrary(PipelineLibrary *pPipelineLibrary, DeletionQueue *pDeletionQueue);
+
+/**
+ * @brief Print the parts, the variants and the average link times
+ * @param pPipelineLibrary Target pipeline library
+ */
+void printPipelineLibrary(PipelineLibrary *pPipelineLibrary);
+
+#endif // LIBRARY_FUN_H
@@ -0,0 +1,153 @@
+/**
+ * @file particle_fun.h
+ * @brief This file contains the API of the GPU particle system, emission, integration and recycling all run in compute shaders
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef PARTICLE_FUN_H
+#define PARTICLE_FUN_H
+
+#include "vk_fun.h"
+
+/*
+ * Dead particles are kept in a free list in device memory. Each frame the emit
+ * pass pops indices from it, the simulate pass pushes back the ones that die and
+ * appends the living ones to an alive list. The cull pass then tests the quad of
+ * every living particle against the views and compacts the visible ones into a
+ * visible list, whose length is the instance count of a single indexed indirect
+ * draw. The draw is emitted with a count read from the same buffer, zero when no
+ * particle is visible, through VK_KHR_draw_indirect_count, and falls back to a
+ * fixed count of one without it. The CPU never reads any of it back, its cost
+ * does not depend on the number of particles.
+ */
+#define PARTICLE_WORKGROUP_SIZE 256
+#define PARTICLE_MAX_BURSTS 8
+#define PARTICLE_MAX_EMIT 16384
+
+/**
+ * @brief One emission request, read by the emit compute shader
+ */
+typedef struct ParticleBurst {
+	float x;
+	float y;
+	float speed;
+	float life;
+	uint32_t color;
+	uint32_t count;
+	uint32_t padding[2];
+} ParticleBurst;
+
+/**
+ * @brief Per-frame parameters of the particle passes, laid out as a std140 uniform block
+ */
+typedef struct ParticleFrame {
+	float deltaTime;
+	float drag;
+	float pixelWidth;
+	float pixelHeight;
+	uint32_t seed;
+	uint32_t burstNumber;
+	uint32_t emitNumber;
+	uint32_t padding;
+	ParticleBurst bursts[PARTICLE_MAX_BURSTS];
+	float viewTransforms[VIEW_MAX_NUMBER][4];
+} ParticleFrame;
+
+/**
+ * @brief Particle buffers, compute and graphics pipelines
+ */
+typedef struct ParticleSystem {
+	VkBuffer particleBuffer;
+	VkDeviceMemory particleMemory;
+	VkBuffer freeListBuffer;
+	VkDeviceMemory freeListMemory;
+	VkBuffer aliveListBuffer;
+	VkDeviceMemory aliveListMemory;
+	VkBuffer stateBuffer;
+	VkDeviceMemory stateMemory;
+	VkBuffer visibleListBuffer;
+	VkDeviceMemory visibleListMemory;
+	VkBuffer drawBuffer;
+	VkDeviceMemory drawMemory;
+	VkBuffer indexBuffer;
+	VkDeviceMemory indexMemory;
+	VkBuffer frameBuffer;
+	VkDeviceMemory frameMemory;
+	char *pFrameData;
+	VkDeviceSize frameStride;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSet;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline emitPipeline;
+	VkPipeline simulatePipeline;
+	VkPipeline cullPipeline;
+	VkPipeline drawPipeline;
+	PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount;
+	uint32_t capacity;
+	uint32_t frameNumber;
+	uint32_t frameCounter;
+	ParticleFrame pendingFrame;
+	ViewConstants viewConstants;
+} ParticleSystem;
+
+/**
+ * @brief Create the particle buffers with every particle dead and the compute and draw pipelines
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device
+ * @param pQueue Queue used to initialize the free list, it must support compute
+ * @param pCommandPool Command pool of the given queue family
+ * @param pRenderTarget Attachments the particles are drawn into
+ * @param pExtent Extent of the attachments
+ * @param pShaderModules Emit, simulate, cull, vertex and fragment shader modules, in this order
+ * @param frameNumber Number of per-image parameter blocks, one for each swapchain image
+ * @param capacity Maximum number of living particles
+ * @return The particle system, its draw pipeline is VK_NULL_HANDLE on failure
+ */
+ParticleSystem createParticleSystem(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules, uint32_t frameNumber, uint32_t capacity);
+
+/**
+ * @brief Destroy a particle system and every resource it owns
+ * @param pDevice Target logical device
+ * @param pParticleSystem The particle system to be destroyed
+ */
+void deleteParticleSystem(VkDevice *pDevice, ParticleSystem *pParticleSystem);
+
+/**
+ * @brief Queue a burst for the next frame, bursts beyond PARTICLE_MAX_BURSTS or PARTICLE_MAX_EMIT particles are clamped
+ * @param pParticleSystem Target particle system
+ * @param x Horizontal origin in normalized device coordinates
+ * @param y Vertical origin in normalized device coordinates
+ * @param count Number of particles
+ * @param speed Maximum initial speed in normalized device coordinates per second
+ * @param life Maximum life time in seconds
+ * @param color Packed R8G8B8A8 color
+ */
+void emitParticles(ParticleSystem *pParticleSystem, float x, float y, uint32_t count, float speed, float life, uint32_t color);
+
+/**
+ * @brief Publish the queued bursts, the time step and the view transforms culled against to a swapchain image, its previous submission must be complete
+ * @param pParticleSystem Target particle system
+ * @param frameIndex Swapchain image index
+ * @param deltaTime Time step in seconds
+ */
+void updateParticles(ParticleSystem *pParticleSystem, uint32_t frameIndex, float deltaTime);
+
+/**
+ * @brief Record the emit, simulate and cull dispatches, outside of any render pass. The particle, free list, alive list, state,
+ * visible list and draw buffers are written by compute shaders and read by the draw, the render graph synchronizes them with the other passes
+ * @param pParticleSystem Target particle system
+ * @param pCommandBuffer Command buffer being recorded
+ * @param frameIndex Swapchain image index
+ */
+void recordParticleUpdate(ParticleSystem *pParticleSystem, VkCommandBuffer *pCommandBuffer, uint32_t frameIndex);
+
+/**
+ * @brief Record the indexed indirect draw of the visible particles, inside the render pass
+ * @param pParticleSystem Target particle system
+ * @param pCommandBuffer Command buffer being recorded
+ * @param frameIndex Swapchain image index
+ */
+void recordParticleDraw(ParticleSystem *pParticleSystem, VkCommandBuffer *pCommandBuffer, uint32_t frameIndex);
+
+#endif // PARTICLE_FUN_H
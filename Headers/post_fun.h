@@ -0,0 +1,132 @@
+/**
+ * @file post_fun.h
+ * @brief This file contains the API of the post-processing chain, bloom, vignette and CRT scanlines applied after the scene is drawn
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef POST_FUN_H
+#define POST_FUN_H
+
+#include "graph_fun.h"
+
+/*
+ * The chain is a sequence of render graph passes: the scene is drawn into a
+ * transient image, the bloom extracts its bright parts into a half resolution
+ * image blurred in two separable passes, and a last fullscreen pass adds the
+ * bloom and applies the vignette and the CRT scanlines while writing the
+ * output. Intermediate images are transient images owned by the render graph.
+ * Every stage is optional, a chain without any stage draws the scene straight
+ * into the output.
+ *
+ * With POST_STAGE_UPSCALE the scene only covers the top left corner of its
+ * image, scaled between POST_MIN_SCALE and 1 by a controller that keeps the
+ * measured GPU time under a budget, and the composite pass stretches it to the
+ * output. The chain's passes read that corner with scaled coordinates.
+ */
+#define POST_STAGE_BLOOM 0x1
+#define POST_STAGE_VIGNETTE 0x2
+#define POST_STAGE_CRT 0x4
+#define POST_STAGE_UPSCALE 0x8
+#define POST_STAGE_ALL (POST_STAGE_BLOOM | POST_STAGE_VIGNETTE | POST_STAGE_CRT)
+#define POST_MIN_SCALE 0.5f
+#define POST_SCALE_ALIGNMENT 8
+
+/**
+ * @brief Push constants shared by every post-processing shader
+ */
+typedef struct PostConstants {
+	float texelSize[2];
+	float direction[2];
+	float uvScale[2];
+	float threshold;
+	float intensity;
+	uint32_t stages;
+} PostConstants;
+
+/**
+ * @brief Pipelines, descriptor sets and graph resources of the post-processing chain
+ */
+typedef struct PostChain {
+	uint32_t stages;
+	VkExtent2D extent;
+	VkExtent2D bloomExtent;
+	VkExtent2D renderExtent;
+	float renderScale;
+	float gpuBudget;
+	float bloomThreshold;
+	float bloomIntensity;
+	VkSampler sampler;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet brightDescriptorSet;
+	VkDescriptorSet blurDescriptorSet;
+	VkDescriptorSet compositeDescriptorSet;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline bloomPipeline;
+	VkPipeline compositePipeline;
+	uint32_t sceneImage;
+	uint32_t bloomImages[2];
+	uint32_t outputImage;
+} PostChain;
+
+/**
+ * @brief Create the pipelines of the enabled stages
+ * @param pDevice Target logical device
+ * @param pRenderTarget Target of the graph passes, one color attachment in the output format
+ * @param pExtent Extent of the output
+ * @param pShaderModules Fullscreen vertex shader, bloom fragment shader and composite fragment shader
+ * @param stages Combination of POST_STAGE_* flags
+ * @param gpuBudget GPU time in milliseconds the render scale controller aims for with POST_STAGE_UPSCALE
+ * @return The post-processing chain, its composite pipeline is VK_NULL_HANDLE on failure when a stage is enabled
+ */
+PostChain createPostChain(VkDevice *pDevice, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules, uint32_t stages, float gpuBudget);
+
+/**
+ * @brief Destroy a post-processing chain, the graph images are owned by the render graph
+ * @param pDevice Target logical device
+ * @param pPostChain The post-processing chain to be destroyed
+ */
+void deletePostChain(VkDevice *pDevice, PostChain *pPostChain);
+
+/**
+ * @brief Set the render scale of the scene, the command buffers must be recorded again to use it
+ * @param pPostChain Target post-processing chain
+ * @param scale Fraction of the output size, clamped between POST_MIN_SCALE and 1, ignored without POST_STAGE_UPSCALE
+ * @return VK_TRUE if the render extent changed
+ */
+VkBool32 setPostChainScale(PostChain *pPostChain, float scale);
+
+/**
+ * @brief Move the render scale toward the one that keeps the GPU time of a frame under pPostChain->gpuBudget
+ * @param pPostChain Target post-processing chain
+ * @param gpuTime Measured GPU time of a frame in milliseconds
+ * @return VK_TRUE if the render extent changed
+ */
+VkBool32 updatePostChainScale(PostChain *pPostChain, float gpuTime);
+
+/**
+ * @brief Declare the image the scene is drawn into, must be called before the scene pass is added
+ * @param pPostChain Target post-processing chain
+ * @param pRenderGraph Render graph being built
+ * @param format Format of the output, the scene pipelines stay compatible with it
+ * @param output Image resource the chain writes, the swapchain images for example
+ * @return The image resource the scene pass draws into, output itself when no stage is enabled
+ */
+uint32_t addPostChainInput(PostChain *pPostChain, RenderGraph *pRenderGraph, VkFormat format, uint32_t output);
+
+/**
+ * @brief Append the passes of the enabled stages, must be called after the scene pass is added
+ * @param pPostChain Target post-processing chain
+ * @param pRenderGraph Render graph being built
+ */
+void addPostChainPasses(PostChain *pPostChain, RenderGraph *pRenderGraph);
+
+/**
+ * @brief Point the descriptor sets at the graph images, must be called once the graph is compiled
+ * @param pDevice Target logical device
+ * @param pPostChain Target post-processing chain
+ * @param pRenderGraph Compiled render graph
+ */
+void bindPostChainImages(VkDevice *pDevice, PostChain *pPostChain, RenderGraph *pRenderGraph);
+
+#endif // POST_FUN_H
@@ -0,0 +1,94 @@
+/**
+ * @file reload_fun.h
+ * @brief This file contains the API of the shader hot reload, watching the GLSL sources and rebuilding the pipelines in the background
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef RELOAD_FUN_H
+#define RELOAD_FUN_H
+
+#include "vk_fun.h"
+
+/*
+ * A watcher thread waits for inotify events on the shader source directory.
+ * When a .vert or .frag file is written, the thread compiles it to SPIR-V,
+ * with libshaderc when the build found it or glslangValidator otherwise, and
+ * rebuilds every registered pipeline using it. The new pipeline is only
+ * published: the render thread swaps it in between two frames, the old one
+ * stays alive until no command buffer references it anymore.
+ */
+#define RELOAD_MAX_PIPELINES 16
+#define RELOAD_MAX_RETIRED 32
+#define RELOAD_MAX_PATH 256
+
+/**
+ * @brief Called by the watcher thread to build a pipeline from freshly compiled shaders
+ * @param pDevice Target logical device
+ * @param pShaderModules Vertex and fragment shader modules, destroyed once the call returns
+ * @param pUserData User data given to addReloadPipeline
+ * @return The new pipeline, VK_NULL_HANDLE on failure
+ */
+typedef VkPipeline (*BuildPipelineCallback)(VkDevice *pDevice, VkShaderModule *pShaderModules, void *pUserData);
+
+/**
+ * @brief Pipeline rebuilt whenever one of its shader sources changes
+ */
+typedef struct ReloadPipeline {
+	char vertexFileName[64];
+	char fragmentFileName[64];
+	BuildPipelineCallback build;
+	void *pUserData;
+	VkPipeline *pPipeline;
+	VkPipeline pendingPipeline;
+} ReloadPipeline;
+
+typedef struct ShaderReloader ShaderReloader;
+
+/**
+ * @brief Create a shader reloader, nothing is watched before startShaderReloader
+ * @param pDevice Target logical device
+ * @param directory Directory holding the GLSL sources
+ * @return The shader reloader, VK_NULL_HANDLE on failure or when the platform has no inotify
+ */
+ShaderReloader *createShaderReloader(VkDevice *pDevice, const char *directory);
+
+/**
+ * @brief Stop the watcher thread and destroy the pipelines it built but that were never swapped in, the GPU must be idle
+ * @param pDevice Target logical device
+ * @param ppShaderReloader The shader reloader to be removed
+ */
+void deleteShaderReloader(VkDevice *pDevice, ShaderReloader **ppShaderReloader);
+
+/**
+ * @brief Register a pipeline, must be called before startShaderReloader
+ * @param pShaderReloader Target shader reloader
+ * @param vertexFileName Name of the vertex shader source in the watched directory, triangle.vert for example
+ * @param fragmentFileName Name of the fragment shader source in the watched directory
+ * @param build Function building the pipeline from the compiled shaders, called on the watcher thread
+ * @param pUserData User data given to build
+ * @param pPipeline Pipeline used by the command buffers, overwritten by applyShaderReload
+ */
+void addReloadPipeline(ShaderReloader *pShaderReloader, const char *vertexFileName, const char *fragmentFileName, BuildPipelineCallback build, void *pUserData, VkPipeline *pPipeline);
+
+/**
+ * @brief Start watching the shader sources
+ * @param pShaderReloader Target shader reloader
+ * @return 0 on success, -1 on failure
+ */
+int startShaderReloader(ShaderReloader *pShaderReloader);
+
+/**
+ * @brief Swap in the pipelines rebuilt since the last call, must be called between two frames on the render thread
+ * @param pShaderReloader Target shader reloader
+ * @return VK_TRUE if a pipeline changed, the command buffers must then be recorded again
+ */
+VkBool32 applyShaderReload(ShaderReloader *pShaderReloader);
+
+/**
+ * @brief Hand the pipelines replaced by applyShaderReload to a deletion queue, once every command buffer has been recorded again
+ * @param pShaderReloader Target shader reloader
+ * @param pDeletionQueue Deletion queue destroying them after the submissions in flight
+ */
+void releaseShaderReload(ShaderReloader *pShaderReloader, DeletionQueue *pDeletionQueue);
+
+#endif // RELOAD_FUN_H
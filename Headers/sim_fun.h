@@ -0,0 +1,219 @@
+/**
+ * @file sim_fun.h
+ * @brief This file contains the API for the pong game simulation, independent from any graphics API
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef SIM_FUN_H
+#define SIM_FUN_H
+
+#include "std_c.h"
+#include "job_fun.h"
+
+/*
+ * The playfield uses the same normalized coordinates as the Vulkan clip space:
+ * x and y both range from -1.0 to 1.0, the left paddle stands at -SIM_PADDLE_X
+ * and the right paddle at +SIM_PADDLE_X. One tick is 1/120 of a second.
+ */
+#define SIM_TICK_RATE 120
+#define SIM_PADDLE_X 0.9f
+#define SIM_PADDLE_HALF_HEIGHT 0.15f
+#define SIM_PADDLE_SPEED 0.025f
+#define SIM_BALL_RADIUS 0.02f
+#define SIM_BALL_START_SPEED 0.012f
+#define SIM_BALL_MAX_SPEED 0.035f
+#define SIM_BALL_SPEEDUP 1.05f
+#define SIM_WINNING_SCORE 11
+#define SIM_MAX_TICKS 200000
+
+/*
+ * Events reported by a simulation step, combined as a bitmask
+ */
+#define SIM_EVENT_NONE 0x0
+#define SIM_EVENT_WALL_HIT 0x1
+#define SIM_EVENT_PADDLE_HIT 0x2
+#define SIM_EVENT_GOAL_LEFT 0x4
+#define SIM_EVENT_GOAL_RIGHT 0x8
+#define SIM_EVENT_MATCH_OVER 0x10
+
+/**
+ * @brief State of a single pong match
+ */
+typedef struct PongMatch {
+	float ballX, ballY;
+	float ballVX, ballVY;
+	float paddleY[2];
+	float aiError[2];
+	uint32_t score[2];
+	uint32_t tick;
+	uint32_t hits;
+	uint32_t rally;
+	uint32_t longestRally;
+	uint64_t rngState;
+} PongMatch;
+
+/**
+ * @brief Outcome of a finished pong match
+ */
+typedef struct PongMatchResult {
+	uint64_t seed;
+	uint32_t score[2];
+	uint32_t ticks;
+	uint32_t hits;
+	uint32_t longestRally;
+} PongMatchResult;
+
+/**
+ * @brief Reset a match to its initial state and serve the first ball
+ * @param pMatch Target match
+ * @param seed Seed of the match random generator, the same seed always plays the same match
+ */
+void initMatch(PongMatch *pMatch, uint64_t seed);
+
+/**
+ * @brief Put the ball back in the middle of the field after a goal
+ * @param pMatch Target match
+ * @param side 0 to serve towards the left paddle, 1 towards the right paddle
+ */
+void serveBall(PongMatch *pMatch, uint32_t side);
+
+/**
+ * @brief Update the rally counters after a paddle hit and draw a new aiming error for the other player
+ * @param pMatch Target match, its random generator is advanced
+ * @param side 0 if the left paddle hit the ball, 1 if the right paddle did
+ */
+void countPaddleHit(PongMatch *pMatch, uint32_t side);
+
+/**
+ * @brief Advance a match by one tick
+ * @param pMatch Target match
+ * @param leftAction Left paddle command, from -1.0 (down) to 1.0 (up)
+ * @param rightAction Right paddle command, from -1.0 (down) to 1.0 (up)
+ * @return Bitmask of SIM_EVENT_* raised during the tick
+ */
+uint32_t stepMatch(PongMatch *pMatch, float leftAction, float rightAction);
+
+/**
+ * @brief Fetch if a match has a winner or has reached SIM_MAX_TICKS
+ * @param pMatch Target match
+ * @return 1 if the match is over, otherwise 0
+ */
+int isMatchOver(PongMatch *pMatch);
+
+/**
+ * @brief Compute the paddle command of a computer controlled player
+ * @param pMatch Target match
+ * @param side 0 for the left paddle, 1 for the right paddle
+ * @param skill Player skill from 0.0 (slow and inaccurate) to 1.0 (perfect)
+ * @return The paddle command to give to stepMatch
+ */
+float getAIAction(PongMatch *pMatch, uint32_t side, float skill);
+
+/**
+ * @brief Play a whole AI versus AI match
+ * @param seed Seed of the match
+ * @param leftSkill Skill of the left player
+ * @param rightSkill Skill of the right player
+ * @return The outcome of the match
+ */
+PongMatchResult runMatch(uint64_t seed, float leftSkill, float rightSkill);
+
+/*
+ * Layout of the batched observations: feature k of match i is stored at
+ * pObservations[k * matchNumber + i], so every feature is a contiguous row
+ */
+#define SIM_OBSERVATION_BALL_X 0
+#define SIM_OBSERVATION_BALL_Y 1
+#define SIM_OBSERVATION_BALL_VX 2
+#define SIM_OBSERVATION_BALL_VY 3
+#define SIM_OBSERVATION_LEFT_PADDLE_Y 4
+#define SIM_OBSERVATION_RIGHT_PADDLE_Y 5
+#define SIM_OBSERVATION_SIZE 6
+
+/**
+ * @brief Matches stepped in lockstep, stored as structure of arrays
+ */
+typedef struct PongBatch {
+	uint32_t matchNumber;
+	uint64_t nextSeed;
+	void *memory;
+	float *ballX, *ballY;
+	float *ballVX, *ballVY;
+	float *leftPaddleY, *rightPaddleY;
+	float *leftAIError, *rightAIError;
+	uint32_t *leftScore, *rightScore;
+	uint32_t *tick;
+	uint32_t *hits, *rally, *longestRally;
+	uint64_t *rngState;
+	uint8_t *hitSides;
+} PongBatch;
+
+/**
+ * @brief Create a batch of matches
+ * @param matchNumber Number of matches in the batch
+ * @param baseSeed Seed of the first match, every reset match takes the next seed
+ * @return The created batch, its arrays are 64 bytes aligned
+ */
+PongBatch createBatch(uint32_t matchNumber, uint64_t baseSeed);
+
+/**
+ * @brief Delete a batch of matches
+ * @param pBatch The batch to be removed
+ */
+void deleteBatch(PongBatch *pBatch);
+
+/**
+ * @brief Copy the state of one match of a batch
+ * @param pBatch Target batch
+ * @param index Index of the match in the batch
+ * @param pMatch Filled with the state of the match, as stepMatch would have left it
+ */
+void getBatchMatch(PongBatch *pBatch, uint32_t index, PongMatch *pMatch);
+
+/**
+ * @brief Write the current observations of every match of a batch
+ * @param pBatch Target batch
+ * @param pObservations Caller owned buffer of SIM_OBSERVATION_SIZE * matchNumber floats
+ */
+void getBatchObservations(PongBatch *pBatch, float *pObservations);
+
+/**
+ * @brief Advance every match of a batch by one tick, finished matches restart with a new seed
+ * @param pBatch Target batch
+ * @param pActions Paddle commands, left paddle of match i at [i] and right paddle at [matchNumber + i]
+ * @param pObservations Caller owned buffer of SIM_OBSERVATION_SIZE * matchNumber floats, written in place
+ * @param pRewards Caller owned buffer of matchNumber floats, 1.0 when the left player scores, -1.0 when the right player scores
+ * @param pDones Caller owned buffer of matchNumber bytes, 1 when the match ended during the step
+ */
+void stepBatch(PongBatch *pBatch, const float *pActions, float *pObservations, float *pRewards, uint8_t *pDones);
+
+/**
+ * @brief Play independent AI versus AI matches on a job system of its own
+ * @param matchNumber Number of matches to play
+ * @param baseSeed Seed of the first match, match i is played with baseSeed + i
+ * @param leftSkill Skill of the left player
+ * @param rightSkill Skill of the right player
+ * @param threadNumber Number of worker threads, 0 to use every hardware thread, at most JOB_MAX_WORKERS
+ * @param pStealNumber Filled with the number of successful steals, may be NULL
+ * @return Array of matchNumber results, ordered by match index
+ */
+PongMatchResult *runMatches(uint32_t matchNumber, uint64_t baseSeed, float leftSkill, float rightSkill, uint32_t threadNumber, uint32_t *pStealNumber);
+
+/**
+ * @brief Delete an array of match results
+ * @param ppResults Pointer to the pointer of the array of results
+ */
+void deleteMatchResults(PongMatchResult **ppResults);
+
+/**
+ * @brief Aggregate match results and write them into a summary file
+ * @param fileName Path of the summary file
+ * @param pResults Array of match results
+ * @param matchNumber Number of results in the given array
+ * @param seconds Wall clock duration of the run
+ * @param threadNumber Number of worker threads used for the run
+ * @return 0 on success, -1 if the file could not be written
+ */
+int writeMatchSummary(const char *fileName, PongMatchResult *pResults, uint32_t matchNumber, double seconds, uint32_t threadNumber);
+
+#endif // SIM_FUN_H
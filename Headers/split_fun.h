@@ -0,0 +1,110 @@
+/**
+ * @file split_fun.h
+ * @brief This file contains the API of the split screen, both views of the match are drawn in a single multiview pass and composed side by side
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef SPLIT_FUN_H
+#define SPLIT_FUN_H
+
+#include "graph_fun.h"
+
+/*
+ * The scene pass gets a view mask and draws into a transient image with one
+ * layer per view, half as wide as the output. Every draw is recorded once and
+ * the driver broadcasts it to both layers, the scene vertex shaders only pick
+ * the transform of gl_ViewIndex. A fullscreen pass then writes the left view
+ * in the left half of the output and the right view in the right half.
+ *
+ * Each view zooms by SPLIT_VIEW_ZOOM toward its own side of the field, so a
+ * player sees their paddle and a bit past the net at a less squeezed aspect.
+ * The composed image is the input of the post-processing chain, the scene
+ * pipelines are created with the view mask and the post pipelines without.
+ */
+#define SPLIT_VIEW_NUMBER 2
+#define SPLIT_VIEW_MASK 0x3
+#define SPLIT_VIEW_ZOOM 1.5f
+#define SPLIT_DIVIDER_WIDTH 2
+
+/**
+ * @brief Push constants of the split screen composition shader
+ */
+typedef struct SplitConstants {
+	float texelSize[2];
+	float uvScale[2];
+	float divider;
+} SplitConstants;
+
+/**
+ * @brief Pipeline, descriptor set and graph resources of the split screen
+ */
+typedef struct SplitScreen {
+	VkExtent2D extent;
+	VkExtent2D viewExtent;
+	VkExtent2D renderExtent;
+	VkExtent2D viewRenderExtent;
+	ViewConstants viewConstants;
+	VkSampler sampler;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSet;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline pipeline;
+	uint32_t viewImage;
+	uint32_t outputImage;
+	uint32_t scenePass;
+	uint32_t composePass;
+} SplitScreen;
+
+/**
+ * @brief Create the composition pipeline and the view transforms
+ * @param pDevice Target logical device
+ * @param pRenderTarget Target without multiview, one color attachment in the output format
+ * @param pExtent Extent of the output
+ * @param pShaderModules Fullscreen vertex shader and split composition fragment shader
+ * @return The split screen, its pipeline is VK_NULL_HANDLE on failure
+ */
+SplitScreen createSplitScreen(VkDevice *pDevice, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules);
+
+/**
+ * @brief Destroy a split screen, the layered image is owned by the render graph
+ * @param pDevice Target logical device
+ * @param pSplitScreen The split screen to be destroyed
+ */
+void deleteSplitScreen(VkDevice *pDevice, SplitScreen *pSplitScreen);
+
+/**
+ * @brief Declare the layered image both views are drawn into, must be called before the scene pass is added
+ * @param pSplitScreen Target split screen
+ * @param pRenderGraph Render graph being built
+ * @param format Format of the output, the scene pipelines stay compatible with it
+ * @param output Image resource the composition writes, the input of the post-processing chain for example
+ * @return The image resource the scene pass draws into
+ */
+uint32_t addSplitScreenInput(SplitScreen *pSplitScreen, RenderGraph *pRenderGraph, VkFormat format, uint32_t output);
+
+/**
+ * @brief Give the scene pass the view mask and append the composition pass, must be called after the scene pass is added
+ * @param pSplitScreen Target split screen
+ * @param pRenderGraph Render graph being built
+ * @param scenePass Pass drawing the scene into the image returned by addSplitScreenInput
+ */
+void addSplitScreenPasses(SplitScreen *pSplitScreen, RenderGraph *pRenderGraph, uint32_t scenePass);
+
+/**
+ * @brief Point the descriptor set at the layered image, must be called once the graph is compiled
+ * @param pDevice Target logical device
+ * @param pSplitScreen Target split screen
+ * @param pRenderGraph Compiled render graph
+ */
+void bindSplitScreenImages(VkDevice *pDevice, SplitScreen *pSplitScreen, RenderGraph *pRenderGraph);
+
+/**
+ * @brief Restrict the composition to the top left corner of the output and the views to the matching corner of their layers
+ * @param pSplitScreen Target split screen
+ * @param pRenderGraph Compiled render graph
+ * @param pExtent Size of the composed area, the render extent of the post-processing chain for example
+ */
+void setSplitScreenRenderArea(SplitScreen *pSplitScreen, RenderGraph *pRenderGraph, VkExtent2D *pExtent);
+
+#endif // SPLIT_FUN_H
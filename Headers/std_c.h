@@ -3,6 +3,8 @@
 
 #include "stdio.h"
 #include "stdlib.h"
+#include "stdint.h"
+#include "stddef.h"
 #include "string.h"
 #include "limits.h"
 #include "time.h"
@@ -0,0 +1,139 @@
+/**
+ * @file stream_fun.h
+ * @brief This file contains the API of the texture streamer, decoding image files on the job system and uploading them on a transfer queue
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef STREAM_FUN_H
+#define STREAM_FUN_H
+
+#include "submit_fun.h"
+#include "job_fun.h"
+
+/*
+ * A request only queues a job reading the header of a binary PPM (P6) or
+ * PGM (P5) file with pread, the header must fit in its first
+ * STREAM_HEADER_SIZE bytes. That job creates the image, places it in a
+ * single device-local block of STREAM_IMAGE_MEMORY_SIZE bytes allocated at
+ * creation, and writes its view in one of the descriptor sets allocated at
+ * creation too. Once per frame the render thread reserves room for the
+ * textures whose header is read in a persistently mapped staging ring of
+ * STREAM_STAGING_SIZE bytes, in order and without waiting: a texture that
+ * does not fit yet waits for a later frame. It then starts one job per
+ * block of STREAM_DECODE_ROWS rows, each expanding its rows to RGBA
+ * straight into the reserved range through a STREAM_READ_SIZE bytes buffer
+ * on its stack. A job never waits for room nor allocates. Every streamer
+ * job goes through runBackgroundJob, which the render thread never runs
+ * while it waits on a counter, so it never creates an image nor decodes.
+ *
+ * Once per frame the render thread records the decoded textures of a batch:
+ * the transfer queue copies the first mip level into a device-local image
+ * and releases it to the graphics family, the copy signals the transfer
+ * timeline. When a later frame reads that timeline value as completed, the
+ * graphics queue acquires the image, fills the mip chain with a chain of
+ * linear blits and moves it to the shader read layout, then signals the
+ * graphics timeline. The texture can be sampled from that same frame, its
+ * commands run before the frame on the graphics queue. The render thread
+ * only polls the timelines, it never waits on them nor on the decoding jobs.
+ *
+ * Without a transfer only queue family the copies go to the graphics queue
+ * and no ownership transfer is needed. Without VK_KHR_timeline_semaphore
+ * the streamer is not created.
+ */
+#define STREAM_MAX_TEXTURES 32
+#define STREAM_MAX_BATCHES 4
+#define STREAM_BATCH_TEXTURES 4
+#define STREAM_STAGING_SIZE (32u << 20)
+#define STREAM_STAGING_ALIGNMENT 256
+#define STREAM_HEADER_SIZE 1024
+#define STREAM_DECODE_ROWS 64
+#define STREAM_READ_SIZE (64u << 10)
+#define STREAM_IMAGE_MEMORY_SIZE (128u << 20)
+#define STREAM_MAX_EXTENT 2048
+#define STREAM_MAX_PATH 256
+#define STREAM_TEXTURE_FORMAT VK_FORMAT_R8G8B8A8_UNORM
+#define STREAM_IMAGE_USAGE (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+#define STREAM_INVALID_TEXTURE UINT32_MAX
+
+#define STREAM_TEXTURE_QUEUED 0
+#define STREAM_TEXTURE_DECODED 1
+#define STREAM_TEXTURE_UPLOADING 2
+#define STREAM_TEXTURE_READY 3
+#define STREAM_TEXTURE_FAILED 4
+
+typedef struct TextureStreamer TextureStreamer;
+
+/**
+ * @brief Create the staging ring, the texture memory, the descriptor sets, the command pools and the timelines
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device, created with the timeline semaphore feature
+ * @param graphicsQueueFamilyIndex Queue family of the drawing queue
+ * @param pGraphicsQueue Drawing queue, the textures are sampled there
+ * @param transferQueueFamilyIndex Queue family of the transfer queue, from getTransferQueueFamilyIndex
+ * @param pTransferQueue Queue the copies are submitted to, the drawing queue when both families are the same
+ * @param pJobSystem Job system created by the render thread, with at least one other worker, the files are decoded on it
+ * @return The texture streamer, VK_NULL_HANDLE on failure
+ */
+TextureStreamer *createTextureStreamer(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, uint32_t graphicsQueueFamilyIndex, VkQueue *pGraphicsQueue, uint32_t transferQueueFamilyIndex, VkQueue *pTransferQueue, JobSystem *pJobSystem);
+
+/**
+ * @brief Wait for the decoding jobs, which give up their texture, wait for the uploads in flight, destroy every texture and print the streaming statistics
+ * @param pDevice Target logical device
+ * @param ppTextureStreamer The texture streamer to be removed
+ */
+void deleteTextureStreamer(VkDevice *pDevice, TextureStreamer **ppTextureStreamer);
+
+/**
+ * @brief Start the job reading the header of an image file to be decoded and uploaded, never blocks, called by the render thread
+ * @param pTextureStreamer Target texture streamer
+ * @param fileName Binary PPM or PGM file, copied
+ * @return The index of the texture, STREAM_INVALID_TEXTURE when STREAM_MAX_TEXTURES were already requested
+ */
+uint32_t requestTexture(TextureStreamer *pTextureStreamer, const char *fileName);
+
+/**
+ * @brief Submit the acquisitions of completed copies and the copies of decoded textures, and start the decoding of the textures that fit in the staging ring, once per frame before its submission
+ * @param pTextureStreamer Target texture streamer
+ * @return VK_TRUE when a texture became ready during this call
+ */
+VkBool32 updateTextureStreamer(TextureStreamer *pTextureStreamer);
+
+/**
+ * @brief Share the queues with a frame submitter, the streamer then locks them around each of its submissions
+ * @param pTextureStreamer Target texture streamer
+ * @param pFrameSubmitter Frame submitter owning the queues, VK_NULL_HANDLE once it is deleted
+ */
+void setTextureStreamerSubmitter(TextureStreamer *pTextureStreamer, FrameSubmitter *pFrameSubmitter);
+
+/**
+ * @brief Fetch the state of a texture
+ * @param pTextureStreamer Target texture streamer
+ * @param texture Index returned by requestTexture
+ * @return One of the STREAM_TEXTURE_* states
+ */
+uint32_t getTextureState(TextureStreamer *pTextureStreamer, uint32_t texture);
+
+/**
+ * @brief Fetch the descriptor set sampling a texture at binding 0, with its mip chain and a trilinear sampler
+ * @param pTextureStreamer Target texture streamer
+ * @param texture Index returned by requestTexture
+ * @return The descriptor set, VK_NULL_HANDLE until the texture is ready
+ */
+VkDescriptorSet getTextureDescriptorSet(TextureStreamer *pTextureStreamer, uint32_t texture);
+
+/**
+ * @brief Fetch the sampler, view and layout of a texture, to write it in another descriptor set such as a bindless table
+ * @param pTextureStreamer Target texture streamer
+ * @param texture Index returned by requestTexture
+ * @return The image info, its view is VK_NULL_HANDLE until the texture is ready
+ */
+VkDescriptorImageInfo getTextureImageInfo(TextureStreamer *pTextureStreamer, uint32_t texture);
+
+/**
+ * @brief Fetch the layout of the texture descriptor sets, a single combined image sampler read by the fragment stage
+ * @param pTextureStreamer Target texture streamer
+ * @return The descriptor set layout, owned by the streamer
+ */
+VkDescriptorSetLayout *getTextureSetLayout(TextureStreamer *pTextureStreamer);
+
+#endif // STREAM_FUN_H
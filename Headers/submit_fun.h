@@ -0,0 +1,106 @@
+/**
+ * @file submit_fun.h
+ * @brief This file contains the API of the frame submitter, a thread acquiring, submitting and presenting the swapchain images on behalf of the render thread
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef SUBMIT_FUN_H
+#define SUBMIT_FUN_H
+
+#include "vk_fun.h"
+
+/*
+ * While it runs, the submit thread is the only one to touch the swapchain
+ * and the only one to submit the frames. It keeps the image of the next frame
+ * acquired in advance: the render thread takes it from a ring of
+ * SUBMIT_QUEUE_CAPACITY acquired images, records the frame and pushes it to a
+ * ring of SUBMIT_QUEUE_CAPACITY submissions, then starts the next frame on
+ * the image already acquired while the previous one is submitted and
+ * presented. A blocking vkQueuePresentKHR or vkAcquireNextImageKHR only holds
+ * the submit thread, the render thread waits only when both rings leave it
+ * nothing to do.
+ *
+ * Before acquiring the image of a frame slot the submit thread waits for the
+ * front fence of that slot, the acquire semaphore of the slot is then free,
+ * and once acquired for the back fence of the image. Being the only thread
+ * resetting the fences, it is also the only one waiting on them.
+ * Since at most one frame is acquired in advance, two images are acquired at
+ * once at most, which every swapchain of minImageCount + 1 images allows.
+ *
+ * Each queue has its own lock, held by the submit thread only around
+ * vkQueueSubmit and around vkQueuePresentKHR on the presenting queue. A
+ * present blocked on a full swapchain therefore holds the drawing queue only
+ * when it is also the presenting queue. Other threads submitting to the same
+ * queues, such as the texture streamer, lock the queue they submit to with
+ * lockSubmitQueue around vkQueueSubmit.
+ *
+ * Once waitFrameSubmitter or deleteFrameSubmitter is called no image is
+ * acquired in advance any more, and the images already acquired that no
+ * frame will draw get an empty submission waiting on their acquire semaphore
+ * and signaling the fence of their slot, so no semaphore is left signaled.
+ * waitFrameSubmitter returns once these submissions are made, before the
+ * device is waited idle, and deleteFrameSubmitter waits every slot fence.
+ */
+#define SUBMIT_QUEUE_CAPACITY 2
+
+typedef struct FrameSubmitter FrameSubmitter;
+
+/**
+ * @brief Start the submit thread, it acquires the images of the first frames at once
+ * @param pDevice Target logical device
+ * @param pSwapchain Swapchain owned by the submit thread until deleteFrameSubmitter
+ * @param pDrawingQueue Queue the frames are submitted to
+ * @param pPresentingQueue Queue the images are presented on, may be the drawing queue
+ * @param pCommandBuffers Command buffers of the swapchain images
+ * @param pFrontFences Fence of each frame slot, signaled by its submission
+ * @param pBackFences Fence of the last frame drawn on each swapchain image, waited and set by the submit thread only
+ * @param pWaitSemaphores Acquire semaphore of each frame slot
+ * @param pSignalSemaphores Render finished semaphore of each frame slot
+ * @param maxFrames Number of frame slots
+ * @return The frame submitter, VK_NULL_HANDLE when the thread cannot be started
+ */
+FrameSubmitter *createFrameSubmitter(VkDevice *pDevice, VkSwapchainKHR *pSwapchain, VkQueue *pDrawingQueue, VkQueue *pPresentingQueue, VkCommandBuffer *pCommandBuffers, VkFence *pFrontFences, VkFence *pBackFences, VkSemaphore *pWaitSemaphores, VkSemaphore *pSignalSemaphores, uint32_t maxFrames);
+
+/**
+ * @brief Submit and present the frames still queued, stop the submit thread, wait the fences of every frame slot and print the waiting times of both threads
+ * @param ppFrameSubmitter The frame submitter to be removed
+ */
+void deleteFrameSubmitter(FrameSubmitter **ppFrameSubmitter);
+
+/**
+ * @brief Take the image acquired for the next frame, waiting for the submit thread when none is ready yet
+ * @param pFrameSubmitter Target frame submitter
+ * @param pFrame Returned frame slot the image was acquired with, to be given back to pushSubmitterFrame
+ * @return Index of the swapchain image
+ */
+uint32_t takeSubmitterImage(FrameSubmitter *pFrameSubmitter, uint32_t *pFrame);
+
+/**
+ * @brief Hand a recorded frame to the submit thread, waiting only when SUBMIT_QUEUE_CAPACITY frames are already queued
+ * @param pFrameSubmitter Target frame submitter
+ * @param frame Frame slot returned by takeSubmitterImage with the image
+ * @param imageIndex Image returned by takeSubmitterImage
+ */
+void pushSubmitterFrame(FrameSubmitter *pFrameSubmitter, uint32_t frame, uint32_t imageIndex);
+
+/**
+ * @brief Stop acquiring images, wait until every frame pushed is submitted and presented and the images acquired in advance are given back, the queues are then idle from the host side
+ * @param pFrameSubmitter Target frame submitter, no frame can be pushed afterwards
+ */
+void waitFrameSubmitter(FrameSubmitter *pFrameSubmitter);
+
+/**
+ * @brief Take the exclusive use of a queue, to submit to it from another thread
+ * @param pFrameSubmitter Target frame submitter, may be VK_NULL_HANDLE when there is no submit thread
+ * @param queue Queue to submit to, nothing is locked when the submit thread does not use it
+ */
+void lockSubmitQueue(FrameSubmitter *pFrameSubmitter, VkQueue queue);
+
+/**
+ * @brief Give back a queue taken with lockSubmitQueue
+ * @param pFrameSubmitter Target frame submitter, may be VK_NULL_HANDLE when there is no submit thread
+ * @param queue Queue given to lockSubmitQueue
+ */
+void unlockSubmitQueue(FrameSubmitter *pFrameSubmitter, VkQueue queue);
+
+#endif // SUBMIT_FUN_H
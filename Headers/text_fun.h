@@ -0,0 +1,162 @@
+/**
+ * @file text_fun.h
+ * @brief This file contains the API of the glyph atlas text renderer, every string of a frame is drawn with a single instanced draw
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef TEXT_FUN_H
+#define TEXT_FUN_H
+
+#include "bindless_fun.h"
+
+/*
+ * The atlas is built at startup from a 5x7 bitmap font covering ASCII 0x20 to
+ * 0x5F (lowercase letters are drawn uppercase), each glyph lives in an 8x8 cell.
+ * The cell after the last glyph is fully opaque and is used to draw solid rects.
+ *
+ * With a bindless table the atlas takes a slot of the table and every quad
+ * carries the index of the texture it samples, so sprites of any number of
+ * textures are drawn with the glyphs in the same instanced draw.
+ */
+#define TEXT_CELL_SIZE 8
+#define TEXT_FIRST_CHARACTER 0x20
+#define TEXT_GLYPH_NUMBER 64
+#define TEXT_SOLID_GLYPH TEXT_GLYPH_NUMBER
+#define TEXT_ATLAS_COLUMNS 16
+#define TEXT_ATLAS_ROWS 5
+
+/**
+ * @brief Build a packed R8G8B8A8 color
+ */
+#define TEXT_COLOR(r, g, b, a) ((uint32_t)(r) | ((uint32_t)(g) << 8) | ((uint32_t)(b) << 16) | ((uint32_t)(a) << 24))
+
+/**
+ * @brief One glyph quad, read by the vertex shader as per-instance attributes
+ */
+typedef struct TextGlyph {
+	float rect[4];
+	float uv[4];
+	uint32_t color;
+	uint32_t texture;
+} TextGlyph;
+
+/**
+ * @brief Glyph atlas, pipeline and per-image glyph buffers
+ */
+typedef struct TextRenderer {
+	VkImage atlasImage;
+	VkDeviceMemory atlasMemory;
+	VkImageView atlasImageView;
+	VkSampler sampler;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSet;
+	BindlessTable *pBindlessTable;
+	VkImageView bindlessAtlasView;
+	uint32_t atlasTexture;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline pipeline;
+	VkBuffer frameBuffer;
+	VkDeviceMemory frameMemory;
+	char *pFrameData;
+	VkDeviceSize frameStride;
+	uint32_t frameNumber;
+	uint32_t glyphCapacity;
+	VkExtent2D extent;
+	uint32_t currentFrame;
+	uint32_t glyphNumber;
+	TextGlyph *pGlyphs;
+	ViewConstants viewConstants;
+} TextRenderer;
+
+/**
+ * @brief Build the glyph atlas, upload it and create the text pipeline and per-image buffers
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device
+ * @param pQueue Queue used to upload the atlas
+ * @param pCommandPool Command pool of the given queue family
+ * @param pRenderTarget Attachments the text is drawn into
+ * @param pExtent Extent of the attachments
+ * @param pVertexShaderModule Text vertex shader
+ * @param pFragmentShaderModule Text fragment shader
+ * @param frameNumber Number of per-image buffers, one for each swapchain image
+ * @param glyphCapacity Maximum number of glyphs drawn in a frame
+ * @return The text renderer, its pipeline is VK_NULL_HANDLE on failure
+ */
+TextRenderer createTextRenderer(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, uint32_t frameNumber, uint32_t glyphCapacity);
+
+/**
+ * @brief Destroy a text renderer and every resource it owns
+ * @param pDevice Target logical device
+ * @param pTextRenderer The text renderer to be destroyed
+ */
+void deleteTextRenderer(VkDevice *pDevice, TextRenderer *pTextRenderer);
+
+/**
+ * @brief Switch a text renderer to a bindless table: its atlas takes a slot of the table and its pipeline indexes the table
+ * @param pDevice Target logical device
+ * @param pTextRenderer Target text renderer, before its first draw is recorded
+ * @param pBindlessTable Bindless table bound by every draw of the renderer, must outlive it
+ * @param pRenderTarget Attachments the text is drawn into
+ * @param pVertexShaderModule Sprite vertex shader, passing the texture index of each quad
+ * @param pFragmentShaderModule Sprite fragment shader, sampling the table
+ * @return 0 on success, -1 when the renderer keeps its own descriptor set
+ */
+int useTextBindlessTable(VkDevice *pDevice, TextRenderer *pTextRenderer, BindlessTable *pBindlessTable, RenderTarget *pRenderTarget, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule);
+
+/**
+ * @brief Start writing the glyphs of a swapchain image, its previous submission must be complete
+ * @param pTextRenderer Target text renderer
+ * @param frameIndex Swapchain image index
+ */
+void beginText(TextRenderer *pTextRenderer, uint32_t frameIndex);
+
+/**
+ * @brief Append a string, glyphs beyond the capacity are dropped
+ * @param pTextRenderer Target text renderer
+ * @param x Left of the first glyph in pixels
+ * @param y Top of the first glyph in pixels
+ * @param scale Size of a font pixel in screen pixels
+ * @param color Packed color from TEXT_COLOR
+ * @param text Zero terminated string, '\n' starts a new line
+ */
+void drawText(TextRenderer *pTextRenderer, float x, float y, float scale, uint32_t color, const char *text);
+
+/**
+ * @brief Append a solid rectangle, drawn with the same instanced draw as the glyphs
+ * @param pTextRenderer Target text renderer
+ * @param x Left of the rectangle in pixels
+ * @param y Top of the rectangle in pixels
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param color Packed color from TEXT_COLOR
+ */
+void drawTextRect(TextRenderer *pTextRenderer, float x, float y, float width, float height, uint32_t color);
+
+/**
+ * @brief Append a textured rectangle, drawn with the same instanced draw as the glyphs
+ * @param pTextRenderer Target text renderer
+ * @param x Left of the rectangle in pixels
+ * @param y Top of the rectangle in pixels
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param texture Index returned by addBindlessTexture, the rectangle is solid without a bindless table
+ * @param color Packed color from TEXT_COLOR, multiplied with the texture
+ */
+void drawTextSprite(TextRenderer *pTextRenderer, float x, float y, float width, float height, uint32_t texture, uint32_t color);
+
+/**
+ * @brief Publish the glyph count of the current image to its indirect draw
+ * @param pTextRenderer Target text renderer
+ */
+void endText(TextRenderer *pTextRenderer);
+
+/**
+ * @brief Record the single indirect draw of a swapchain image, the glyph count is read by the GPU at execution
+ * @param pTextRenderer Target text renderer
+ * @param pCommandBuffer Command buffer being recorded, inside the render pass
+ * @param frameIndex Swapchain image index
+ */
+void recordTextDraw(TextRenderer *pTextRenderer, VkCommandBuffer *pCommandBuffer, uint32_t frameIndex);
+
+#endif // TEXT_FUN_H
@@ -0,0 +1,91 @@
+/**
+ * @file trace_fun.h
+ * @brief This file contains the API of the CPU zone tracer, exporting nested timed scopes of every thread as Chrome trace events
+ * @authors lonelydevil nakira974
+ * @date 24/02/2024
+ */
+#ifndef TRACE_FUN_H
+#define TRACE_FUN_H
+
+#include "std_c.h"
+
+/*
+ * Each thread writes the zones it closes into its own ring of
+ * TRACE_RING_SIZE events, with no lock: the thread only moves the head, the
+ * flusher thread only moves the tail. Every TRACE_FLUSH_PERIOD_MS the
+ * flusher appends the events between the two to a Chrome trace-event JSON
+ * file, which chrome://tracing and ui.perfetto.dev open directly. A zone is
+ * written once, as a complete event, when it ends, so a full ring drops
+ * whole zones and the nesting of the others stays right. Without
+ * VK_PONG_TRACE every macro expands to nothing and vk_trace.c is empty.
+ * Zone names must outlive the tracer, string literals for example.
+ * deleteTracer runs at exit while other threads may still trace: every
+ * entry point counts itself in the tracer before touching its ring, and the
+ * rings are only freed once the flusher has stopped and that count is zero.
+ * Each createTracer starts a new generation, and a thread reuses the ring it
+ * keeps only if it took it under the current one, so a tracer created again
+ * never sees a ring freed by the previous deleteTracer.
+ */
+#define TRACE_RING_SIZE 16384
+#define TRACE_MAX_DEPTH 32
+#define TRACE_MAX_THREAD_NAME 32
+#define TRACE_FLUSH_PERIOD_MS 50
+
+#ifdef VK_PONG_TRACE
+
+/**
+ * @brief Open the trace file and start the flusher thread, zones opened before are not recorded
+ * @param fileName Chrome trace-event JSON file to write
+ * @return 0 on success, -1 on failure
+ */
+int createTracer(const char *fileName);
+
+/**
+ * @brief Stop the flusher thread, wait for the zones being written, write the last events and the thread names and close the file, may be called more than once
+ */
+void deleteTracer();
+
+/**
+ * @brief Name the calling thread in the trace
+ * @param name Name shown in the trace viewer, truncated to TRACE_MAX_THREAD_NAME characters
+ */
+void setTraceThreadName(const char *name);
+
+/**
+ * @brief Open a zone on the calling thread, nested in the zones it has open
+ * @param name Name of the zone
+ */
+void beginTraceZone(const char *name);
+
+/**
+ * @brief Close the last zone opened by the calling thread and write it to its ring
+ */
+void endTraceZone();
+
+/**
+ * @brief Close the zone of TRACE_ZONE when its variable leaves its scope
+ * @param ppName Variable holding the name of the zone
+ */
+void endTraceScope(const char **ppName);
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+/**
+ * @brief Open a zone closed at the end of the enclosing block, including through return, break or continue
+ */
+#define TRACE_ZONE(name) const char *TRACE_CONCAT(traceZone, __LINE__) __attribute__((cleanup(endTraceScope))) = name; beginTraceZone(name)
+#define TRACE_BEGIN(name) beginTraceZone(name)
+#define TRACE_END() endTraceZone()
+#define TRACE_THREAD(name) setTraceThreadName(name)
+
+#else
+
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END() ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+
+#endif // VK_PONG_TRACE
+
+#endif // TRACE_FUN_H
@@ -10,6 +10,256 @@
 #include "std_c.h"
 #include "ext.h"
 
+/**
+ * @brief Called while recording a command buffer to append extra commands, before the render pass or inside it
+ * @param pCommandBuffer Command buffer being recorded
+ * @param commandBufferIndex Index of the command buffer, which is also the swapchain image index
+ * @param pUserData User data given to recordCommandBuffers
+ */
+typedef void (*RecordDrawsCallback)(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData);
+
+/**
+ * @brief Called by the main loop once the GPU is done with the resources of a swapchain image
+ * @param imageIndex Index of the acquired swapchain image, about to be submitted
+ * @param pUserData User data given to presentImage
+ */
+typedef void (*UpdateFrameCallback)(uint32_t imageIndex, void *pUserData);
+
+/**
+ * @brief Called by the deletion queue to destroy an object that is not a plain Vulkan handle
+ * @param pDevice Target logical device
+ * @param pObject Object given to retireCallback
+ */
+typedef void (*DeleteCallback)(VkDevice *pDevice, void *pObject);
+
+/**
+ * @brief Object waiting for the GPU to finish the submission it was retired in
+ */
+typedef struct DeletionEntry {
+	uint64_t serial;
+	VkObjectType type;
+	uint64_t handle;
+	DeleteCallback callback;
+	void *pObject;
+} DeletionEntry;
+
+/*
+ * Each submission of the main loop gets a serial, objects retired while a
+ * frame is being prepared are tagged with the serial of the next submission.
+ * Once the fence of a submission is signaled every object tagged with its
+ * serial or an older one is destroyed, without waiting for the whole device.
+ *
+ * The entries are allocated once, DELETION_MAX_FRAME_ENTRIES for each frame
+ * in flight and the one being prepared, which covers a full shader reload
+ * and pipeline library upgrade in the same frame. Retiring never allocates
+ * nor waits for the device: an object retired into a full queue is reported
+ * and leaked.
+ */
+#define DELETION_MAX_FRAME_ENTRIES 128
+
+typedef struct DeletionQueue {
+	VkDevice device;
+	uint64_t submitSerial;
+	uint64_t completedSerial;
+	uint32_t entryNumber;
+	uint32_t entryCapacity;
+	uint32_t overflowNumber;
+	DeletionEntry *pEntries;
+} DeletionQueue;
+
+/*
+ * The frame limiter paces the main loop at a fixed frequency. It sleeps
+ * until shortly before the deadline, then spins for the remainder, so the
+ * loop neither burns a core nor depends on the scheduler waking it on time.
+ * The spin margin starts from the wake-up latency measured when the limiter
+ * is created. It widens as soon as a wake-up comes later than the margin,
+ * then slowly shrinks back toward twice the average lateness.
+ */
+#define FRAME_LIMITER_MIN_SPIN 100000
+#define FRAME_LIMITER_MAX_SPIN 2000000
+#define FRAME_LIMITER_CALIBRATION_SLEEPS 16
+
+typedef struct FrameLimiter {
+	uint64_t period;
+	uint64_t spinMargin;
+	uint64_t deadline;
+	uint64_t lastFrameTime;
+	double meanOversleep;
+	uint64_t maxOversleep;
+	uint64_t intervalNumber;
+	double intervalSum;
+	double intervalSquareSum;
+	uint64_t minInterval;
+	uint64_t maxInterval;
+	uint64_t missedNumber;
+} FrameLimiter;
+
+/*
+ * In on-demand mode the main loop only renders when something changed. The
+ * simulation, the UI and the window callbacks set dirty flags, from any
+ * thread, and a flag set while the loop sleeps wakes it with an empty event.
+ * With no flag set the loop blocks in glfwWaitEventsTimeout without acquiring
+ * an image or submitting anything. Once idleTimeout seconds pass without a
+ * change it still renders one frame, so the statistics shown on screen and
+ * the pipelines rebuilt in the background catch up.
+ */
+#define REDRAW_SIMULATION 0x1
+#define REDRAW_INPUT 0x2
+#define REDRAW_WINDOW 0x4
+#define REDRAW_IDLE 0x8
+#define REDRAW_IDLE_TIMEOUT 0.5
+
+typedef struct RedrawState {
+	uint32_t dirtyFlags;
+	double idleTimeout;
+	double lastFrameTime;
+	double sleepTime;
+	double totalSleepTime;
+	uint64_t frameNumber;
+	uint64_t idleFrameNumber;
+	uint64_t emptyWakeNumber;
+} RedrawState;
+
+/*
+ * Scene vertex shaders place their output through one transform per view,
+ * indexed by gl_ViewIndex. A render pass without multiview only draws view 0.
+ */
+#define VIEW_MAX_NUMBER 2
+
+/**
+ * @brief Push constants of the scene vertex shaders, each transform is a clip space scale in xy and offset in zw
+ */
+typedef struct ViewConstants {
+	float transforms[VIEW_MAX_NUMBER][4];
+} ViewConstants;
+
+/*
+ * With VK_KHR_dynamic_rendering a pass begins rendering directly on the image
+ * views of its attachments: there is no render pass nor framebuffer object to
+ * create, nor to rebuild when the attachments change. A pipeline then only
+ * needs the formats and the view mask of the pass it is drawn in. Without the
+ * extension the target keeps a render pass, every pass drawing with its
+ * pipelines must be compatible with it.
+ */
+
+/**
+ * @brief Attachments a pipeline is drawn into, a render pass or the single color format and view mask of a dynamic rendering pass when renderPass is VK_NULL_HANDLE
+ */
+typedef struct RenderTarget {
+	VkRenderPass renderPass;
+	VkFormat colorFormat;
+	uint32_t viewMask;
+} RenderTarget;
+
+/*
+ * Host allocations made by the driver go through VkAllocationCallbacks served
+ * from size-class pools: blocks up to HOST_ALLOCATOR_MAX_CLASS_SIZE come from
+ * 64 KiB slabs, each thread keeps a small cache per size class and only takes
+ * the pool mutex to refill or drain it, larger blocks go to malloc. Every create
+ * and destroy wrapper passes the callbacks of its object type so the live and
+ * peak bytes and the call counts are tracked per object type and allocation
+ * scope. Before createHostAllocator or after deleteHostAllocator the wrappers
+ * pass VK_NULL_HANDLE and the driver allocates on its own.
+ */
+#define HOST_ALLOCATOR_CLASS_NUMBER 9
+#define HOST_ALLOCATOR_MAX_CLASS_SIZE 8192
+#define HOST_ALLOCATOR_SCOPE_NUMBER (VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1)
+#define HOST_ALLOCATOR_TYPE_NUMBER (VK_OBJECT_TYPE_COMMAND_POOL + 3)
+
+/**
+ * @brief Host allocation counters of one object type in one allocation scope
+ */
+typedef struct HostAllocationStats {
+	uint64_t liveBytes;
+	uint64_t peakBytes;
+	uint64_t allocationNumber;
+	uint64_t reallocationNumber;
+	uint64_t freeNumber;
+} HostAllocationStats;
+
+/**
+ * @brief Create the host allocator, must be called before createInstance
+ * @return 0 on success, -1 on failure
+ */
+int createHostAllocator();
+
+/**
+ * @brief Release the pools of the host allocator, must be called after deleteInstance, prints the bytes still allocated if any
+ */
+void deleteHostAllocator();
+
+/**
+ * @brief Get the allocation callbacks to give to a create or destroy call
+ * @param objectType Type of the object created or destroyed, the allocations are counted under it
+ * @return The allocation callbacks of the object type, VK_NULL_HANDLE when the host allocator does not exist
+ */
+const VkAllocationCallbacks *getHostAllocator(VkObjectType objectType);
+
+/**
+ * @brief Get the counters of an object type in an allocation scope
+ * @param objectType Target object type
+ * @param scope Target allocation scope
+ * @return A copy of the counters, all zero when the object type is not tracked
+ */
+HostAllocationStats getHostAllocationStats(VkObjectType objectType, VkSystemAllocationScope scope);
+
+/**
+ * @brief Get the number of allocation and reallocation calls made by the driver so far, over every object type and scope
+ * @return The total call count, the difference between two frames is the allocation churn of a frame
+ */
+uint64_t getHostAllocationNumber();
+
+/**
+ * @brief Print the counters of every object type and scope that allocated, the driver internal allocations and the pool activity
+ */
+void printHostAllocator();
+
+/*
+ * Temporary arrays that do not outlive the function filling them, create
+ * infos and enumerations mostly, come from a linear arena owned by the
+ * calling thread instead of malloc. A function saves the mark of the arena
+ * on entry and resets it before returning, which releases everything it
+ * took at once. With VK_PONG_HEAP_CHECK defined malloc, calloc and realloc
+ * are counted by every thread in a single atomic counter, and the main loop
+ * aborts when any thread allocates on the heap between the starts of two
+ * frames once HEAP_CHECK_WARMUP_FRAMES frames have run. Only the threads
+ * compiling pipelines in the background, which are not part of any frame,
+ * leave their allocations out with ignoreHeapAllocations.
+ */
+#define SCRATCH_ARENA_SIZE (1 << 20)
+#define SCRATCH_ALIGNMENT 16
+#define HEAP_CHECK_WARMUP_FRAMES 120
+
+/**
+ * @brief Take a block from the scratch arena of the calling thread, valid until the arena is reset below it
+ * @param size Size of the block in bytes
+ * @return The block aligned on SCRATCH_ALIGNMENT, VK_NULL_HANDLE when the arena is full
+ */
+void *allocateScratch(size_t size);
+
+/**
+ * @brief Get the current mark of the scratch arena of the calling thread
+ * @return The mark to give to resetScratch
+ */
+size_t getScratchMark();
+
+/**
+ * @brief Release every block taken from the scratch arena of the calling thread since a mark
+ * @param scratchMark Mark returned by getScratchMark
+ */
+void resetScratch(size_t scratchMark);
+
+/**
+ * @brief Get the number of heap allocations made by every thread of the program
+ * @return The number of malloc, calloc and realloc calls, always 0 without VK_PONG_HEAP_CHECK
+ */
+uint64_t getHeapAllocationNumber();
+
+/**
+ * @brief Leave the heap allocations of the calling thread out of getHeapAllocationNumber, for a thread doing no frame work
+ */
+void ignoreHeapAllocations();
+
 /**
  * @brief Create a Vulkan instance to link current application with API
  * @param app_name Application name
@@ -62,6 +312,63 @@ uint32_t getBestPhysicalDeviceIndex(VkPhysicalDevice *pPhysicalDevices, uint32_t
  */
 uint32_t getPhysicalDeviceTotalMemory(VkPhysicalDeviceMemoryProperties *pPhysicalDeviceMemoryProperties);
 
+/**
+ * @brief Check if a physical device supports a device extension
+ * @param pPhysicalDevice Target physical device
+ * @param extensionName Name of the extension
+ * @return VK_TRUE if the extension is supported
+ */
+VkBool32 getDeviceExtensionSupport(VkPhysicalDevice *pPhysicalDevice, const char *extensionName);
+
+/**
+ * @brief Check if a physical device supports VK_KHR_synchronization2 and its feature, createDevice enables it when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if synchronization2 can be used
+ */
+VkBool32 getSynchronization2Support(VkPhysicalDevice *pPhysicalDevice);
+
+/**
+ * @brief Check if a physical device supports VK_EXT_graphics_pipeline_library and its feature, createDevice enables it when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if graphics pipelines can be linked from pipeline libraries
+ */
+VkBool32 getGraphicsPipelineLibrarySupport(VkPhysicalDevice *pPhysicalDevice);
+
+/**
+ * @brief Check if a physical device supports multiview, core since Vulkan 1.1, createDevice enables it when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if render passes can draw several views at once
+ */
+VkBool32 getMultiviewSupport(VkPhysicalDevice *pPhysicalDevice);
+
+/**
+ * @brief Check if a physical device supports VK_KHR_timeline_semaphore and its feature, createDevice enables it when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if semaphores can carry a 64 bits counter waited and signaled by value
+ */
+VkBool32 getTimelineSemaphoreSupport(VkPhysicalDevice *pPhysicalDevice);
+
+/**
+ * @brief Check if a physical device supports VK_EXT_descriptor_indexing with runtime arrays, partially bound and update-after-bind bindings, createDevice enables it when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if a single descriptor set can hold arrays of textures and buffers indexed from the shaders and written while in use
+ */
+VkBool32 getDescriptorIndexingSupport(VkPhysicalDevice *pPhysicalDevice);
+
+/**
+ * @brief Check if a physical device supports VK_KHR_draw_indirect_count, createDevice enables it when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if the number of indirect draws can be read from a buffer written by the GPU
+ */
+VkBool32 getDrawIndirectCountSupport(VkPhysicalDevice *pPhysicalDevice);
+
+/**
+ * @brief Check if a physical device supports VK_KHR_dynamic_rendering, createDevice enables it with its dependencies when it does
+ * @param pPhysicalDevice Target physical device
+ * @return VK_TRUE if rendering can begin directly on image views, without render pass nor framebuffer objects
+ */
+VkBool32 getDynamicRenderingSupport(VkPhysicalDevice *pPhysicalDevice);
+
 /**
  * @brief Fetch the list of supported queues family for a given physical device
  * @param pPhysicalDevice The physical device to get queues family on
@@ -126,6 +433,15 @@ VkQueue getDrawingQueue(VkDevice *pDevice, uint32_t graphicsQueueFamilyindex);
  */
 VkQueue getPresentingQueue(VkDevice *pDevice, uint32_t graphicsQueueFamilyindex, uint32_t graphicsQueueMode);
 
+/**
+ * @brief Fetch a queue family dedicated to transfers, the DMA engines of discrete GPUs for example
+ * @param pQueueFamilyProperties Queue family properties for a given device
+ * @param queueFamilyNumber Number of queue families
+ * @param graphicsQueueFamilyindex Chosen graphics family index, returned when there is no transfer only family
+ * @return The transfer queue family index
+ */
+uint32_t getTransferQueueFamilyIndex(VkQueueFamilyProperties *pQueueFamilyProperties, uint32_t queueFamilyNumber, uint32_t graphicsQueueFamilyindex);
+
 /**
  * @brief Create a Vulkan surface for a given GLFW window
  * @param pWindow The window to bet set in the Vulkan surface
@@ -183,7 +499,7 @@ VkPresentModeKHR getBestPresentMode(VkSurfaceKHR *pSurface, VkPhysicalDevice *pP
 VkExtent2D getBestSwapchainExtent(VkSurfaceCapabilitiesKHR *pSurfaceCapabilities, GLFWwindow *window);
 
 /**
- * @brief Create a swapchain with the specified parameters
+ * @brief Create a swapchain with the specified parameters, its images are transfer sources when the surface supports it
  * @param pDevice Target logical device
  * @param pSurface Target surface
  * @param pSurfaceCapabilities - Target surface capabilities
@@ -245,13 +561,150 @@ VkImageView *createImageViews(VkDevice *pDevice, VkImage **ppImages, VkSurfaceFo
  */
 void deleteImageViews(VkDevice *pDevice, VkImageView **ppImageViews, uint32_t imageViewNumber);
 
+/**
+ * @brief Create a 2D image with a single mip level, without memory
+ * @param pDevice Target logical device
+ * @param format Format of the image texels
+ * @param pExtent Size of the image
+ * @param usage How the image will be used
+ * @param layerNumber Number of array layers, one per view for a multiview attachment
+ * @return The created image
+ */
+VkImage createImage(VkDevice *pDevice, VkFormat format, VkExtent2D *pExtent, VkImageUsageFlags usage, uint32_t layerNumber);
+
+/**
+ * @brief Create a 2D image with a single layer and a mip chain, without memory
+ * @param pDevice Target logical device
+ * @param format Format of the image texels
+ * @param pExtent Size of the first mip level
+ * @param usage How the image will be used
+ * @param mipLevelNumber Number of mip levels
+ * @return The created image
+ */
+VkImage createMipImage(VkDevice *pDevice, VkFormat format, VkExtent2D *pExtent, VkImageUsageFlags usage, uint32_t mipLevelNumber);
+
+/**
+ * @brief Destroy an image created by createImage
+ * @param pDevice Target logical device
+ * @param pImage The image to be destroyed
+ */
+void deleteImage(VkDevice *pDevice, VkImage *pImage);
+
+/**
+ * @brief Create a color image view over the whole image
+ * @param pDevice Target logical device
+ * @param pImage Target image
+ * @param format Format of the view
+ * @param layerNumber Number of array layers of the image, the view is a 2D array view when there are several
+ * @return The created image view
+ */
+VkImageView createImageView(VkDevice *pDevice, VkImage *pImage, VkFormat format, uint32_t layerNumber);
+
+/**
+ * @brief Create a 2D color image view over every mip level of an image created by createMipImage
+ * @param pDevice Target logical device
+ * @param pImage Target image
+ * @param format Format of the view
+ * @param mipLevelNumber Number of mip levels of the image
+ * @return The created image view
+ */
+VkImageView createMipImageView(VkDevice *pDevice, VkImage *pImage, VkFormat format, uint32_t mipLevelNumber);
+
+/**
+ * @brief Destroy a single image view
+ * @param pDevice Target logical device
+ * @param pImageView The image view to be destroyed
+ */
+void deleteImageView(VkDevice *pDevice, VkImageView *pImageView);
+
+/**
+ * @brief Create a clamp-to-edge sampler
+ * @param pDevice Target logical device
+ * @param filter Magnification, minification and mip filter
+ * @return The created sampler
+ */
+VkSampler createSampler(VkDevice *pDevice, VkFilter filter);
+
+/**
+ * @brief Destroy a sampler
+ * @param pDevice Target logical device
+ * @param pSampler The sampler to be destroyed
+ */
+void deleteSampler(VkDevice *pDevice, VkSampler *pSampler);
+
+/**
+ * @brief Record a layout transition of the first mip level and layer of a color image
+ * @param pCommandBuffer Command buffer being recorded
+ * @param pImage Target image
+ * @param oldLayout Current layout of the image
+ * @param newLayout Layout of the image after the barrier
+ * @param srcAccessMask Accesses to make available before the transition
+ * @param dstAccessMask Accesses waiting for the transition
+ * @param srcStageMask Stages to wait for
+ * @param dstStageMask Stages waiting for the transition
+ */
+void recordImageLayoutTransition(VkCommandBuffer *pCommandBuffer, VkImage *pImage, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
+
+/**
+ * @brief Find a memory type matching a resource requirements and the wanted properties
+ * @param pPhysicalDevice Target physical device
+ * @param memoryTypeBits Memory types allowed by the resource
+ * @param memoryProperties Properties the memory type must have
+ * @return Index of the memory type, UINT32_MAX if there is none
+ */
+uint32_t getMemoryTypeIndex(VkPhysicalDevice *pPhysicalDevice, uint32_t memoryTypeBits, VkMemoryPropertyFlags memoryProperties);
+
+/**
+ * @brief Create a buffer, without memory
+ * @param pDevice Target logical device
+ * @param size Size of the buffer in bytes
+ * @param usage How the buffer will be used
+ * @return The created buffer
+ */
+VkBuffer createBuffer(VkDevice *pDevice, VkDeviceSize size, VkBufferUsageFlags usage);
+
+/**
+ * @brief Destroy a buffer
+ * @param pDevice Target logical device
+ * @param pBuffer The buffer to be destroyed
+ */
+void deleteBuffer(VkDevice *pDevice, VkBuffer *pBuffer);
+
+/**
+ * @brief Allocate dedicated memory for a buffer and bind it
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device
+ * @param pBuffer Target buffer
+ * @param memoryProperties Properties the memory must have
+ * @return The bound memory, VK_NULL_HANDLE on failure
+ */
+VkDeviceMemory allocateBufferMemory(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkBuffer *pBuffer, VkMemoryPropertyFlags memoryProperties);
+
+/**
+ * @brief Allocate dedicated memory for an image and bind it
+ * @param pPhysicalDevice Target physical device
+ * @param pDevice Target logical device
+ * @param pImage Target image
+ * @param memoryProperties Properties the memory must have
+ * @return The bound memory, VK_NULL_HANDLE on failure
+ */
+VkDeviceMemory allocateImageMemory(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkImage *pImage, VkMemoryPropertyFlags memoryProperties);
+
+/**
+ * @brief Free device memory
+ * @param pDevice Target logical device
+ * @param pMemory The memory to be freed
+ */
+void freeMemory(VkDevice *pDevice, VkDeviceMemory *pMemory);
+
 /**
  * @brief Create a Vulkan render pass.
  * @param pDevice Target logical device
  * @param pFormat Chosen surface format
+ * @param viewMask Views rendered by each draw with multiview, bit i renders layer i, 0 disables multiview
  * @return The created render pass
  */
-VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat);
+VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat, uint32_t viewMask);
 
 /**
  * @brief Destroy a Vulkan render pass.
@@ -260,6 +713,32 @@ VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat);
  */
 void deleteRenderPass(VkDevice *pDevice, VkRenderPass *pRenderPass);
 
+/**
+ * @brief Describe the attachments of the pipelines drawn in a pass, with one color attachment in the surface format
+ * @param pDevice Target logical device
+ * @param pFormat Chosen surface format
+ * @param viewMask Views rendered by each draw with multiview, bit i renders layer i, 0 disables multiview
+ * @param dynamicRendering VK_TRUE if VK_KHR_dynamic_rendering is enabled on the device, a render pass is created with createRenderPass otherwise
+ * @return The render target
+ */
+RenderTarget createRenderTarget(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat, uint32_t viewMask, VkBool32 dynamicRendering);
+
+/**
+ * @brief Destroy the render pass of a render target, if it has one
+ * @param pDevice Target logical device
+ * @param pRenderTarget Render target to be destroyed
+ */
+void deleteRenderTarget(VkDevice *pDevice, RenderTarget *pRenderTarget);
+
+/**
+ * @brief Chain the rendering create info of a dynamic rendering target in front of a pipeline create info pNext chain
+ * @param pRenderTarget Target the pipeline is drawn into
+ * @param pRenderingCreateInfo Filled when the target has no render pass, it must live until the pipeline is created
+ * @param pNext Rest of the pNext chain, may be VK_NULL_HANDLE
+ * @return The pNext of the pipeline create info
+ */
+const void *chainRenderingCreateInfo(RenderTarget *pRenderTarget, VkPipelineRenderingCreateInfoKHR *pRenderingCreateInfo, const void *pNext);
+
 /**
  * @brief Create Vulkan framebuffers for rendering.
  * @param pDevice Target logical device
@@ -318,6 +797,14 @@ void deleteShaderModule(VkDevice *pDevice, VkShaderModule *pShaderModule);
  */
 VkPipelineLayout createPipelineLayout(VkDevice *pDevice);
 
+/**
+ * @brief Create a pipeline layout with a single descriptor set, for fullscreen passes sampling one texture
+ * @param pDevice Target logical device
+ * @param pDescriptorSetLayout Layout of the descriptor set bound at set 0
+ * @return The created pipeline layout
+ */
+VkPipelineLayout createTexturePipelineLayout(VkDevice *pDevice, VkDescriptorSetLayout *pDescriptorSetLayout);
+
 /**
  * @brief Delete a Vulkan pipeline layout.
  * @param pDevice Target logical device
@@ -415,18 +902,46 @@ VkPipelineColorBlendAttachmentState configureColorBlendAttachmentState();
  */
 VkPipelineColorBlendStateCreateInfo configureColorBlendStateCreateInfo(VkPipelineColorBlendAttachmentState *pColorBlendAttachmentState);
 
+/**
+ * @brief Configure the dynamic state create info shared by the graphics pipelines
+ * @return The configured dynamic state create info, viewport and scissor are dynamic
+ * @see The viewport and the scissor are set with recordViewport while recording, so the render resolution can change without recreating the pipelines
+ */
+VkPipelineDynamicStateCreateInfo configureDynamicStateCreateInfo();
+
+/**
+ * @brief Record the viewport and scissor covering the given extent
+ * @param pCommandBuffer Command buffer being recorded
+ * @param pExtent Extent of the rendering area
+ */
+void recordViewport(VkCommandBuffer *pCommandBuffer, VkExtent2D *pExtent);
+
+/**
+ * @brief Build view transforms that leave every view untouched
+ * @return Identity view constants
+ */
+ViewConstants createViewConstants();
+
+/**
+ * @brief Record the view transforms of a scene pipeline
+ * @param pCommandBuffer Command buffer being recorded
+ * @param pPipelineLayout Pipeline layout with a vertex stage push constant range holding ViewConstants at offset 0
+ * @param pViewConstants View transforms
+ */
+void recordViewConstants(VkCommandBuffer *pCommandBuffer, VkPipelineLayout *pPipelineLayout, ViewConstants *pViewConstants);
+
 /**
  * @brief Create a graphics pipeline for rendering in Vulkan.
  * @param pDevice Target logical device
  * @param pPipelineLayout Pointer to the pipeline layout
  * @param pVertexShaderModule Pointer to the vertex shader module
  * @param pFragmentShaderModule Pointer to the fragment shader module
- * @param pRenderPass Pointer to the render pass
+ * @param pRenderTarget Attachments the pipeline is drawn into
  * @param pExtent Pointer to the extension of the rendering area
  * @return The created graphics pipeline
  * @see Create a graphics pipeline that defines the entire rendering process, including the shaders, vertex input, rasterization, and more
  */
-VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, VkRenderPass *pRenderPass, VkExtent2D *pExtent);
+VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, RenderTarget *pRenderTarget, VkExtent2D *pExtent);
 
 /**
  * @brief Destroy a graphics pipeline in Vulkan.
@@ -436,7 +951,7 @@ VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipeline
 void deleteGraphicsPipeline(VkDevice *pDevice, VkPipeline *pGraphicsPipeline);
 
 /**
- * @brief Creates a Vulkan command pool for a given queue family.
+ * @brief Creates a Vulkan command pool for a given queue family, its command buffers can be recorded again once the GPU is done with them.
  * @param pDevice Target logical device
  * @param queueFamilyIndex Index of the queue family
  * @return The created command pool
@@ -468,6 +983,23 @@ VkCommandBuffer *createCommandBuffers(VkDevice *pDevice, VkCommandPool *pCommand
  */
 void deleteCommandBuffers(VkDevice *pDevice, VkCommandBuffer **ppCommandBuffers, VkCommandPool *pCommandPool, uint32_t commandBufferNumber);
 
+/**
+ * @brief Allocate and begin a command buffer meant to be submitted once
+ * @param pDevice Target logical device
+ * @param pCommandPool Pointer to the command pool
+ * @return The command buffer in recording state
+ */
+VkCommandBuffer beginSingleTimeCommands(VkDevice *pDevice, VkCommandPool *pCommandPool);
+
+/**
+ * @brief End, submit and free a command buffer from beginSingleTimeCommands, waiting for its completion
+ * @param pDevice Target logical device
+ * @param pCommandPool Pointer to the command pool the command buffer comes from
+ * @param pQueue Queue to submit to
+ * @param pCommandBuffer The command buffer to submit
+ */
+void endSingleTimeCommands(VkDevice *pDevice, VkCommandPool *pCommandPool, VkQueue *pQueue, VkCommandBuffer *pCommandBuffer);
+
 /**
  * @brief Records commands into multiple Vulkan command buffers.
  * @param ppCommandBuffers Pointer to an array of command buffer pointers
@@ -476,8 +1008,11 @@ void deleteCommandBuffers(VkDevice *pDevice, VkCommandBuffer **ppCommandBuffers,
  * @param pExtent Pointer to the extent of the framebuffer
  * @param pPipeline Pointer to the graphics pipeline
  * @param commandBufferNumber Number of command buffers to record
+ * @param recordPrePass Extra commands recorded before the render pass begins, such as compute dispatches, may be VK_NULL_HANDLE
+ * @param recordDraws Extra draws recorded after the triangle, may be VK_NULL_HANDLE
+ * @param pUserData User data given to recordPrePass and recordDraws
  */
-void recordCommandBuffers(VkCommandBuffer **ppCommandBuffers, VkRenderPass *pRenderPass, VkFramebuffer **ppFramebuffers, VkExtent2D *pExtent, VkPipeline *pPipeline, uint32_t commandBufferNumber);
+void recordCommandBuffers(VkCommandBuffer **ppCommandBuffers, VkRenderPass *pRenderPass, VkFramebuffer **ppFramebuffers, VkExtent2D *pExtent, VkPipeline *pPipeline, uint32_t commandBufferNumber, RecordDrawsCallback recordPrePass, RecordDrawsCallback recordDraws, void *pUserData);
 
 /**
  * @brief Create an array of semaphores for synchronization between frames
@@ -524,6 +1059,115 @@ VkFence *createEmptyFences(uint32_t maxFrames);
  */
 void deleteEmptyFences(VkFence **ppFences);
 
+/**
+ * @brief Create an empty deletion queue with room for the objects retired during every frame in flight
+ * @param pDevice Target logical device
+ * @param maxFrames Number of frames in flight
+ * @return The deletion queue, VK_NULL_HANDLE on failure
+ */
+DeletionQueue *createDeletionQueue(VkDevice *pDevice, uint32_t maxFrames);
+
+/**
+ * @brief Destroy every object left in a deletion queue and the queue itself, the GPU must be idle
+ * @param pDevice Target logical device
+ * @param ppDeletionQueue The deletion queue to be removed
+ */
+void deleteDeletionQueue(VkDevice *pDevice, DeletionQueue **ppDeletionQueue);
+
+/**
+ * @brief Destroy a Vulkan object once the submissions that may still use it are finished
+ * @param pDeletionQueue Target deletion queue
+ * @param type Type of the object, VK_OBJECT_TYPE_DEVICE_MEMORY is freed
+ * @param handle The object, cast to uint64_t
+ */
+void retireObject(DeletionQueue *pDeletionQueue, VkObjectType type, uint64_t handle);
+
+/**
+ * @brief Call a destruction function once the submissions that may still use its object are finished
+ * @param pDeletionQueue Target deletion queue
+ * @param callback Destruction function
+ * @param pObject Object given to callback
+ */
+void retireCallback(DeletionQueue *pDeletionQueue, DeleteCallback callback, void *pObject);
+
+/**
+ * @brief Close the current submission, objects retired from now on wait for the next one
+ * @param pDeletionQueue Target deletion queue
+ * @return Serial of the submission just made, to be given to collectDeletionQueue once its fence is signaled
+ */
+uint64_t advanceDeletionQueue(DeletionQueue *pDeletionQueue);
+
+/**
+ * @brief Destroy the objects retired up to a finished submission
+ * @param pDeletionQueue Target deletion queue
+ * @param completedSerial Serial of a submission whose fence is signaled
+ */
+void collectDeletionQueue(DeletionQueue *pDeletionQueue, uint64_t completedSerial);
+
+/**
+ * @brief Create a frame limiter and measure the wake-up latency of the scheduler
+ * @param frequency Target frequency in Hz
+ * @return The frame limiter, its period is 0 when the frequency is not positive
+ */
+FrameLimiter createFrameLimiter(double frequency);
+
+/**
+ * @brief Wait for the next frame deadline, sleeping first and spinning for the last part, then record the frame interval
+ * @param pFrameLimiter Target frame limiter
+ */
+void waitFrameLimiter(FrameLimiter *pFrameLimiter);
+
+/**
+ * @brief Get the standard deviation of the frame intervals measured so far
+ * @param pFrameLimiter Target frame limiter
+ * @return The jitter in milliseconds
+ */
+double getFrameLimiterJitter(FrameLimiter *pFrameLimiter);
+
+/**
+ * @brief Print the achieved frequency, the frame interval jitter, the extreme intervals and the spin margin
+ * @param pFrameLimiter Target frame limiter
+ */
+void printFrameLimiter(FrameLimiter *pFrameLimiter);
+
+/**
+ * @brief Create the dirty flags of the on-demand mode and install the window callbacks that set them
+ * @param pWindow Window whose key, mouse button, resize, refresh and focus events request a frame, its user pointer is taken
+ * @param idleTimeout Longest time in seconds without any frame, REDRAW_IDLE_TIMEOUT for example
+ * @return The redraw state, VK_NULL_HANDLE on failure
+ */
+RedrawState *createRedrawState(GLFWwindow *pWindow, double idleTimeout);
+
+/**
+ * @brief Remove the window callbacks and destroy the redraw state
+ * @param pWindow Window given to createRedrawState
+ * @param ppRedrawState The redraw state to be destroyed
+ */
+void deleteRedrawState(GLFWwindow *pWindow, RedrawState **ppRedrawState);
+
+/**
+ * @brief Request a frame, may be called from any thread
+ * @param pRedrawState Target redraw state
+ * @param flags Combination of REDRAW_* flags telling what changed
+ */
+void markRedraw(RedrawState *pRedrawState, uint32_t flags);
+
+/**
+ * @brief Process the window events and block until a frame is requested or the idle timeout expires
+ * @param pWindow Window of the main loop
+ * @param pRedrawState Target redraw state
+ * @return The flags of the frame to render, 0 when the window should close
+ */
+uint32_t waitRedraw(GLFWwindow *pWindow, RedrawState *pRedrawState);
+
+/**
+ * @brief Print the rendered frames, the idle refreshes, the wake-ups that changed nothing and the time spent asleep
+ * @param pRedrawState Target redraw state
+ */
+void printRedrawState(RedrawState *pRedrawState);
+
+struct FrameSubmitter;
+
 /**
  * @brief Main program loop
  * @param pDevice Target logical device
@@ -537,8 +1181,14 @@ void deleteEmptyFences(VkFence **ppFences);
  * @param pDrawingQueue Target drawing queue
  * @param pPresentingQueue Target presentation queue
  * @param maxFrames Maximum number of frames to be synchronized
- */
-void presentImage(VkDevice *pDevice, GLFWwindow *window, VkCommandBuffer *pCommandBuffers, VkFence *pFrontFences, VkFence *pBackFences, VkSemaphore *pWaitSemaphores, VkSemaphore *pSignalSemaphores, VkSwapchainKHR *pSwapchain, VkQueue *pDrawingQueue, VkQueue *pPresentingQueue, uint32_t maxFrames);
+ * @param updateFrame Called before each submission to update per-image data, may be VK_NULL_HANDLE
+ * @param pUserData User data given to updateFrame
+ * @param pDeletionQueue Deletion queue collected as the frame fences are signaled, may be VK_NULL_HANDLE
+ * @param pFrameLimiter Frame limiter pacing each iteration, may be VK_NULL_HANDLE to run as fast as the present mode allows
+ * @param pRedrawState Dirty flags of the on-demand mode, an iteration without any flag acquires and submits nothing, may be VK_NULL_HANDLE to render continuously
+ * @param pFrameSubmitter Submit thread acquiring, submitting and presenting the frames, may be VK_NULL_HANDLE to do it on the calling thread
+ */
+void presentImage(VkDevice *pDevice, GLFWwindow *window, VkCommandBuffer *pCommandBuffers, VkFence *pFrontFences, VkFence *pBackFences, VkSemaphore *pWaitSemaphores, VkSemaphore *pSignalSemaphores, VkSwapchainKHR *pSwapchain, VkQueue *pDrawingQueue, VkQueue *pPresentingQueue, uint32_t maxFrames, UpdateFrameCallback updateFrame, void *pUserData, DeletionQueue *pDeletionQueue, FrameLimiter *pFrameLimiter, RedrawState *pRedrawState, struct FrameSubmitter *pFrameSubmitter);
 
 void testLoop(GLFWwindow *window);
 
@@ -0,0 +1,48 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+struct Particle{
+	vec2 position;
+	vec2 velocity;
+	vec4 color;
+	float life;
+	float maxLife;
+	float size;
+	float padding;
+};
+
+struct Burst{
+	vec4 origin;
+	uvec4 data;
+};
+
+layout(std430,set=0,binding=0) readonly buffer Particles{
+	Particle particles[];
+};
+
+layout(std430,set=0,binding=5) readonly buffer VisibleList{
+	uint visibleIndices[];
+};
+
+layout(std140,set=0,binding=4) uniform Frame{
+	vec4 timing;
+	uvec4 counts;
+	Burst bursts[8];
+} frame;
+
+layout(push_constant) uniform ViewConstants{
+	vec4 transforms[2];
+} views;
+
+layout(location=0) out vec2 fragCorner;
+layout(location=1) out vec4 fragColor;
+
+void main(){
+	Particle particle=particles[visibleIndices[gl_InstanceIndex]];
+	float fade=particle.life/particle.maxLife;
+	vec2 corner=vec2(gl_VertexIndex&1,gl_VertexIndex>>1)*2.0-1.0;
+	vec4 transform=views.transforms[gl_ViewIndex];
+	gl_Position=vec4((particle.position+corner*frame.timing.zw*particle.size*(0.5+0.5*fade))*transform.xy+transform.zw,0.0,1.0);
+	fragCorner=corner;
+	fragColor=vec4(particle.color.rgb,particle.color.a*fade);
+}
@@ -0,0 +1,9 @@
+#version 450
+
+layout(location=0) out vec2 fragUV;
+
+void main(){
+	// Un seul triangle qui couvre tout l'écran, aucun vertex buffer
+	fragUV=vec2((gl_VertexIndex<<1)&2,gl_VertexIndex&2);
+	gl_Position=vec4(fragUV*2.0-1.0,0.0,1.0);
+}
@@ -0,0 +1,36 @@
+#version 450
+
+layout(set=0,binding=0) uniform sampler2D source;
+
+layout(push_constant) uniform PostConstants{
+	vec2 texelSize;
+	vec2 direction;
+	vec2 uvScale;
+	float threshold;
+	float intensity;
+	uint stages;
+} constants;
+
+layout(location=0) out vec4 outColor;
+
+layout(location=0) in vec2 fragUV;
+
+const float weights[5]=float[](0.227027,0.1945946,0.1216216,0.054054,0.016216);
+
+vec3 bright(vec2 uv){
+	// La source peut n'occuper que le coin haut gauche de son image, on ne lit pas au-delà
+	uv=min(uv*constants.uvScale,constants.uvScale-0.5*constants.texelSize);
+	vec3 color=texture(source,uv).rgb;
+	return max(color-vec3(constants.threshold),vec3(0.0));
+}
+
+void main(){
+	// Flou gaussien séparable, seuil appliqué à chaque échantillon lors de la première passe
+	vec2 offset=constants.direction*constants.texelSize;
+	vec3 color=bright(fragUV)*weights[0];
+	for(int i=1;i<5;i++){
+		color+=bright(fragUV+offset*float(i))*weights[i];
+		color+=bright(fragUV-offset*float(i))*weights[i];
+	}
+	outColor=vec4(color,1.0);
+}
@@ -0,0 +1,53 @@
+#version 450
+
+layout(set=0,binding=0) uniform sampler2D source;
+layout(set=0,binding=1) uniform sampler2D bloom;
+
+layout(push_constant) uniform PostConstants{
+	vec2 texelSize;
+	vec2 direction;
+	vec2 uvScale;
+	float threshold;
+	float intensity;
+	uint stages;
+} constants;
+
+layout(location=0) out vec4 outColor;
+
+layout(location=0) in vec2 fragUV;
+
+const uint POST_STAGE_BLOOM=1;
+const uint POST_STAGE_VIGNETTE=2;
+const uint POST_STAGE_CRT=4;
+
+void main(){
+	vec2 uv=fragUV;
+	if((constants.stages&POST_STAGE_CRT)!=0){
+		// Écran bombé : les coins s'éloignent du centre
+		vec2 centered=uv*2.0-1.0;
+		centered*=1.0+0.04*dot(centered.yx,centered.yx);
+		uv=centered*0.5+0.5;
+	}
+
+	// La scène peut être rendue à une résolution réduite dans le coin haut gauche de son image
+	vec2 sourceUV=min(uv*constants.uvScale,constants.uvScale-0.5*constants.texelSize);
+	vec3 color=texture(source,sourceUV).rgb;
+	if((constants.stages&POST_STAGE_BLOOM)!=0){
+		color+=texture(bloom,uv).rgb*constants.intensity;
+	}
+	if((constants.stages&POST_STAGE_CRT)!=0){
+		// Une ligne sur deux assombrie et masque de phosphores RGB par colonne
+		float scanline=0.75+0.25*cos(uv.y/constants.texelSize.y*3.14159265);
+		int column=int(gl_FragCoord.x)%3;
+		vec3 mask=vec3(column==0?1.0:0.8,column==1?1.0:0.8,column==2?1.0:0.8);
+		color*=scanline*mask;
+		if(uv.x<0.0||uv.x>1.0||uv.y<0.0||uv.y>1.0){
+			color=vec3(0.0);
+		}
+	}
+	if((constants.stages&POST_STAGE_VIGNETTE)!=0){
+		vec2 centered=fragUV-0.5;
+		color*=1.0-smoothstep(0.25,0.8,length(centered));
+	}
+	outColor=vec4(color,1.0);
+}
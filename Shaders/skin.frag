@@ -0,0 +1,12 @@
+#version 450
+
+layout(set=0,binding=0) uniform sampler2D skin;
+
+layout(location=0) out vec4 outColor;
+
+layout(location=0) in vec2 fragUV;
+
+void main(){
+	// Assombri pour que le terrain, les raquettes et la balle restent lisibles par-dessus
+	outColor=vec4(texture(skin,fragUV).rgb*0.45,1.0);
+}
@@ -0,0 +1,27 @@
+#version 450
+
+layout(set=0,binding=0) uniform sampler2DArray views;
+
+layout(push_constant) uniform SplitConstants{
+	vec2 texelSize;
+	vec2 uvScale;
+	float divider;
+} constants;
+
+layout(location=0) out vec4 outColor;
+
+layout(location=0) in vec2 fragUV;
+
+void main(){
+	// Moitié gauche : couche 0, moitié droite : couche 1
+	float layer=fragUV.x<0.5?0.0:1.0;
+	vec2 viewUV=vec2(fragUV.x*2.0-layer,fragUV.y);
+
+	// Comme la scène, chaque vue peut n'occuper que le coin haut gauche de sa couche
+	vec2 sourceUV=min(viewUV*constants.uvScale,constants.uvScale-0.5*constants.texelSize);
+	vec3 color=texture(views,vec3(sourceUV,layer)).rgb;
+	if(abs(fragUV.x-0.5)<constants.divider){
+		color=vec3(0.0);
+	}
+	outColor=vec4(color,1.0);
+}
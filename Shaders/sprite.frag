@@ -0,0 +1,15 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set=0,binding=0) uniform sampler2D textures[];
+
+layout(location=0) out vec4 outColor;
+
+layout(location=0) in vec2 fragUV;
+layout(location=1) in vec4 fragColor;
+layout(location=2) flat in uint fragTexture;
+
+void main(){
+	// L'indice change d'un quad à l'autre dans le même draw, il doit être marqué non uniforme
+	outColor=fragColor*texture(textures[nonuniformEXT(fragTexture)],fragUV);
+}
@@ -0,0 +1,22 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+layout(location=0) in vec4 glyphRect;
+layout(location=1) in vec4 glyphUV;
+layout(location=2) in vec4 glyphColor;
+
+layout(push_constant) uniform ViewConstants{
+	vec4 transforms[2];
+} views;
+
+layout(location=0) out vec2 fragUV;
+layout(location=1) out vec4 fragColor;
+
+void main(){
+	vec2 corner=vec2(gl_VertexIndex&1,gl_VertexIndex>>1);
+	// Chaque vue place la scène avec sa propre échelle et son propre décalage
+	vec4 transform=views.transforms[gl_ViewIndex];
+	gl_Position=vec4((glyphRect.xy+corner*glyphRect.zw)*transform.xy+transform.zw,0.0,1.0);
+	fragUV=mix(glyphUV.xy,glyphUV.zw,corner);
+	fragColor=glyphColor;
+}
@@ -0,0 +1,380 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef VK_PONG_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+#include "../Headers/audio_fun.h"
+#include "../Headers/trace_fun.h"
+
+/**
+ * Quatre échantillons traités d'un coup, SSE sur x86, NEON sur ARM
+ */
+typedef float AudioVector __attribute__((vector_size(16)));
+
+typedef struct AudioCommand {
+	uint32_t sound;
+	float gains[AUDIO_CHANNEL_NUMBER];
+	uint64_t time;
+} AudioCommand;
+
+typedef struct AudioVoice {
+	const float *pSamples;
+	uint32_t position;
+	uint32_t frameNumber;
+	float gains[AUDIO_CHANNEL_NUMBER];
+} AudioVoice;
+
+struct AudioMixer {
+	float left[AUDIO_BLOCK_FRAMES] __attribute__((aligned(16)));
+	float right[AUDIO_BLOCK_FRAMES] __attribute__((aligned(16)));
+	int16_t output[AUDIO_CHANNEL_NUMBER * AUDIO_BLOCK_FRAMES] __attribute__((aligned(16)));
+	AudioSinkType sinkType;
+	const char *fileName;
+	FILE *pFile;
+	uint64_t dataBytes;
+#ifdef VK_PONG_ALSA
+	snd_pcm_t *pPcm;
+#endif
+	uint32_t soundNumber;
+	float *pSounds[AUDIO_MAX_SOUNDS];
+	uint32_t soundFrames[AUDIO_MAX_SOUNDS];
+	uint32_t voiceNumber;
+	AudioVoice voices[AUDIO_MAX_VOICES];
+	AudioCommand commands[AUDIO_QUEUE_SIZE];
+	uint64_t commandHead;
+	uint64_t commandTail;
+	uint64_t droppedCommandNumber;
+	uint64_t droppedVoiceNumber;
+	uint64_t blockNumber;
+	uint64_t missedNumber;
+	uint64_t startedNumber;
+	uint64_t latencySum;
+	uint64_t maxLatency;
+	uint64_t mixTimeSum;
+	uint64_t maxMixTime;
+	int isRealTime;
+	int isRunning;
+	int isStarted;
+	pthread_t thread;
+};
+
+static uint64_t getAudioTime(){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void writeWavHeader(FILE *pFile, uint32_t dataBytes){
+	uint32_t byteRate = AUDIO_SAMPLE_RATE * AUDIO_CHANNEL_NUMBER * sizeof(int16_t);
+	uint32_t fields[] = {36 + dataBytes, 16, 1 | (AUDIO_CHANNEL_NUMBER << 16), AUDIO_SAMPLE_RATE, byteRate, (AUDIO_CHANNEL_NUMBER * sizeof(int16_t)) | (16 << 16), dataBytes};
+	const char *tags[] = {"RIFF", "WAVEfmt ", "data"};
+	// Entiers petit-boutistes écrits octet par octet, quel que soit l'hôte
+	uint8_t header[44];
+	memcpy(&header[0], tags[0], 4);
+	memcpy(&header[8], tags[1], 8);
+	memcpy(&header[36], tags[2], 4);
+	uint32_t offsets[] = {4, 16, 20, 24, 28, 32, 40};
+	for(uint32_t i = 0; i < 7; i++){
+		for(uint32_t j = 0; j < 4; j++){
+			header[offsets[i] + j] = (uint8_t)(fields[i] >> (8 * j));
+		}
+	}
+	fwrite(header, 1, sizeof(header), pFile);
+}
+
+AudioMixer *createAudioMixer(AudioSinkType sinkType, const char *fileName){
+	AudioMixer *pAudioMixer = (AudioMixer *)calloc(1, sizeof(AudioMixer));
+	if(pAudioMixer == NULL){
+		printf("AudioException : unable to allocate the mixer\n");
+		return NULL;
+	}
+	pAudioMixer->sinkType = sinkType;
+	pAudioMixer->fileName = fileName;
+	if(sinkType == AUDIO_SINK_WAV){
+		pAudioMixer->pFile = fopen(fileName, "wb");
+		if(pAudioMixer->pFile == NULL){
+			printf("AudioException : unable to open %s\n", fileName);
+			free(pAudioMixer);
+			return NULL;
+		}
+		writeWavHeader(pAudioMixer->pFile, 0);
+	}else if(sinkType == AUDIO_SINK_ALSA){
+#ifdef VK_PONG_ALSA
+		// Quelques blocs dans le tampon du périphérique : assez pour absorber un réveil tardif, assez peu pour rester réactif
+		unsigned int latency = (unsigned int)(AUDIO_DEVICE_BLOCKS * AUDIO_BLOCK_FRAMES * 1000000ull / AUDIO_SAMPLE_RATE);
+		if(snd_pcm_open(&pAudioMixer->pPcm, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0 ||
+		   snd_pcm_set_params(pAudioMixer->pPcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED, AUDIO_CHANNEL_NUMBER, AUDIO_SAMPLE_RATE, 1, latency) < 0){
+			printf("AudioException : unable to open the default ALSA device\n");
+			if(pAudioMixer->pPcm != NULL){
+				snd_pcm_close(pAudioMixer->pPcm);
+			}
+			free(pAudioMixer);
+			return NULL;
+		}
+#else
+		printf("AudioException : ALSA output is compiled out, configure with ALSA installed\n");
+		free(pAudioMixer);
+		return NULL;
+#endif
+	}
+	return pAudioMixer;
+}
+
+uint32_t addAudioSound(AudioMixer *pAudioMixer, const float *pSamples, uint32_t frameNumber){
+	if(pAudioMixer->isStarted || pAudioMixer->soundNumber == AUDIO_MAX_SOUNDS || frameNumber == 0){
+		printf("AudioException : sound of %u frames not added\n", frameNumber);
+		return AUDIO_INVALID_SOUND;
+	}
+	// Complété par du silence jusqu'à un bloc entier, le mélange n'a jamais de reste à traiter
+	uint32_t paddedFrames = (frameNumber + AUDIO_BLOCK_FRAMES - 1) / AUDIO_BLOCK_FRAMES * AUDIO_BLOCK_FRAMES;
+	float *pSound = (float *)calloc(paddedFrames, sizeof(float));
+	if(pSound == NULL){
+		printf("AudioException : unable to allocate a sound of %u frames\n", frameNumber);
+		return AUDIO_INVALID_SOUND;
+	}
+	memcpy(pSound, pSamples, frameNumber * sizeof(float));
+	pAudioMixer->pSounds[pAudioMixer->soundNumber] = pSound;
+	pAudioMixer->soundFrames[pAudioMixer->soundNumber] = paddedFrames;
+	return pAudioMixer->soundNumber++;
+}
+
+uint32_t addAudioTone(AudioMixer *pAudioMixer, float startFrequency, float endFrequency, float duration){
+	uint32_t frameNumber = (uint32_t)(duration * AUDIO_SAMPLE_RATE);
+	float *pSamples = (float *)malloc(frameNumber * sizeof(float));
+	if(pSamples == NULL){
+		return AUDIO_INVALID_SOUND;
+	}
+	double phase = 0.0;
+	for(uint32_t i = 0; i < frameNumber; i++){
+		double progress = (double)i / (double)frameNumber;
+		double frequency = startFrequency + (endFrequency - startFrequency) * progress;
+		phase += 2.0 * M_PI * frequency / AUDIO_SAMPLE_RATE;
+		// Attaque de 2 ms pour éviter le clic, puis décroissance exponentielle
+		double attack = (double)i / (0.002 * AUDIO_SAMPLE_RATE);
+		double envelope = (attack < 1.0 ? attack : 1.0) * exp(-5.0 * progress);
+		pSamples[i] = (float)(0.5 * envelope * sin(phase));
+	}
+	uint32_t sound = addAudioSound(pAudioMixer, pSamples, frameNumber);
+	free(pSamples);
+	return sound;
+}
+
+static void startAudioVoices(AudioMixer *pAudioMixer, uint64_t blockTime){
+	uint64_t tail = pAudioMixer->commandTail;
+	uint64_t head = __atomic_load_n(&pAudioMixer->commandHead, __ATOMIC_ACQUIRE);
+	for(; tail < head; tail++){
+		AudioCommand *pCommand = &pAudioMixer->commands[tail % AUDIO_QUEUE_SIZE];
+		uint64_t latency = blockTime > pCommand->time ? blockTime - pCommand->time : 0;
+		pAudioMixer->latencySum += latency;
+		pAudioMixer->maxLatency = latency > pAudioMixer->maxLatency ? latency : pAudioMixer->maxLatency;
+		pAudioMixer->startedNumber++;
+		if(pAudioMixer->voiceNumber == AUDIO_MAX_VOICES){
+			pAudioMixer->droppedVoiceNumber++;
+			continue;
+		}
+		AudioVoice *pVoice = &pAudioMixer->voices[pAudioMixer->voiceNumber++];
+		pVoice->pSamples = pAudioMixer->pSounds[pCommand->sound];
+		pVoice->frameNumber = pAudioMixer->soundFrames[pCommand->sound];
+		pVoice->position = 0;
+		pVoice->gains[0] = pCommand->gains[0];
+		pVoice->gains[1] = pCommand->gains[1];
+	}
+	// L'emplacement n'est rendu au thread du jeu qu'une fois la commande lue
+	__atomic_store_n(&pAudioMixer->commandTail, tail, __ATOMIC_RELEASE);
+}
+
+static void mixAudioBlock(AudioMixer *pAudioMixer){
+	memset(pAudioMixer->left, 0, sizeof(pAudioMixer->left));
+	memset(pAudioMixer->right, 0, sizeof(pAudioMixer->right));
+	for(uint32_t i = 0; i < pAudioMixer->voiceNumber;){
+		AudioVoice *pVoice = &pAudioMixer->voices[i];
+		AudioVector leftGain = {pVoice->gains[0], pVoice->gains[0], pVoice->gains[0], pVoice->gains[0]};
+		AudioVector rightGain = {pVoice->gains[1], pVoice->gains[1], pVoice->gains[1], pVoice->gains[1]};
+		const float *pSamples = &pVoice->pSamples[pVoice->position];
+		AudioVector *pLeft = (AudioVector *)pAudioMixer->left, *pRight = (AudioVector *)pAudioMixer->right;
+		for(uint32_t j = 0; j < AUDIO_BLOCK_FRAMES / 4; j++){
+			AudioVector samples;
+			memcpy(&samples, &pSamples[4 * j], sizeof(AudioVector));
+			pLeft[j] += samples * leftGain;
+			pRight[j] += samples * rightGain;
+		}
+		// Une voix terminée est remplacée par la dernière, l'ordre des voix n'a pas d'importance
+		pVoice->position += AUDIO_BLOCK_FRAMES;
+		if(pVoice->position >= pVoice->frameNumber){
+			*pVoice = pAudioMixer->voices[--pAudioMixer->voiceNumber];
+		}else{
+			i++;
+		}
+	}
+
+	// Entrelacement et conversion en 16 bits saturés
+#ifdef __SSE2__
+	__m128 scale = _mm_set1_ps(32767.0f);
+	for(uint32_t i = 0; i < AUDIO_BLOCK_FRAMES; i += 4){
+		__m128i left = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(&pAudioMixer->left[i]), scale));
+		__m128i right = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(&pAudioMixer->right[i]), scale));
+		__m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(left, right), _mm_unpackhi_epi32(left, right));
+		_mm_store_si128((__m128i *)&pAudioMixer->output[2 * i], packed);
+	}
+#else
+	for(uint32_t i = 0; i < AUDIO_BLOCK_FRAMES; i++){
+		float left = pAudioMixer->left[i] * 32767.0f, right = pAudioMixer->right[i] * 32767.0f;
+		pAudioMixer->output[2 * i] = (int16_t)(left > 32767.0f ? 32767.0f : left < -32768.0f ? -32768.0f : left);
+		pAudioMixer->output[2 * i + 1] = (int16_t)(right > 32767.0f ? 32767.0f : right < -32768.0f ? -32768.0f : right);
+	}
+#endif
+}
+
+static void writeAudioBlock(AudioMixer *pAudioMixer){
+	if(pAudioMixer->sinkType == AUDIO_SINK_WAV){
+		// Sortie de test : l'écriture passe par le tampon de stdio, rarement par le disque
+		pAudioMixer->dataBytes += fwrite(pAudioMixer->output, AUDIO_CHANNEL_NUMBER * sizeof(int16_t), AUDIO_BLOCK_FRAMES, pAudioMixer->pFile) * AUDIO_CHANNEL_NUMBER * sizeof(int16_t);
+	}
+#ifdef VK_PONG_ALSA
+	if(pAudioMixer->sinkType == AUDIO_SINK_ALSA){
+		// L'écriture bloque tant que le tampon du périphérique est plein, c'est elle qui cadence le thread
+		snd_pcm_sframes_t result = snd_pcm_writei(pAudioMixer->pPcm, pAudioMixer->output, AUDIO_BLOCK_FRAMES);
+		if(result == -EPIPE){
+			pAudioMixer->missedNumber++;
+			snd_pcm_prepare(pAudioMixer->pPcm);
+			snd_pcm_writei(pAudioMixer->pPcm, pAudioMixer->output, AUDIO_BLOCK_FRAMES);
+		}else if(result < 0){
+			snd_pcm_recover(pAudioMixer->pPcm, (int)result, 1);
+		}
+	}
+#endif
+}
+
+static void *runAudioMixer(void *pArg){
+	AudioMixer *pAudioMixer = (AudioMixer *)pArg;
+	TRACE_THREAD("audio mixer");
+	uint64_t period = AUDIO_BLOCK_FRAMES * 1000000000ull / AUDIO_SAMPLE_RATE;
+	uint64_t deadline = getAudioTime() + period;
+#ifdef __linux__
+	int isSleepFailed = 0;
+#endif
+	while(__atomic_load_n(&pAudioMixer->isRunning, __ATOMIC_ACQUIRE)){
+		uint64_t blockTime = getAudioTime();
+		TRACE_BEGIN("mix block");
+		startAudioVoices(pAudioMixer, blockTime);
+		mixAudioBlock(pAudioMixer);
+		TRACE_END();
+		uint64_t mixTime = getAudioTime() - blockTime;
+		pAudioMixer->mixTimeSum += mixTime;
+		pAudioMixer->maxMixTime = mixTime > pAudioMixer->maxMixTime ? mixTime : pAudioMixer->maxMixTime;
+		pAudioMixer->blockNumber++;
+		writeAudioBlock(pAudioMixer);
+		if(pAudioMixer->sinkType == AUDIO_SINK_ALSA){
+			continue;
+		}
+
+		// Sans périphérique, chaque bloc doit être prêt avant la fin du précédent
+		uint64_t now = getAudioTime();
+		if(now > deadline){
+			pAudioMixer->missedNumber++;
+			// Un retard de plus d'un bloc décale l'échéance au lieu de mélanger les suivants d'affilée
+			deadline = now > deadline + period ? now : deadline;
+		}
+#ifdef __linux__
+		struct timespec wakeSpec = {(time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull)};
+		int result;
+		while((result = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeSpec, NULL)) == EINTR){
+		}
+		// Sans sommeil le bloc suivant part tout de suite, l'erreur n'est signalée qu'une fois
+		if(result != 0 && !isSleepFailed){
+			printf("AudioException : clock_nanosleep failed with error %d, the mixer no longer waits between blocks\n", result);
+			isSleepFailed = 1;
+		}
+#else
+		now = getAudioTime();
+		struct timespec sleepSpec = {0, now < deadline ? (long)(deadline - now) : 0};
+		nanosleep(&sleepSpec, NULL);
+#endif
+		deadline += period;
+	}
+	return NULL;
+}
+
+int startAudioMixer(AudioMixer *pAudioMixer){
+	pAudioMixer->isRunning = 1;
+	// Priorité temps réel si le processus y a droit (CAP_SYS_NICE ou limite rtprio), sinon priorité normale
+	pthread_attr_t threadAttributes;
+	struct sched_param schedParam;
+	memset(&schedParam, 0, sizeof(schedParam));
+	schedParam.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+	pthread_attr_init(&threadAttributes);
+	pthread_attr_setinheritsched(&threadAttributes, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&threadAttributes, SCHED_FIFO);
+	pthread_attr_setschedparam(&threadAttributes, &schedParam);
+	pAudioMixer->isRealTime = pthread_create(&pAudioMixer->thread, &threadAttributes, runAudioMixer, pAudioMixer) == 0;
+	pthread_attr_destroy(&threadAttributes);
+	if(!pAudioMixer->isRealTime && pthread_create(&pAudioMixer->thread, NULL, runAudioMixer, pAudioMixer) != 0){
+		printf("AudioException : unable to start the mixer thread\n");
+		pAudioMixer->isRunning = 0;
+		return -1;
+	}
+	pAudioMixer->isStarted = 1;
+	return 0;
+}
+
+int playAudioSound(AudioMixer *pAudioMixer, uint32_t sound, float gain, float pan){
+	if(sound >= pAudioMixer->soundNumber){
+		return -1;
+	}
+	uint64_t head = pAudioMixer->commandHead;
+	if(head - __atomic_load_n(&pAudioMixer->commandTail, __ATOMIC_ACQUIRE) >= AUDIO_QUEUE_SIZE){
+		pAudioMixer->droppedCommandNumber++;
+		return -1;
+	}
+	// Panoramique à puissance constante
+	float angle = (float)(M_PI / 4.0) * ((pan < -1.0f ? -1.0f : pan > 1.0f ? 1.0f : pan) + 1.0f);
+	AudioCommand *pCommand = &pAudioMixer->commands[head % AUDIO_QUEUE_SIZE];
+	pCommand->sound = sound;
+	pCommand->gains[0] = gain * cosf(angle);
+	pCommand->gains[1] = gain * sinf(angle);
+	pCommand->time = getAudioTime();
+	__atomic_store_n(&pAudioMixer->commandHead, head + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+void deleteAudioMixer(AudioMixer **ppAudioMixer){
+	AudioMixer *pAudioMixer = *ppAudioMixer;
+	if(pAudioMixer->isStarted){
+		__atomic_store_n(&pAudioMixer->isRunning, 0, __ATOMIC_RELEASE);
+		pthread_join(pAudioMixer->thread, NULL);
+		double blockTime = AUDIO_BLOCK_FRAMES * 1e3 / AUDIO_SAMPLE_RATE;
+		printf("audio mixer : %llu blocks of %.2f ms at %s priority, %llu deadlines missed\n", (unsigned long long)pAudioMixer->blockNumber, blockTime,
+			pAudioMixer->isRealTime ? "real-time" : "normal", (unsigned long long)pAudioMixer->missedNumber);
+		printf("  mix %.3f ms average, %.3f ms max, %llu sounds started, command latency %.3f ms average, %.3f ms max\n",
+			pAudioMixer->blockNumber != 0 ? (double)pAudioMixer->mixTimeSum * 1e-6 / (double)pAudioMixer->blockNumber : 0.0, (double)pAudioMixer->maxMixTime * 1e-6,
+			(unsigned long long)pAudioMixer->startedNumber, pAudioMixer->startedNumber != 0 ? (double)pAudioMixer->latencySum * 1e-6 / (double)pAudioMixer->startedNumber : 0.0,
+			(double)pAudioMixer->maxLatency * 1e-6);
+		if(pAudioMixer->droppedCommandNumber != 0 || pAudioMixer->droppedVoiceNumber != 0){
+			printf("  %llu commands dropped on a full queue, %llu sounds dropped with every voice busy\n",
+				(unsigned long long)pAudioMixer->droppedCommandNumber, (unsigned long long)pAudioMixer->droppedVoiceNumber);
+		}
+	}
+	if(pAudioMixer->pFile != NULL){
+		// Les tailles de l'en-tête ne sont connues qu'à la fin
+		fseek(pAudioMixer->pFile, 0, SEEK_SET);
+		writeWavHeader(pAudioMixer->pFile, (uint32_t)pAudioMixer->dataBytes);
+		fclose(pAudioMixer->pFile);
+		printf("audio mixer : %.1f s written to %s\n", (double)pAudioMixer->dataBytes / (AUDIO_SAMPLE_RATE * AUDIO_CHANNEL_NUMBER * sizeof(int16_t)), pAudioMixer->fileName);
+	}
+#ifdef VK_PONG_ALSA
+	if(pAudioMixer->pPcm != NULL){
+		snd_pcm_drain(pAudioMixer->pPcm);
+		snd_pcm_close(pAudioMixer->pPcm);
+	}
+#endif
+	for(uint32_t i = 0; i < pAudioMixer->soundNumber; i++){
+		free(pAudioMixer->pSounds[i]);
+	}
+	free(pAudioMixer);
+	*ppAudioMixer = NULL;
+}
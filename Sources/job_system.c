@@ -0,0 +1,454 @@
+#include <pthread.h>
+#include <sched.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../Headers/job_fun.h"
+
+typedef struct Job {
+	JobFunction function;
+	JobRangeFunction rangeFunction;
+	void *pData;
+	JobCounter *pCounter;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t grain;
+} Job;
+
+/*
+ * Le haut de la deque est écrit par les voleurs et le bas par le propriétaire,
+ * chacun sur sa propre ligne de cache
+ */
+typedef struct JobWorker {
+	int64_t top __attribute__((aligned(64)));
+	int64_t bottom __attribute__((aligned(64)));
+	Job *deque;
+	uint32_t index;
+	uint64_t rngState;
+	uint64_t jobNumber;
+	uint64_t stealNumber;
+	uint64_t sleepNumber;
+	pthread_t thread;
+	struct JobSystem *pJobSystem;
+} __attribute__((aligned(64))) JobWorker;
+
+struct JobSystem {
+	void *workerMemory;
+	JobWorker *workers;
+	// File des jobs de fond, sous le verrou, que seuls les workers autres que le thread créateur vident
+	Job *backgroundJobs;
+	uint32_t backgroundFirst;
+	uint32_t backgroundNumber;
+	uint32_t workerNumber;
+	uint32_t pendingNumber;
+	uint32_t sleepingNumber;
+	uint32_t isStopping;
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+};
+
+static __thread JobWorker *pCurrentWorker = NULL;
+
+/*
+ * Un voleur peut lire une case pendant que le propriétaire la réécrit, son
+ * compare-and-swap échoue alors et la copie est jetée : chaque champ passe
+ * par un accès atomique relâché pour que cette lecture reste définie
+ */
+static void storeJob(Job *pSlot, const Job *pJob){
+	__atomic_store_n(&pSlot->function, pJob->function, __ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->rangeFunction, pJob->rangeFunction, __ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->pData, pJob->pData, __ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->pCounter, pJob->pCounter, __ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->begin, pJob->begin, __ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->end, pJob->end, __ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->grain, pJob->grain, __ATOMIC_RELAXED);
+}
+
+static void loadJob(Job *pJob, Job *pSlot){
+	pJob->function = __atomic_load_n(&pSlot->function, __ATOMIC_RELAXED);
+	pJob->rangeFunction = __atomic_load_n(&pSlot->rangeFunction, __ATOMIC_RELAXED);
+	pJob->pData = __atomic_load_n(&pSlot->pData, __ATOMIC_RELAXED);
+	pJob->pCounter = __atomic_load_n(&pSlot->pCounter, __ATOMIC_RELAXED);
+	pJob->begin = __atomic_load_n(&pSlot->begin, __ATOMIC_RELAXED);
+	pJob->end = __atomic_load_n(&pSlot->end, __ATOMIC_RELAXED);
+	pJob->grain = __atomic_load_n(&pSlot->grain, __ATOMIC_RELAXED);
+}
+
+static int pushJob(JobWorker *pWorker, const Job *pJob){
+	int64_t bottom = __atomic_load_n(&pWorker->bottom, __ATOMIC_RELAXED);
+	int64_t top = __atomic_load_n(&pWorker->top, __ATOMIC_ACQUIRE);
+	if(bottom - top >= JOB_DEQUE_CAPACITY){
+		return -1;
+	}
+	storeJob(&pWorker->deque[bottom & (JOB_DEQUE_CAPACITY - 1)], pJob);
+	// Le job doit être visible avant le nouveau bas
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&pWorker->bottom, bottom + 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+static int popJob(JobWorker *pWorker, Job *pJob){
+	int64_t bottom = __atomic_load_n(&pWorker->bottom, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&pWorker->bottom, bottom, __ATOMIC_RELAXED);
+	// Le bas réservé doit être vu par les voleurs avant de lire le haut
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t top = __atomic_load_n(&pWorker->top, __ATOMIC_RELAXED);
+	if(top > bottom){
+		__atomic_store_n(&pWorker->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	loadJob(pJob, &pWorker->deque[bottom & (JOB_DEQUE_CAPACITY - 1)]);
+	if(top < bottom){
+		return 1;
+	}
+	// Dernier job : le propriétaire le dispute aux voleurs sur le haut
+	int isTaken = __atomic_compare_exchange_n(&pWorker->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+	__atomic_store_n(&pWorker->bottom, bottom + 1, __ATOMIC_RELAXED);
+	return isTaken;
+}
+
+static int stealJob(JobWorker *pVictim, Job *pJob){
+	int64_t top = __atomic_load_n(&pVictim->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t bottom = __atomic_load_n(&pVictim->bottom, __ATOMIC_ACQUIRE);
+	if(top >= bottom){
+		return 0;
+	}
+	loadJob(pJob, &pVictim->deque[top & (JOB_DEQUE_CAPACITY - 1)]);
+	return __atomic_compare_exchange_n(&pVictim->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/**
+ * Seuls les workers et le thread créateur ont une deque, NULL pour tout autre thread
+ */
+static JobWorker *getCurrentWorker(JobSystem *pJobSystem){
+	if(pCurrentWorker != NULL && pCurrentWorker->pJobSystem == pJobSystem){
+		return pCurrentWorker;
+	}
+	return NULL;
+}
+
+static void executeJob(JobWorker *pWorker, Job *pJob);
+
+static void submitJob(JobWorker *pWorker, Job *pJob){
+	JobSystem *pJobSystem = pWorker->pJobSystem;
+	if(pJob->pCounter != NULL){
+		__atomic_add_fetch(&pJob->pCounter->value, 1, __ATOMIC_RELAXED);
+	}
+	if(pushJob(pWorker, pJob) != 0){
+		executeJob(pWorker, pJob);
+		return;
+	}
+
+	// Le compteur des jobs en attente est lu par les workers avant de s'endormir
+	__atomic_add_fetch(&pJobSystem->pendingNumber, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&pJobSystem->sleepingNumber, __ATOMIC_SEQ_CST) > 0){
+		pthread_mutex_lock(&pJobSystem->mutex);
+		pthread_cond_signal(&pJobSystem->condition);
+		pthread_mutex_unlock(&pJobSystem->mutex);
+	}
+}
+
+static void executeJob(JobWorker *pWorker, Job *pJob){
+	JobCounter *pCounter = pJob->pCounter;
+	if(pJob->rangeFunction != NULL){
+		// La moitié haute repart dans la deque, la plus grosse part est la première volée
+		uint32_t begin = pJob->begin, end = pJob->end;
+		while(end - begin > pJob->grain){
+			uint32_t middle = begin + (end - begin) / 2;
+			Job upperJob = *pJob;
+			upperJob.begin = middle;
+			upperJob.end = end;
+			submitJob(pWorker, &upperJob);
+			end = middle;
+		}
+		pJob->rangeFunction(pJob->pData, begin, end);
+	}else{
+		pJob->function(pJob->pData);
+	}
+	pWorker->jobNumber++;
+	if(pCounter != NULL){
+		__atomic_sub_fetch(&pCounter->value, 1, __ATOMIC_RELEASE);
+	}
+}
+
+static int takeBackgroundJob(JobSystem *pJobSystem, Job *pJob){
+	int isFound = 0;
+	pthread_mutex_lock(&pJobSystem->mutex);
+	if(pJobSystem->backgroundNumber != 0){
+		*pJob = pJobSystem->backgroundJobs[pJobSystem->backgroundFirst];
+		pJobSystem->backgroundFirst = (pJobSystem->backgroundFirst + 1) % JOB_DEQUE_CAPACITY;
+		__atomic_store_n(&pJobSystem->backgroundNumber, pJobSystem->backgroundNumber - 1, __ATOMIC_RELAXED);
+		isFound = 1;
+	}
+	pthread_mutex_unlock(&pJobSystem->mutex);
+	return isFound;
+}
+
+static int findJob(JobWorker *pWorker, Job *pJob){
+	JobSystem *pJobSystem = pWorker->pJobSystem;
+	uint32_t workerNumber = __atomic_load_n(&pJobSystem->workerNumber, __ATOMIC_ACQUIRE);
+	int isFound = popJob(pWorker, pJob);
+
+	// Les victimes sont parcourues depuis un worker tiré au hasard
+	if( ! isFound && workerNumber > 1){
+		pWorker->rngState ^= pWorker->rngState << 13;
+		pWorker->rngState ^= pWorker->rngState >> 7;
+		pWorker->rngState ^= pWorker->rngState << 17;
+		uint32_t first = (uint32_t)(pWorker->rngState % workerNumber);
+		for(uint32_t i = 0; i < workerNumber && !isFound; i++){
+			JobWorker *pVictim = &pJobSystem->workers[(first + i) % workerNumber];
+			if(pVictim != pWorker && stealJob(pVictim, pJob)){
+				__atomic_add_fetch(&pWorker->stealNumber, 1, __ATOMIC_RELAXED);
+				isFound = 1;
+			}
+		}
+	}
+	// Les jobs de fond passent après les vols, le thread créateur ne les prend jamais pendant ses attentes
+	if( ! isFound && pWorker->index != 0 && __atomic_load_n(&pJobSystem->backgroundNumber, __ATOMIC_RELAXED) != 0){
+		isFound = takeBackgroundJob(pJobSystem, pJob);
+	}
+	if(isFound){
+		__atomic_sub_fetch(&pJobSystem->pendingNumber, 1, __ATOMIC_SEQ_CST);
+	}
+	return isFound;
+}
+
+static void *runJobWorker(void *pArgument){
+	JobWorker *pWorker = (JobWorker *)pArgument;
+	JobSystem *pJobSystem = pWorker->pJobSystem;
+	pCurrentWorker = pWorker;
+	Job job;
+	uint32_t spinNumber = 0;
+
+	for(;;){
+		if(findJob(pWorker, &job)){
+			executeJob(pWorker, &job);
+			spinNumber = 0;
+			continue;
+		}
+		// Un job encore en attente à l'arrêt est exécuté avant de sortir, son compteur finit toujours à zéro
+		if(__atomic_load_n(&pJobSystem->isStopping, __ATOMIC_ACQUIRE)){
+			break;
+		}
+		if(++spinNumber < JOB_SPIN_NUMBER){
+			continue;
+		}
+
+		// Le worker se déclare endormi avant de relire le compteur, un job poussé entre les deux le réveille
+		spinNumber = 0;
+		pthread_mutex_lock(&pJobSystem->mutex);
+		__atomic_add_fetch(&pJobSystem->sleepingNumber, 1, __ATOMIC_SEQ_CST);
+		while(__atomic_load_n(&pJobSystem->pendingNumber, __ATOMIC_SEQ_CST) == 0 && !pJobSystem->isStopping){
+			pWorker->sleepNumber++;
+			pthread_cond_wait(&pJobSystem->condition, &pJobSystem->mutex);
+		}
+		__atomic_sub_fetch(&pJobSystem->sleepingNumber, 1, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&pJobSystem->mutex);
+	}
+	pCurrentWorker = NULL;
+	return NULL;
+}
+
+uint32_t getHardwareThreadNumber(){
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	long threadNumber = (long)systemInfo.dwNumberOfProcessors;
+#else
+	long threadNumber = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return threadNumber > 0 ? (uint32_t)threadNumber : 1;
+}
+
+JobSystem *createJobSystem(uint32_t workerNumber){
+	if(workerNumber == 0){
+		workerNumber = getHardwareThreadNumber();
+	}
+	if(workerNumber > JOB_MAX_WORKERS){
+		workerNumber = JOB_MAX_WORKERS;
+	}
+
+	JobSystem *pJobSystem = (JobSystem *)calloc(1, sizeof(JobSystem));
+	if(pJobSystem == NULL){
+		return NULL;
+	}
+	// Un worker par ligne de cache, les deques sont allouées à part
+	pJobSystem->workerMemory = calloc(workerNumber + 1, sizeof(JobWorker));
+	if(pJobSystem->workerMemory == NULL){
+		free(pJobSystem);
+		return NULL;
+	}
+	pJobSystem->backgroundJobs = (Job *)malloc(JOB_DEQUE_CAPACITY * sizeof(Job));
+	if(pJobSystem->backgroundJobs == NULL){
+		free(pJobSystem->workerMemory);
+		free(pJobSystem);
+		return NULL;
+	}
+	pJobSystem->workers = (JobWorker *)(((uintptr_t)pJobSystem->workerMemory + 63) & ~(uintptr_t)63);
+	pJobSystem->workerNumber = workerNumber;
+	pthread_mutex_init(&pJobSystem->mutex, NULL);
+	pthread_cond_init(&pJobSystem->condition, NULL);
+
+	for(uint32_t i = 0; i < workerNumber; i++){
+		JobWorker *pWorker = &pJobSystem->workers[i];
+		pWorker->deque = (Job *)malloc(JOB_DEQUE_CAPACITY * sizeof(Job));
+		pWorker->index = i;
+		pWorker->rngState = 0x9e3779b97f4a7c15ull * (i + 1);
+		pWorker->pJobSystem = pJobSystem;
+		if(pWorker->deque == NULL){
+			printf("JobException : unable to allocate the deque of worker %u\n", i);
+			for(uint32_t j = 0; j < i; j++){
+				free(pJobSystem->workers[j].deque);
+			}
+			pthread_cond_destroy(&pJobSystem->condition);
+			pthread_mutex_destroy(&pJobSystem->mutex);
+			free(pJobSystem->backgroundJobs);
+			free(pJobSystem->workerMemory);
+			free(pJobSystem);
+			return NULL;
+		}
+	}
+
+	// Le thread appelant joue le rôle du worker 0
+	pCurrentWorker = &pJobSystem->workers[0];
+	for(uint32_t i = 1; i < workerNumber; i++){
+		if(pthread_create(&pJobSystem->workers[i].thread, NULL, runJobWorker, &pJobSystem->workers[i]) != 0){
+			// Les workers manquants ne sont jamais volés, leurs deques restent vides
+			printf("JobException : unable to start worker %u, %u workers are used\n", i, i);
+			for(uint32_t j = i; j < workerNumber; j++){
+				free(pJobSystem->workers[j].deque);
+				pJobSystem->workers[j].deque = NULL;
+			}
+			__atomic_store_n(&pJobSystem->workerNumber, i, __ATOMIC_RELEASE);
+			break;
+		}
+	}
+	return pJobSystem;
+}
+
+void deleteJobSystem(JobSystem **ppJobSystem){
+	JobSystem *pJobSystem = *ppJobSystem;
+	pthread_mutex_lock(&pJobSystem->mutex);
+	__atomic_store_n(&pJobSystem->isStopping, 1, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&pJobSystem->condition);
+	pthread_mutex_unlock(&pJobSystem->mutex);
+
+	for(uint32_t i = 1; i < pJobSystem->workerNumber; i++){
+		pthread_join(pJobSystem->workers[i].thread, NULL);
+	}
+	// Les workers ne sortent que deques vides, il ne reste que les jobs de la deque 0 ou poussés par les derniers jobs
+	JobWorker *pWorker = &pJobSystem->workers[0];
+	Job job;
+	while(findJob(pWorker, &job) || takeBackgroundJob(pJobSystem, &job)){
+		executeJob(pWorker, &job);
+	}
+	for(uint32_t i = 0; i < pJobSystem->workerNumber; i++){
+		free(pJobSystem->workers[i].deque);
+	}
+
+	if(pCurrentWorker != NULL && pCurrentWorker->pJobSystem == pJobSystem){
+		pCurrentWorker = NULL;
+	}
+	pthread_cond_destroy(&pJobSystem->condition);
+	pthread_mutex_destroy(&pJobSystem->mutex);
+	free(pJobSystem->backgroundJobs);
+	free(pJobSystem->workerMemory);
+	free(pJobSystem);
+	*ppJobSystem = NULL;
+}
+
+void runJob(JobSystem *pJobSystem, JobFunction function, void *pData, JobCounter *pCounter){
+	JobWorker *pWorker = getCurrentWorker(pJobSystem);
+	// Le bas d'une deque n'a qu'un écrivain, son propriétaire : un autre thread n'y pousse jamais et fait le job lui-même
+	if(pWorker == NULL){
+		printf("JobException : job pushed from a thread outside the job system, it is run at once\n");
+		function(pData);
+		return;
+	}
+	Job job = {function, NULL, pData, pCounter, 0, 0, 0};
+	submitJob(pWorker, &job);
+}
+
+void runBackgroundJob(JobSystem *pJobSystem, JobFunction function, void *pData, JobCounter *pCounter){
+	pthread_mutex_lock(&pJobSystem->mutex);
+	// Sans autre worker, ou file pleine, le job est fait tout de suite comme quand une deque est pleine
+	if(pJobSystem->workerNumber < 2 || pJobSystem->backgroundNumber == JOB_DEQUE_CAPACITY){
+		pthread_mutex_unlock(&pJobSystem->mutex);
+		function(pData);
+		return;
+	}
+	if(pCounter != NULL){
+		__atomic_add_fetch(&pCounter->value, 1, __ATOMIC_RELAXED);
+	}
+	Job job = {function, NULL, pData, pCounter, 0, 0, 0};
+	pJobSystem->backgroundJobs[(pJobSystem->backgroundFirst + pJobSystem->backgroundNumber) % JOB_DEQUE_CAPACITY] = job;
+	__atomic_store_n(&pJobSystem->backgroundNumber, pJobSystem->backgroundNumber + 1, __ATOMIC_RELAXED);
+	// Le worker 0 ne dort jamais sur la condition, celui réveillé peut prendre le job
+	__atomic_add_fetch(&pJobSystem->pendingNumber, 1, __ATOMIC_SEQ_CST);
+	pthread_cond_signal(&pJobSystem->condition);
+	pthread_mutex_unlock(&pJobSystem->mutex);
+}
+
+void waitJobCounter(JobSystem *pJobSystem, JobCounter *pCounter){
+	JobWorker *pWorker = getCurrentWorker(pJobSystem);
+	Job job;
+	// Attendre revient à travailler : les jobs dont dépend le compteur sont peut-être dans cette deque
+	while(__atomic_load_n(&pCounter->value, __ATOMIC_ACQUIRE) != 0){
+		if(pWorker != NULL && findJob(pWorker, &job)){
+			executeJob(pWorker, &job);
+		}else{
+			sched_yield();
+		}
+	}
+}
+
+void parallelFor(JobSystem *pJobSystem, uint32_t count, uint32_t grain, JobRangeFunction function, void *pData){
+	if(count == 0){
+		return;
+	}
+	JobWorker *pWorker = getCurrentWorker(pJobSystem);
+	if(pWorker == NULL){
+		printf("JobException : parallel for started from a thread outside the job system, it is run at once\n");
+		function(pData, 0, count);
+		return;
+	}
+	JobCounter counter = {1};
+	Job job = {NULL, function, pData, &counter, 0, count, grain != 0 ? grain : 1};
+	// La racine est découpée sur place, sans passer par la deque
+	executeJob(pWorker, &job);
+	waitJobCounter(pJobSystem, &counter);
+}
+
+uint32_t getJobWorkerNumber(JobSystem *pJobSystem){
+	return pJobSystem->workerNumber;
+}
+
+uint32_t getJobWorkerIndex(JobSystem *pJobSystem){
+	JobWorker *pWorker = getCurrentWorker(pJobSystem);
+	return pWorker != NULL ? pWorker->index : JOB_INVALID_WORKER;
+}
+
+void printJobSystem(JobSystem *pJobSystem){
+	uint64_t jobNumber = 0, stealNumber = 0, sleepNumber = 0;
+	for(uint32_t i = 0; i < pJobSystem->workerNumber; i++){
+		JobWorker *pWorker = &pJobSystem->workers[i];
+		jobNumber += __atomic_load_n(&pWorker->jobNumber, __ATOMIC_RELAXED);
+		stealNumber += __atomic_load_n(&pWorker->stealNumber, __ATOMIC_RELAXED);
+		sleepNumber += __atomic_load_n(&pWorker->sleepNumber, __ATOMIC_RELAXED);
+	}
+	printf("job system : %llu jobs on %u workers, %llu steals, %llu sleeps\n", (unsigned long long)jobNumber,
+		pJobSystem->workerNumber, (unsigned long long)stealNumber, (unsigned long long)sleepNumber);
+}
+
+uint64_t getJobStealNumber(JobSystem *pJobSystem){
+	uint64_t stealNumber = 0;
+	for(uint32_t i = 0; i < pJobSystem->workerNumber; i++){
+		stealNumber += __atomic_load_n(&pJobSystem->workers[i].stealNumber, __ATOMIC_RELAXED);
+	}
+	return stealNumber;
+}
@@ -0,0 +1,217 @@
+#include "../Headers/sim_fun.h"
+
+/*
+ * Matches are laid out as structure of arrays so that the step below is one
+ * branch-free pass the compiler turns into SIMD code. Paddle hits, goals and
+ * match ends need the random generator of the match, the vector pass only
+ * flags their lanes and a sparse scalar pass then runs countPaddleHit,
+ * serveBall and initMatch on them in the order stepMatch does. The
+ * "vk_pong_sim check" mode steps both side by side and compares them bit for bit.
+ */
+
+static inline float clampLane(float value, float low, float high){
+	value = value < low ? low : value;
+	return value > high ? high : value;
+}
+
+static uint32_t getPaddedNumber(uint32_t matchNumber){
+	return (matchNumber + 15) & ~15u;
+}
+
+void getBatchMatch(PongBatch *pBatch, uint32_t index, PongMatch *pMatch){
+	memset(pMatch, 0, sizeof(PongMatch));
+	pMatch->ballX = pBatch->ballX[index];
+	pMatch->ballY = pBatch->ballY[index];
+	pMatch->ballVX = pBatch->ballVX[index];
+	pMatch->ballVY = pBatch->ballVY[index];
+	pMatch->paddleY[0] = pBatch->leftPaddleY[index];
+	pMatch->paddleY[1] = pBatch->rightPaddleY[index];
+	pMatch->aiError[0] = pBatch->leftAIError[index];
+	pMatch->aiError[1] = pBatch->rightAIError[index];
+	pMatch->score[0] = pBatch->leftScore[index];
+	pMatch->score[1] = pBatch->rightScore[index];
+	pMatch->tick = pBatch->tick[index];
+	pMatch->hits = pBatch->hits[index];
+	pMatch->rally = pBatch->rally[index];
+	pMatch->longestRally = pBatch->longestRally[index];
+	pMatch->rngState = pBatch->rngState[index];
+}
+
+static void storeMatch(PongBatch *pBatch, uint32_t index, PongMatch *pMatch){
+	pBatch->ballX[index] = pMatch->ballX;
+	pBatch->ballY[index] = pMatch->ballY;
+	pBatch->ballVX[index] = pMatch->ballVX;
+	pBatch->ballVY[index] = pMatch->ballVY;
+	pBatch->leftPaddleY[index] = pMatch->paddleY[0];
+	pBatch->rightPaddleY[index] = pMatch->paddleY[1];
+	pBatch->leftAIError[index] = pMatch->aiError[0];
+	pBatch->rightAIError[index] = pMatch->aiError[1];
+	pBatch->leftScore[index] = pMatch->score[0];
+	pBatch->rightScore[index] = pMatch->score[1];
+	pBatch->tick[index] = pMatch->tick;
+	pBatch->hits[index] = pMatch->hits;
+	pBatch->rally[index] = pMatch->rally;
+	pBatch->longestRally[index] = pMatch->longestRally;
+	pBatch->rngState[index] = pMatch->rngState;
+}
+
+static void writeObservation(PongBatch *pBatch, uint32_t index, float *pObservations){
+	uint32_t n = pBatch->matchNumber;
+	pObservations[SIM_OBSERVATION_BALL_X * n + index] = pBatch->ballX[index];
+	pObservations[SIM_OBSERVATION_BALL_Y * n + index] = pBatch->ballY[index];
+	pObservations[SIM_OBSERVATION_BALL_VX * n + index] = pBatch->ballVX[index];
+	pObservations[SIM_OBSERVATION_BALL_VY * n + index] = pBatch->ballVY[index];
+	pObservations[SIM_OBSERVATION_LEFT_PADDLE_Y * n + index] = pBatch->leftPaddleY[index];
+	pObservations[SIM_OBSERVATION_RIGHT_PADDLE_Y * n + index] = pBatch->rightPaddleY[index];
+}
+
+PongBatch createBatch(uint32_t matchNumber, uint64_t baseSeed){
+	uint32_t paddedNumber = getPaddedNumber(matchNumber);
+	PongBatch batch;
+	memset(&batch, 0, sizeof(PongBatch));
+
+	// Un seul bloc pour tous les tableaux, chacun aligné sur 64 octets
+	size_t floatArraySize = paddedNumber * sizeof(float);
+	size_t memorySize = 8 * floatArraySize + 6 * paddedNumber * sizeof(uint32_t) + paddedNumber * sizeof(uint64_t)
+	                    + paddedNumber * sizeof(uint8_t) + 64;
+	batch.memory = malloc(memorySize);
+	if(batch.memory == NULL){
+		return batch;
+	}
+	memset(batch.memory, 0, memorySize);
+
+	char *cursor = (char *)(((uintptr_t)batch.memory + 63) & ~(uintptr_t)63);
+	batch.rngState = (uint64_t *)cursor; cursor += paddedNumber * sizeof(uint64_t);
+	batch.ballX = (float *)cursor; cursor += floatArraySize;
+	batch.ballY = (float *)cursor; cursor += floatArraySize;
+	batch.ballVX = (float *)cursor; cursor += floatArraySize;
+	batch.ballVY = (float *)cursor; cursor += floatArraySize;
+	batch.leftPaddleY = (float *)cursor; cursor += floatArraySize;
+	batch.rightPaddleY = (float *)cursor; cursor += floatArraySize;
+	batch.leftAIError = (float *)cursor; cursor += floatArraySize;
+	batch.rightAIError = (float *)cursor; cursor += floatArraySize;
+	batch.leftScore = (uint32_t *)cursor; cursor += paddedNumber * sizeof(uint32_t);
+	batch.rightScore = (uint32_t *)cursor; cursor += paddedNumber * sizeof(uint32_t);
+	batch.tick = (uint32_t *)cursor; cursor += paddedNumber * sizeof(uint32_t);
+	batch.hits = (uint32_t *)cursor; cursor += paddedNumber * sizeof(uint32_t);
+	batch.rally = (uint32_t *)cursor; cursor += paddedNumber * sizeof(uint32_t);
+	batch.longestRally = (uint32_t *)cursor; cursor += paddedNumber * sizeof(uint32_t);
+	batch.hitSides = (uint8_t *)cursor;
+
+	batch.matchNumber = matchNumber;
+	batch.nextSeed = baseSeed + matchNumber;
+	for(uint32_t i = 0; i < matchNumber; i++){
+		PongMatch match;
+		initMatch(&match, baseSeed + i);
+		storeMatch(&batch, i, &match);
+	}
+	return batch;
+}
+
+void deleteBatch(PongBatch *pBatch){
+	free(pBatch->memory);
+	pBatch->memory = NULL;
+	pBatch->matchNumber = 0;
+}
+
+void getBatchObservations(PongBatch *pBatch, float *pObservations){
+	for(uint32_t i = 0; i < pBatch->matchNumber; i++){
+		writeObservation(pBatch, i, pObservations);
+	}
+}
+
+void stepBatch(PongBatch *pBatch, const float *pActions, float *pObservations, float *pRewards, uint8_t *pDones){
+	const uint32_t n = pBatch->matchNumber;
+	const float paddleLimit = 1.0f - SIM_PADDLE_HALF_HEIGHT;
+	const float wallLimit = 1.0f - SIM_BALL_RADIUS;
+	const float paddlePlane = SIM_PADDLE_X - SIM_BALL_RADIUS;
+	const float paddleReach = SIM_PADDLE_HALF_HEIGHT + SIM_BALL_RADIUS;
+
+	float *restrict ballX = pBatch->ballX, *restrict ballY = pBatch->ballY;
+	float *restrict ballVX = pBatch->ballVX, *restrict ballVY = pBatch->ballVY;
+	float *restrict leftPaddleY = pBatch->leftPaddleY, *restrict rightPaddleY = pBatch->rightPaddleY;
+	uint32_t *restrict leftScore = pBatch->leftScore, *restrict rightScore = pBatch->rightScore, *restrict tick = pBatch->tick;
+	const float *restrict leftActions = pActions, *restrict rightActions = pActions + n;
+	float *restrict observedBallX = pObservations + (size_t)SIM_OBSERVATION_BALL_X * n;
+	float *restrict observedBallY = pObservations + (size_t)SIM_OBSERVATION_BALL_Y * n;
+	float *restrict observedBallVX = pObservations + (size_t)SIM_OBSERVATION_BALL_VX * n;
+	float *restrict observedBallVY = pObservations + (size_t)SIM_OBSERVATION_BALL_VY * n;
+	float *restrict observedLeftPaddleY = pObservations + (size_t)SIM_OBSERVATION_LEFT_PADDLE_Y * n;
+	float *restrict observedRightPaddleY = pObservations + (size_t)SIM_OBSERVATION_RIGHT_PADDLE_Y * n;
+	float *restrict rewards = pRewards;
+	uint8_t *restrict dones = pDones;
+	uint8_t *restrict hitSides = pBatch->hitSides;
+
+	// Les tableaux ne se recouvrent jamais, ce qui évite au compilateur de tester l'aliasing
+#pragma GCC ivdep
+	for(uint32_t i = 0; i < n; i++){
+		float leftY = clampLane(leftPaddleY[i] + clampLane(leftActions[i], -1.0f, 1.0f) * SIM_PADDLE_SPEED, -paddleLimit, paddleLimit);
+		float rightY = clampLane(rightPaddleY[i] + clampLane(rightActions[i], -1.0f, 1.0f) * SIM_PADDLE_SPEED, -paddleLimit, paddleLimit);
+
+		float x = ballX[i], vx = ballVX[i], vy = ballVY[i];
+		float nextX = x + vx, nextY = ballY[i] + vy;
+
+		int lowWall = nextY < -wallLimit, highWall = nextY > wallLimit;
+		nextY = lowWall ? -2.0f * wallLimit - nextY : nextY;
+		nextY = highWall ? 2.0f * wallLimit - nextY : nextY;
+		vy = (lowWall | highWall) ? -vy : vy;
+
+		float leftOffset = (nextY - leftY) / paddleReach, rightOffset = (nextY - rightY) / paddleReach;
+		int leftHit = (vx < 0.0f) & (x >= -paddlePlane) & (nextX < -paddlePlane) & (leftOffset >= -1.0f) & (leftOffset <= 1.0f);
+		int rightHit = (vx > 0.0f) & (x <= paddlePlane) & (nextX > paddlePlane) & (rightOffset >= -1.0f) & (rightOffset <= 1.0f);
+		float speed = fabsf(vx) * SIM_BALL_SPEEDUP;
+		speed = speed > SIM_BALL_MAX_SPEED ? SIM_BALL_MAX_SPEED : speed;
+
+		nextX = leftHit ? -SIM_PADDLE_X + SIM_BALL_RADIUS : nextX;
+		nextX = rightHit ? SIM_PADDLE_X - SIM_BALL_RADIUS : nextX;
+		vx = leftHit ? speed : vx;
+		vx = rightHit ? -speed : vx;
+		vy = leftHit ? leftOffset * speed : vy;
+		vy = rightHit ? rightOffset * speed : vy;
+
+		int leftGoal = nextX > 1.0f, rightGoal = nextX < -1.0f;
+		uint32_t left = leftScore[i] + leftGoal, right = rightScore[i] + rightGoal, ticks = tick[i] + 1;
+		int done = (left >= SIM_WINNING_SCORE) | (right >= SIM_WINNING_SCORE) | (ticks >= SIM_MAX_TICKS);
+
+		ballX[i] = nextX;
+		ballY[i] = nextY;
+		ballVX[i] = vx;
+		ballVY[i] = vy;
+		leftPaddleY[i] = leftY;
+		rightPaddleY[i] = rightY;
+		leftScore[i] = left;
+		rightScore[i] = right;
+		tick[i] = ticks;
+
+		rewards[i] = (float)leftGoal - (float)rightGoal;
+		dones[i] = (uint8_t)done;
+		hitSides[i] = (uint8_t)(leftHit | (rightHit << 1));
+
+		observedBallX[i] = nextX;
+		observedBallY[i] = nextY;
+		observedBallVX[i] = vx;
+		observedBallVY[i] = vy;
+		observedLeftPaddleY[i] = leftY;
+		observedRightPaddleY[i] = rightY;
+	}
+
+	// Passe scalaire pour les touches, les buts et les fins de match, qui ont besoin du générateur aléatoire
+	// Les touches passent en premier, comme dans stepMatch, pour que le tirage du service suive le leur
+	for(uint32_t i = 0; i < n; i++){
+		if(hitSides[i] == 0 && rewards[i] == 0.0f && !dones[i]){
+			continue;
+		}
+		PongMatch match;
+		getBatchMatch(pBatch, i, &match);
+		if(hitSides[i] != 0){
+			countPaddleHit(&match, hitSides[i] >> 1);
+		}
+		if(dones[i]){
+			initMatch(&match, pBatch->nextSeed++);
+		}else if(rewards[i] != 0.0f){
+			serveBall(&match, rewards[i] < 0.0f ? 0 : 1);
+		}
+		storeMatch(pBatch, i, &match);
+		writeObservation(pBatch, i, pObservations);
+	}
+}
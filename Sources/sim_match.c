@@ -0,0 +1,166 @@
+#include "../Headers/sim_fun.h"
+
+static uint32_t nextRandom(uint64_t *pState){
+	uint64_t x = *pState;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*pState = x;
+	return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static float nextRandomFloat(uint64_t *pState){
+	return (float)(nextRandom(pState) >> 8) * (1.0f / 16777216.0f);
+}
+
+static float clampFloat(float value, float low, float high){
+	if(value < low){
+		return low;
+	}
+	if(value > high){
+		return high;
+	}
+	return value;
+}
+
+void serveBall(PongMatch *pMatch, uint32_t side){
+	float direction = (side == 0) ? -1.0f : 1.0f;
+
+	pMatch->ballX = 0.0f;
+	pMatch->ballY = (nextRandomFloat(&pMatch->rngState) - 0.5f);
+	pMatch->ballVX = direction * SIM_BALL_START_SPEED;
+	pMatch->ballVY = (nextRandomFloat(&pMatch->rngState) - 0.5f) * SIM_BALL_START_SPEED;
+	pMatch->rally = 0;
+	pMatch->aiError[0] = nextRandomFloat(&pMatch->rngState) * 2.0f - 1.0f;
+	pMatch->aiError[1] = nextRandomFloat(&pMatch->rngState) * 2.0f - 1.0f;
+}
+
+void initMatch(PongMatch *pMatch, uint64_t seed){
+	memset(pMatch, 0, sizeof(PongMatch));
+	pMatch->rngState = seed * 0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+	if(pMatch->rngState == 0){
+		pMatch->rngState = 1;
+	}
+	serveBall(pMatch, nextRandom(&pMatch->rngState) & 1);
+}
+
+void countPaddleHit(PongMatch *pMatch, uint32_t side){
+	pMatch->hits++;
+	pMatch->rally++;
+	if(pMatch->rally > pMatch->longestRally){
+		pMatch->longestRally = pMatch->rally;
+	}
+	pMatch->aiError[1 - side] = nextRandomFloat(&pMatch->rngState) * 2.0f - 1.0f;
+}
+
+static uint32_t bounceOnPaddle(PongMatch *pMatch, uint32_t side){
+	float offset = (pMatch->ballY - pMatch->paddleY[side]) / (SIM_PADDLE_HALF_HEIGHT + SIM_BALL_RADIUS);
+	if(offset < -1.0f || offset > 1.0f){
+		return SIM_EVENT_NONE;
+	}
+
+	float speed = fabsf(pMatch->ballVX) * SIM_BALL_SPEEDUP;
+	if(speed > SIM_BALL_MAX_SPEED){
+		speed = SIM_BALL_MAX_SPEED;
+	}
+
+	// La balle repart du bord de la raquette, l'angle dépend du point d'impact
+	if(side == 0){
+		pMatch->ballX = -SIM_PADDLE_X + SIM_BALL_RADIUS;
+		pMatch->ballVX = speed;
+	}else{
+		pMatch->ballX = SIM_PADDLE_X - SIM_BALL_RADIUS;
+		pMatch->ballVX = -speed;
+	}
+	pMatch->ballVY = offset * speed;
+
+	countPaddleHit(pMatch, side);
+	return SIM_EVENT_PADDLE_HIT;
+}
+
+uint32_t stepMatch(PongMatch *pMatch, float leftAction, float rightAction){
+	uint32_t events = SIM_EVENT_NONE;
+	float actions[2] = {leftAction, rightAction};
+	float paddleLimit = 1.0f - SIM_PADDLE_HALF_HEIGHT;
+
+	for(uint32_t i = 0; i < 2; i++){
+		pMatch->paddleY[i] += clampFloat(actions[i], -1.0f, 1.0f) * SIM_PADDLE_SPEED;
+		pMatch->paddleY[i] = clampFloat(pMatch->paddleY[i], -paddleLimit, paddleLimit);
+	}
+
+	float previousX = pMatch->ballX;
+	pMatch->ballX += pMatch->ballVX;
+	pMatch->ballY += pMatch->ballVY;
+
+	float wallLimit = 1.0f - SIM_BALL_RADIUS;
+	if(pMatch->ballY < -wallLimit){
+		pMatch->ballY = -2.0f * wallLimit - pMatch->ballY;
+		pMatch->ballVY = -pMatch->ballVY;
+		events |= SIM_EVENT_WALL_HIT;
+	}else if(pMatch->ballY > wallLimit){
+		pMatch->ballY = 2.0f * wallLimit - pMatch->ballY;
+		pMatch->ballVY = -pMatch->ballVY;
+		events |= SIM_EVENT_WALL_HIT;
+	}
+
+	float paddlePlane = SIM_PADDLE_X - SIM_BALL_RADIUS;
+	if(pMatch->ballVX < 0.0f && previousX >= -paddlePlane && pMatch->ballX < -paddlePlane){
+		events |= bounceOnPaddle(pMatch, 0);
+	}else if(pMatch->ballVX > 0.0f && previousX <= paddlePlane && pMatch->ballX > paddlePlane){
+		events |= bounceOnPaddle(pMatch, 1);
+	}
+
+	if(pMatch->ballX < -1.0f){
+		pMatch->score[1]++;
+		events |= SIM_EVENT_GOAL_RIGHT;
+		serveBall(pMatch, 0);
+	}else if(pMatch->ballX > 1.0f){
+		pMatch->score[0]++;
+		events |= SIM_EVENT_GOAL_LEFT;
+		serveBall(pMatch, 1);
+	}
+
+	pMatch->tick++;
+	if(isMatchOver(pMatch)){
+		events |= SIM_EVENT_MATCH_OVER;
+	}
+	return events;
+}
+
+int isMatchOver(PongMatch *pMatch){
+	return pMatch->score[0] >= SIM_WINNING_SCORE || pMatch->score[1] >= SIM_WINNING_SCORE || pMatch->tick >= SIM_MAX_TICKS;
+}
+
+float getAIAction(PongMatch *pMatch, uint32_t side, float skill){
+	skill = clampFloat(skill, 0.0f, 1.0f);
+
+	// Une balle qui s'éloigne ramène la raquette au centre, une balle trop lointaine n'est pas encore suivie
+	float target = 0.0f;
+	float distance = (side == 0) ? (pMatch->ballX + SIM_PADDLE_X) : (SIM_PADDLE_X - pMatch->ballX);
+	int incoming = (side == 0) ? (pMatch->ballVX < 0.0f) : (pMatch->ballVX > 0.0f);
+	if(incoming && distance < 0.3f + 1.2f * skill){
+		target = pMatch->ballY + pMatch->aiError[side] * (1.0f - skill) * 6.0f * SIM_PADDLE_HALF_HEIGHT;
+	}
+
+	float action = (target - pMatch->paddleY[side]) / SIM_PADDLE_SPEED;
+	float maxAction = 0.4f + 0.6f * skill;
+	return clampFloat(action, -maxAction, maxAction);
+}
+
+PongMatchResult runMatch(uint64_t seed, float leftSkill, float rightSkill){
+	PongMatch match;
+	initMatch(&match, seed);
+
+	while( ! isMatchOver(&match)){
+		stepMatch(&match, getAIAction(&match, 0, leftSkill), getAIAction(&match, 1, rightSkill));
+	}
+
+	PongMatchResult result = {
+		seed,
+		{match.score[0], match.score[1]},
+		match.tick,
+		match.hits,
+		match.longestRally
+	};
+	return result;
+}
@@ -0,0 +1,92 @@
+#include "../Headers/sim_fun.h"
+
+typedef struct SimMatchJob {
+	PongMatchResult *results;
+	uint64_t baseSeed;
+	float skills[2];
+} SimMatchJob;
+
+static void runMatchRange(void *pData, uint32_t begin, uint32_t end){
+	SimMatchJob *pMatchJob = (SimMatchJob *)pData;
+	for(uint32_t i = begin; i < end; i++){
+		pMatchJob->results[i] = runMatch(pMatchJob->baseSeed + i, pMatchJob->skills[0], pMatchJob->skills[1]);
+	}
+}
+
+PongMatchResult *runMatches(uint32_t matchNumber, uint64_t baseSeed, float leftSkill, float rightSkill, uint32_t threadNumber, uint32_t *pStealNumber){
+	if(threadNumber == 0){
+		threadNumber = getHardwareThreadNumber();
+	}
+	if(threadNumber > matchNumber && matchNumber != 0){
+		threadNumber = matchNumber;
+	}
+
+	SimMatchJob matchJob = {
+		(PongMatchResult *)malloc(matchNumber * sizeof(PongMatchResult)),
+		baseSeed,
+		{leftSkill, rightSkill}
+	};
+	JobSystem *pJobSystem = createJobSystem(threadNumber);
+	if(matchJob.results == NULL || pJobSystem == NULL){
+		if(pJobSystem != NULL){
+			deleteJobSystem(&pJobSystem);
+		}
+		free(matchJob.results);
+		return NULL;
+	}
+
+	// Un match dure des millisecondes : chaque match est une part de la boucle, les voleurs prennent les plus grosses
+	parallelFor(pJobSystem, matchNumber, 1, runMatchRange, &matchJob);
+	if(pStealNumber != NULL){
+		*pStealNumber = (uint32_t)getJobStealNumber(pJobSystem);
+	}
+
+	deleteJobSystem(&pJobSystem);
+	return matchJob.results;
+}
+
+void deleteMatchResults(PongMatchResult **ppResults){
+	free(*ppResults);
+}
+
+int writeMatchSummary(const char *fileName, PongMatchResult *pResults, uint32_t matchNumber, double seconds, uint32_t threadNumber){
+	FILE *fp = fopen(fileName, "w");
+	if(fp == NULL){
+		return -1;
+	}
+
+	uint32_t leftWins = 0, rightWins = 0, draws = 0, longestRally = 0;
+	uint64_t totalTicks = 0, totalHits = 0, totalPoints = 0;
+	for(uint32_t i = 0; i < matchNumber; i++){
+		if(pResults[i].score[0] > pResults[i].score[1]){
+			leftWins++;
+		}else if(pResults[i].score[1] > pResults[i].score[0]){
+			rightWins++;
+		}else{
+			draws++;
+		}
+		if(pResults[i].longestRally > longestRally){
+			longestRally = pResults[i].longestRally;
+		}
+		totalTicks += pResults[i].ticks;
+		totalHits += pResults[i].hits;
+		totalPoints += pResults[i].score[0] + pResults[i].score[1];
+	}
+
+	double divisor = matchNumber != 0 ? (double)matchNumber : 1.0;
+	fprintf(fp, "matches %u\n", matchNumber);
+	fprintf(fp, "threads %u\n", threadNumber);
+	fprintf(fp, "seconds %.6f\n", seconds);
+	fprintf(fp, "matches_per_second %.1f\n", seconds > 0.0 ? matchNumber / seconds : 0.0);
+	fprintf(fp, "ticks_per_second %.1f\n", seconds > 0.0 ? totalTicks / seconds : 0.0);
+	fprintf(fp, "left_wins %u\n", leftWins);
+	fprintf(fp, "right_wins %u\n", rightWins);
+	fprintf(fp, "draws %u\n", draws);
+	fprintf(fp, "average_ticks %.1f\n", totalTicks / divisor);
+	fprintf(fp, "average_hits %.1f\n", totalHits / divisor);
+	fprintf(fp, "average_points %.2f\n", totalPoints / divisor);
+	fprintf(fp, "longest_rally %u\n", longestRally);
+
+	fclose(fp);
+	return 0;
+}
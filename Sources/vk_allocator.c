@@ -0,0 +1,442 @@
+#include <pthread.h>
+
+#include "../Headers/vk_fun.h"
+
+#define HOST_ALLOCATOR_SLAB_SIZE 65536
+#define HOST_ALLOCATOR_CACHE_SIZE 32
+#define HOST_ALLOCATOR_BATCH_SIZE 16
+#define HOST_ALLOCATOR_LARGE_CLASS HOST_ALLOCATOR_CLASS_NUMBER
+#define HOST_ALLOCATOR_MIN_ALIGNMENT 16
+
+/**
+ * En-tête placé juste avant chaque bloc rendu au driver
+ */
+typedef struct HostBlockHeader {
+	void *pBlock;
+	size_t size;
+	uint32_t sizeClass;
+	uint16_t typeSlot;
+	uint16_t scope;
+} HostBlockHeader;
+
+/**
+ * Blocs libres gardés par un thread, sans verrou
+ */
+typedef struct HostThreadCache {
+	uint32_t generation;
+	uint32_t freeNumbers[HOST_ALLOCATOR_CLASS_NUMBER];
+	void *pFreeBlocks[HOST_ALLOCATOR_CLASS_NUMBER];
+} HostThreadCache;
+
+typedef struct HostAllocator {
+	VkAllocationCallbacks callbacks[HOST_ALLOCATOR_TYPE_NUMBER];
+	HostAllocationStats stats[HOST_ALLOCATOR_TYPE_NUMBER][HOST_ALLOCATOR_SCOPE_NUMBER];
+	HostAllocationStats internalStats[HOST_ALLOCATOR_SCOPE_NUMBER];
+	pthread_mutex_t mutex;
+	pthread_key_t cacheKey;
+	void *pFreeBlocks[HOST_ALLOCATOR_CLASS_NUMBER];
+	void *pSlabs;
+	uint64_t slabNumber;
+	uint64_t refillNumber;
+	uint64_t drainNumber;
+	uint64_t largeNumber;
+	uint32_t generation;
+	int isCreated;
+} HostAllocator;
+
+static HostAllocator hostAllocator;
+static __thread HostThreadCache *pThreadCache;
+
+static const char *hostAllocatorTypeNames[HOST_ALLOCATOR_TYPE_NUMBER] = {
+	"unknown", "instance", "physical device", "device", "queue", "semaphore", "command buffer", "fence",
+	"device memory", "buffer", "image", "event", "query pool", "buffer view", "image view", "shader module",
+	"pipeline cache", "pipeline layout", "render pass", "pipeline", "descriptor set layout", "sampler",
+	"descriptor pool", "descriptor set", "framebuffer", "command pool", "surface", "swapchain"
+};
+
+static const char *hostAllocatorScopeNames[HOST_ALLOCATOR_SCOPE_NUMBER] = {
+	"command", "object", "cache", "device", "instance"
+};
+
+static uint32_t getHostAllocatorTypeSlot(VkObjectType objectType){
+	if(objectType <= VK_OBJECT_TYPE_COMMAND_POOL){
+		return (uint32_t)objectType;
+	}
+	if(objectType == VK_OBJECT_TYPE_SURFACE_KHR){
+		return VK_OBJECT_TYPE_COMMAND_POOL + 1;
+	}
+	if(objectType == VK_OBJECT_TYPE_SWAPCHAIN_KHR){
+		return VK_OBJECT_TYPE_COMMAND_POOL + 2;
+	}
+	return VK_OBJECT_TYPE_UNKNOWN;
+}
+
+static uint32_t getSizeClass(size_t blockSize){
+	uint32_t sizeClass = 0;
+	size_t classSize = HOST_ALLOCATOR_MAX_CLASS_SIZE >> (HOST_ALLOCATOR_CLASS_NUMBER - 1);
+	while(sizeClass < HOST_ALLOCATOR_CLASS_NUMBER && classSize < blockSize){
+		classSize <<= 1;
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+static void updatePeakBytes(HostAllocationStats *pStats, uint64_t liveBytes){
+	uint64_t peakBytes = __atomic_load_n(&pStats->peakBytes, __ATOMIC_RELAXED);
+	while(liveBytes > peakBytes && !__atomic_compare_exchange_n(&pStats->peakBytes, &peakBytes, liveBytes, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+	}
+}
+
+static void countAllocation(HostAllocationStats *pStats, size_t size){
+	updatePeakBytes(pStats, __atomic_add_fetch(&pStats->liveBytes, size, __ATOMIC_RELAXED));
+	__atomic_add_fetch(&pStats->allocationNumber, 1, __ATOMIC_RELAXED);
+}
+
+static void countReallocation(HostAllocationStats *pStats, size_t oldSize, size_t size){
+	if(size > oldSize){
+		updatePeakBytes(pStats, __atomic_add_fetch(&pStats->liveBytes, size - oldSize, __ATOMIC_RELAXED));
+	}else{
+		__atomic_sub_fetch(&pStats->liveBytes, oldSize - size, __ATOMIC_RELAXED);
+	}
+	__atomic_add_fetch(&pStats->reallocationNumber, 1, __ATOMIC_RELAXED);
+}
+
+static void countFree(HostAllocationStats *pStats, size_t size){
+	__atomic_sub_fetch(&pStats->liveBytes, size, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&pStats->freeNumber, 1, __ATOMIC_RELAXED);
+}
+
+static HostAllocationStats copyHostAllocationStats(HostAllocationStats *pStats){
+	HostAllocationStats stats = {
+		__atomic_load_n(&pStats->liveBytes, __ATOMIC_RELAXED),
+		__atomic_load_n(&pStats->peakBytes, __ATOMIC_RELAXED),
+		__atomic_load_n(&pStats->allocationNumber, __ATOMIC_RELAXED),
+		__atomic_load_n(&pStats->reallocationNumber, __ATOMIC_RELAXED),
+		__atomic_load_n(&pStats->freeNumber, __ATOMIC_RELAXED)
+	};
+	return stats;
+}
+
+static void drainThreadCache(HostThreadCache *pCache, uint32_t sizeClass, uint32_t blockNumber){
+	// Les blocs rendus au pool sont chaînés dans le cache puis raccrochés d'un coup sous le verrou
+	void *pFirst = pCache->pFreeBlocks[sizeClass], *pLast = pFirst;
+	for(uint32_t i = 1; i < blockNumber; i++){
+		pLast = *(void **)pLast;
+	}
+	pCache->pFreeBlocks[sizeClass] = *(void **)pLast;
+	pCache->freeNumbers[sizeClass] -= blockNumber;
+	pthread_mutex_lock(&hostAllocator.mutex);
+	*(void **)pLast = hostAllocator.pFreeBlocks[sizeClass];
+	hostAllocator.pFreeBlocks[sizeClass] = pFirst;
+	hostAllocator.drainNumber++;
+	pthread_mutex_unlock(&hostAllocator.mutex);
+}
+
+static void deleteThreadCache(void *pArg){
+	HostThreadCache *pCache = (HostThreadCache *)pArg;
+	// Un thread qui se termine rend ses blocs, sauf si le pool a été détruit entre temps
+	if(__atomic_load_n(&hostAllocator.isCreated, __ATOMIC_ACQUIRE) && pCache->generation == hostAllocator.generation){
+		for(uint32_t i = 0; i < HOST_ALLOCATOR_CLASS_NUMBER; i++){
+			if(pCache->freeNumbers[i] > 0){
+				drainThreadCache(pCache, i, pCache->freeNumbers[i]);
+			}
+		}
+	}
+	free(pCache);
+}
+
+static HostThreadCache *getThreadCache(){
+	if(pThreadCache != VK_NULL_HANDLE && pThreadCache->generation == hostAllocator.generation){
+		return pThreadCache;
+	}
+	// Premier appel de ce thread, ou cache d'un pool précédent dont les blocs n'existent plus
+	free(pThreadCache);
+	pThreadCache = (HostThreadCache *)malloc(sizeof(HostThreadCache));
+	if(pThreadCache != VK_NULL_HANDLE){
+		memset(pThreadCache, 0, sizeof(HostThreadCache));
+		pThreadCache->generation = hostAllocator.generation;
+	}
+	pthread_setspecific(hostAllocator.cacheKey, pThreadCache);
+	return pThreadCache;
+}
+
+static void *takePoolBlock(uint32_t sizeClass){
+	HostThreadCache *pCache = getThreadCache();
+	if(pCache == VK_NULL_HANDLE){
+		return VK_NULL_HANDLE;
+	}
+	if(pCache->pFreeBlocks[sizeClass] == VK_NULL_HANDLE){
+		size_t classSize = (size_t)HOST_ALLOCATOR_MAX_CLASS_SIZE >> (HOST_ALLOCATOR_CLASS_NUMBER - 1 - sizeClass);
+		pthread_mutex_lock(&hostAllocator.mutex);
+		if(hostAllocator.pFreeBlocks[sizeClass] == VK_NULL_HANDLE){
+			// Nouveau slab découpé en blocs de la classe, le premier mot du slab chaîne les slabs entre eux
+			char *pSlab = (char *)malloc(HOST_ALLOCATOR_SLAB_SIZE);
+			if(pSlab == VK_NULL_HANDLE){
+				pthread_mutex_unlock(&hostAllocator.mutex);
+				return VK_NULL_HANDLE;
+			}
+			*(void **)pSlab = hostAllocator.pSlabs;
+			hostAllocator.pSlabs = pSlab;
+			hostAllocator.slabNumber++;
+			for(size_t offset = classSize; offset + classSize <= HOST_ALLOCATOR_SLAB_SIZE; offset += classSize){
+				*(void **)&pSlab[offset] = hostAllocator.pFreeBlocks[sizeClass];
+				hostAllocator.pFreeBlocks[sizeClass] = &pSlab[offset];
+			}
+		}
+		// Un lot de blocs passe dans le cache du thread pour les prochains appels
+		for(uint32_t i = 0; i < HOST_ALLOCATOR_BATCH_SIZE && hostAllocator.pFreeBlocks[sizeClass] != VK_NULL_HANDLE; i++){
+			void *pBlock = hostAllocator.pFreeBlocks[sizeClass];
+			hostAllocator.pFreeBlocks[sizeClass] = *(void **)pBlock;
+			*(void **)pBlock = pCache->pFreeBlocks[sizeClass];
+			pCache->pFreeBlocks[sizeClass] = pBlock;
+			pCache->freeNumbers[sizeClass]++;
+		}
+		hostAllocator.refillNumber++;
+		pthread_mutex_unlock(&hostAllocator.mutex);
+	}
+	void *pBlock = pCache->pFreeBlocks[sizeClass];
+	pCache->pFreeBlocks[sizeClass] = *(void **)pBlock;
+	pCache->freeNumbers[sizeClass]--;
+	return pBlock;
+}
+
+static void givePoolBlock(uint32_t sizeClass, void *pBlock){
+	HostThreadCache *pCache = getThreadCache();
+	if(pCache == VK_NULL_HANDLE){
+		pthread_mutex_lock(&hostAllocator.mutex);
+		*(void **)pBlock = hostAllocator.pFreeBlocks[sizeClass];
+		hostAllocator.pFreeBlocks[sizeClass] = pBlock;
+		pthread_mutex_unlock(&hostAllocator.mutex);
+		return;
+	}
+	*(void **)pBlock = pCache->pFreeBlocks[sizeClass];
+	pCache->pFreeBlocks[sizeClass] = pBlock;
+	pCache->freeNumbers[sizeClass]++;
+	if(pCache->freeNumbers[sizeClass] > HOST_ALLOCATOR_CACHE_SIZE){
+		drainThreadCache(pCache, sizeClass, HOST_ALLOCATOR_BATCH_SIZE);
+	}
+}
+
+static void *allocateHostBlock(uint32_t typeSlot, size_t size, size_t alignment, VkSystemAllocationScope scope){
+	if(alignment < HOST_ALLOCATOR_MIN_ALIGNMENT){
+		alignment = HOST_ALLOCATOR_MIN_ALIGNMENT;
+	}
+	// L'en-tête et le décalage d'alignement font partie du bloc
+	size_t blockSize = sizeof(HostBlockHeader) + alignment - 1 + size;
+	uint32_t sizeClass = getSizeClass(blockSize);
+	char *pBlock;
+	if(sizeClass == HOST_ALLOCATOR_LARGE_CLASS){
+		pBlock = (char *)malloc(blockSize);
+		__atomic_add_fetch(&hostAllocator.largeNumber, 1, __ATOMIC_RELAXED);
+	}else{
+		pBlock = (char *)takePoolBlock(sizeClass);
+	}
+	if(pBlock == VK_NULL_HANDLE){
+		return VK_NULL_HANDLE;
+	}
+	uintptr_t address = ((uintptr_t)pBlock + sizeof(HostBlockHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	HostBlockHeader *pHeader = (HostBlockHeader *)(address - sizeof(HostBlockHeader));
+	pHeader->pBlock = pBlock;
+	pHeader->size = size;
+	pHeader->sizeClass = sizeClass;
+	pHeader->typeSlot = (uint16_t)typeSlot;
+	pHeader->scope = (uint16_t)scope;
+	return (void *)address;
+}
+
+static void freeHostBlock(HostBlockHeader *pHeader){
+	if(pHeader->sizeClass == HOST_ALLOCATOR_LARGE_CLASS){
+		free(pHeader->pBlock);
+	}else{
+		givePoolBlock(pHeader->sizeClass, pHeader->pBlock);
+	}
+}
+
+static void *VKAPI_PTR allocateHostMemory(void *pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope){
+	uint32_t typeSlot = (uint32_t)(uintptr_t)pUserData;
+	if(size == 0){
+		return VK_NULL_HANDLE;
+	}
+	void *pMemory = allocateHostBlock(typeSlot, size, alignment, scope);
+	if(pMemory != VK_NULL_HANDLE){
+		countAllocation(&hostAllocator.stats[typeSlot][scope], size);
+	}
+	return pMemory;
+}
+
+static void VKAPI_PTR freeHostMemory(void *pUserData, void *pMemory){
+	(void)pUserData;
+	if(pMemory == VK_NULL_HANDLE){
+		return;
+	}
+	// Le bloc peut être libéré avec les callbacks d'un autre type, seul l'en-tête fait foi
+	HostBlockHeader *pHeader = (HostBlockHeader *)((char *)pMemory - sizeof(HostBlockHeader));
+	countFree(&hostAllocator.stats[pHeader->typeSlot][pHeader->scope], pHeader->size);
+	freeHostBlock(pHeader);
+}
+
+static void *VKAPI_PTR reallocateHostMemory(void *pUserData, void *pOriginal, size_t size, size_t alignment, VkSystemAllocationScope scope){
+	if(pOriginal == VK_NULL_HANDLE){
+		return allocateHostMemory(pUserData, size, alignment, scope);
+	}
+	if(size == 0){
+		freeHostMemory(pUserData, pOriginal);
+		return VK_NULL_HANDLE;
+	}
+	// La réallocation reste comptée sur le type et la portée de l'allocation d'origine
+	HostBlockHeader *pHeader = (HostBlockHeader *)((char *)pOriginal - sizeof(HostBlockHeader));
+	HostAllocationStats *pStats = &hostAllocator.stats[pHeader->typeSlot][pHeader->scope];
+	size_t oldSize = pHeader->size;
+	// Le bloc actuel suffit si la nouvelle taille tient dans sa classe avec le même alignement
+	if(pHeader->sizeClass != HOST_ALLOCATOR_LARGE_CLASS && ((uintptr_t)pOriginal & (alignment - 1)) == 0){
+		size_t classSize = (size_t)HOST_ALLOCATOR_MAX_CLASS_SIZE >> (HOST_ALLOCATOR_CLASS_NUMBER - 1 - pHeader->sizeClass);
+		if((char *)pOriginal + size <= (char *)pHeader->pBlock + classSize){
+			pHeader->size = size;
+			countReallocation(pStats, oldSize, size);
+			return pOriginal;
+		}
+	}
+	void *pMemory = allocateHostBlock(pHeader->typeSlot, size, alignment, (VkSystemAllocationScope)pHeader->scope);
+	if(pMemory == VK_NULL_HANDLE){
+		return VK_NULL_HANDLE;
+	}
+	memcpy(pMemory, pOriginal, oldSize < size ? oldSize : size);
+	freeHostBlock(pHeader);
+	countReallocation(pStats, oldSize, size);
+	return pMemory;
+}
+
+static void VKAPI_PTR notifyInternalAllocation(void *pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope scope){
+	(void)pUserData;
+	(void)allocationType;
+	countAllocation(&hostAllocator.internalStats[scope], size);
+}
+
+static void VKAPI_PTR notifyInternalFree(void *pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope scope){
+	(void)pUserData;
+	(void)allocationType;
+	countFree(&hostAllocator.internalStats[scope], size);
+}
+
+int createHostAllocator(){
+	if(hostAllocator.isCreated){
+		return 0;
+	}
+	uint32_t generation = hostAllocator.generation + 1;
+	memset(&hostAllocator, 0, sizeof(HostAllocator));
+	hostAllocator.generation = generation;
+	if(pthread_mutex_init(&hostAllocator.mutex, VK_NULL_HANDLE) != 0){
+		printf("VkAllocatorException : unable to create the pool mutex\n");
+		return -1;
+	}
+	if(pthread_key_create(&hostAllocator.cacheKey, deleteThreadCache) != 0){
+		printf("VkAllocatorException : unable to create the thread cache key\n");
+		pthread_mutex_destroy(&hostAllocator.mutex);
+		return -1;
+	}
+	// Un jeu de callbacks par type d'objet, pUserData porte l'indice du type
+	for(uint32_t i = 0; i < HOST_ALLOCATOR_TYPE_NUMBER; i++){
+		VkAllocationCallbacks callbacks = {
+			(void *)(uintptr_t)i,
+			allocateHostMemory,
+			reallocateHostMemory,
+			freeHostMemory,
+			notifyInternalAllocation,
+			notifyInternalFree
+		};
+		hostAllocator.callbacks[i] = callbacks;
+	}
+	__atomic_store_n(&hostAllocator.isCreated, 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+void deleteHostAllocator(){
+	if(!hostAllocator.isCreated){
+		return;
+	}
+	uint64_t liveBytes = 0;
+	for(uint32_t i = 0; i < HOST_ALLOCATOR_TYPE_NUMBER; i++){
+		for(uint32_t j = 0; j < HOST_ALLOCATOR_SCOPE_NUMBER; j++){
+			liveBytes += hostAllocator.stats[i][j].liveBytes;
+		}
+	}
+	__atomic_store_n(&hostAllocator.isCreated, 0, __ATOMIC_RELEASE);
+	if(liveBytes > 0){
+		// Des blocs sont encore référencés, les slabs ne sont pas libérés pour ne pas les invalider
+		printf("VkAllocatorException : %llu bytes still allocated, the pools are kept\n", (unsigned long long)liveBytes);
+		return;
+	}
+	free(pThreadCache);
+	pThreadCache = VK_NULL_HANDLE;
+	pthread_setspecific(hostAllocator.cacheKey, VK_NULL_HANDLE);
+	while(hostAllocator.pSlabs != VK_NULL_HANDLE){
+		void *pSlab = hostAllocator.pSlabs;
+		hostAllocator.pSlabs = *(void **)pSlab;
+		free(pSlab);
+	}
+	pthread_key_delete(hostAllocator.cacheKey);
+	pthread_mutex_destroy(&hostAllocator.mutex);
+}
+
+const VkAllocationCallbacks *getHostAllocator(VkObjectType objectType){
+	if(!__atomic_load_n(&hostAllocator.isCreated, __ATOMIC_ACQUIRE)){
+		return VK_NULL_HANDLE;
+	}
+	return &hostAllocator.callbacks[getHostAllocatorTypeSlot(objectType)];
+}
+
+HostAllocationStats getHostAllocationStats(VkObjectType objectType, VkSystemAllocationScope scope){
+	uint32_t typeSlot = getHostAllocatorTypeSlot(objectType);
+	if((uint32_t)scope >= HOST_ALLOCATOR_SCOPE_NUMBER || (typeSlot == VK_OBJECT_TYPE_UNKNOWN && objectType != VK_OBJECT_TYPE_UNKNOWN)){
+		HostAllocationStats stats;
+		memset(&stats, 0, sizeof(HostAllocationStats));
+		return stats;
+	}
+	return copyHostAllocationStats(&hostAllocator.stats[typeSlot][scope]);
+}
+
+uint64_t getHostAllocationNumber(){
+	uint64_t allocationNumber = 0;
+	for(uint32_t i = 0; i < HOST_ALLOCATOR_TYPE_NUMBER; i++){
+		for(uint32_t j = 0; j < HOST_ALLOCATOR_SCOPE_NUMBER; j++){
+			allocationNumber += __atomic_load_n(&hostAllocator.stats[i][j].allocationNumber, __ATOMIC_RELAXED);
+			allocationNumber += __atomic_load_n(&hostAllocator.stats[i][j].reallocationNumber, __ATOMIC_RELAXED);
+		}
+	}
+	return allocationNumber;
+}
+
+void printHostAllocator(){
+	printf("host allocations :\n");
+	printf("  %-22s %-9s %12s %12s %10s %10s %10s\n", "type", "scope", "live", "peak", "allocs", "reallocs", "frees");
+	uint64_t liveBytes = 0, peakBytes = 0, callNumber = 0;
+	for(uint32_t i = 0; i < HOST_ALLOCATOR_TYPE_NUMBER; i++){
+		for(uint32_t j = 0; j < HOST_ALLOCATOR_SCOPE_NUMBER; j++){
+			HostAllocationStats stats = copyHostAllocationStats(&hostAllocator.stats[i][j]);
+			if(stats.allocationNumber == 0){
+				continue;
+			}
+			printf("  %-22s %-9s %12llu %12llu %10llu %10llu %10llu\n", hostAllocatorTypeNames[i], hostAllocatorScopeNames[j],
+				(unsigned long long)stats.liveBytes, (unsigned long long)stats.peakBytes, (unsigned long long)stats.allocationNumber,
+				(unsigned long long)stats.reallocationNumber, (unsigned long long)stats.freeNumber);
+			liveBytes += stats.liveBytes;
+			peakBytes += stats.peakBytes;
+			callNumber += stats.allocationNumber + stats.reallocationNumber + stats.freeNumber;
+		}
+	}
+	printf("  total : %llu bytes live, %llu bytes at the sum of the peaks, %llu calls\n", (unsigned long long)liveBytes, (unsigned long long)peakBytes, (unsigned long long)callNumber);
+	for(uint32_t j = 0; j < HOST_ALLOCATOR_SCOPE_NUMBER; j++){
+		HostAllocationStats stats = copyHostAllocationStats(&hostAllocator.internalStats[j]);
+		if(stats.allocationNumber > 0){
+			printf("  driver internal, %s scope : %llu bytes live, %llu peak, %llu allocs\n", hostAllocatorScopeNames[j],
+				(unsigned long long)stats.liveBytes, (unsigned long long)stats.peakBytes, (unsigned long long)stats.allocationNumber);
+		}
+	}
+	// Activité des pools : beaucoup de recharges ou de vidages signale des allocations qui vont et viennent
+	if(hostAllocator.isCreated){
+		pthread_mutex_lock(&hostAllocator.mutex);
+		printf("  pools : %llu slabs of %u bytes, %llu refills, %llu drains, %llu large blocks\n", (unsigned long long)hostAllocator.slabNumber, HOST_ALLOCATOR_SLAB_SIZE,
+			(unsigned long long)hostAllocator.refillNumber, (unsigned long long)hostAllocator.drainNumber, (unsigned long long)__atomic_load_n(&hostAllocator.largeNumber, __ATOMIC_RELAXED));
+		pthread_mutex_unlock(&hostAllocator.mutex);
+	}
+}
@@ -0,0 +1,163 @@
+#include "../Headers/bindless_fun.h"
+
+struct BindlessTable {
+	VkDevice device;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet descriptorSet;
+	uint32_t textureCapacity;
+	uint32_t bufferCapacity;
+	uint32_t textureNumber;
+	uint32_t bufferNumber;
+};
+
+static uint32_t minBindlessCount(uint32_t count, uint32_t limit){
+	return count < limit ? count : limit;
+}
+
+BindlessTable *createBindlessTable(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice){
+	if(!getDescriptorIndexingSupport(pPhysicalDevice)){
+		printf("VkBindlessException : descriptor indexing not supported, every texture keeps its own descriptor set\n");
+		return VK_NULL_HANDLE;
+	}
+	BindlessTable *pBindlessTable = (BindlessTable *)calloc(1, sizeof(BindlessTable));
+	if(pBindlessTable == VK_NULL_HANDLE){
+		return VK_NULL_HANDLE;
+	}
+	pBindlessTable->device = *pDevice;
+
+	// Les limites update-after-bind sont à part des limites classiques, une texture compte aussi comme sampler
+	VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties;
+	memset(&descriptorIndexingProperties, 0, sizeof(VkPhysicalDeviceDescriptorIndexingPropertiesEXT));
+	descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+	VkPhysicalDeviceProperties2 physicalDeviceProperties = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+		&descriptorIndexingProperties
+	};
+	vkGetPhysicalDeviceProperties2(*pPhysicalDevice, &physicalDeviceProperties);
+	uint32_t textureCapacity = minBindlessCount(BINDLESS_MAX_TEXTURES, descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+	textureCapacity = minBindlessCount(textureCapacity, descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+	textureCapacity = minBindlessCount(textureCapacity, descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+	textureCapacity = minBindlessCount(textureCapacity, descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSamplers);
+	uint32_t bufferCapacity = minBindlessCount(BINDLESS_MAX_BUFFERS, descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+	bufferCapacity = minBindlessCount(bufferCapacity, descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers);
+	pBindlessTable->textureCapacity = textureCapacity;
+	pBindlessTable->bufferCapacity = bufferCapacity;
+
+	VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
+		{BINDLESS_TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCapacity, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE},
+		{BINDLESS_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCapacity, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE}
+	};
+	// Les emplacements jamais écrits ne sont pas lus, ceux qui ne servent pas à une soumission en vol peuvent être écrits
+	VkDescriptorBindingFlagsEXT descriptorBindingFlags[] = {
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT,
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT
+	};
+	VkDescriptorSetLayoutBindingFlagsCreateInfoEXT descriptorSetLayoutBindingFlagsCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+		VK_NULL_HANDLE,
+		2,
+		descriptorBindingFlags
+	};
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		&descriptorSetLayoutBindingFlagsCreateInfo,
+		VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+		2,
+		descriptorSetLayoutBindings
+	};
+	vkCreateDescriptorSetLayout(*pDevice, &descriptorSetLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &pBindlessTable->descriptorSetLayout);
+
+	VkDescriptorPoolSize descriptorPoolSizes[] = {
+		{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCapacity},
+		{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCapacity}
+	};
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+		1,
+		2,
+		descriptorPoolSizes
+	};
+	vkCreateDescriptorPool(*pDevice, &descriptorPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pBindlessTable->descriptorPool);
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pBindlessTable->descriptorPool,
+		1,
+		&pBindlessTable->descriptorSetLayout
+	};
+	if(pBindlessTable->descriptorSetLayout == VK_NULL_HANDLE || pBindlessTable->descriptorPool == VK_NULL_HANDLE ||
+	   vkAllocateDescriptorSets(*pDevice, &descriptorSetAllocateInfo, &pBindlessTable->descriptorSet) != VK_SUCCESS){
+		printf("VkBindlessException : unable to allocate the table of %u textures and %u buffers\n", textureCapacity, bufferCapacity);
+		deleteBindlessTable(pDevice, &pBindlessTable);
+		return VK_NULL_HANDLE;
+	}
+	return pBindlessTable;
+}
+
+void deleteBindlessTable(VkDevice *pDevice, BindlessTable **ppBindlessTable){
+	BindlessTable *pBindlessTable = *ppBindlessTable;
+	if(pBindlessTable->descriptorSet != VK_NULL_HANDLE){
+		printf("bindless table : %u of %u textures, %u of %u buffers\n", pBindlessTable->textureNumber, pBindlessTable->textureCapacity,
+			pBindlessTable->bufferNumber, pBindlessTable->bufferCapacity);
+	}
+	vkDestroyDescriptorPool(*pDevice, pBindlessTable->descriptorPool, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+	vkDestroyDescriptorSetLayout(*pDevice, pBindlessTable->descriptorSetLayout, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+	free(pBindlessTable);
+	*ppBindlessTable = VK_NULL_HANDLE;
+}
+
+uint32_t addBindlessTexture(BindlessTable *pBindlessTable, VkDescriptorImageInfo *pImageInfo){
+	if(pBindlessTable->textureNumber == pBindlessTable->textureCapacity){
+		printf("VkBindlessException : the table already holds %u textures\n", pBindlessTable->textureCapacity);
+		return BINDLESS_INVALID_INDEX;
+	}
+	uint32_t texture = pBindlessTable->textureNumber++;
+	VkWriteDescriptorSet writeDescriptorSet = {
+		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		VK_NULL_HANDLE,
+		pBindlessTable->descriptorSet,
+		BINDLESS_TEXTURE_BINDING,
+		texture,
+		1,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		pImageInfo,
+		VK_NULL_HANDLE,
+		VK_NULL_HANDLE
+	};
+	vkUpdateDescriptorSets(pBindlessTable->device, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	return texture;
+}
+
+uint32_t addBindlessBuffer(BindlessTable *pBindlessTable, VkDescriptorBufferInfo *pBufferInfo){
+	if(pBindlessTable->bufferNumber == pBindlessTable->bufferCapacity){
+		printf("VkBindlessException : the table already holds %u buffers\n", pBindlessTable->bufferCapacity);
+		return BINDLESS_INVALID_INDEX;
+	}
+	uint32_t buffer = pBindlessTable->bufferNumber++;
+	VkWriteDescriptorSet writeDescriptorSet = {
+		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		VK_NULL_HANDLE,
+		pBindlessTable->descriptorSet,
+		BINDLESS_BUFFER_BINDING,
+		buffer,
+		1,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_NULL_HANDLE,
+		pBufferInfo,
+		VK_NULL_HANDLE
+	};
+	vkUpdateDescriptorSets(pBindlessTable->device, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	return buffer;
+}
+
+VkDescriptorSetLayout *getBindlessSetLayout(BindlessTable *pBindlessTable){
+	return &pBindlessTable->descriptorSetLayout;
+}
+
+void recordBindlessTable(BindlessTable *pBindlessTable, VkCommandBuffer *pCommandBuffer, VkPipelineLayout *pPipelineLayout){
+	vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *pPipelineLayout, 0, 1, &pBindlessTable->descriptorSet, 0, VK_NULL_HANDLE);
+}
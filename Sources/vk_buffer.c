@@ -0,0 +1,82 @@
+#include "../Headers/vk_fun.h"
+
+uint32_t getMemoryTypeIndex(VkPhysicalDevice *pPhysicalDevice, uint32_t memoryTypeBits, VkMemoryPropertyFlags memoryProperties){
+	VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(*pPhysicalDevice, &physicalDeviceMemoryProperties);
+
+	for(uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; i++){
+		if((memoryTypeBits & (1u << i)) != 0 && (physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & memoryProperties) == memoryProperties){
+			return i;
+		}
+	}
+	return UINT32_MAX;
+}
+
+VkBuffer createBuffer(VkDevice *pDevice, VkDeviceSize size, VkBufferUsageFlags usage){
+	VkBufferCreateInfo bufferCreateInfo = {
+		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		size,
+		usage,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		VK_NULL_HANDLE
+	};
+
+	VkBuffer buffer;
+	vkCreateBuffer(*pDevice, &bufferCreateInfo, getHostAllocator(VK_OBJECT_TYPE_BUFFER), &buffer);
+	return buffer;
+}
+
+void deleteBuffer(VkDevice *pDevice, VkBuffer *pBuffer){
+	vkDestroyBuffer(*pDevice, *pBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+}
+
+static VkDeviceMemory allocateMemory(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkMemoryRequirements *pMemoryRequirements, VkMemoryPropertyFlags memoryProperties){
+	uint32_t memoryTypeIndex = getMemoryTypeIndex(pPhysicalDevice, pMemoryRequirements->memoryTypeBits, memoryProperties);
+	if(memoryTypeIndex == UINT32_MAX){
+		printf("VkMemoryException : no memory type with properties 0x%x\n", memoryProperties);
+		return VK_NULL_HANDLE;
+	}
+
+	VkMemoryAllocateInfo memoryAllocateInfo = {
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pMemoryRequirements->size,
+		memoryTypeIndex
+	};
+
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if(vkAllocateMemory(*pDevice, &memoryAllocateInfo, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY), &memory) != VK_SUCCESS){
+		printf("VkMemoryException : unable to allocate %llu bytes\n", (unsigned long long)pMemoryRequirements->size);
+		return VK_NULL_HANDLE;
+	}
+	return memory;
+}
+
+VkDeviceMemory allocateBufferMemory(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkBuffer *pBuffer, VkMemoryPropertyFlags memoryProperties){
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(*pDevice, *pBuffer, &memoryRequirements);
+
+	VkDeviceMemory memory = allocateMemory(pPhysicalDevice, pDevice, &memoryRequirements, memoryProperties);
+	if(memory != VK_NULL_HANDLE){
+		vkBindBufferMemory(*pDevice, *pBuffer, memory, 0);
+	}
+	return memory;
+}
+
+VkDeviceMemory allocateImageMemory(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkImage *pImage, VkMemoryPropertyFlags memoryProperties){
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(*pDevice, *pImage, &memoryRequirements);
+
+	VkDeviceMemory memory = allocateMemory(pPhysicalDevice, pDevice, &memoryRequirements, memoryProperties);
+	if(memory != VK_NULL_HANDLE){
+		vkBindImageMemory(*pDevice, *pImage, memory, 0);
+	}
+	return memory;
+}
+
+void freeMemory(VkDevice *pDevice, VkDeviceMemory *pMemory){
+	vkFreeMemory(*pDevice, *pMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+}
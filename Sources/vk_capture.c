@@ -0,0 +1,341 @@
+#include <pthread.h>
+
+#include "../Headers/capture_fun.h"
+#include "../Headers/trace_fun.h"
+
+struct FrameCapture {
+	VkDevice device;
+	VkExtent2D extent;
+	uint32_t fileFormat;
+	VkBool32 isBgra;
+	const char *fileName;
+	FILE *pFile;
+	uint32_t frameRate;
+	uint64_t startTime;
+	uint64_t tickNumber;
+	uint32_t slotNumber;
+	VkDeviceSize slotSize;
+	VkBuffer buffer;
+	VkDeviceMemory memory;
+	uint8_t *pData;
+	uint8_t *pConvertedFrame;
+	RenderGraph *pRenderGraph;
+	uint32_t image;
+	uint32_t slotStates[CAPTURE_MAX_SLOTS];
+	uint32_t slotRepeats[CAPTURE_MAX_SLOTS];
+	uint32_t imageSlots[GRAPH_MAX_IMAGES];
+	uint32_t nextSlot;
+	uint32_t copyingFirst;
+	uint32_t copyingNumber;
+	uint32_t copyingSlots[CAPTURE_MAX_SLOTS];
+	uint32_t writingFirst;
+	uint32_t writingNumber;
+	uint32_t writingSlots[CAPTURE_MAX_SLOTS];
+	uint64_t frameNumber;
+	uint64_t writtenNumber;
+	uint64_t repeatedNumber;
+	uint64_t skippedNumber;
+	uint64_t droppedNumber;
+	uint32_t droppedRun;
+	int isRunning;
+	int isStarted;
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	pthread_t thread;
+};
+
+static void convertFrame(FrameCapture *pFrameCapture, const uint8_t *pPixels){
+	uint32_t pixelNumber = pFrameCapture->extent.width * pFrameCapture->extent.height;
+	uint32_t red = pFrameCapture->isBgra ? 2 : 0, blue = pFrameCapture->isBgra ? 0 : 2;
+	uint8_t *pOutput = pFrameCapture->pConvertedFrame;
+	if(pFrameCapture->fileFormat == CAPTURE_FORMAT_RAW){
+		for(uint32_t i = 0; i < pixelNumber; i++){
+			pOutput[4 * i] = pPixels[4 * i + red];
+			pOutput[4 * i + 1] = pPixels[4 * i + 1];
+			pOutput[4 * i + 2] = pPixels[4 * i + blue];
+			pOutput[4 * i + 3] = pPixels[4 * i + 3];
+		}
+		return;
+	}
+	// YCbCr BT.601 en plage limitée, trois plans pleine résolution (C444)
+	uint8_t *pLuma = pOutput, *pBlue = &pOutput[pixelNumber], *pRed = &pOutput[2 * pixelNumber];
+	for(uint32_t i = 0; i < pixelNumber; i++){
+		int r = pPixels[4 * i + red], g = pPixels[4 * i + 1], b = pPixels[4 * i + blue];
+		pLuma[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		pBlue[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		pRed[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+}
+
+static uint64_t getCaptureTime(){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static int writeFrame(FrameCapture *pFrameCapture, uint32_t slot, uint32_t repeatNumber){
+	uint32_t pixelNumber = pFrameCapture->extent.width * pFrameCapture->extent.height;
+	size_t frameSize = (pFrameCapture->fileFormat == CAPTURE_FORMAT_Y4M ? 3 : 4) * (size_t)pixelNumber;
+	convertFrame(pFrameCapture, &pFrameCapture->pData[slot * pFrameCapture->slotSize]);
+	// Une image convertie une seule fois est répétée pour chaque période de la vidéo qu'elle couvre
+	for(uint32_t i = 0; i < repeatNumber; i++){
+		if(pFrameCapture->fileFormat == CAPTURE_FORMAT_Y4M && fputs("FRAME\n", pFrameCapture->pFile) == EOF){
+			return -1;
+		}
+		if(fwrite(pFrameCapture->pConvertedFrame, 1, frameSize, pFrameCapture->pFile) != frameSize){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void *runFrameWriter(void *pArg){
+	FrameCapture *pFrameCapture = (FrameCapture *)pArg;
+	int isWriteFailed = 0;
+	TRACE_THREAD("capture writer");
+	pthread_mutex_lock(&pFrameCapture->mutex);
+	while(1){
+		while(pFrameCapture->isRunning && pFrameCapture->writingNumber == 0){
+			pthread_cond_wait(&pFrameCapture->condition, &pFrameCapture->mutex);
+		}
+		// À l'arrêt les images déjà copiées sont écrites avant de quitter
+		if(pFrameCapture->writingNumber == 0){
+			break;
+		}
+		uint32_t slot = pFrameCapture->writingSlots[pFrameCapture->writingFirst];
+		uint32_t repeatNumber = pFrameCapture->slotRepeats[slot];
+		pFrameCapture->writingFirst = (pFrameCapture->writingFirst + 1) % CAPTURE_MAX_SLOTS;
+		pFrameCapture->writingNumber--;
+		pthread_mutex_unlock(&pFrameCapture->mutex);
+
+		// Conversion et écriture sans le verrou, le thread de rendu n'attend jamais le disque
+		TRACE_BEGIN("write frame");
+		int result = isWriteFailed ? -1 : writeFrame(pFrameCapture, slot, repeatNumber);
+		TRACE_END();
+		if(result != 0 && !isWriteFailed){
+			printf("VkCaptureException : unable to write to %s, the next frames are dropped\n", pFrameCapture->fileName);
+			isWriteFailed = 1;
+		}
+
+		pthread_mutex_lock(&pFrameCapture->mutex);
+		if(result == 0){
+			pFrameCapture->writtenNumber++;
+			pFrameCapture->repeatedNumber += repeatNumber - 1;
+		}else{
+			pFrameCapture->droppedNumber++;
+		}
+		pFrameCapture->slotStates[slot] = CAPTURE_SLOT_FREE;
+	}
+	pthread_mutex_unlock(&pFrameCapture->mutex);
+	return VK_NULL_HANDLE;
+}
+
+static void recordFrameCapture(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData){
+	FrameCapture *pFrameCapture = (FrameCapture *)pUserData;
+	uint32_t slot = pFrameCapture->imageSlots[commandBufferIndex];
+	// Aucun emplacement libre pour cette frame, elle est déjà comptée comme perdue
+	if(slot == GRAPH_INVALID_INDEX){
+		return;
+	}
+	GraphResource *pResource = &pFrameCapture->pRenderGraph->resources[pFrameCapture->image];
+	VkImage image = pResource->images[pResource->imageNumber == 1 ? 0 : commandBufferIndex];
+	VkBufferImageCopy bufferImageCopy = {
+		slot * pFrameCapture->slotSize,
+		0,
+		0,
+		{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+		{0, 0, 0},
+		{pFrameCapture->extent.width, pFrameCapture->extent.height, 1}
+	};
+	vkCmdCopyImageToBuffer(*pCommandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pFrameCapture->buffer, 1, &bufferImageCopy);
+
+	// La copie doit être visible de l'hôte une fois la barrière de la frame passée
+	VkBufferMemoryBarrier bufferMemoryBarrier = {
+		VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		VK_NULL_HANDLE,
+		VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_ACCESS_HOST_READ_BIT,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		pFrameCapture->buffer,
+		slot * pFrameCapture->slotSize,
+		pFrameCapture->slotSize
+	};
+	vkCmdPipelineBarrier(*pCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, VK_NULL_HANDLE, 1, &bufferMemoryBarrier, 0, VK_NULL_HANDLE);
+}
+
+FrameCapture *createFrameCapture(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkFormat format, VkExtent2D *pExtent, const char *fileName, uint32_t frameRate, uint32_t slotNumber){
+	VkBool32 isBgra = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+	if(!isBgra && format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_R8G8B8A8_SRGB){
+		printf("VkCaptureException : format %d cannot be captured\n", format);
+		return VK_NULL_HANDLE;
+	}
+	FrameCapture *pFrameCapture = (FrameCapture *)malloc(sizeof(FrameCapture));
+	if(pFrameCapture == VK_NULL_HANDLE){
+		printf("VkCaptureException : unable to allocate the frame capture\n");
+		return VK_NULL_HANDLE;
+	}
+	memset(pFrameCapture, 0, sizeof(FrameCapture));
+	pFrameCapture->device = *pDevice;
+	pFrameCapture->extent = *pExtent;
+	pFrameCapture->isBgra = isBgra;
+	pFrameCapture->fileName = fileName;
+	pFrameCapture->frameRate = frameRate == 0 ? 1 : frameRate;
+	pFrameCapture->slotNumber = slotNumber < 2 ? 2 : slotNumber > CAPTURE_MAX_SLOTS ? CAPTURE_MAX_SLOTS : slotNumber;
+	pFrameCapture->slotSize = 4 * (VkDeviceSize)pExtent->width * pExtent->height;
+	pFrameCapture->image = GRAPH_INVALID_INDEX;
+	for(uint32_t i = 0; i < GRAPH_MAX_IMAGES; i++){
+		pFrameCapture->imageSlots[i] = GRAPH_INVALID_INDEX;
+	}
+	size_t nameLength = strlen(fileName);
+	pFrameCapture->fileFormat = nameLength > 4 && strcmp(&fileName[nameLength - 4], ".y4m") == 0 ? CAPTURE_FORMAT_Y4M : CAPTURE_FORMAT_RAW;
+
+	// Mémoire en cache côté hôte de préférence, la lecture d'une mémoire non cachée est très lente
+	pFrameCapture->buffer = createBuffer(pDevice, pFrameCapture->slotNumber * pFrameCapture->slotSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(*pDevice, pFrameCapture->buffer, &memoryRequirements);
+	VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+	if(getMemoryTypeIndex(pPhysicalDevice, memoryRequirements.memoryTypeBits, memoryProperties) == UINT32_MAX){
+		memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
+	pFrameCapture->memory = allocateBufferMemory(pPhysicalDevice, pDevice, &pFrameCapture->buffer, memoryProperties);
+	pFrameCapture->pConvertedFrame = (uint8_t *)malloc((size_t)pFrameCapture->slotSize);
+	pFrameCapture->pFile = fopen(fileName, "wb");
+	if(pFrameCapture->memory == VK_NULL_HANDLE || pFrameCapture->pConvertedFrame == VK_NULL_HANDLE || pFrameCapture->pFile == VK_NULL_HANDLE){
+		printf("VkCaptureException : unable to prepare the capture to %s\n", fileName);
+		deleteFrameCapture(pDevice, &pFrameCapture);
+		return VK_NULL_HANDLE;
+	}
+	vkMapMemory(*pDevice, pFrameCapture->memory, 0, VK_WHOLE_SIZE, 0, (void **)&pFrameCapture->pData);
+
+	if(pFrameCapture->fileFormat == CAPTURE_FORMAT_Y4M){
+		fprintf(pFrameCapture->pFile, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", pExtent->width, pExtent->height, pFrameCapture->frameRate);
+	}else{
+		printf("frame capture : raw RGBA %ux%u frames at %u fps written to %s\n", pExtent->width, pExtent->height, pFrameCapture->frameRate, fileName);
+	}
+
+	pthread_mutex_init(&pFrameCapture->mutex, VK_NULL_HANDLE);
+	pthread_cond_init(&pFrameCapture->condition, VK_NULL_HANDLE);
+	pFrameCapture->isRunning = 1;
+	if(pthread_create(&pFrameCapture->thread, VK_NULL_HANDLE, runFrameWriter, pFrameCapture) != 0){
+		printf("VkCaptureException : unable to start the writer thread\n");
+		pthread_cond_destroy(&pFrameCapture->condition);
+		pthread_mutex_destroy(&pFrameCapture->mutex);
+		pFrameCapture->isRunning = 0;
+		deleteFrameCapture(pDevice, &pFrameCapture);
+		return VK_NULL_HANDLE;
+	}
+	pFrameCapture->isStarted = 1;
+	return pFrameCapture;
+}
+
+void deleteFrameCapture(VkDevice *pDevice, FrameCapture **ppFrameCapture){
+	FrameCapture *pFrameCapture = *ppFrameCapture;
+	if(pFrameCapture->isStarted){
+		pthread_mutex_lock(&pFrameCapture->mutex);
+		// Le GPU est inactif, toutes les copies en cours sont terminées
+		while(pFrameCapture->copyingNumber > 0){
+			pFrameCapture->writingSlots[(pFrameCapture->writingFirst + pFrameCapture->writingNumber++) % CAPTURE_MAX_SLOTS] = pFrameCapture->copyingSlots[pFrameCapture->copyingFirst];
+			pFrameCapture->copyingFirst = (pFrameCapture->copyingFirst + 1) % CAPTURE_MAX_SLOTS;
+			pFrameCapture->copyingNumber--;
+		}
+		pFrameCapture->isRunning = 0;
+		pthread_cond_signal(&pFrameCapture->condition);
+		pthread_mutex_unlock(&pFrameCapture->mutex);
+		pthread_join(pFrameCapture->thread, VK_NULL_HANDLE);
+		pthread_cond_destroy(&pFrameCapture->condition);
+		pthread_mutex_destroy(&pFrameCapture->mutex);
+		printf("frame capture : %llu frames written to %s at %u fps, %llu repeated, %llu skipped, %llu dropped\n",
+		       (unsigned long long)(pFrameCapture->writtenNumber + pFrameCapture->repeatedNumber), pFrameCapture->fileName, pFrameCapture->frameRate,
+		       (unsigned long long)pFrameCapture->repeatedNumber, (unsigned long long)pFrameCapture->skippedNumber, (unsigned long long)pFrameCapture->droppedNumber);
+	}
+	if(pFrameCapture->pFile != VK_NULL_HANDLE){
+		fclose(pFrameCapture->pFile);
+	}
+	if(pFrameCapture->pData != VK_NULL_HANDLE){
+		vkUnmapMemory(*pDevice, pFrameCapture->memory);
+	}
+	freeMemory(pDevice, &pFrameCapture->memory);
+	deleteBuffer(pDevice, &pFrameCapture->buffer);
+	free(pFrameCapture->pConvertedFrame);
+	free(pFrameCapture);
+	*ppFrameCapture = VK_NULL_HANDLE;
+}
+
+uint32_t addFrameCapturePass(FrameCapture *pFrameCapture, RenderGraph *pRenderGraph, uint32_t image){
+	uint32_t readback = importGraphBuffer(pRenderGraph, "capture readback", pFrameCapture->buffer);
+	uint32_t pass = addGraphPass(pRenderGraph, "capture", VK_PIPELINE_BIND_POINT_COMPUTE, recordFrameCapture, pFrameCapture);
+	if(readback == GRAPH_INVALID_INDEX || pass == GRAPH_INVALID_INDEX){
+		return GRAPH_INVALID_INDEX;
+	}
+	// Le buffer n'est lu que par l'hôte, sans cette sortie le graphe supprimerait la passe
+	addGraphOutput(pRenderGraph, readback);
+	addGraphPassUse(pRenderGraph, pass, image, GRAPH_USE_TRANSFER_READ);
+	addGraphPassUse(pRenderGraph, pass, readback, GRAPH_USE_TRANSFER_WRITE);
+	pFrameCapture->pRenderGraph = pRenderGraph;
+	pFrameCapture->image = image;
+	return pass;
+}
+
+void updateFrameCapture(FrameCapture *pFrameCapture, uint32_t imageIndex){
+	pthread_mutex_lock(&pFrameCapture->mutex);
+	// Les soumissions se terminent dans l'ordre : si celle de cette image est finie, les copies plus anciennes aussi
+	uint32_t completedSlot = pFrameCapture->imageSlots[imageIndex];
+	if(completedSlot != GRAPH_INVALID_INDEX){
+		uint32_t slot = GRAPH_INVALID_INDEX;
+		while(pFrameCapture->copyingNumber > 0 && slot != completedSlot){
+			slot = pFrameCapture->copyingSlots[pFrameCapture->copyingFirst];
+			pFrameCapture->copyingFirst = (pFrameCapture->copyingFirst + 1) % CAPTURE_MAX_SLOTS;
+			pFrameCapture->copyingNumber--;
+			pFrameCapture->slotStates[slot] = CAPTURE_SLOT_WRITING;
+			pFrameCapture->writingSlots[(pFrameCapture->writingFirst + pFrameCapture->writingNumber++) % CAPTURE_MAX_SLOTS] = slot;
+		}
+		pthread_cond_signal(&pFrameCapture->condition);
+	}
+
+	// Nombre de périodes de la vidéo commencées depuis la première frame, qui ouvre la période 0
+	uint64_t now = getCaptureTime();
+	if(pFrameCapture->frameNumber == 0){
+		pFrameCapture->startTime = now;
+	}
+	uint64_t dueTicks = (now - pFrameCapture->startTime) * pFrameCapture->frameRate / 1000000000ULL + 1;
+
+	// Une frame qui n'ouvre aucune période n'est pas copiée, le rendu est plus rapide que la vidéo
+	pFrameCapture->imageSlots[imageIndex] = GRAPH_INVALID_INDEX;
+	if(dueTicks <= pFrameCapture->tickNumber){
+		pFrameCapture->frameNumber++;
+		pFrameCapture->skippedNumber++;
+		pthread_mutex_unlock(&pFrameCapture->mutex);
+		return;
+	}
+
+	// Prochain emplacement libre, sinon la frame est perdue plutôt que d'attendre l'écriture
+	// Les périodes d'une frame perdue reviennent à la suivante, qui est répétée d'autant
+	for(uint32_t i = 0; i < pFrameCapture->slotNumber; i++){
+		uint32_t slot = (pFrameCapture->nextSlot + i) % pFrameCapture->slotNumber;
+		if(pFrameCapture->slotStates[slot] == CAPTURE_SLOT_FREE){
+			pFrameCapture->slotStates[slot] = CAPTURE_SLOT_COPYING;
+			pFrameCapture->copyingSlots[(pFrameCapture->copyingFirst + pFrameCapture->copyingNumber++) % CAPTURE_MAX_SLOTS] = slot;
+			pFrameCapture->imageSlots[imageIndex] = slot;
+			pFrameCapture->slotRepeats[slot] = (uint32_t)(dueTicks - pFrameCapture->tickNumber);
+			pFrameCapture->tickNumber = dueTicks;
+			pFrameCapture->nextSlot = (slot + 1) % pFrameCapture->slotNumber;
+			break;
+		}
+	}
+	uint64_t frameNumber = pFrameCapture->frameNumber++;
+	VkBool32 isDropped = pFrameCapture->imageSlots[imageIndex] == GRAPH_INVALID_INDEX;
+	uint32_t droppedRun = pFrameCapture->droppedRun;
+	if(isDropped){
+		pFrameCapture->droppedNumber++;
+		pFrameCapture->droppedRun++;
+	}else{
+		pFrameCapture->droppedRun = 0;
+	}
+	pthread_mutex_unlock(&pFrameCapture->mutex);
+
+	// Une ligne par série de frames perdues
+	if(!isDropped && droppedRun > 0){
+		printf("VkCaptureException : %u frames dropped before frame %llu, the writer thread is behind\n", droppedRun, (unsigned long long)frameNumber);
+	}
+}
@@ -1,20 +1,21 @@
 #include "../Headers/vk_fun.h"
 
 VkCommandPool createCommandPool(VkDevice *pDevice, uint32_t queueFamilyIndex){
+	// Les command buffers peuvent être réenregistrés un par un, quand la résolution du rendu change par exemple
 	VkCommandPoolCreateInfo commandPoolCreateInfo = {
 		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 		VK_NULL_HANDLE,
-		0,
+		VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
 		queueFamilyIndex
 	};
 
 	VkCommandPool commandPool;
-	vkCreateCommandPool(*pDevice, &commandPoolCreateInfo, VK_NULL_HANDLE, &commandPool);
+	vkCreateCommandPool(*pDevice, &commandPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_COMMAND_POOL), &commandPool);
 	return commandPool;
 }
 
 void deleteCommandPool(VkDevice *pDevice, VkCommandPool *pCommandPool){
-	vkDestroyCommandPool(*pDevice, *pCommandPool, VK_NULL_HANDLE);
+	vkDestroyCommandPool(*pDevice, *pCommandPool, getHostAllocator(VK_OBJECT_TYPE_COMMAND_POOL));
 }
 
 VkCommandBuffer *createCommandBuffers(VkDevice *pDevice, VkCommandPool *pCommandPool, uint32_t commandBufferNumber){
@@ -36,9 +37,52 @@ void deleteCommandBuffers(VkDevice *pDevice, VkCommandBuffer **ppCommandBuffers,
 	free(*ppCommandBuffers);
 }
 
-void recordCommandBuffers(VkCommandBuffer **ppCommandBuffers, VkRenderPass *pRenderPass, VkFramebuffer **ppFramebuffers, VkExtent2D *pExtent, VkPipeline *pPipeline, uint32_t commandBufferNumber){
-	VkCommandBufferBeginInfo *commandBufferBeginInfos = (VkCommandBufferBeginInfo *)malloc(commandBufferNumber * sizeof(VkCommandBufferBeginInfo));
-	VkRenderPassBeginInfo *renderPassBeginInfos = (VkRenderPassBeginInfo *)malloc(commandBufferNumber *sizeof(VkRenderPassBeginInfo));
+VkCommandBuffer beginSingleTimeCommands(VkDevice *pDevice, VkCommandPool *pCommandPool){
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		*pCommandPool,
+		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		1
+	};
+
+	VkCommandBuffer commandBuffer;
+	vkAllocateCommandBuffers(*pDevice, &commandBufferAllocateInfo, &commandBuffer);
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		VK_NULL_HANDLE,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		VK_NULL_HANDLE
+	};
+	vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+	return commandBuffer;
+}
+
+void endSingleTimeCommands(VkDevice *pDevice, VkCommandPool *pCommandPool, VkQueue *pQueue, VkCommandBuffer *pCommandBuffer){
+	vkEndCommandBuffer(*pCommandBuffer);
+
+	VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		VK_NULL_HANDLE,
+		0,
+		VK_NULL_HANDLE,
+		VK_NULL_HANDLE,
+		1,
+		pCommandBuffer,
+		0,
+		VK_NULL_HANDLE
+	};
+	vkQueueSubmit(*pQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(*pQueue);
+
+	vkFreeCommandBuffers(*pDevice, *pCommandPool, 1, pCommandBuffer);
+}
+
+void recordCommandBuffers(VkCommandBuffer **ppCommandBuffers, VkRenderPass *pRenderPass, VkFramebuffer **ppFramebuffers, VkExtent2D *pExtent, VkPipeline *pPipeline, uint32_t commandBufferNumber, RecordDrawsCallback recordPrePass, RecordDrawsCallback recordDraws, void *pUserData){
+	size_t scratchMark = getScratchMark();
+	VkCommandBufferBeginInfo *commandBufferBeginInfos = (VkCommandBufferBeginInfo *)allocateScratch(commandBufferNumber * sizeof(VkCommandBufferBeginInfo));
+	VkRenderPassBeginInfo *renderPassBeginInfos = (VkRenderPassBeginInfo *)allocateScratch(commandBufferNumber *sizeof(VkRenderPassBeginInfo));
 	VkRect2D renderArea = {
 		{0, 0},
 		{pExtent->width, pExtent->height}
@@ -60,13 +104,19 @@ void recordCommandBuffers(VkCommandBuffer **ppCommandBuffers, VkRenderPass *pRen
 		renderPassBeginInfos[i].pClearValues = &clearValue;
 
 		vkBeginCommandBuffer((*ppCommandBuffers)[i], &commandBufferBeginInfos[i]);
+		if(recordPrePass != VK_NULL_HANDLE){
+			recordPrePass(&(*ppCommandBuffers)[i], i, pUserData);
+		}
 		vkCmdBeginRenderPass((*ppCommandBuffers)[i], &renderPassBeginInfos[i], VK_SUBPASS_CONTENTS_INLINE);
+		recordViewport(&(*ppCommandBuffers)[i], pExtent);
 		vkCmdBindPipeline((*ppCommandBuffers)[i], VK_PIPELINE_BIND_POINT_GRAPHICS, *pPipeline);
 		vkCmdDraw((*ppCommandBuffers)[i], 3, 1, 0, 0);
+		if(recordDraws != VK_NULL_HANDLE){
+			recordDraws(&(*ppCommandBuffers)[i], i, pUserData);
+		}
 		vkCmdEndRenderPass((*ppCommandBuffers)[i]);
 		vkEndCommandBuffer((*ppCommandBuffers)[i]);
 	}
 
-	free(renderPassBeginInfos);
-	free(commandBufferBeginInfos);
+	resetScratch(scratchMark);
 }
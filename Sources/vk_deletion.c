@@ -0,0 +1,138 @@
+#include "../Headers/vk_fun.h"
+
+static void destroyObject(VkDevice *pDevice, DeletionEntry *pEntry){
+	if(pEntry->callback != VK_NULL_HANDLE){
+		pEntry->callback(pDevice, pEntry->pObject);
+		return;
+	}
+	switch(pEntry->type){
+		case VK_OBJECT_TYPE_BUFFER:
+			vkDestroyBuffer(*pDevice, (VkBuffer)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+			break;
+		case VK_OBJECT_TYPE_IMAGE:
+			vkDestroyImage(*pDevice, (VkImage)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_IMAGE));
+			break;
+		case VK_OBJECT_TYPE_IMAGE_VIEW:
+			vkDestroyImageView(*pDevice, (VkImageView)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+			break;
+		case VK_OBJECT_TYPE_SAMPLER:
+			vkDestroySampler(*pDevice, (VkSampler)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_SAMPLER));
+			break;
+		case VK_OBJECT_TYPE_DEVICE_MEMORY:
+			vkFreeMemory(*pDevice, (VkDeviceMemory)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+			break;
+		case VK_OBJECT_TYPE_PIPELINE:
+			vkDestroyPipeline(*pDevice, (VkPipeline)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+			break;
+		case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+			vkDestroyPipelineLayout(*pDevice, (VkPipelineLayout)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+			break;
+		case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+			vkDestroyDescriptorPool(*pDevice, (VkDescriptorPool)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+			break;
+		case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+			vkDestroyDescriptorSetLayout(*pDevice, (VkDescriptorSetLayout)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+			break;
+		case VK_OBJECT_TYPE_FRAMEBUFFER:
+			vkDestroyFramebuffer(*pDevice, (VkFramebuffer)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_FRAMEBUFFER));
+			break;
+		case VK_OBJECT_TYPE_RENDER_PASS:
+			vkDestroyRenderPass(*pDevice, (VkRenderPass)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_RENDER_PASS));
+			break;
+		case VK_OBJECT_TYPE_SHADER_MODULE:
+			vkDestroyShaderModule(*pDevice, (VkShaderModule)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE));
+			break;
+		case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+			vkDestroySwapchainKHR(*pDevice, (VkSwapchainKHR)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_SWAPCHAIN_KHR));
+			break;
+		case VK_OBJECT_TYPE_QUERY_POOL:
+			vkDestroyQueryPool(*pDevice, (VkQueryPool)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_QUERY_POOL));
+			break;
+		case VK_OBJECT_TYPE_SEMAPHORE:
+			vkDestroySemaphore(*pDevice, (VkSemaphore)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_SEMAPHORE));
+			break;
+		case VK_OBJECT_TYPE_FENCE:
+			vkDestroyFence(*pDevice, (VkFence)pEntry->handle, getHostAllocator(VK_OBJECT_TYPE_FENCE));
+			break;
+		default:
+			printf("VkDeletionException : object type %d cannot be retired\n", (int)pEntry->type);
+			break;
+	}
+}
+
+static void pushDeletionEntry(DeletionQueue *pDeletionQueue, DeletionEntry *pEntry){
+	// File pleine : l'objet est perdu plutôt que détruit sous le GPU ou après une attente du device en pleine frame
+	if(pDeletionQueue->entryNumber == pDeletionQueue->entryCapacity){
+		pDeletionQueue->overflowNumber++;
+		printf("VkDeletionException : deletion queue full with %u objects, object of type %d leaked\n", pDeletionQueue->entryCapacity, (int)pEntry->type);
+		return;
+	}
+	pDeletionQueue->pEntries[pDeletionQueue->entryNumber++] = *pEntry;
+}
+
+DeletionQueue *createDeletionQueue(VkDevice *pDevice, uint32_t maxFrames){
+	DeletionQueue *pDeletionQueue = (DeletionQueue *)malloc(sizeof(DeletionQueue));
+	if(pDeletionQueue == VK_NULL_HANDLE){
+		printf("VkDeletionException : unable to allocate the deletion queue\n");
+		return VK_NULL_HANDLE;
+	}
+	memset(pDeletionQueue, 0, sizeof(DeletionQueue));
+	// Une entrée vit au plus le temps des frames en vol et de celle en préparation, la file ne grandit jamais ensuite
+	pDeletionQueue->entryCapacity = (maxFrames + 1) * DELETION_MAX_FRAME_ENTRIES;
+	pDeletionQueue->pEntries = (DeletionEntry *)malloc(pDeletionQueue->entryCapacity * sizeof(DeletionEntry));
+	if(pDeletionQueue->pEntries == VK_NULL_HANDLE){
+		printf("VkDeletionException : unable to allocate %u deletion entries\n", pDeletionQueue->entryCapacity);
+		free(pDeletionQueue);
+		return VK_NULL_HANDLE;
+	}
+	pDeletionQueue->device = *pDevice;
+	// Le numéro 0 est réservé aux soumissions qui n'ont jamais eu lieu
+	pDeletionQueue->submitSerial = 1;
+	return pDeletionQueue;
+}
+
+void deleteDeletionQueue(VkDevice *pDevice, DeletionQueue **ppDeletionQueue){
+	DeletionQueue *pDeletionQueue = *ppDeletionQueue;
+	for(uint32_t i = 0; i < pDeletionQueue->entryNumber; i++){
+		destroyObject(pDevice, &pDeletionQueue->pEntries[i]);
+	}
+	if(pDeletionQueue->overflowNumber != 0){
+		printf("VkDeletionException : %u objects leaked, raise DELETION_MAX_FRAME_ENTRIES\n", pDeletionQueue->overflowNumber);
+	}
+	free(pDeletionQueue->pEntries);
+	free(pDeletionQueue);
+	*ppDeletionQueue = VK_NULL_HANDLE;
+}
+
+void retireObject(DeletionQueue *pDeletionQueue, VkObjectType type, uint64_t handle){
+	if(handle == 0){
+		return;
+	}
+	DeletionEntry entry = {pDeletionQueue->submitSerial, type, handle, VK_NULL_HANDLE, VK_NULL_HANDLE};
+	pushDeletionEntry(pDeletionQueue, &entry);
+}
+
+void retireCallback(DeletionQueue *pDeletionQueue, DeleteCallback callback, void *pObject){
+	DeletionEntry entry = {pDeletionQueue->submitSerial, VK_OBJECT_TYPE_UNKNOWN, 0, callback, pObject};
+	pushDeletionEntry(pDeletionQueue, &entry);
+}
+
+uint64_t advanceDeletionQueue(DeletionQueue *pDeletionQueue){
+	return pDeletionQueue->submitSerial++;
+}
+
+void collectDeletionQueue(DeletionQueue *pDeletionQueue, uint64_t completedSerial){
+	if(completedSerial > pDeletionQueue->completedSerial){
+		pDeletionQueue->completedSerial = completedSerial;
+	}
+	// Les entrées sont ajoutées avec des numéros croissants, seules celles du début peuvent être terminées
+	uint32_t doneNumber = 0;
+	while(doneNumber < pDeletionQueue->entryNumber && pDeletionQueue->pEntries[doneNumber].serial <= pDeletionQueue->completedSerial){
+		destroyObject(&pDeletionQueue->device, &pDeletionQueue->pEntries[doneNumber]);
+		doneNumber++;
+	}
+	if(doneNumber > 0){
+		pDeletionQueue->entryNumber -= doneNumber;
+		memmove(pDeletionQueue->pEntries, &pDeletionQueue->pEntries[doneNumber], pDeletionQueue->entryNumber * sizeof(DeletionEntry));
+	}
+}
@@ -1,11 +1,12 @@
 #include "../Headers/vk_fun.h"
 
 VkDevice createDevice(VkPhysicalDevice *pPhysicalDevice, uint32_t queueFamilyNumber, VkQueueFamilyProperties *pQueueFamilyProperties){
-	VkDeviceQueueCreateInfo *deviceQueueCreateInfo = (VkDeviceQueueCreateInfo *)malloc(queueFamilyNumber * sizeof(VkDeviceQueueCreateInfo));
-	float **queuePriorities = (float **)malloc(queueFamilyNumber * sizeof(float *));
+	size_t scratchMark = getScratchMark();
+	VkDeviceQueueCreateInfo *deviceQueueCreateInfo = (VkDeviceQueueCreateInfo *)allocateScratch(queueFamilyNumber * sizeof(VkDeviceQueueCreateInfo));
+	float **queuePriorities = (float **)allocateScratch(queueFamilyNumber * sizeof(float *));
 
 	for(uint32_t i = 0; i < queueFamilyNumber; i++){
-		queuePriorities[i] = (float *)malloc(pQueueFamilyProperties[i].queueCount * sizeof(float));
+		queuePriorities[i] = (float *)allocateScratch(pQueueFamilyProperties[i].queueCount * sizeof(float));
 		for(uint32_t j = 0; j < pQueueFamilyProperties[i].queueCount; j++){
 			queuePriorities[i][j] = 1.0f;
 		}
@@ -18,39 +19,108 @@ VkDevice createDevice(VkPhysicalDevice *pPhysicalDevice, uint32_t queueFamilyNum
 		deviceQueueCreateInfo[i].pQueuePriorities = queuePriorities[i];
 	}
 
-	const char extensionList[][VK_MAX_EXTENSION_NAME_SIZE] = {
-		"VK_KHR_swapchain"
-	};
-	const char *extensions[] = {
-		extensionList[0]
-	};
+	const char *extensions[12];
+	uint32_t extensionNumber = 0;
+	extensions[extensionNumber++] = "VK_KHR_swapchain";
 	VkPhysicalDeviceFeatures physicalDeviceFeatures;
 	vkGetPhysicalDeviceFeatures(*pPhysicalDevice, &physicalDeviceFeatures);
 
+	// Les extensions optionnelles ne sont activées que si le physical device les supporte
+	void *pNext = VK_NULL_HANDLE;
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+		VK_NULL_HANDLE,
+		VK_TRUE
+	};
+	if(getSynchronization2Support(pPhysicalDevice)){
+		extensions[extensionNumber++] = VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME;
+		synchronization2Features.pNext = pNext;
+		pNext = &synchronization2Features;
+	}
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+		VK_NULL_HANDLE,
+		VK_TRUE
+	};
+	if(getGraphicsPipelineLibrarySupport(pPhysicalDevice)){
+		extensions[extensionNumber++] = VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME;
+		extensions[extensionNumber++] = VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME;
+		graphicsPipelineLibraryFeatures.pNext = pNext;
+		pNext = &graphicsPipelineLibraryFeatures;
+	}
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+		VK_NULL_HANDLE,
+		VK_TRUE
+	};
+	if(getTimelineSemaphoreSupport(pPhysicalDevice)){
+		extensions[extensionNumber++] = VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME;
+		timelineSemaphoreFeatures.pNext = pNext;
+		pNext = &timelineSemaphoreFeatures;
+	}
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures;
+	memset(&descriptorIndexingFeatures, 0, sizeof(VkPhysicalDeviceDescriptorIndexingFeaturesEXT));
+	descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+	if(getDescriptorIndexingSupport(pPhysicalDevice)){
+		extensions[extensionNumber++] = VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME;
+		descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		descriptorIndexingFeatures.pNext = pNext;
+		pNext = &descriptorIndexingFeatures;
+	}
+	if(getDrawIndirectCountSupport(pPhysicalDevice)){
+		extensions[extensionNumber++] = VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+	}
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+		VK_NULL_HANDLE,
+		VK_TRUE
+	};
+	if(getDynamicRenderingSupport(pPhysicalDevice)){
+		extensions[extensionNumber++] = VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME;
+		extensions[extensionNumber++] = VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME;
+		extensions[extensionNumber++] = VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME;
+		dynamicRenderingFeatures.pNext = pNext;
+		pNext = &dynamicRenderingFeatures;
+	}
+	// Les shaders de la scène lisent gl_ViewIndex, la fonctionnalité est activée même sans écran partagé
+	VkPhysicalDeviceMultiviewFeatures multiviewFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES,
+		VK_NULL_HANDLE,
+		VK_TRUE,
+		VK_FALSE,
+		VK_FALSE
+	};
+	if(getMultiviewSupport(pPhysicalDevice)){
+		multiviewFeatures.pNext = pNext;
+		pNext = &multiviewFeatures;
+	}
+
 	VkDeviceCreateInfo deviceCreateInfo = {
 		VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-		VK_NULL_HANDLE,
+		pNext,
 		0,
 		queueFamilyNumber,
 		deviceQueueCreateInfo,
 		0,
 		VK_NULL_HANDLE,
-		1,
+		extensionNumber,
 		extensions,
 		&physicalDeviceFeatures
 	};
 
 	VkDevice device;
-	vkCreateDevice(*pPhysicalDevice, &deviceCreateInfo, VK_NULL_HANDLE, &device);
+	vkCreateDevice(*pPhysicalDevice, &deviceCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DEVICE), &device);
 
-	for(uint32_t i = 0; i < queueFamilyNumber; i++){
-		free(queuePriorities[i]);
-	}
-	free(queuePriorities);
-	free(deviceQueueCreateInfo);
+	// Les priorités et les create infos sont rendues d'un coup à l'arène
+	resetScratch(scratchMark);
 	return device;
 }
 
 void deleteDevice(VkDevice *pDevice){
-	vkDestroyDevice(*pDevice, VK_NULL_HANDLE);
+	vkDestroyDevice(*pDevice, getHostAllocator(VK_OBJECT_TYPE_DEVICE));
 }
@@ -1,6 +1,6 @@
 #include "../Headers/vk_fun.h"
 
-VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat){
+VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat, uint32_t viewMask){
 	VkAttachmentDescription attachmentDescription = {
 		0,
 		pFormat->format,
@@ -41,9 +41,21 @@ VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat){
 		0
 	};
 
+	// Avec multiview chaque draw est diffusé à toutes les vues du masque, les pipelines doivent être créés avec le même masque
+	VkRenderPassMultiviewCreateInfo renderPassMultiviewCreateInfo = {
+		VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO,
+		VK_NULL_HANDLE,
+		1,
+		&viewMask,
+		0,
+		VK_NULL_HANDLE,
+		1,
+		&viewMask
+	};
+
 	VkRenderPassCreateInfo renderPassCreateInfo = {
 		VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-		VK_NULL_HANDLE,
+		viewMask != 0 ? &renderPassMultiviewCreateInfo : VK_NULL_HANDLE,
 		0,
 		1,
 		&attachmentDescription,
@@ -54,16 +66,51 @@ VkRenderPass createRenderPass(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat){
 	};
 
 	VkRenderPass renderPass;
-	vkCreateRenderPass(*pDevice, &renderPassCreateInfo, VK_NULL_HANDLE, &renderPass);
+	vkCreateRenderPass(*pDevice, &renderPassCreateInfo, getHostAllocator(VK_OBJECT_TYPE_RENDER_PASS), &renderPass);
 	return renderPass;
 }
 
 void deleteRenderPass(VkDevice *pDevice, VkRenderPass *pRenderPass){
-	vkDestroyRenderPass(*pDevice, *pRenderPass, VK_NULL_HANDLE);
+	vkDestroyRenderPass(*pDevice, *pRenderPass, getHostAllocator(VK_OBJECT_TYPE_RENDER_PASS));
+}
+
+RenderTarget createRenderTarget(VkDevice *pDevice, VkSurfaceFormatKHR *pFormat, uint32_t viewMask, VkBool32 dynamicRendering){
+	RenderTarget renderTarget = {
+		VK_NULL_HANDLE,
+		pFormat->format,
+		viewMask
+	};
+	// Sans l'extension, la render pass ne sert qu'à la compatibilité des pipelines, le graphe crée les siennes
+	if(!dynamicRendering){
+		renderTarget.renderPass = createRenderPass(pDevice, pFormat, viewMask);
+	}
+	return renderTarget;
+}
+
+void deleteRenderTarget(VkDevice *pDevice, RenderTarget *pRenderTarget){
+	if(pRenderTarget->renderPass != VK_NULL_HANDLE){
+		deleteRenderPass(pDevice, &pRenderTarget->renderPass);
+		pRenderTarget->renderPass = VK_NULL_HANDLE;
+	}
+}
+
+const void *chainRenderingCreateInfo(RenderTarget *pRenderTarget, VkPipelineRenderingCreateInfoKHR *pRenderingCreateInfo, const void *pNext){
+	if(pRenderTarget->renderPass != VK_NULL_HANDLE){
+		return pNext;
+	}
+	pRenderingCreateInfo->sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+	pRenderingCreateInfo->pNext = pNext;
+	pRenderingCreateInfo->viewMask = pRenderTarget->viewMask;
+	pRenderingCreateInfo->colorAttachmentCount = 1;
+	pRenderingCreateInfo->pColorAttachmentFormats = &pRenderTarget->colorFormat;
+	pRenderingCreateInfo->depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+	pRenderingCreateInfo->stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+	return pRenderingCreateInfo;
 }
 
 VkFramebuffer *createFramebuffers(VkDevice *pDevice, VkRenderPass *pRenderPass, VkExtent2D *pExtent, VkImageView **ppImageViews, uint32_t imageViewNumber){
-	VkFramebufferCreateInfo *framebufferCreateInfo = (VkFramebufferCreateInfo *)malloc(imageViewNumber * sizeof(VkFramebufferCreateInfo));
+	size_t scratchMark = getScratchMark();
+	VkFramebufferCreateInfo *framebufferCreateInfo = (VkFramebufferCreateInfo *)allocateScratch(imageViewNumber * sizeof(VkFramebufferCreateInfo));
 	VkFramebuffer *framebuffers = (VkFramebuffer *)malloc(imageViewNumber * sizeof(VkFramebuffer));
 
 	for(uint32_t i = 0; i < imageViewNumber; i++){
@@ -77,16 +124,16 @@ VkFramebuffer *createFramebuffers(VkDevice *pDevice, VkRenderPass *pRenderPass,
 		framebufferCreateInfo[i].height = pExtent->height;
 		framebufferCreateInfo[i].layers = 1;
 
-		vkCreateFramebuffer(*pDevice, &framebufferCreateInfo[i], VK_NULL_HANDLE, &framebuffers[i]);
+		vkCreateFramebuffer(*pDevice, &framebufferCreateInfo[i], getHostAllocator(VK_OBJECT_TYPE_FRAMEBUFFER), &framebuffers[i]);
 	}
 
-	free(framebufferCreateInfo);
+	resetScratch(scratchMark);
 	return framebuffers;
 }
 
 void deleteFramebuffers(VkDevice *pDevice, VkFramebuffer **ppFramebuffers, uint32_t framebufferNumber){
 	for(uint32_t i = 0; i < framebufferNumber; i++){
-		vkDestroyFramebuffer(*pDevice, (*ppFramebuffers)[i], VK_NULL_HANDLE);
+		vkDestroyFramebuffer(*pDevice, (*ppFramebuffers)[i], getHostAllocator(VK_OBJECT_TYPE_FRAMEBUFFER));
 	}
 	free(*ppFramebuffers);
 }
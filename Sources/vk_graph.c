@@ -0,0 +1,920 @@
+#include "../Headers/graph_fun.h"
+
+/**
+ * Stage, accès et layout de chaque usage, les bits historiques ont la même valeur en synchronization2
+ */
+typedef struct GraphUseInfo {
+	VkPipelineStageFlags2KHR stages;
+	VkAccessFlags2KHR access;
+	VkImageLayout layout;
+	VkBool32 isWrite;
+	VkImageUsageFlags imageUsage;
+} GraphUseInfo;
+
+static const GraphUseInfo graphUseInfos[GRAPH_USE_NUMBER] = {
+	{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_TRUE, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT},
+	{VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_FALSE, VK_IMAGE_USAGE_SAMPLED_BIT},
+	{VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_FALSE, VK_IMAGE_USAGE_SAMPLED_BIT},
+	{VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_FALSE, VK_IMAGE_USAGE_STORAGE_BIT},
+	{VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_TRUE, VK_IMAGE_USAGE_STORAGE_BIT},
+	{VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_FALSE, VK_IMAGE_USAGE_STORAGE_BIT},
+	{VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_FALSE, 0},
+	{VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_FALSE, VK_IMAGE_USAGE_TRANSFER_SRC_BIT},
+	{VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_TRUE, VK_IMAGE_USAGE_TRANSFER_DST_BIT}
+};
+
+RenderGraph *createRenderGraph(VkDevice *pDevice, VkBool32 synchronization2, VkBool32 dynamicRendering){
+	RenderGraph *pRenderGraph = (RenderGraph *)malloc(sizeof(RenderGraph));
+	if(pRenderGraph == VK_NULL_HANDLE){
+		printf("VkGraphException : unable to allocate the render graph\n");
+		return VK_NULL_HANDLE;
+	}
+	memset(pRenderGraph, 0, sizeof(RenderGraph));
+	pRenderGraph->device = *pDevice;
+
+	// Sans l'extension on retombe sur vkCmdPipelineBarrier, les masques sont compatibles
+	if(synchronization2){
+		pRenderGraph->cmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(*pDevice, "vkCmdPipelineBarrier2KHR");
+	}
+	pRenderGraph->synchronization2 = pRenderGraph->cmdPipelineBarrier2 != VK_NULL_HANDLE;
+	// Sans l'extension chaque passe graphique a sa render pass et un framebuffer par image
+	if(dynamicRendering){
+		pRenderGraph->cmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(*pDevice, "vkCmdBeginRenderingKHR");
+		pRenderGraph->cmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(*pDevice, "vkCmdEndRenderingKHR");
+	}
+	pRenderGraph->dynamicRendering = pRenderGraph->cmdBeginRendering != VK_NULL_HANDLE && pRenderGraph->cmdEndRendering != VK_NULL_HANDLE;
+	if(dynamicRendering && !pRenderGraph->dynamicRendering){
+		printf("VkGraphException : vkCmdBeginRenderingKHR not found, the graphics passes need render passes\n");
+	}
+	return pRenderGraph;
+}
+
+void deleteRenderGraph(VkDevice *pDevice, RenderGraph **ppRenderGraph){
+	RenderGraph *pRenderGraph = *ppRenderGraph;
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		for(uint32_t j = 0; j < pPass->framebufferNumber; j++){
+			vkDestroyFramebuffer(*pDevice, pPass->framebuffers[j], getHostAllocator(VK_OBJECT_TYPE_FRAMEBUFFER));
+		}
+		vkDestroyRenderPass(*pDevice, pPass->renderPass, getHostAllocator(VK_OBJECT_TYPE_RENDER_PASS));
+	}
+	for(uint32_t i = 0; i < pRenderGraph->resourceNumber; i++){
+		GraphResource *pResource = &pRenderGraph->resources[i];
+		if(pResource->isTransient){
+			vkDestroyImageView(*pDevice, pResource->imageViews[0], getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+			vkDestroyImage(*pDevice, pResource->images[0], getHostAllocator(VK_OBJECT_TYPE_IMAGE));
+		}
+	}
+	for(uint32_t i = 0; i < pRenderGraph->memoryBlockNumber; i++){
+		vkFreeMemory(*pDevice, pRenderGraph->memoryBlocks[i], getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	}
+	vkDestroyQueryPool(*pDevice, pRenderGraph->queryPool, getHostAllocator(VK_OBJECT_TYPE_QUERY_POOL));
+	free(pRenderGraph);
+	*ppRenderGraph = VK_NULL_HANDLE;
+}
+
+static uint32_t addGraphResource(RenderGraph *pRenderGraph, const char *name){
+	if(pRenderGraph->isCompiled || pRenderGraph->resourceNumber >= GRAPH_MAX_RESOURCES){
+		printf("VkGraphException : unable to add resource %s\n", name);
+		return GRAPH_INVALID_INDEX;
+	}
+	GraphResource *pResource = &pRenderGraph->resources[pRenderGraph->resourceNumber];
+	memset(pResource, 0, sizeof(GraphResource));
+	pResource->name = name;
+	pResource->firstPass = GRAPH_INVALID_INDEX;
+	pResource->lastPass = GRAPH_INVALID_INDEX;
+	pResource->memoryBlock = GRAPH_INVALID_INDEX;
+	pResource->aliasPredecessor = GRAPH_INVALID_INDEX;
+	return pRenderGraph->resourceNumber++;
+}
+
+uint32_t importGraphImage(RenderGraph *pRenderGraph, const char *name, VkFormat format, VkExtent2D *pExtent, VkImage *pImages, VkImageView *pImageViews, uint32_t imageNumber, VkImageLayout initialLayout, VkImageLayout finalLayout){
+	if(imageNumber == 0 || imageNumber > GRAPH_MAX_IMAGES){
+		printf("VkGraphException : %s imports %u images, at most %u are supported\n", name, imageNumber, GRAPH_MAX_IMAGES);
+		return GRAPH_INVALID_INDEX;
+	}
+	uint32_t index = addGraphResource(pRenderGraph, name);
+	if(index == GRAPH_INVALID_INDEX){
+		return index;
+	}
+
+	GraphResource *pResource = &pRenderGraph->resources[index];
+	pResource->isImage = VK_TRUE;
+	pResource->format = format;
+	pResource->extent = *pExtent;
+	pResource->layerNumber = 1;
+	pResource->initialLayout = initialLayout;
+	pResource->finalLayout = finalLayout;
+	pResource->imageNumber = imageNumber;
+	for(uint32_t i = 0; i < imageNumber; i++){
+		pResource->images[i] = pImages[i];
+		pResource->imageViews[i] = pImageViews[i];
+	}
+	return index;
+}
+
+uint32_t importGraphBuffer(RenderGraph *pRenderGraph, const char *name, VkBuffer buffer){
+	uint32_t index = addGraphResource(pRenderGraph, name);
+	if(index != GRAPH_INVALID_INDEX){
+		pRenderGraph->resources[index].buffer = buffer;
+	}
+	return index;
+}
+
+void addGraphOutput(RenderGraph *pRenderGraph, uint32_t resource){
+	if(resource < pRenderGraph->resourceNumber){
+		pRenderGraph->resources[resource].isOutput = VK_TRUE;
+	}
+}
+
+uint32_t createGraphImage(RenderGraph *pRenderGraph, const char *name, VkFormat format, VkExtent2D *pExtent, uint32_t layerNumber){
+	uint32_t index = addGraphResource(pRenderGraph, name);
+	if(index == GRAPH_INVALID_INDEX){
+		return index;
+	}
+
+	GraphResource *pResource = &pRenderGraph->resources[index];
+	pResource->isImage = VK_TRUE;
+	pResource->isTransient = VK_TRUE;
+	pResource->format = format;
+	pResource->extent = *pExtent;
+	pResource->layerNumber = layerNumber != 0 ? layerNumber : 1;
+	pResource->imageNumber = 1;
+	return index;
+}
+
+uint32_t addGraphPass(RenderGraph *pRenderGraph, const char *name, VkPipelineBindPoint bindPoint, RecordDrawsCallback record, void *pUserData){
+	if(pRenderGraph->isCompiled || pRenderGraph->passNumber >= GRAPH_MAX_PASSES){
+		printf("VkGraphException : unable to add pass %s\n", name);
+		return GRAPH_INVALID_INDEX;
+	}
+	GraphPass *pPass = &pRenderGraph->passes[pRenderGraph->passNumber];
+	memset(pPass, 0, sizeof(GraphPass));
+	pPass->name = name;
+	pPass->bindPoint = bindPoint;
+	pPass->record = record;
+	pPass->pUserData = pUserData;
+	return pRenderGraph->passNumber++;
+}
+
+void setGraphPassViewMask(RenderGraph *pRenderGraph, uint32_t pass, uint32_t viewMask){
+	if(pRenderGraph->isCompiled || pass >= pRenderGraph->passNumber || pRenderGraph->passes[pass].bindPoint != VK_PIPELINE_BIND_POINT_GRAPHICS){
+		printf("VkGraphException : unable to set the view mask of pass %u\n", pass);
+		return;
+	}
+	pRenderGraph->passes[pass].viewMask = viewMask;
+}
+
+static GraphPassUse *appendGraphPassUse(RenderGraph *pRenderGraph, uint32_t pass, uint32_t resource, GraphUse use){
+	if(pass >= pRenderGraph->passNumber || resource >= pRenderGraph->resourceNumber || pRenderGraph->passes[pass].useNumber >= GRAPH_MAX_PASS_USES){
+		printf("VkGraphException : invalid use of resource %u by pass %u\n", resource, pass);
+		return VK_NULL_HANDLE;
+	}
+	GraphPassUse *pUse = &pRenderGraph->passes[pass].uses[pRenderGraph->passes[pass].useNumber++];
+	memset(pUse, 0, sizeof(GraphPassUse));
+	pUse->resource = resource;
+	pUse->use = use;
+	pUse->loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	return pUse;
+}
+
+void addGraphPassUse(RenderGraph *pRenderGraph, uint32_t pass, uint32_t resource, GraphUse use){
+	appendGraphPassUse(pRenderGraph, pass, resource, use);
+}
+
+void addGraphColorAttachment(RenderGraph *pRenderGraph, uint32_t pass, uint32_t resource, VkAttachmentLoadOp loadOp, VkClearValue *pClearValue){
+	GraphPassUse *pUse = appendGraphPassUse(pRenderGraph, pass, resource, GRAPH_USE_COLOR_ATTACHMENT);
+	if(pUse != VK_NULL_HANDLE){
+		pUse->loadOp = loadOp;
+		if(pClearValue != VK_NULL_HANDLE){
+			pUse->clearValue = *pClearValue;
+		}
+	}
+}
+
+static VkBool32 readsPreviousContent(GraphPassUse *pUse){
+	return !graphUseInfos[pUse->use].isWrite || pUse->use == GRAPH_USE_COMPUTE_STORAGE_WRITE
+		|| (pUse->use == GRAPH_USE_COLOR_ATTACHMENT && pUse->loadOp == VK_ATTACHMENT_LOAD_OP_LOAD);
+}
+
+static void cullGraphPasses(RenderGraph *pRenderGraph){
+	// Les sorties du graphe sont les images importées avec un layout final et les ressources marquées comme telles
+	for(uint32_t i = 0; i < pRenderGraph->resourceNumber; i++){
+		GraphResource *pResource = &pRenderGraph->resources[i];
+		pResource->isNeeded = pResource->isOutput || (pResource->isImage && !pResource->isTransient && pResource->finalLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+	}
+
+	// Parcours à rebours : une passe est gardée si elle écrit une ressource lue plus tard
+	for(uint32_t i = pRenderGraph->passNumber; i-- > 0;){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		pPass->isCulled = VK_TRUE;
+		for(uint32_t j = 0; j < pPass->useNumber; j++){
+			if(graphUseInfos[pPass->uses[j].use].isWrite && pRenderGraph->resources[pPass->uses[j].resource].isNeeded){
+				pPass->isCulled = VK_FALSE;
+			}
+		}
+		if(pPass->isCulled){
+			continue;
+		}
+		for(uint32_t j = 0; j < pPass->useNumber; j++){
+			if(readsPreviousContent(&pPass->uses[j])){
+				pRenderGraph->resources[pPass->uses[j].resource].isNeeded = VK_TRUE;
+			}
+		}
+	}
+
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		if(pPass->isCulled){
+			continue;
+		}
+		for(uint32_t j = 0; j < pPass->useNumber; j++){
+			GraphResource *pResource = &pRenderGraph->resources[pPass->uses[j].resource];
+			if(pResource->firstPass == GRAPH_INVALID_INDEX){
+				pResource->firstPass = i;
+			}
+			pResource->lastPass = i;
+			pResource->usage |= graphUseInfos[pPass->uses[j].use].imageUsage;
+		}
+	}
+}
+
+static VkBool32 overlapsGraphLifetime(GraphResource *pFirst, GraphResource *pSecond){
+	return !(pFirst->lastPass < pSecond->firstPass || pSecond->lastPass < pFirst->firstPass);
+}
+
+static int allocateGraphImages(VkPhysicalDevice *pPhysicalDevice, RenderGraph *pRenderGraph){
+	VkDevice *pDevice = &pRenderGraph->device;
+	VkMemoryRequirements memoryRequirements[GRAPH_MAX_RESOURCES];
+	uint32_t order[GRAPH_MAX_RESOURCES], transientNumber = 0;
+
+	for(uint32_t i = 0; i < pRenderGraph->resourceNumber; i++){
+		GraphResource *pResource = &pRenderGraph->resources[i];
+		if(!pResource->isTransient || pResource->firstPass == GRAPH_INVALID_INDEX){
+			continue;
+		}
+		// Une image qui n'est qu'attachement peut rester en mémoire de tuile et n'être jamais allouée
+		if((pResource->usage & ~(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT)) == 0){
+			pResource->usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		}
+		pResource->images[0] = createImage(pDevice, pResource->format, &pResource->extent, pResource->usage, pResource->layerNumber);
+		vkGetImageMemoryRequirements(*pDevice, pResource->images[0], &memoryRequirements[i]);
+		order[transientNumber++] = i;
+	}
+
+	// Les plus grosses images d'abord, chacune rejoint le premier bloc dont les occupants ne vivent pas en même temps
+	for(uint32_t i = 1; i < transientNumber; i++){
+		for(uint32_t j = i; j > 0 && memoryRequirements[order[j]].size > memoryRequirements[order[j - 1]].size; j--){
+			uint32_t swap = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = swap;
+		}
+	}
+	for(uint32_t i = 0; i < transientNumber; i++){
+		GraphResource *pResource = &pRenderGraph->resources[order[i]];
+		VkMemoryRequirements *pRequirements = &memoryRequirements[order[i]];
+		for(uint32_t block = 0; block < pRenderGraph->memoryBlockNumber && pResource->memoryBlock == GRAPH_INVALID_INDEX; block++){
+			if((pRequirements->memoryTypeBits & (1u << pRenderGraph->memoryBlockTypes[block])) == 0){
+				continue;
+			}
+			VkBool32 isFree = VK_TRUE;
+			for(uint32_t j = 0; j < i; j++){
+				GraphResource *pOccupant = &pRenderGraph->resources[order[j]];
+				if(pOccupant->memoryBlock == block && overlapsGraphLifetime(pResource, pOccupant)){
+					isFree = VK_FALSE;
+				}
+			}
+			if(isFree){
+				pResource->memoryBlock = block;
+				if(pRenderGraph->memoryBlockSizes[block] < pRequirements->size){
+					pRenderGraph->memoryBlockSizes[block] = pRequirements->size;
+				}
+			}
+		}
+		if(pResource->memoryBlock == GRAPH_INVALID_INDEX){
+			uint32_t memoryTypeIndex = UINT32_MAX;
+			if(pResource->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT){
+				memoryTypeIndex = getMemoryTypeIndex(pPhysicalDevice, pRequirements->memoryTypeBits, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+			}
+			pRenderGraph->memoryBlockLazy[pRenderGraph->memoryBlockNumber] = memoryTypeIndex != UINT32_MAX;
+			if(memoryTypeIndex == UINT32_MAX){
+				memoryTypeIndex = getMemoryTypeIndex(pPhysicalDevice, pRequirements->memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			}
+			if(memoryTypeIndex == UINT32_MAX){
+				printf("VkGraphException : no device local memory for %s\n", pResource->name);
+				return -1;
+			}
+			pResource->memoryBlock = pRenderGraph->memoryBlockNumber;
+			pRenderGraph->memoryBlockTypes[pRenderGraph->memoryBlockNumber] = memoryTypeIndex;
+			pRenderGraph->memoryBlockSizes[pRenderGraph->memoryBlockNumber] = pRequirements->size;
+			pRenderGraph->memoryBlockNumber++;
+		}
+	}
+
+	for(uint32_t block = 0; block < pRenderGraph->memoryBlockNumber; block++){
+		VkMemoryAllocateInfo memoryAllocateInfo = {
+			VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			VK_NULL_HANDLE,
+			pRenderGraph->memoryBlockSizes[block],
+			pRenderGraph->memoryBlockTypes[block]
+		};
+		if(vkAllocateMemory(*pDevice, &memoryAllocateInfo, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY), &pRenderGraph->memoryBlocks[block]) != VK_SUCCESS){
+			printf("VkGraphException : unable to allocate %llu bytes of transient memory\n", (unsigned long long)pRenderGraph->memoryBlockSizes[block]);
+			return -1;
+		}
+	}
+
+	for(uint32_t i = 0; i < transientNumber; i++){
+		GraphResource *pResource = &pRenderGraph->resources[order[i]];
+		vkBindImageMemory(*pDevice, pResource->images[0], pRenderGraph->memoryBlocks[pResource->memoryBlock], 0);
+		pResource->imageViews[0] = createImageView(pDevice, &pResource->images[0], pResource->format, pResource->layerNumber);
+
+		// Le prédécesseur est le dernier occupant du bloc avant nous, ou le dernier de la frame précédente
+		uint32_t predecessor = GRAPH_INVALID_INDEX, lastOccupant = order[i];
+		for(uint32_t j = 0; j < transientNumber; j++){
+			GraphResource *pOccupant = &pRenderGraph->resources[order[j]];
+			if(pOccupant->memoryBlock != pResource->memoryBlock){
+				continue;
+			}
+			if(pOccupant->lastPass < pResource->firstPass && (predecessor == GRAPH_INVALID_INDEX || pOccupant->lastPass > pRenderGraph->resources[predecessor].lastPass)){
+				predecessor = order[j];
+			}
+			if(pOccupant->lastPass > pRenderGraph->resources[lastOccupant].lastPass){
+				lastOccupant = order[j];
+			}
+		}
+		pResource->aliasPredecessor = predecessor != GRAPH_INVALID_INDEX ? predecessor : lastOccupant;
+	}
+	return 0;
+}
+
+static void startGraphResource(RenderGraph *pRenderGraph, uint32_t resource){
+	GraphResource *pResource = &pRenderGraph->resources[resource];
+	GraphResourceState *pState = &pResource->state;
+
+	if(pResource->isTransient){
+		// Image transitoire : attendre le dernier usage de la mémoire qu'elle partage, son contenu est perdu
+		GraphResource *pPredecessor = &pRenderGraph->resources[pResource->aliasPredecessor];
+		GraphResourceState *pPrevious = pPredecessor->firstPass < pResource->firstPass ? &pPredecessor->state : &pPredecessor->finalState;
+		VkPipelineStageFlags2KHR writeStages = pPrevious->writeStages | pPrevious->readStages;
+		VkAccessFlags2KHR writeAccess = pPrevious->writeAccess;
+		memset(pState, 0, sizeof(GraphResourceState));
+		pState->writeStages = writeStages;
+		pState->writeAccess = writeAccess;
+		pState->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	}else if(pResource->isImage && pResource->initialLayout == VK_IMAGE_LAYOUT_UNDEFINED){
+		// Image de la swapchain : la soumission attend le sémaphore d'acquisition à ce stage
+		memset(pState, 0, sizeof(GraphResourceState));
+		pState->writeStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		pState->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	}else{
+		// Contenu conservé : on repart de l'état de fin de la frame précédente
+		*pState = pResource->finalState;
+		if(pResource->isImage && pState->layout == VK_IMAGE_LAYOUT_UNDEFINED){
+			pState->layout = pResource->initialLayout;
+		}
+	}
+}
+
+static VkBool32 applyGraphUse(GraphResource *pResource, const GraphUseInfo *pInfo, GraphBarrier *pBarrier){
+	GraphResourceState *pState = &pResource->state;
+	VkImageLayout layout = pResource->isImage ? pInfo->layout : VK_IMAGE_LAYOUT_UNDEFINED;
+	VkBool32 isTransition = pResource->isImage && layout != pState->layout;
+
+	pBarrier->oldLayout = pState->layout;
+	pBarrier->newLayout = layout;
+	pBarrier->dstStages = pInfo->stages;
+	pBarrier->dstAccess = pInfo->access;
+
+	if(pInfo->isWrite || isTransition){
+		// Écriture ou transition : attendre l'écriture précédente et toutes les lectures qui l'ont suivie
+		pBarrier->srcStages = pState->writeStages | pState->readStages;
+		pBarrier->srcAccess = pState->writeAccess;
+		pState->writeStages = pInfo->stages;
+		pState->writeAccess = pInfo->isWrite ? pInfo->access : 0;
+		pState->readStages = pInfo->isWrite ? 0 : pInfo->stages;
+		pState->visibleStages = pInfo->stages;
+		pState->visibleAccess = pInfo->access;
+		pState->layout = layout;
+		return pBarrier->srcStages != 0 || isTransition;
+	}
+
+	// Lecture après lecture, ou écriture déjà rendue visible à ce stage : aucune barrière
+	pState->readStages |= pInfo->stages;
+	if(pState->writeStages == 0 || ((pState->visibleStages & pInfo->stages) == pInfo->stages && (pState->visibleAccess & pInfo->access) == pInfo->access)){
+		return VK_FALSE;
+	}
+	pBarrier->srcStages = pState->writeStages;
+	pBarrier->srcAccess = pState->writeAccess;
+	pState->visibleStages |= pInfo->stages;
+	pState->visibleAccess |= pInfo->access;
+	return VK_TRUE;
+}
+
+static void computeGraphBarriers(RenderGraph *pRenderGraph){
+	VkBool32 isStarted[GRAPH_MAX_RESOURCES];
+	memset(isStarted, 0, sizeof(isStarted));
+	pRenderGraph->barrierNumber = 0;
+
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		pPass->barrierFirst = pRenderGraph->barrierNumber;
+		pPass->barrierNumber = 0;
+		if(pPass->isCulled){
+			continue;
+		}
+		for(uint32_t j = 0; j < pPass->useNumber; j++){
+			uint32_t resource = pPass->uses[j].resource;
+			if(!isStarted[resource]){
+				startGraphResource(pRenderGraph, resource);
+				isStarted[resource] = VK_TRUE;
+			}
+			GraphBarrier *pBarrier = &pRenderGraph->barriers[pRenderGraph->barrierNumber];
+			pBarrier->resource = resource;
+			if(applyGraphUse(&pRenderGraph->resources[resource], &graphUseInfos[pPass->uses[j].use], pBarrier)){
+				pRenderGraph->barrierNumber++;
+				pPass->barrierNumber++;
+			}
+		}
+	}
+
+	// Transitions de fin de frame vers le layout attendu par l'application, la présentation par exemple
+	pRenderGraph->finalBarrierFirst = pRenderGraph->barrierNumber;
+	pRenderGraph->finalBarrierNumber = 0;
+	for(uint32_t i = 0; i < pRenderGraph->resourceNumber; i++){
+		GraphResource *pResource = &pRenderGraph->resources[i];
+		if(!isStarted[i]){
+			continue;
+		}
+		if(pResource->isImage && !pResource->isTransient && pResource->finalLayout != VK_IMAGE_LAYOUT_UNDEFINED && pResource->finalLayout != pResource->state.layout){
+			VkBool32 isPresent = pResource->finalLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			GraphBarrier *pBarrier = &pRenderGraph->barriers[pRenderGraph->barrierNumber++];
+			pBarrier->resource = i;
+			pBarrier->srcStages = pResource->state.writeStages | pResource->state.readStages;
+			pBarrier->srcAccess = pResource->state.writeAccess;
+			pBarrier->dstStages = isPresent ? 0 : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			pBarrier->dstAccess = 0;
+			pBarrier->oldLayout = pResource->state.layout;
+			pBarrier->newLayout = pResource->finalLayout;
+			pRenderGraph->finalBarrierNumber++;
+
+			memset(&pResource->state, 0, sizeof(GraphResourceState));
+			pResource->state.writeStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			pResource->state.layout = pResource->finalLayout;
+		}
+		pResource->finalState = pResource->state;
+	}
+}
+
+static int createGraphRenderPasses(RenderGraph *pRenderGraph){
+	VkDevice *pDevice = &pRenderGraph->device;
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		if(pPass->isCulled || pPass->bindPoint != VK_PIPELINE_BIND_POINT_GRAPHICS){
+			continue;
+		}
+
+		VkAttachmentDescription attachmentDescriptions[GRAPH_MAX_PASS_USES];
+		VkAttachmentReference attachmentReferences[GRAPH_MAX_PASS_USES];
+		uint32_t attachmentNumber = 0;
+		pPass->framebufferNumber = 1;
+		for(uint32_t j = 0; j < pPass->useNumber; j++){
+			GraphPassUse *pUse = &pPass->uses[j];
+			if(pUse->use != GRAPH_USE_COLOR_ATTACHMENT){
+				continue;
+			}
+			GraphResource *pResource = &pRenderGraph->resources[pUse->resource];
+			if(attachmentNumber == 0){
+				pPass->extent = pResource->extent;
+			}
+			// Chaque vue du masque écrit la couche de même indice
+			if((pPass->viewMask >> pResource->layerNumber) != 0){
+				printf("VkGraphException : %s has %u layers, not enough for the views 0x%x of %s\n", pResource->name, pResource->layerNumber, pPass->viewMask, pPass->name);
+				return -1;
+			}
+			if(pResource->imageNumber > pPass->framebufferNumber){
+				pPass->framebufferNumber = pResource->imageNumber;
+			}
+
+			// Les transitions sont faites par les barrières du graphe, pas par la render pass
+			attachmentDescriptions[attachmentNumber].flags = 0;
+			attachmentDescriptions[attachmentNumber].format = pResource->format;
+			attachmentDescriptions[attachmentNumber].samples = VK_SAMPLE_COUNT_1_BIT;
+			attachmentDescriptions[attachmentNumber].loadOp = pUse->loadOp;
+			attachmentDescriptions[attachmentNumber].storeOp = !pResource->isTransient || pResource->lastPass > i ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachmentDescriptions[attachmentNumber].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachmentDescriptions[attachmentNumber].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachmentDescriptions[attachmentNumber].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			attachmentDescriptions[attachmentNumber].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			attachmentReferences[attachmentNumber].attachment = attachmentNumber;
+			attachmentReferences[attachmentNumber].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			pPass->clearValues[attachmentNumber] = pUse->clearValue;
+			pPass->attachmentResources[attachmentNumber] = pUse->resource;
+			pPass->loadOps[attachmentNumber] = attachmentDescriptions[attachmentNumber].loadOp;
+			pPass->storeOps[attachmentNumber] = attachmentDescriptions[attachmentNumber].storeOp;
+			attachmentNumber++;
+		}
+		if(attachmentNumber == 0){
+			printf("VkGraphException : graphics pass %s has no color attachment\n", pPass->name);
+			return -1;
+		}
+		pPass->renderArea = pPass->extent;
+		pPass->clearValueNumber = attachmentNumber;
+		// Le rendu commence directement sur les vues des attachements, rien d'autre à créer
+		if(pRenderGraph->dynamicRendering){
+			pPass->framebufferNumber = 0;
+			continue;
+		}
+
+		VkSubpassDescription subpassDescription = {
+			0,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			0,
+			VK_NULL_HANDLE,
+			attachmentNumber,
+			attachmentReferences,
+			VK_NULL_HANDLE,
+			VK_NULL_HANDLE,
+			0,
+			VK_NULL_HANDLE
+		};
+		// Même masque de corrélation que createRenderPass, sans quoi les pipelines de la scène ne seraient pas compatibles
+		VkRenderPassMultiviewCreateInfo renderPassMultiviewCreateInfo = {
+			VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO,
+			VK_NULL_HANDLE,
+			1,
+			&pPass->viewMask,
+			0,
+			VK_NULL_HANDLE,
+			1,
+			&pPass->viewMask
+		};
+		VkRenderPassCreateInfo renderPassCreateInfo = {
+			VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			pPass->viewMask != 0 ? &renderPassMultiviewCreateInfo : VK_NULL_HANDLE,
+			0,
+			attachmentNumber,
+			attachmentDescriptions,
+			1,
+			&subpassDescription,
+			0,
+			VK_NULL_HANDLE
+		};
+		if(vkCreateRenderPass(*pDevice, &renderPassCreateInfo, getHostAllocator(VK_OBJECT_TYPE_RENDER_PASS), &pPass->renderPass) != VK_SUCCESS){
+			printf("VkGraphException : unable to create the render pass of %s\n", pPass->name);
+			return -1;
+		}
+
+		for(uint32_t j = 0; j < pPass->framebufferNumber; j++){
+			VkImageView imageViews[GRAPH_MAX_PASS_USES];
+			for(uint32_t k = 0; k < attachmentNumber; k++){
+				GraphResource *pResource = &pRenderGraph->resources[pPass->attachmentResources[k]];
+				imageViews[k] = pResource->imageViews[j % pResource->imageNumber];
+			}
+			VkFramebufferCreateInfo framebufferCreateInfo = {
+				VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+				VK_NULL_HANDLE,
+				0,
+				pPass->renderPass,
+				attachmentNumber,
+				imageViews,
+				pPass->extent.width,
+				pPass->extent.height,
+				1
+			};
+			vkCreateFramebuffer(*pDevice, &framebufferCreateInfo, getHostAllocator(VK_OBJECT_TYPE_FRAMEBUFFER), &pPass->framebuffers[j]);
+		}
+	}
+	return 0;
+}
+
+static void createGraphQueryPool(VkPhysicalDevice *pPhysicalDevice, RenderGraph *pRenderGraph){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	if(!physicalDeviceProperties.limits.timestampComputeAndGraphics){
+		printf("VkGraphException : timestamps not supported, passes will not be timed\n");
+		return;
+	}
+
+	// Un timestamp avant la première passe puis un après chaque passe gardée, une plage par image
+	pRenderGraph->queryNumber = 1;
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		pPass->timestampQuery = pPass->isCulled ? GRAPH_INVALID_INDEX : pRenderGraph->queryNumber++;
+	}
+	pRenderGraph->timestampImageNumber = 1;
+	for(uint32_t i = 0; i < pRenderGraph->resourceNumber; i++){
+		if(pRenderGraph->resources[i].imageNumber > pRenderGraph->timestampImageNumber){
+			pRenderGraph->timestampImageNumber = pRenderGraph->resources[i].imageNumber;
+		}
+	}
+	pRenderGraph->timestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+
+	VkQueryPoolCreateInfo queryPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		VK_QUERY_TYPE_TIMESTAMP,
+		pRenderGraph->queryNumber * pRenderGraph->timestampImageNumber,
+		0
+	};
+	if(vkCreateQueryPool(pRenderGraph->device, &queryPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_QUERY_POOL), &pRenderGraph->queryPool) != VK_SUCCESS){
+		printf("VkGraphException : unable to create the timestamp query pool\n");
+		pRenderGraph->queryPool = VK_NULL_HANDLE;
+	}
+}
+
+int compileRenderGraph(VkPhysicalDevice *pPhysicalDevice, RenderGraph *pRenderGraph){
+	if(pRenderGraph->isCompiled){
+		return 0;
+	}
+	cullGraphPasses(pRenderGraph);
+	if(allocateGraphImages(pPhysicalDevice, pRenderGraph) != 0){
+		return -1;
+	}
+
+	// Deux passages : le second part de l'état de fin du premier, comme la frame suivante le fera
+	computeGraphBarriers(pRenderGraph);
+	computeGraphBarriers(pRenderGraph);
+
+	if(createGraphRenderPasses(pRenderGraph) != 0){
+		return -1;
+	}
+	createGraphQueryPool(pPhysicalDevice, pRenderGraph);
+	pRenderGraph->isCompiled = VK_TRUE;
+	return 0;
+}
+
+VkRenderPass getGraphRenderPass(RenderGraph *pRenderGraph, uint32_t pass){
+	return pass < pRenderGraph->passNumber ? pRenderGraph->passes[pass].renderPass : VK_NULL_HANDLE;
+}
+
+void setGraphPassRenderArea(RenderGraph *pRenderGraph, uint32_t pass, VkExtent2D *pExtent){
+	if(pass >= pRenderGraph->passNumber){
+		return;
+	}
+	GraphPass *pPass = &pRenderGraph->passes[pass];
+	pPass->renderArea.width = pExtent->width < pPass->extent.width ? pExtent->width : pPass->extent.width;
+	pPass->renderArea.height = pExtent->height < pPass->extent.height ? pExtent->height : pPass->extent.height;
+}
+
+static void recordGraphBarriers(RenderGraph *pRenderGraph, VkCommandBuffer *pCommandBuffer, uint32_t barrierFirst, uint32_t barrierNumber, uint32_t imageIndex){
+	if(barrierNumber == 0){
+		return;
+	}
+	// Toutes les couches d'une image changent de layout ensemble
+	VkImageSubresourceRange subresourceRange = {
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		0,
+		1,
+		0,
+		VK_REMAINING_ARRAY_LAYERS
+	};
+
+	if(pRenderGraph->synchronization2){
+		VkImageMemoryBarrier2KHR imageMemoryBarriers[GRAPH_MAX_RESOURCES];
+		VkBufferMemoryBarrier2KHR bufferMemoryBarriers[GRAPH_MAX_RESOURCES];
+		uint32_t imageBarrierNumber = 0, bufferBarrierNumber = 0;
+		for(uint32_t i = 0; i < barrierNumber; i++){
+			GraphBarrier *pBarrier = &pRenderGraph->barriers[barrierFirst + i];
+			GraphResource *pResource = &pRenderGraph->resources[pBarrier->resource];
+			if(pResource->isImage){
+				VkImageMemoryBarrier2KHR *pImageMemoryBarrier = &imageMemoryBarriers[imageBarrierNumber++];
+				pImageMemoryBarrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+				pImageMemoryBarrier->pNext = VK_NULL_HANDLE;
+				pImageMemoryBarrier->srcStageMask = pBarrier->srcStages;
+				pImageMemoryBarrier->srcAccessMask = pBarrier->srcAccess;
+				pImageMemoryBarrier->dstStageMask = pBarrier->dstStages;
+				pImageMemoryBarrier->dstAccessMask = pBarrier->dstAccess;
+				pImageMemoryBarrier->oldLayout = pBarrier->oldLayout;
+				pImageMemoryBarrier->newLayout = pBarrier->newLayout;
+				pImageMemoryBarrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				pImageMemoryBarrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				pImageMemoryBarrier->image = pResource->images[imageIndex % pResource->imageNumber];
+				pImageMemoryBarrier->subresourceRange = subresourceRange;
+			}else{
+				VkBufferMemoryBarrier2KHR *pBufferMemoryBarrier = &bufferMemoryBarriers[bufferBarrierNumber++];
+				pBufferMemoryBarrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+				pBufferMemoryBarrier->pNext = VK_NULL_HANDLE;
+				pBufferMemoryBarrier->srcStageMask = pBarrier->srcStages;
+				pBufferMemoryBarrier->srcAccessMask = pBarrier->srcAccess;
+				pBufferMemoryBarrier->dstStageMask = pBarrier->dstStages;
+				pBufferMemoryBarrier->dstAccessMask = pBarrier->dstAccess;
+				pBufferMemoryBarrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				pBufferMemoryBarrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				pBufferMemoryBarrier->buffer = pResource->buffer;
+				pBufferMemoryBarrier->offset = 0;
+				pBufferMemoryBarrier->size = VK_WHOLE_SIZE;
+			}
+		}
+
+		VkDependencyInfoKHR dependencyInfo = {
+			VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+			VK_NULL_HANDLE,
+			0,
+			0,
+			VK_NULL_HANDLE,
+			bufferBarrierNumber,
+			bufferMemoryBarriers,
+			imageBarrierNumber,
+			imageMemoryBarriers
+		};
+		pRenderGraph->cmdPipelineBarrier2(*pCommandBuffer, &dependencyInfo);
+		return;
+	}
+
+	// Repli synchronization 1 : un seul appel avec l'union des stages
+	VkImageMemoryBarrier imageMemoryBarriers[GRAPH_MAX_RESOURCES];
+	VkBufferMemoryBarrier bufferMemoryBarriers[GRAPH_MAX_RESOURCES];
+	uint32_t imageBarrierNumber = 0, bufferBarrierNumber = 0;
+	VkPipelineStageFlags srcStages = 0, dstStages = 0;
+	for(uint32_t i = 0; i < barrierNumber; i++){
+		GraphBarrier *pBarrier = &pRenderGraph->barriers[barrierFirst + i];
+		GraphResource *pResource = &pRenderGraph->resources[pBarrier->resource];
+		srcStages |= (VkPipelineStageFlags)pBarrier->srcStages;
+		dstStages |= (VkPipelineStageFlags)pBarrier->dstStages;
+		if(pResource->isImage){
+			VkImageMemoryBarrier *pImageMemoryBarrier = &imageMemoryBarriers[imageBarrierNumber++];
+			pImageMemoryBarrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			pImageMemoryBarrier->pNext = VK_NULL_HANDLE;
+			pImageMemoryBarrier->srcAccessMask = (VkAccessFlags)pBarrier->srcAccess;
+			pImageMemoryBarrier->dstAccessMask = (VkAccessFlags)pBarrier->dstAccess;
+			pImageMemoryBarrier->oldLayout = pBarrier->oldLayout;
+			pImageMemoryBarrier->newLayout = pBarrier->newLayout;
+			pImageMemoryBarrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			pImageMemoryBarrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			pImageMemoryBarrier->image = pResource->images[imageIndex % pResource->imageNumber];
+			pImageMemoryBarrier->subresourceRange = subresourceRange;
+		}else{
+			VkBufferMemoryBarrier *pBufferMemoryBarrier = &bufferMemoryBarriers[bufferBarrierNumber++];
+			pBufferMemoryBarrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			pBufferMemoryBarrier->pNext = VK_NULL_HANDLE;
+			pBufferMemoryBarrier->srcAccessMask = (VkAccessFlags)pBarrier->srcAccess;
+			pBufferMemoryBarrier->dstAccessMask = (VkAccessFlags)pBarrier->dstAccess;
+			pBufferMemoryBarrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			pBufferMemoryBarrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			pBufferMemoryBarrier->buffer = pResource->buffer;
+			pBufferMemoryBarrier->offset = 0;
+			pBufferMemoryBarrier->size = VK_WHOLE_SIZE;
+		}
+	}
+	vkCmdPipelineBarrier(*pCommandBuffer, srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStages != 0 ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0, 0, VK_NULL_HANDLE, bufferBarrierNumber, bufferMemoryBarriers, imageBarrierNumber, imageMemoryBarriers);
+}
+
+void recordRenderGraph(RenderGraph *pRenderGraph, VkCommandBuffer *pCommandBuffer, uint32_t imageIndex){
+	uint32_t queryFirst = (imageIndex % (pRenderGraph->timestampImageNumber != 0 ? pRenderGraph->timestampImageNumber : 1)) * pRenderGraph->queryNumber;
+	if(pRenderGraph->queryPool != VK_NULL_HANDLE){
+		vkCmdResetQueryPool(*pCommandBuffer, pRenderGraph->queryPool, queryFirst, pRenderGraph->queryNumber);
+		vkCmdWriteTimestamp(*pCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pRenderGraph->queryPool, queryFirst);
+	}
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		if(pPass->isCulled){
+			continue;
+		}
+		recordGraphBarriers(pRenderGraph, pCommandBuffer, pPass->barrierFirst, pPass->barrierNumber, imageIndex);
+
+		if(pPass->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS && pRenderGraph->dynamicRendering){
+			VkRenderingAttachmentInfoKHR renderingAttachmentInfos[GRAPH_MAX_PASS_USES];
+			for(uint32_t j = 0; j < pPass->clearValueNumber; j++){
+				GraphResource *pResource = &pRenderGraph->resources[pPass->attachmentResources[j]];
+				VkRenderingAttachmentInfoKHR *pRenderingAttachmentInfo = &renderingAttachmentInfos[j];
+				pRenderingAttachmentInfo->sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+				pRenderingAttachmentInfo->pNext = VK_NULL_HANDLE;
+				pRenderingAttachmentInfo->imageView = pResource->imageViews[imageIndex % pResource->imageNumber];
+				pRenderingAttachmentInfo->imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+				pRenderingAttachmentInfo->resolveMode = VK_RESOLVE_MODE_NONE;
+				pRenderingAttachmentInfo->resolveImageView = VK_NULL_HANDLE;
+				pRenderingAttachmentInfo->resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				pRenderingAttachmentInfo->loadOp = pPass->loadOps[j];
+				pRenderingAttachmentInfo->storeOp = pPass->storeOps[j];
+				pRenderingAttachmentInfo->clearValue = pPass->clearValues[j];
+			}
+			VkRenderingInfoKHR renderingInfo = {
+				VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+				VK_NULL_HANDLE,
+				0,
+				{
+					{0, 0},
+					{pPass->renderArea.width, pPass->renderArea.height}
+				},
+				1,
+				pPass->viewMask,
+				pPass->clearValueNumber,
+				renderingAttachmentInfos,
+				VK_NULL_HANDLE,
+				VK_NULL_HANDLE
+			};
+			pRenderGraph->cmdBeginRendering(*pCommandBuffer, &renderingInfo);
+			recordViewport(pCommandBuffer, &pPass->renderArea);
+		}else if(pPass->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS){
+			VkRenderPassBeginInfo renderPassBeginInfo = {
+				VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+				VK_NULL_HANDLE,
+				pPass->renderPass,
+				pPass->framebuffers[imageIndex % pPass->framebufferNumber],
+				{
+					{0, 0},
+					{pPass->renderArea.width, pPass->renderArea.height}
+				},
+				pPass->clearValueNumber,
+				pPass->clearValues
+			};
+			vkCmdBeginRenderPass(*pCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+			recordViewport(pCommandBuffer, &pPass->renderArea);
+		}
+		if(pPass->record != VK_NULL_HANDLE){
+			pPass->record(pCommandBuffer, imageIndex, pPass->pUserData);
+		}
+		if(pPass->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS && pRenderGraph->dynamicRendering){
+			pRenderGraph->cmdEndRendering(*pCommandBuffer);
+		}else if(pPass->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS){
+			vkCmdEndRenderPass(*pCommandBuffer);
+		}
+		// La durée d'une passe va de la fin de la précédente à sa propre fin, barrières comprises
+		if(pRenderGraph->queryPool != VK_NULL_HANDLE){
+			vkCmdWriteTimestamp(*pCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pRenderGraph->queryPool, queryFirst + pPass->timestampQuery);
+		}
+	}
+	recordGraphBarriers(pRenderGraph, pCommandBuffer, pRenderGraph->finalBarrierFirst, pRenderGraph->finalBarrierNumber, imageIndex);
+}
+
+void recordRenderGraphCommandBuffer(RenderGraph *pRenderGraph, VkCommandBuffer *pCommandBuffer, uint32_t imageIndex){
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		VK_NULL_HANDLE,
+		0,
+		VK_NULL_HANDLE
+	};
+
+	vkBeginCommandBuffer(*pCommandBuffer, &commandBufferBeginInfo);
+	recordRenderGraph(pRenderGraph, pCommandBuffer, imageIndex);
+	vkEndCommandBuffer(*pCommandBuffer);
+}
+
+void recordRenderGraphCommandBuffers(RenderGraph *pRenderGraph, VkCommandBuffer **ppCommandBuffers, uint32_t commandBufferNumber){
+	for(uint32_t i = 0; i < commandBufferNumber; i++){
+		recordRenderGraphCommandBuffer(pRenderGraph, &(*ppCommandBuffers)[i], i);
+	}
+}
+
+void readRenderGraphTimestamps(RenderGraph *pRenderGraph, uint32_t imageIndex){
+	if(pRenderGraph->queryPool == VK_NULL_HANDLE){
+		return;
+	}
+	// Les requêtes d'une image ne sont valides qu'après sa première soumission
+	uint32_t timestampImage = imageIndex % pRenderGraph->timestampImageNumber;
+	if(pRenderGraph->timestampFrames[timestampImage]++ == 0){
+		return;
+	}
+
+	uint64_t timestamps[GRAPH_MAX_PASSES + 1];
+	if(vkGetQueryPoolResults(pRenderGraph->device, pRenderGraph->queryPool, timestampImage * pRenderGraph->queryNumber, pRenderGraph->queryNumber,
+		sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS){
+		return;
+	}
+
+	// Moyenne glissante : une mesure isolée est trop bruitée pour budgéter un effet
+	float millisecondsPerTick = pRenderGraph->timestampPeriod * 1e-6f;
+	for(uint32_t i = 0, previousQuery = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		if(pPass->isCulled){
+			continue;
+		}
+		float gpuTime = (float)(timestamps[pPass->timestampQuery] - timestamps[previousQuery]) * millisecondsPerTick;
+		pPass->gpuTime += 0.1f * (gpuTime - pPass->gpuTime);
+		previousQuery = pPass->timestampQuery;
+	}
+	float gpuTime = (float)(timestamps[pRenderGraph->queryNumber - 1] - timestamps[0]) * millisecondsPerTick;
+	pRenderGraph->gpuTime += 0.1f * (gpuTime - pRenderGraph->gpuTime);
+}
+
+void printRenderGraph(RenderGraph *pRenderGraph){
+	printf("render graph : %u passes, %s barriers, %s, %.3f ms on the GPU\n", pRenderGraph->passNumber, pRenderGraph->synchronization2 ? "synchronization2" : "legacy",
+		pRenderGraph->dynamicRendering ? "dynamic rendering" : "render passes", pRenderGraph->gpuTime);
+	for(uint32_t i = 0; i < pRenderGraph->passNumber; i++){
+		GraphPass *pPass = &pRenderGraph->passes[i];
+		if(pPass->isCulled){
+			printf("  pass %s (dropped)\n", pPass->name);
+		}else if(pPass->viewMask != 0){
+			printf("  pass %s : %.3f ms, views 0x%x\n", pPass->name, pPass->gpuTime, pPass->viewMask);
+		}else{
+			printf("  pass %s : %.3f ms\n", pPass->name, pPass->gpuTime);
+		}
+		for(uint32_t j = 0; j < pPass->barrierNumber; j++){
+			GraphBarrier *pBarrier = &pRenderGraph->barriers[pPass->barrierFirst + j];
+			printf("    barrier %s : stages 0x%llx -> 0x%llx, layout %d -> %d\n", pRenderGraph->resources[pBarrier->resource].name,
+				(unsigned long long)pBarrier->srcStages, (unsigned long long)pBarrier->dstStages, pBarrier->oldLayout, pBarrier->newLayout);
+		}
+	}
+	for(uint32_t i = 0; i < pRenderGraph->memoryBlockNumber; i++){
+		printf("  memory block %u : %llu bytes%s shared by", i, (unsigned long long)pRenderGraph->memoryBlockSizes[i], pRenderGraph->memoryBlockLazy[i] ? " lazily allocated" : "");
+		for(uint32_t j = 0; j < pRenderGraph->resourceNumber; j++){
+			if(pRenderGraph->resources[j].isTransient && pRenderGraph->resources[j].memoryBlock == i){
+				printf(" %s", pRenderGraph->resources[j].name);
+			}
+		}
+		printf("\n");
+	}
+}
@@ -0,0 +1,113 @@
+#include "../Headers/glfw_fun.h"
+#include "../Headers/hud_fun.h"
+
+static const char *hudGraphNames[HUD_GRAPH_NUMBER] = {
+	"cpu", "gpu", "sim", "present"
+};
+
+PerfHud createPerfHud(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules, uint32_t frameNumber){
+	PerfHud perfHud;
+	memset(&perfHud, 0, sizeof(PerfHud));
+	perfHud.pass = GRAPH_INVALID_INDEX;
+	perfHud.isVisible = VK_TRUE;
+	// Même atlas et même pipeline que le texte de la scène, mais sans vue multiple ni post-traitement
+	perfHud.textRenderer = createTextRenderer(pPhysicalDevice, pDevice, pQueue, pCommandPool, pRenderTarget, pExtent, &pShaderModules[0], &pShaderModules[1], frameNumber, HUD_QUAD_CAPACITY);
+	if(perfHud.textRenderer.pipeline == VK_NULL_HANDLE){
+		printf("VkHudException : unable to create the text renderer of the overlay\n");
+	}
+	return perfHud;
+}
+
+void deletePerfHud(VkDevice *pDevice, PerfHud *pPerfHud){
+	deleteTextRenderer(pDevice, &pPerfHud->textRenderer);
+}
+
+static void recordPerfHud(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData){
+	PerfHud *pPerfHud = (PerfHud *)pUserData;
+	recordTextDraw(&pPerfHud->textRenderer, pCommandBuffer, commandBufferIndex);
+}
+
+uint32_t addPerfHudPass(PerfHud *pPerfHud, RenderGraph *pRenderGraph, uint32_t output){
+	pPerfHud->pass = addGraphPass(pRenderGraph, "hud", VK_PIPELINE_BIND_POINT_GRAPHICS, recordPerfHud, pPerfHud);
+	if(pPerfHud->pass == GRAPH_INVALID_INDEX){
+		return GRAPH_INVALID_INDEX;
+	}
+	// L'overlay se pose sur l'image finale, son contenu doit être conservé
+	addGraphColorAttachment(pRenderGraph, pPerfHud->pass, output, VK_ATTACHMENT_LOAD_OP_LOAD, VK_NULL_HANDLE);
+	return pPerfHud->pass;
+}
+
+void pushPerfHudFrame(PerfHud *pPerfHud, HudFrame *pFrame){
+	for(uint32_t i = 0; i < HUD_GRAPH_NUMBER; i++){
+		pPerfHud->history[i][pPerfHud->historyIndex] = pFrame->times[i];
+	}
+	pPerfHud->historyIndex = (pPerfHud->historyIndex + 1) % HUD_HISTORY_LENGTH;
+	pPerfHud->frame = *pFrame;
+}
+
+static void drawHudGraph(PerfHud *pPerfHud, uint32_t graph, float x, float y){
+	TextRenderer *pTextRenderer = &pPerfHud->textRenderer;
+	uint32_t grey = TEXT_COLOR(255, 255, 255, 160), background = TEXT_COLOR(0, 0, 0, 144);
+	uint32_t green = TEXT_COLOR(80, 220, 120, 255), red = TEXT_COLOR(255, 80, 80, 255);
+	float *pHistory = pPerfHud->history[graph];
+
+	float maxTime = 0.0f;
+	for(uint32_t i = 0; i < HUD_HISTORY_LENGTH; i++){
+		maxTime = pHistory[i] > maxTime ? pHistory[i] : maxTime;
+	}
+	char label[40];
+	snprintf(label, sizeof(label), "%-7s %6.2f max %6.2f", hudGraphNames[graph], pPerfHud->frame.times[graph], maxTime);
+	drawText(pTextRenderer, x, y, HUD_TEXT_SCALE, grey, label);
+
+	// Les barres défilent de la plus ancienne, à gauche, à la plus récente ; une valeur nulle ne coûte aucun quad
+	float graphY = y + TEXT_CELL_SIZE * HUD_TEXT_SCALE;
+	float bottom = graphY + HUD_GRAPH_HEIGHT;
+	drawTextRect(pTextRenderer, x, graphY, HUD_HISTORY_LENGTH * HUD_BAR_WIDTH, HUD_GRAPH_HEIGHT, background);
+	for(uint32_t i = 0; i < HUD_HISTORY_LENGTH; i++){
+		float time = pHistory[(pPerfHud->historyIndex + i) % HUD_HISTORY_LENGTH];
+		float height = time < HUD_GRAPH_RANGE ? time * HUD_GRAPH_HEIGHT / HUD_GRAPH_RANGE : HUD_GRAPH_HEIGHT;
+		if(height >= 0.5f){
+			drawTextRect(pTextRenderer, x + i * HUD_BAR_WIDTH, bottom - height, HUD_BAR_WIDTH, height, time > HUD_FRAME_BUDGET ? red : green);
+		}
+	}
+	drawTextRect(pTextRenderer, x, bottom - HUD_FRAME_BUDGET * HUD_GRAPH_HEIGHT / HUD_GRAPH_RANGE, HUD_HISTORY_LENGTH * HUD_BAR_WIDTH, 1.0f, grey);
+}
+
+void updatePerfHud(PerfHud *pPerfHud, RenderGraph *pRenderGraph, uint32_t frameIndex){
+	TextRenderer *pTextRenderer = &pPerfHud->textRenderer;
+	beginText(pTextRenderer, frameIndex);
+	if(!pPerfHud->isVisible){
+		endText(pTextRenderer);
+		return;
+	}
+	double startTime = glfwGetTime();
+
+	float panelWidth = HUD_HISTORY_LENGTH * HUD_BAR_WIDTH;
+	float x = (float)pTextRenderer->extent.width - panelWidth - 8.0f, y = 8.0f;
+	for(uint32_t i = 0; i < HUD_GRAPH_NUMBER; i++){
+		drawHudGraph(pPerfHud, i, x, y);
+		y += TEXT_CELL_SIZE * HUD_TEXT_SCALE + HUD_GRAPH_HEIGHT + 6.0f;
+	}
+
+	uint32_t grey = TEXT_COLOR(255, 255, 255, 160);
+	char line[40];
+	snprintf(line, sizeof(line), "draws %u inst %u", pPerfHud->frame.drawNumber, pPerfHud->frame.instanceNumber);
+	drawText(pTextRenderer, x, y, HUD_TEXT_SCALE, grey, line);
+	y += TEXT_CELL_SIZE * HUD_TEXT_SCALE;
+	snprintf(line, sizeof(line), "allocs %llu", (unsigned long long)pPerfHud->frame.allocationNumber);
+	drawText(pTextRenderer, x, y, HUD_TEXT_SCALE, grey, line);
+	y += TEXT_CELL_SIZE * HUD_TEXT_SCALE;
+	// Coût de l'overlay lui-même : remplissage du tampon côté CPU, sa passe côté GPU
+	float gpuTime = pPerfHud->pass != GRAPH_INVALID_INDEX ? pRenderGraph->passes[pPerfHud->pass].gpuTime : 0.0f;
+	snprintf(line, sizeof(line), "hud %.3f cpu %.3f gpu", pPerfHud->cpuTime, gpuTime);
+	drawText(pTextRenderer, x, y, HUD_TEXT_SCALE, grey, line);
+	endText(pTextRenderer);
+
+	float cpuTime = (float)((glfwGetTime() - startTime) * 1e3);
+	pPerfHud->cpuTime += 0.1f * (cpuTime - pPerfHud->cpuTime);
+	pPerfHud->maxCpuTime = cpuTime > pPerfHud->maxCpuTime ? cpuTime : pPerfHud->maxCpuTime;
+}
+
+void printPerfHud(PerfHud *pPerfHud){
+	printf("performance overlay : %.3f ms average, %.3f ms max on the CPU\n", pPerfHud->cpuTime, pPerfHud->maxCpuTime);
+}
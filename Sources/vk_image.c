@@ -32,7 +32,8 @@ VkImageView *createImageViews(VkDevice *pDevice, VkImage **ppImages, VkSurfaceFo
 		imageArrayLayers
 	};
 
-	VkImageViewCreateInfo *imageViewCreateInfo = (VkImageViewCreateInfo *)malloc(imageNumber * sizeof(VkImageViewCreateInfo));
+	size_t scratchMark = getScratchMark();
+	VkImageViewCreateInfo *imageViewCreateInfo = (VkImageViewCreateInfo *)allocateScratch(imageNumber * sizeof(VkImageViewCreateInfo));
 	VkImageView *imageViews = (VkImageView *)malloc(imageNumber * sizeof(VkImageView));
 
 	for(uint32_t i = 0; i < imageNumber; i++){
@@ -45,15 +46,183 @@ VkImageView *createImageViews(VkDevice *pDevice, VkImage **ppImages, VkSurfaceFo
 		imageViewCreateInfo[i].components = componentMapping;
 		imageViewCreateInfo[i].subresourceRange = imageSubresourceRange;
 
-		vkCreateImageView(*pDevice, &(imageViewCreateInfo[i]), VK_NULL_HANDLE, &(imageViews[i]));
+		vkCreateImageView(*pDevice, &(imageViewCreateInfo[i]), getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW), &(imageViews[i]));
 	}
 
-	free(imageViewCreateInfo);
+	resetScratch(scratchMark);
 	return imageViews;
 }
 
 void deleteImageViews(VkDevice *pDevice, VkImageView **ppImageViews, uint32_t imageViewNumber){
 	for(uint32_t i = 0; i < imageViewNumber; i++){
-		vkDestroyImageView(*pDevice, (*ppImageViews)[i], VK_NULL_HANDLE);
+		vkDestroyImageView(*pDevice, (*ppImageViews)[i], getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
 	}
 }
+
+VkImage createImage(VkDevice *pDevice, VkFormat format, VkExtent2D *pExtent, VkImageUsageFlags usage, uint32_t layerNumber){
+	VkImageCreateInfo imageCreateInfo;
+	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.pNext = VK_NULL_HANDLE;
+	imageCreateInfo.flags = 0;
+	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.format = format;
+	imageCreateInfo.extent.width = pExtent->width;
+	imageCreateInfo.extent.height = pExtent->height;
+	imageCreateInfo.extent.depth = 1;
+	imageCreateInfo.mipLevels = 1;
+	imageCreateInfo.arrayLayers = layerNumber;
+	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage = usage;
+	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageCreateInfo.queueFamilyIndexCount = 0;
+	imageCreateInfo.pQueueFamilyIndices = VK_NULL_HANDLE;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	VkImage image;
+	vkCreateImage(*pDevice, &imageCreateInfo, getHostAllocator(VK_OBJECT_TYPE_IMAGE), &image);
+	return image;
+}
+
+VkImage createMipImage(VkDevice *pDevice, VkFormat format, VkExtent2D *pExtent, VkImageUsageFlags usage, uint32_t mipLevelNumber){
+	VkImageCreateInfo imageCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		VK_IMAGE_TYPE_2D,
+		format,
+		{pExtent->width, pExtent->height, 1},
+		mipLevelNumber,
+		1,
+		VK_SAMPLE_COUNT_1_BIT,
+		VK_IMAGE_TILING_OPTIMAL,
+		usage,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0,
+		VK_NULL_HANDLE,
+		VK_IMAGE_LAYOUT_UNDEFINED
+	};
+
+	VkImage image;
+	vkCreateImage(*pDevice, &imageCreateInfo, getHostAllocator(VK_OBJECT_TYPE_IMAGE), &image);
+	return image;
+}
+
+void deleteImage(VkDevice *pDevice, VkImage *pImage){
+	vkDestroyImage(*pDevice, *pImage, getHostAllocator(VK_OBJECT_TYPE_IMAGE));
+}
+
+VkImageView createImageView(VkDevice *pDevice, VkImage *pImage, VkFormat format, uint32_t layerNumber){
+	// Une vue tableau pour les attachements multiview, que les shaders lisent en sampler2DArray
+	VkImageViewCreateInfo imageViewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		*pImage,
+		layerNumber > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+		format,
+		{
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY
+		},
+		{
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			0,
+			1,
+			0,
+			layerNumber
+		}
+	};
+
+	VkImageView imageView;
+	vkCreateImageView(*pDevice, &imageViewCreateInfo, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW), &imageView);
+	return imageView;
+}
+
+VkImageView createMipImageView(VkDevice *pDevice, VkImage *pImage, VkFormat format, uint32_t mipLevelNumber){
+	VkImageViewCreateInfo imageViewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		*pImage,
+		VK_IMAGE_VIEW_TYPE_2D,
+		format,
+		{
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY
+		},
+		{
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			0,
+			mipLevelNumber,
+			0,
+			1
+		}
+	};
+
+	VkImageView imageView;
+	vkCreateImageView(*pDevice, &imageViewCreateInfo, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW), &imageView);
+	return imageView;
+}
+
+void deleteImageView(VkDevice *pDevice, VkImageView *pImageView){
+	vkDestroyImageView(*pDevice, *pImageView, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+}
+
+VkSampler createSampler(VkDevice *pDevice, VkFilter filter){
+	VkSamplerCreateInfo samplerCreateInfo;
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.pNext = VK_NULL_HANDLE;
+	samplerCreateInfo.flags = 0;
+	samplerCreateInfo.magFilter = filter;
+	samplerCreateInfo.minFilter = filter;
+	// Sans effet sur les images à un seul niveau, trilinéaire sur les textures avec leurs mips
+	samplerCreateInfo.mipmapMode = filter == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.mipLodBias = 0.0f;
+	samplerCreateInfo.anisotropyEnable = VK_FALSE;
+	samplerCreateInfo.maxAnisotropy = 1.0f;
+	samplerCreateInfo.compareEnable = VK_FALSE;
+	samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerCreateInfo.minLod = 0.0f;
+	samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+	samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+
+	VkSampler sampler;
+	vkCreateSampler(*pDevice, &samplerCreateInfo, getHostAllocator(VK_OBJECT_TYPE_SAMPLER), &sampler);
+	return sampler;
+}
+
+void deleteSampler(VkDevice *pDevice, VkSampler *pSampler){
+	vkDestroySampler(*pDevice, *pSampler, getHostAllocator(VK_OBJECT_TYPE_SAMPLER));
+}
+
+void recordImageLayoutTransition(VkCommandBuffer *pCommandBuffer, VkImage *pImage, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask){
+	VkImageMemoryBarrier imageMemoryBarrier = {
+		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		VK_NULL_HANDLE,
+		srcAccessMask,
+		dstAccessMask,
+		oldLayout,
+		newLayout,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		*pImage,
+		{
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			0,
+			1,
+			0,
+			1
+		}
+	};
+
+	vkCmdPipelineBarrier(*pCommandBuffer, srcStageMask, dstStageMask, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &imageMemoryBarrier);
+}
@@ -19,7 +19,7 @@ VkInstance createInstance(const char * app_name, uint32_t app_version, const cha
                 app_version,
                 engine_name,
                 engine_version,
-                VK_API_VERSION_1_0
+                VK_API_VERSION_1_1
         };
 
 
@@ -47,7 +47,7 @@ VkInstance createInstance(const char * app_name, uint32_t app_version, const cha
         };
 
         VkInstance instance;
-        if(vkCreateInstance(&instanceCreateInfo, VK_NULL_HANDLE, &instance) != VK_SUCCESS){
+        if(vkCreateInstance(&instanceCreateInfo, getHostAllocator(VK_OBJECT_TYPE_INSTANCE), &instance) != VK_SUCCESS){
             printf("VkInstanceException : Error while creating vulkan instance\n");
             instance_exception();
         };
@@ -58,5 +58,5 @@ VkInstance createInstance(const char * app_name, uint32_t app_version, const cha
 
 
 void deleteInstance(VkInstance *pInstance){
-	vkDestroyInstance(*pInstance, VK_NULL_HANDLE);
+	vkDestroyInstance(*pInstance, getHostAllocator(VK_OBJECT_TYPE_INSTANCE));
 }
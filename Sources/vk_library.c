@@ -0,0 +1,473 @@
+#include <pthread.h>
+
+#include "../Headers/library_fun.h"
+#include "../Headers/trace_fun.h"
+
+#define PIPELINE_LIBRARY_MAX_RENDER_TARGETS 8
+
+/**
+ * Interfaces de sortie d'une cible de rendu, une par mode de mélange
+ */
+typedef struct PipelineOutputParts {
+	RenderTarget renderTarget;
+	VkPipeline parts[PIPELINE_BLEND_MODE_NUMBER];
+} PipelineOutputParts;
+
+struct PipelineLibrary {
+	VkDevice device;
+	VkBool32 isSupported;
+	VkPipeline vertexInputParts[PIPELINE_TOPOLOGY_NUMBER];
+	uint32_t outputNumber;
+	PipelineOutputParts outputs[PIPELINE_LIBRARY_MAX_RENDER_TARGETS];
+	uint32_t shaderNumber;
+	PipelineShaders shaders[PIPELINE_LIBRARY_MAX_SHADERS];
+	uint32_t upgradeNumber;
+	uint32_t nextUpgrade;
+	PipelineUpgrade upgrades[PIPELINE_LIBRARY_MAX_UPGRADES];
+	uint32_t retiredNumber;
+	VkPipeline retiredPipelines[PIPELINE_LIBRARY_MAX_RETIRED];
+	uint32_t partNumber;
+	uint32_t linkNumber;
+	uint32_t optimizedNumber;
+	double partTime;
+	double linkTime;
+	double optimizedTime;
+	int isRunning;
+	int isStarted;
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	pthread_t thread;
+};
+
+static VkPipelineColorBlendAttachmentState configureBlendModeAttachmentState(uint32_t blendMode){
+	VkPipelineColorBlendAttachmentState colorBlendAttachmentState = configureColorBlendAttachmentState();
+	if(blendMode == PIPELINE_BLEND_ALPHA){
+		colorBlendAttachmentState.blendEnable = VK_TRUE;
+		colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	}else if(blendMode == PIPELINE_BLEND_ADDITIVE){
+		colorBlendAttachmentState.blendEnable = VK_TRUE;
+		colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	}
+	return colorBlendAttachmentState;
+}
+
+static VkPipeline createPipelinePart(PipelineLibrary *pPipelineLibrary, VkGraphicsPipelineCreateInfo *pGraphicsPipelineCreateInfo, RenderTarget *pRenderTarget, VkGraphicsPipelineLibraryFlagsEXT libraryFlags){
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+		VK_NULL_HANDLE,
+		libraryFlags
+	};
+	pGraphicsPipelineCreateInfo->sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pGraphicsPipelineCreateInfo->pNext = &libraryCreateInfo;
+	// Seule l'interface des sommets ne dépend pas de la cible de rendu
+	VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+	if(pRenderTarget != VK_NULL_HANDLE){
+		pGraphicsPipelineCreateInfo->pNext = chainRenderingCreateInfo(pRenderTarget, &renderingCreateInfo, &libraryCreateInfo);
+		pGraphicsPipelineCreateInfo->renderPass = pRenderTarget->renderPass;
+	}
+	// Les parties gardent de quoi refaire une édition de liens optimisée plus tard
+	pGraphicsPipelineCreateInfo->flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+	pGraphicsPipelineCreateInfo->basePipelineHandle = VK_NULL_HANDLE;
+	pGraphicsPipelineCreateInfo->basePipelineIndex = -1;
+
+	double startTime = glfwGetTime();
+	VkPipeline part = VK_NULL_HANDLE;
+	if(vkCreateGraphicsPipelines(pPipelineLibrary->device, VK_NULL_HANDLE, 1, pGraphicsPipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &part) != VK_SUCCESS){
+		printf("VkPipelineException : unable to create the pipeline library part 0x%x\n", (unsigned int)libraryFlags);
+		return VK_NULL_HANDLE;
+	}
+	pPipelineLibrary->partTime += glfwGetTime() - startTime;
+	pPipelineLibrary->partNumber++;
+	return part;
+}
+
+static VkPipeline getVertexInputPart(PipelineLibrary *pPipelineLibrary, VkPrimitiveTopology topology){
+	if(pPipelineLibrary->vertexInputParts[topology] != VK_NULL_HANDLE){
+		return pPipelineLibrary->vertexInputParts[topology];
+	}
+	VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = configureVertexInputStateCreateInfo();
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = configureInputAssemblyStateCreateInfo();
+	inputAssemblyStateCreateInfo.topology = topology;
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo;
+	memset(&graphicsPipelineCreateInfo, 0, sizeof(VkGraphicsPipelineCreateInfo));
+	graphicsPipelineCreateInfo.pVertexInputState = &vertexInputStateCreateInfo;
+	graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssemblyStateCreateInfo;
+	pPipelineLibrary->vertexInputParts[topology] = createPipelinePart(pPipelineLibrary, &graphicsPipelineCreateInfo, VK_NULL_HANDLE, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+	return pPipelineLibrary->vertexInputParts[topology];
+}
+
+static VkBool32 isSameRenderTarget(RenderTarget *pFirstTarget, RenderTarget *pSecondTarget){
+	if(pFirstTarget->renderPass != VK_NULL_HANDLE || pSecondTarget->renderPass != VK_NULL_HANDLE){
+		return pFirstTarget->renderPass == pSecondTarget->renderPass;
+	}
+	return pFirstTarget->colorFormat == pSecondTarget->colorFormat && pFirstTarget->viewMask == pSecondTarget->viewMask;
+}
+
+static VkPipeline getFragmentOutputPart(PipelineLibrary *pPipelineLibrary, RenderTarget *pRenderTarget, uint32_t blendMode){
+	PipelineOutputParts *pOutputParts = VK_NULL_HANDLE;
+	for(uint32_t i = 0; i < pPipelineLibrary->outputNumber; i++){
+		if(isSameRenderTarget(&pPipelineLibrary->outputs[i].renderTarget, pRenderTarget)){
+			pOutputParts = &pPipelineLibrary->outputs[i];
+		}
+	}
+	if(pOutputParts == VK_NULL_HANDLE){
+		if(pPipelineLibrary->outputNumber == PIPELINE_LIBRARY_MAX_RENDER_TARGETS){
+			printf("VkPipelineException : too many render targets in the pipeline library\n");
+			return VK_NULL_HANDLE;
+		}
+		pOutputParts = &pPipelineLibrary->outputs[pPipelineLibrary->outputNumber++];
+		memset(pOutputParts, 0, sizeof(PipelineOutputParts));
+		pOutputParts->renderTarget = *pRenderTarget;
+	}
+	if(pOutputParts->parts[blendMode] != VK_NULL_HANDLE){
+		return pOutputParts->parts[blendMode];
+	}
+
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = configureMultisampleStateCreateInfo();
+	VkPipelineColorBlendAttachmentState colorBlendAttachmentState = configureBlendModeAttachmentState(blendMode);
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = configureColorBlendStateCreateInfo(&colorBlendAttachmentState);
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo;
+	memset(&graphicsPipelineCreateInfo, 0, sizeof(VkGraphicsPipelineCreateInfo));
+	graphicsPipelineCreateInfo.pMultisampleState = &multisampleStateCreateInfo;
+	graphicsPipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+	pOutputParts->parts[blendMode] = createPipelinePart(pPipelineLibrary, &graphicsPipelineCreateInfo, &pOutputParts->renderTarget, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+	return pOutputParts->parts[blendMode];
+}
+
+static void createShaderParts(PipelineLibrary *pPipelineLibrary, PipelineShaders *pShaders){
+	char entryName[] = "main";
+	VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo = configureVertexShaderStageCreateInfo(&pShaders->vertexShaderModule, entryName);
+	VkPipelineShaderStageCreateInfo fragmentShaderStageCreateInfo = configureFragmentShaderStageCreateInfo(&pShaders->fragmentShaderModule, entryName);
+	// Viewport et scissor sont dynamiques, leur taille n'a pas d'importance
+	VkExtent2D extent = {1, 1};
+	VkViewport viewport = configureViewport(&extent);
+	VkRect2D scissor = configureScissor(&extent, 0, 0, 0, 0);
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo = configureViewportStateCreateInfo(&viewport, &scissor);
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = configureRasterizationStateCreateInfo();
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = configureMultisampleStateCreateInfo();
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = configureDynamicStateCreateInfo();
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo;
+	memset(&graphicsPipelineCreateInfo, 0, sizeof(VkGraphicsPipelineCreateInfo));
+	graphicsPipelineCreateInfo.stageCount = 1;
+	graphicsPipelineCreateInfo.pStages = &vertexShaderStageCreateInfo;
+	graphicsPipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+	graphicsPipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
+	graphicsPipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+	graphicsPipelineCreateInfo.layout = pShaders->pipelineLayout;
+	pShaders->preRasterizationPart = createPipelinePart(pPipelineLibrary, &graphicsPipelineCreateInfo, &pShaders->renderTarget, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+
+	memset(&graphicsPipelineCreateInfo, 0, sizeof(VkGraphicsPipelineCreateInfo));
+	graphicsPipelineCreateInfo.stageCount = 1;
+	graphicsPipelineCreateInfo.pStages = &fragmentShaderStageCreateInfo;
+	graphicsPipelineCreateInfo.pMultisampleState = &multisampleStateCreateInfo;
+	graphicsPipelineCreateInfo.layout = pShaders->pipelineLayout;
+	pShaders->fragmentShaderPart = createPipelinePart(pPipelineLibrary, &graphicsPipelineCreateInfo, &pShaders->renderTarget, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+}
+
+static VkPipeline linkPipelineParts(PipelineLibrary *pPipelineLibrary, PipelineShaders *pShaders, VkPipeline *pParts, VkPipelineCreateFlags flags){
+	VkPipelineLibraryCreateInfoKHR libraryCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+		VK_NULL_HANDLE,
+		4,
+		pParts
+	};
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo;
+	memset(&graphicsPipelineCreateInfo, 0, sizeof(VkGraphicsPipelineCreateInfo));
+	graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	graphicsPipelineCreateInfo.pNext = &libraryCreateInfo;
+	graphicsPipelineCreateInfo.flags = flags;
+	graphicsPipelineCreateInfo.layout = pShaders->pipelineLayout;
+	graphicsPipelineCreateInfo.renderPass = pShaders->renderTarget.renderPass;
+	graphicsPipelineCreateInfo.basePipelineIndex = -1;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	if(vkCreateGraphicsPipelines(pPipelineLibrary->device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &pipeline) != VK_SUCCESS){
+		printf("VkPipelineException : unable to link a pipeline variant\n");
+		return VK_NULL_HANDLE;
+	}
+	return pipeline;
+}
+
+static VkPipeline createMonolithicVariant(PipelineLibrary *pPipelineLibrary, PipelineShaders *pShaders, VkPrimitiveTopology topology, uint32_t blendMode){
+	char entryName[] = "main";
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfo[] = {
+		configureVertexShaderStageCreateInfo(&pShaders->vertexShaderModule, entryName),
+		configureFragmentShaderStageCreateInfo(&pShaders->fragmentShaderModule, entryName)
+	};
+	VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = configureVertexInputStateCreateInfo();
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = configureInputAssemblyStateCreateInfo();
+	inputAssemblyStateCreateInfo.topology = topology;
+	VkExtent2D extent = {1, 1};
+	VkViewport viewport = configureViewport(&extent);
+	VkRect2D scissor = configureScissor(&extent, 0, 0, 0, 0);
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo = configureViewportStateCreateInfo(&viewport, &scissor);
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = configureRasterizationStateCreateInfo();
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = configureMultisampleStateCreateInfo();
+	VkPipelineColorBlendAttachmentState colorBlendAttachmentState = configureBlendModeAttachmentState(blendMode);
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = configureColorBlendStateCreateInfo(&colorBlendAttachmentState);
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = configureDynamicStateCreateInfo();
+	VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		chainRenderingCreateInfo(&pShaders->renderTarget, &renderingCreateInfo, VK_NULL_HANDLE),
+		0,
+		2,
+		shaderStageCreateInfo,
+		&vertexInputStateCreateInfo,
+		&inputAssemblyStateCreateInfo,
+		VK_NULL_HANDLE,
+		&viewportStateCreateInfo,
+		&rasterizationStateCreateInfo,
+		&multisampleStateCreateInfo,
+		VK_NULL_HANDLE,
+		&colorBlendStateCreateInfo,
+		&dynamicStateCreateInfo,
+		pShaders->pipelineLayout,
+		pShaders->renderTarget.renderPass,
+		0,
+		VK_NULL_HANDLE,
+		-1
+	};
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	if(vkCreateGraphicsPipelines(pPipelineLibrary->device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &pipeline) != VK_SUCCESS){
+		printf("VkPipelineException : unable to compile a pipeline variant\n");
+		return VK_NULL_HANDLE;
+	}
+	return pipeline;
+}
+
+static void *runPipelineLinker(void *pArg){
+	PipelineLibrary *pPipelineLibrary = (PipelineLibrary *)pArg;
+	TRACE_THREAD("pipeline linker");
+	// Les variantes optimisées se compilent en arrière-plan, hors de toute frame
+	ignoreHeapAllocations();
+	pthread_mutex_lock(&pPipelineLibrary->mutex);
+	while(1){
+		while(pPipelineLibrary->isRunning && pPipelineLibrary->nextUpgrade == pPipelineLibrary->upgradeNumber){
+			pthread_cond_wait(&pPipelineLibrary->condition, &pPipelineLibrary->mutex);
+		}
+		if(!pPipelineLibrary->isRunning){
+			break;
+		}
+		PipelineUpgrade *pUpgrade = &pPipelineLibrary->upgrades[pPipelineLibrary->nextUpgrade++];
+		PipelineShaders *pShaders = &pPipelineLibrary->shaders[pUpgrade->shaders];
+		// Les parties existent déjà et ne changent plus, l'édition de liens se fait sans le verrou
+		VkPipeline parts[] = {
+			pPipelineLibrary->vertexInputParts[pUpgrade->topology],
+			pShaders->preRasterizationPart,
+			pShaders->fragmentShaderPart,
+			getFragmentOutputPart(pPipelineLibrary, &pShaders->renderTarget, pUpgrade->blendMode)
+		};
+		pthread_mutex_unlock(&pPipelineLibrary->mutex);
+
+		double startTime = glfwGetTime();
+		TRACE_BEGIN("link optimized pipeline");
+		VkPipeline pipeline = linkPipelineParts(pPipelineLibrary, pShaders, parts, VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT);
+		TRACE_END();
+		double optimizedTime = glfwGetTime() - startTime;
+
+		pthread_mutex_lock(&pPipelineLibrary->mutex);
+		if(pipeline == VK_NULL_HANDLE){
+			// La variante rapide reste en place
+			pUpgrade->isDone = VK_TRUE;
+		}else{
+			pUpgrade->optimizedPipeline = pipeline;
+			pPipelineLibrary->optimizedNumber++;
+			pPipelineLibrary->optimizedTime += optimizedTime;
+		}
+	}
+	pthread_mutex_unlock(&pPipelineLibrary->mutex);
+	return VK_NULL_HANDLE;
+}
+
+PipelineLibrary *createPipelineLibrary(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice){
+	PipelineLibrary *pPipelineLibrary = (PipelineLibrary *)malloc(sizeof(PipelineLibrary));
+	if(pPipelineLibrary == VK_NULL_HANDLE){
+		printf("VkPipelineException : unable to allocate the pipeline library\n");
+		return VK_NULL_HANDLE;
+	}
+	memset(pPipelineLibrary, 0, sizeof(PipelineLibrary));
+	pPipelineLibrary->device = *pDevice;
+	pPipelineLibrary->isSupported = getGraphicsPipelineLibrarySupport(pPhysicalDevice);
+	pthread_mutex_init(&pPipelineLibrary->mutex, VK_NULL_HANDLE);
+	pthread_cond_init(&pPipelineLibrary->condition, VK_NULL_HANDLE);
+
+	// Sans l'extension chaque variante est compilée en entier, il n'y a rien à optimiser en arrière-plan
+	if(pPipelineLibrary->isSupported){
+		pPipelineLibrary->isRunning = 1;
+		if(pthread_create(&pPipelineLibrary->thread, VK_NULL_HANDLE, runPipelineLinker, pPipelineLibrary) == 0){
+			pPipelineLibrary->isStarted = 1;
+		}else{
+			printf("VkPipelineException : unable to start the link thread, variants stay fast linked\n");
+			pPipelineLibrary->isRunning = 0;
+		}
+	}
+	return pPipelineLibrary;
+}
+
+void deletePipelineLibrary(VkDevice *pDevice, PipelineLibrary **ppPipelineLibrary){
+	PipelineLibrary *pPipelineLibrary = *ppPipelineLibrary;
+	if(pPipelineLibrary->isStarted){
+		pthread_mutex_lock(&pPipelineLibrary->mutex);
+		pPipelineLibrary->isRunning = 0;
+		pthread_cond_broadcast(&pPipelineLibrary->condition);
+		pthread_mutex_unlock(&pPipelineLibrary->mutex);
+		pthread_join(pPipelineLibrary->thread, VK_NULL_HANDLE);
+	}
+	for(uint32_t i = 0; i < pPipelineLibrary->upgradeNumber; i++){
+		if(!pPipelineLibrary->upgrades[i].isDone){
+			vkDestroyPipeline(*pDevice, pPipelineLibrary->upgrades[i].optimizedPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+		}
+	}
+	for(uint32_t i = 0; i < pPipelineLibrary->retiredNumber; i++){
+		vkDestroyPipeline(*pDevice, pPipelineLibrary->retiredPipelines[i], getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	}
+	for(uint32_t i = 0; i < pPipelineLibrary->shaderNumber; i++){
+		PipelineShaders *pShaders = &pPipelineLibrary->shaders[i];
+		vkDestroyPipeline(*pDevice, pShaders->fragmentShaderPart, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+		vkDestroyPipeline(*pDevice, pShaders->preRasterizationPart, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+		vkDestroyShaderModule(*pDevice, pShaders->fragmentShaderModule, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE));
+		vkDestroyShaderModule(*pDevice, pShaders->vertexShaderModule, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE));
+	}
+	for(uint32_t i = 0; i < pPipelineLibrary->outputNumber; i++){
+		for(uint32_t j = 0; j < PIPELINE_BLEND_MODE_NUMBER; j++){
+			vkDestroyPipeline(*pDevice, pPipelineLibrary->outputs[i].parts[j], getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+		}
+	}
+	for(uint32_t i = 0; i < PIPELINE_TOPOLOGY_NUMBER; i++){
+		vkDestroyPipeline(*pDevice, pPipelineLibrary->vertexInputParts[i], getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	}
+	pthread_cond_destroy(&pPipelineLibrary->condition);
+	pthread_mutex_destroy(&pPipelineLibrary->mutex);
+	free(pPipelineLibrary);
+	*ppPipelineLibrary = VK_NULL_HANDLE;
+}
+
+uint32_t addPipelineShaders(PipelineLibrary *pPipelineLibrary, VkPipelineLayout *pPipelineLayout, RenderTarget *pRenderTarget, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule){
+	if(pPipelineLibrary->shaderNumber == PIPELINE_LIBRARY_MAX_SHADERS){
+		printf("VkPipelineException : too many shader sets in the pipeline library\n");
+		return PIPELINE_LIBRARY_INVALID_INDEX;
+	}
+	pthread_mutex_lock(&pPipelineLibrary->mutex);
+	uint32_t shaders = pPipelineLibrary->shaderNumber++;
+	PipelineShaders *pShaders = &pPipelineLibrary->shaders[shaders];
+	memset(pShaders, 0, sizeof(PipelineShaders));
+	pShaders->pipelineLayout = *pPipelineLayout;
+	pShaders->renderTarget = *pRenderTarget;
+	pShaders->vertexShaderModule = *pVertexShaderModule;
+	pShaders->fragmentShaderModule = *pFragmentShaderModule;
+	if(pPipelineLibrary->isSupported){
+		// Les parties compilées n'ont plus besoin des modules
+		createShaderParts(pPipelineLibrary, pShaders);
+		vkDestroyShaderModule(pPipelineLibrary->device, pShaders->fragmentShaderModule, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE));
+		vkDestroyShaderModule(pPipelineLibrary->device, pShaders->vertexShaderModule, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE));
+		pShaders->fragmentShaderModule = VK_NULL_HANDLE;
+		pShaders->vertexShaderModule = VK_NULL_HANDLE;
+	}
+	pthread_mutex_unlock(&pPipelineLibrary->mutex);
+	return shaders;
+}
+
+void createPipelineVariant(PipelineLibrary *pPipelineLibrary, uint32_t shaders, VkPrimitiveTopology topology, uint32_t blendMode, VkPipeline *pPipeline){
+	*pPipeline = VK_NULL_HANDLE;
+	if(shaders >= pPipelineLibrary->shaderNumber || (uint32_t)topology >= PIPELINE_TOPOLOGY_NUMBER || blendMode >= PIPELINE_BLEND_MODE_NUMBER){
+		printf("VkPipelineException : invalid pipeline variant %u, topology %d, blend mode %u\n", shaders, topology, blendMode);
+		return;
+	}
+	PipelineShaders *pShaders = &pPipelineLibrary->shaders[shaders];
+	if(!pPipelineLibrary->isSupported){
+		double startTime = glfwGetTime();
+		*pPipeline = createMonolithicVariant(pPipelineLibrary, pShaders, topology, blendMode);
+		pPipelineLibrary->linkTime += glfwGetTime() - startTime;
+		pPipelineLibrary->linkNumber++;
+		return;
+	}
+
+	pthread_mutex_lock(&pPipelineLibrary->mutex);
+	VkPipeline parts[] = {
+		getVertexInputPart(pPipelineLibrary, topology),
+		pShaders->preRasterizationPart,
+		pShaders->fragmentShaderPart,
+		getFragmentOutputPart(pPipelineLibrary, &pShaders->renderTarget, blendMode)
+	};
+	if(parts[0] == VK_NULL_HANDLE || parts[1] == VK_NULL_HANDLE || parts[2] == VK_NULL_HANDLE || parts[3] == VK_NULL_HANDLE){
+		pthread_mutex_unlock(&pPipelineLibrary->mutex);
+		return;
+	}
+	// Édition de liens rapide tout de suite, la version optimisée suivra
+	double startTime = glfwGetTime();
+	*pPipeline = linkPipelineParts(pPipelineLibrary, pShaders, parts, 0);
+	pPipelineLibrary->linkTime += glfwGetTime() - startTime;
+	pPipelineLibrary->linkNumber++;
+	if(*pPipeline != VK_NULL_HANDLE && pPipelineLibrary->isStarted && pPipelineLibrary->upgradeNumber < PIPELINE_LIBRARY_MAX_UPGRADES){
+		PipelineUpgrade *pUpgrade = &pPipelineLibrary->upgrades[pPipelineLibrary->upgradeNumber++];
+		pUpgrade->shaders = shaders;
+		pUpgrade->topology = topology;
+		pUpgrade->blendMode = blendMode;
+		pUpgrade->pPipeline = pPipeline;
+		pUpgrade->linkedPipeline = *pPipeline;
+		pUpgrade->optimizedPipeline = VK_NULL_HANDLE;
+		pUpgrade->isDone = VK_FALSE;
+		pthread_cond_signal(&pPipelineLibrary->condition);
+	}
+	pthread_mutex_unlock(&pPipelineLibrary->mutex);
+}
+
+VkBool32 applyPipelineLibrary(PipelineLibrary *pPipelineLibrary){
+	// Le thread d'édition de liens ne garde le verrou que le temps de sa comptabilité, on ne l'attend jamais
+	if(pthread_mutex_trylock(&pPipelineLibrary->mutex) != 0){
+		return VK_FALSE;
+	}
+	VkBool32 isSwapped = VK_FALSE;
+	for(uint32_t i = 0; i < pPipelineLibrary->upgradeNumber && pPipelineLibrary->retiredNumber < PIPELINE_LIBRARY_MAX_RETIRED; i++){
+		PipelineUpgrade *pUpgrade = &pPipelineLibrary->upgrades[i];
+		if(pUpgrade->isDone || pUpgrade->optimizedPipeline == VK_NULL_HANDLE){
+			continue;
+		}
+		// Si le propriétaire a remplacé sa variante entre-temps, la version optimisée n'a jamais servi
+		if(*pUpgrade->pPipeline == pUpgrade->linkedPipeline){
+			pPipelineLibrary->retiredPipelines[pPipelineLibrary->retiredNumber++] = pUpgrade->linkedPipeline;
+			*pUpgrade->pPipeline = pUpgrade->optimizedPipeline;
+			isSwapped = VK_TRUE;
+		}else{
+			vkDestroyPipeline(pPipelineLibrary->device, pUpgrade->optimizedPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+		}
+		pUpgrade->isDone = VK_TRUE;
+	}
+	pthread_mutex_unlock(&pPipelineLibrary->mutex);
+	return isSwapped;
+}
+
+void releasePipelineLibrary(PipelineLibrary *pPipelineLibrary, DeletionQueue *pDeletionQueue){
+	for(uint32_t i = 0; i < pPipelineLibrary->retiredNumber; i++){
+		retireObject(pDeletionQueue, VK_OBJECT_TYPE_PIPELINE, (uint64_t)pPipelineLibrary->retiredPipelines[i]);
+	}
+	pPipelineLibrary->retiredNumber = 0;
+}
+
+void printPipelineLibrary(PipelineLibrary *pPipelineLibrary){
+	pthread_mutex_lock(&pPipelineLibrary->mutex);
+	if(!pPipelineLibrary->isSupported){
+		printf("pipeline library : monolithic, %u variants, %.3f ms per compile\n", pPipelineLibrary->linkNumber,
+			pPipelineLibrary->linkNumber != 0 ? 1000.0 * pPipelineLibrary->linkTime / pPipelineLibrary->linkNumber : 0.0);
+	}else{
+		printf("pipeline library : %u parts, %.3f ms per part\n", pPipelineLibrary->partNumber,
+			pPipelineLibrary->partNumber != 0 ? 1000.0 * pPipelineLibrary->partTime / pPipelineLibrary->partNumber : 0.0);
+		printf("  %u fast linked variants, %.1f us per link\n", pPipelineLibrary->linkNumber,
+			pPipelineLibrary->linkNumber != 0 ? 1000000.0 * pPipelineLibrary->linkTime / pPipelineLibrary->linkNumber : 0.0);
+		printf("  %u optimized variants, %.3f ms per link\n", pPipelineLibrary->optimizedNumber,
+			pPipelineLibrary->optimizedNumber != 0 ? 1000.0 * pPipelineLibrary->optimizedTime / pPipelineLibrary->optimizedNumber : 0.0);
+	}
+	pthread_mutex_unlock(&pPipelineLibrary->mutex);
+}
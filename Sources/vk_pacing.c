@@ -0,0 +1,132 @@
+#ifdef __linux__
+#include <errno.h>
+#include <time.h>
+#endif
+
+#include "../Headers/glfw_fun.h"
+#include "../Headers/vk_fun.h"
+
+static uint64_t getMonotonicTime(){
+#ifdef __linux__
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#else
+	return (uint64_t)(glfwGetTime() * 1e9);
+#endif
+}
+
+/**
+ * Dort jusqu'à une date absolue et renvoie le retard du réveil
+ */
+static uint64_t sleepUntil(uint64_t wakeTime){
+#ifdef __linux__
+	struct timespec wakeSpec = {
+		(time_t)(wakeTime / 1000000000ull),
+		(long)(wakeTime % 1000000000ull)
+	};
+	// Une date absolue ne dérive pas quand le sommeil est interrompu par un signal
+	// Toute autre erreur laisse l'attente active finir la frame, signalée une seule fois
+	static int isSleepFailed = 0;
+	int result;
+	while((result = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeSpec, VK_NULL_HANDLE)) == EINTR){
+	}
+	if(result != 0 && !isSleepFailed){
+		printf("VkPacingException : clock_nanosleep failed with error %d, the frame limiter only spins\n", result);
+		isSleepFailed = 1;
+	}
+#endif
+	uint64_t now = getMonotonicTime();
+	return now > wakeTime ? now - wakeTime : 0;
+}
+
+FrameLimiter createFrameLimiter(double frequency){
+	FrameLimiter frameLimiter;
+	memset(&frameLimiter, 0, sizeof(FrameLimiter));
+	frameLimiter.minInterval = UINT64_MAX;
+	if(frequency <= 0.0){
+		return frameLimiter;
+	}
+	frameLimiter.period = (uint64_t)(1e9 / frequency);
+
+	// Calibration : quelques sommeils courts donnent le retard de réveil typique de cette machine
+	uint64_t maxOversleep = 0;
+	double oversleepSum = 0.0;
+	for(uint32_t i = 0; i < FRAME_LIMITER_CALIBRATION_SLEEPS; i++){
+		uint64_t oversleep = sleepUntil(getMonotonicTime() + 500000);
+		oversleepSum += (double)oversleep;
+		maxOversleep = oversleep > maxOversleep ? oversleep : maxOversleep;
+	}
+	frameLimiter.meanOversleep = oversleepSum / FRAME_LIMITER_CALIBRATION_SLEEPS;
+	frameLimiter.spinMargin = maxOversleep + maxOversleep / 4;
+	frameLimiter.spinMargin = frameLimiter.spinMargin < FRAME_LIMITER_MIN_SPIN ? FRAME_LIMITER_MIN_SPIN : frameLimiter.spinMargin > FRAME_LIMITER_MAX_SPIN ? FRAME_LIMITER_MAX_SPIN : frameLimiter.spinMargin;
+	return frameLimiter;
+}
+
+void waitFrameLimiter(FrameLimiter *pFrameLimiter){
+	if(pFrameLimiter->period == 0){
+		return;
+	}
+	uint64_t now = getMonotonicTime();
+	if(pFrameLimiter->deadline == 0){
+		pFrameLimiter->deadline = now;
+	}
+	uint64_t deadline = pFrameLimiter->deadline;
+	if(deadline > now + pFrameLimiter->spinMargin){
+		uint64_t oversleep = sleepUntil(deadline - pFrameLimiter->spinMargin);
+		pFrameLimiter->meanOversleep += ((double)oversleep - pFrameLimiter->meanOversleep) / 64.0;
+		pFrameLimiter->maxOversleep = oversleep > pFrameLimiter->maxOversleep ? oversleep : pFrameLimiter->maxOversleep;
+		// Réveil plus tardif que la marge : on l'élargit tout de suite, sinon elle se rapproche lentement du retard moyen
+		uint64_t targetMargin = (uint64_t)(2.0 * pFrameLimiter->meanOversleep);
+		targetMargin = targetMargin < FRAME_LIMITER_MIN_SPIN ? FRAME_LIMITER_MIN_SPIN : targetMargin;
+		if(oversleep > pFrameLimiter->spinMargin){
+			pFrameLimiter->spinMargin = oversleep + oversleep / 4;
+		}else if(pFrameLimiter->spinMargin > targetMargin){
+			pFrameLimiter->spinMargin -= (pFrameLimiter->spinMargin - targetMargin) / 64;
+		}
+		pFrameLimiter->spinMargin = pFrameLimiter->spinMargin > FRAME_LIMITER_MAX_SPIN ? FRAME_LIMITER_MAX_SPIN : pFrameLimiter->spinMargin;
+	}
+	// Les dernières centaines de microsecondes sont attendues activement
+	do{
+		now = getMonotonicTime();
+	}while(now < deadline);
+
+	if(pFrameLimiter->lastFrameTime != 0){
+		uint64_t interval = now - pFrameLimiter->lastFrameTime;
+		pFrameLimiter->intervalNumber++;
+		pFrameLimiter->intervalSum += (double)interval;
+		pFrameLimiter->intervalSquareSum += (double)interval * (double)interval;
+		pFrameLimiter->minInterval = interval < pFrameLimiter->minInterval ? interval : pFrameLimiter->minInterval;
+		pFrameLimiter->maxInterval = interval > pFrameLimiter->maxInterval ? interval : pFrameLimiter->maxInterval;
+	}
+	pFrameLimiter->lastFrameTime = now;
+
+	// Une frame trop longue décale l'échéance au lieu d'enchaîner les frames suivantes pour rattraper le retard
+	pFrameLimiter->deadline += pFrameLimiter->period;
+	if(pFrameLimiter->deadline <= now){
+		pFrameLimiter->deadline = now + pFrameLimiter->period;
+		pFrameLimiter->missedNumber++;
+	}
+}
+
+double getFrameLimiterJitter(FrameLimiter *pFrameLimiter){
+	if(pFrameLimiter->intervalNumber < 2){
+		return 0.0;
+	}
+	double mean = pFrameLimiter->intervalSum / (double)pFrameLimiter->intervalNumber;
+	double variance = pFrameLimiter->intervalSquareSum / (double)pFrameLimiter->intervalNumber - mean * mean;
+	return variance > 0.0 ? sqrt(variance) * 1e-6 : 0.0;
+}
+
+void printFrameLimiter(FrameLimiter *pFrameLimiter){
+	if(pFrameLimiter->period == 0 || pFrameLimiter->intervalNumber == 0){
+		return;
+	}
+	double mean = pFrameLimiter->intervalSum / (double)pFrameLimiter->intervalNumber;
+	printf("frame limiter : %.2f Hz targeted, %.2f Hz achieved over %llu frames\n", 1e9 / (double)pFrameLimiter->period, 1e9 / mean,
+		(unsigned long long)pFrameLimiter->intervalNumber);
+	printf("  interval %.3f ms, jitter %.3f ms, min %.3f ms, max %.3f ms, %llu deadlines missed\n", mean * 1e-6, getFrameLimiterJitter(pFrameLimiter),
+		(double)pFrameLimiter->minInterval * 1e-6, (double)pFrameLimiter->maxInterval * 1e-6, (unsigned long long)pFrameLimiter->missedNumber);
+	printf("  wake-up lateness %.3f ms average, %.3f ms max, spin margin %.3f ms\n", pFrameLimiter->meanOversleep * 1e-6,
+		(double)pFrameLimiter->maxOversleep * 1e-6, (double)pFrameLimiter->spinMargin * 1e-6);
+}
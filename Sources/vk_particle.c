@@ -0,0 +1,376 @@
+#include "../Headers/particle_fun.h"
+
+// Taille d'une particule côté shader (std430) : position, vitesse, couleur, vie, vie max, taille
+#define PARTICLE_SIZE 48
+// La commande indirecte est suivie du compteur de la free list
+#define PARTICLE_STATE_SIZE 32
+// La commande indexée est suivie du nombre de draws, lu par vkCmdDrawIndexedIndirectCountKHR
+#define PARTICLE_DRAW_SIZE 24
+#define PARTICLE_DRAW_COUNT_OFFSET 20
+
+static VkBuffer createDeviceBuffer(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkDeviceMemory *pMemory){
+	VkBuffer buffer = createBuffer(pDevice, size, usage);
+	*pMemory = allocateBufferMemory(pPhysicalDevice, pDevice, &buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	return buffer;
+}
+
+static int initializeParticleBuffers(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, ParticleSystem *pParticleSystem){
+	VkDeviceSize freeListSize = (VkDeviceSize)pParticleSystem->capacity * sizeof(uint32_t);
+	VkBuffer stagingBuffer = createBuffer(pDevice, freeListSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	VkDeviceMemory stagingMemory = allocateBufferMemory(pPhysicalDevice, pDevice, &stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if(stagingMemory == VK_NULL_HANDLE){
+		deleteBuffer(pDevice, &stagingBuffer);
+		return -1;
+	}
+
+	// Au départ toutes les particules sont mortes et leurs indices sont libres
+	uint32_t *pFreeIndices = VK_NULL_HANDLE;
+	vkMapMemory(*pDevice, stagingMemory, 0, freeListSize, 0, (void **)&pFreeIndices);
+	for(uint32_t i = 0; i < pParticleSystem->capacity; i++){
+		pFreeIndices[i] = i;
+	}
+	vkUnmapMemory(*pDevice, stagingMemory);
+
+	uint32_t state[PARTICLE_STATE_SIZE / sizeof(uint32_t)] = {4, 0, 0, 0, pParticleSystem->capacity, 0, 0, 0};
+	uint32_t draw[PARTICLE_DRAW_SIZE / sizeof(uint32_t)] = {6, 0, 0, 0, 0, 0};
+	// Deux triangles par quad, les coins sont déduits de gl_VertexIndex
+	uint16_t quadIndices[] = {0, 1, 2, 2, 1, 3};
+	VkBufferCopy bufferCopy = {
+		0,
+		0,
+		freeListSize
+	};
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(pDevice, pCommandPool);
+	vkCmdFillBuffer(commandBuffer, pParticleSystem->particleBuffer, 0, VK_WHOLE_SIZE, 0);
+	vkCmdCopyBuffer(commandBuffer, stagingBuffer, pParticleSystem->freeListBuffer, 1, &bufferCopy);
+	vkCmdUpdateBuffer(commandBuffer, pParticleSystem->stateBuffer, 0, PARTICLE_STATE_SIZE, state);
+	vkCmdUpdateBuffer(commandBuffer, pParticleSystem->drawBuffer, 0, PARTICLE_DRAW_SIZE, draw);
+	vkCmdUpdateBuffer(commandBuffer, pParticleSystem->indexBuffer, 0, sizeof(quadIndices), quadIndices);
+	endSingleTimeCommands(pDevice, pCommandPool, pQueue, &commandBuffer);
+
+	freeMemory(pDevice, &stagingMemory);
+	deleteBuffer(pDevice, &stagingBuffer);
+	return 0;
+}
+
+static void createParticleDescriptorSet(VkDevice *pDevice, ParticleSystem *pParticleSystem){
+	VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
+		{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE},
+		{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE},
+		{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE},
+		{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE},
+		{4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE},
+		{5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, VK_NULL_HANDLE},
+		{6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, VK_NULL_HANDLE}
+	};
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		7,
+		descriptorSetLayoutBindings
+	};
+	vkCreateDescriptorSetLayout(*pDevice, &descriptorSetLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &pParticleSystem->descriptorSetLayout);
+
+	VkDescriptorPoolSize descriptorPoolSizes[] = {
+		{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6},
+		{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}
+	};
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		2,
+		descriptorPoolSizes
+	};
+	vkCreateDescriptorPool(*pDevice, &descriptorPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pParticleSystem->descriptorPool);
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pParticleSystem->descriptorPool,
+		1,
+		&pParticleSystem->descriptorSetLayout
+	};
+	vkAllocateDescriptorSets(*pDevice, &descriptorSetAllocateInfo, &pParticleSystem->descriptorSet);
+
+	// Le bloc de paramètres de chaque image est sélectionné par l'offset dynamique
+	VkDescriptorBufferInfo descriptorBufferInfos[] = {
+		{pParticleSystem->particleBuffer, 0, VK_WHOLE_SIZE},
+		{pParticleSystem->freeListBuffer, 0, VK_WHOLE_SIZE},
+		{pParticleSystem->aliveListBuffer, 0, VK_WHOLE_SIZE},
+		{pParticleSystem->stateBuffer, 0, VK_WHOLE_SIZE},
+		{pParticleSystem->frameBuffer, 0, sizeof(ParticleFrame)},
+		{pParticleSystem->visibleListBuffer, 0, VK_WHOLE_SIZE},
+		{pParticleSystem->drawBuffer, 0, VK_WHOLE_SIZE}
+	};
+	VkWriteDescriptorSet writeDescriptorSets[7];
+	for(uint32_t i = 0; i < 7; i++){
+		writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptorSets[i].pNext = VK_NULL_HANDLE;
+		writeDescriptorSets[i].dstSet = pParticleSystem->descriptorSet;
+		writeDescriptorSets[i].dstBinding = i;
+		writeDescriptorSets[i].dstArrayElement = 0;
+		writeDescriptorSets[i].descriptorCount = 1;
+		writeDescriptorSets[i].descriptorType = i == 4 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writeDescriptorSets[i].pImageInfo = VK_NULL_HANDLE;
+		writeDescriptorSets[i].pBufferInfo = &descriptorBufferInfos[i];
+		writeDescriptorSets[i].pTexelBufferView = VK_NULL_HANDLE;
+	}
+	vkUpdateDescriptorSets(*pDevice, 7, writeDescriptorSets, 0, VK_NULL_HANDLE);
+}
+
+static VkPipeline createParticleComputePipeline(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout, VkShaderModule *pShaderModule){
+	VkComputePipelineCreateInfo computePipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		{
+			VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			VK_NULL_HANDLE,
+			0,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			*pShaderModule,
+			"main",
+			VK_NULL_HANDLE
+		},
+		*pPipelineLayout,
+		VK_NULL_HANDLE,
+		-1
+	};
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	vkCreateComputePipelines(*pDevice, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &pipeline);
+	return pipeline;
+}
+
+static VkPipeline createParticleDrawPipeline(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, RenderTarget *pRenderTarget, VkExtent2D *pExtent){
+	char entryName[] = "main";
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfo[] = {
+		configureVertexShaderStageCreateInfo(pVertexShaderModule, entryName),
+		configureFragmentShaderStageCreateInfo(pFragmentShaderModule, entryName)
+	};
+
+	// Les particules sont lues directement dans le storage buffer, pas d'attribut de sommet
+	VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = configureVertexInputStateCreateInfo();
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = configureInputAssemblyStateCreateInfo();
+	VkViewport viewport = configureViewport(pExtent);
+	VkRect2D scissor = configureScissor(pExtent, 0, 0, 0, 0);
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo = configureViewportStateCreateInfo(&viewport, &scissor);
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = configureRasterizationStateCreateInfo();
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = configureMultisampleStateCreateInfo();
+
+	// Mélange additif, l'ordre des particules n'a donc pas d'importance
+	VkPipelineColorBlendAttachmentState colorBlendAttachmentState = configureColorBlendAttachmentState();
+	colorBlendAttachmentState.blendEnable = VK_TRUE;
+	colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = configureColorBlendStateCreateInfo(&colorBlendAttachmentState);
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = configureDynamicStateCreateInfo();
+	VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		chainRenderingCreateInfo(pRenderTarget, &renderingCreateInfo, VK_NULL_HANDLE),
+		0,
+		2,
+		shaderStageCreateInfo,
+		&vertexInputStateCreateInfo,
+		&inputAssemblyStateCreateInfo,
+		VK_NULL_HANDLE,
+		&viewportStateCreateInfo,
+		&rasterizationStateCreateInfo,
+		&multisampleStateCreateInfo,
+		VK_NULL_HANDLE,
+		&colorBlendStateCreateInfo,
+		&dynamicStateCreateInfo,
+		*pPipelineLayout,
+		pRenderTarget->renderPass,
+		0,
+		VK_NULL_HANDLE,
+		-1
+	};
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	vkCreateGraphicsPipelines(*pDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &pipeline);
+	return pipeline;
+}
+
+ParticleSystem createParticleSystem(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules, uint32_t frameNumber, uint32_t capacity){
+	ParticleSystem particleSystem;
+	memset(&particleSystem, 0, sizeof(ParticleSystem));
+	particleSystem.capacity = capacity;
+	particleSystem.viewConstants = createViewConstants();
+	particleSystem.frameNumber = frameNumber;
+	particleSystem.pendingFrame.drag = 1.5f;
+	particleSystem.pendingFrame.pixelWidth = 2.0f / pExtent->width;
+	particleSystem.pendingFrame.pixelHeight = 2.0f / pExtent->height;
+
+	VkBufferUsageFlags storageUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	particleSystem.particleBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, (VkDeviceSize)capacity * PARTICLE_SIZE, storageUsage, &particleSystem.particleMemory);
+	particleSystem.freeListBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, (VkDeviceSize)capacity * sizeof(uint32_t), storageUsage, &particleSystem.freeListMemory);
+	particleSystem.aliveListBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, (VkDeviceSize)capacity * sizeof(uint32_t), storageUsage, &particleSystem.aliveListMemory);
+	particleSystem.stateBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, PARTICLE_STATE_SIZE, storageUsage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, &particleSystem.stateMemory);
+	particleSystem.visibleListBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, (VkDeviceSize)capacity * sizeof(uint32_t), storageUsage, &particleSystem.visibleListMemory);
+	particleSystem.drawBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, PARTICLE_DRAW_SIZE, storageUsage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, &particleSystem.drawMemory);
+	particleSystem.indexBuffer = createDeviceBuffer(pPhysicalDevice, pDevice, 6 * sizeof(uint16_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, &particleSystem.indexMemory);
+
+	// Un bloc de paramètres par image de la swapchain, mappé en permanence
+	particleSystem.frameStride = (sizeof(ParticleFrame) + 255) & ~(VkDeviceSize)255;
+	particleSystem.frameBuffer = createBuffer(pDevice, particleSystem.frameStride * frameNumber, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+	particleSystem.frameMemory = allocateBufferMemory(pPhysicalDevice, pDevice, &particleSystem.frameBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	if(particleSystem.particleMemory == VK_NULL_HANDLE || particleSystem.freeListMemory == VK_NULL_HANDLE || particleSystem.aliveListMemory == VK_NULL_HANDLE
+		|| particleSystem.stateMemory == VK_NULL_HANDLE || particleSystem.visibleListMemory == VK_NULL_HANDLE || particleSystem.drawMemory == VK_NULL_HANDLE
+		|| particleSystem.indexMemory == VK_NULL_HANDLE || particleSystem.frameMemory == VK_NULL_HANDLE){
+		printf("VkParticleException : unable to allocate the buffers of %u particles\n", capacity);
+		deleteParticleSystem(pDevice, &particleSystem);
+		return particleSystem;
+	}
+	if(initializeParticleBuffers(pPhysicalDevice, pDevice, pQueue, pCommandPool, &particleSystem) != 0){
+		printf("VkParticleException : unable to initialize the free list\n");
+		deleteParticleSystem(pDevice, &particleSystem);
+		return particleSystem;
+	}
+
+	memcpy(particleSystem.pendingFrame.viewTransforms, particleSystem.viewConstants.transforms, sizeof(particleSystem.pendingFrame.viewTransforms));
+	vkMapMemory(*pDevice, particleSystem.frameMemory, 0, VK_WHOLE_SIZE, 0, (void **)&particleSystem.pFrameData);
+	for(uint32_t i = 0; i < frameNumber; i++){
+		memcpy(particleSystem.pFrameData + i * particleSystem.frameStride, &particleSystem.pendingFrame, sizeof(ParticleFrame));
+	}
+
+	createParticleDescriptorSet(pDevice, &particleSystem);
+	// Les transformations des vues poussées ne servent qu'au draw, le culling les lit dans le bloc de paramètres
+	VkPushConstantRange pushConstantRange = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		0,
+		sizeof(ViewConstants)
+	};
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&particleSystem.descriptorSetLayout,
+		1,
+		&pushConstantRange
+	};
+	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &particleSystem.pipelineLayout);
+
+	particleSystem.emitPipeline = createParticleComputePipeline(pDevice, &particleSystem.pipelineLayout, &pShaderModules[0]);
+	particleSystem.simulatePipeline = createParticleComputePipeline(pDevice, &particleSystem.pipelineLayout, &pShaderModules[1]);
+	particleSystem.cullPipeline = createParticleComputePipeline(pDevice, &particleSystem.pipelineLayout, &pShaderModules[2]);
+	particleSystem.drawPipeline = createParticleDrawPipeline(pDevice, &particleSystem.pipelineLayout, &pShaderModules[3], &pShaderModules[4], pRenderTarget, pExtent);
+
+	// Sans l'extension le draw est toujours émis, avec zéro instance quand rien n'est visible
+	if(getDrawIndirectCountSupport(pPhysicalDevice)){
+		particleSystem.cmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(*pDevice, "vkCmdDrawIndexedIndirectCountKHR");
+	}
+	return particleSystem;
+}
+
+void deleteParticleSystem(VkDevice *pDevice, ParticleSystem *pParticleSystem){
+	vkDestroyPipeline(*pDevice, pParticleSystem->drawPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipeline(*pDevice, pParticleSystem->cullPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipeline(*pDevice, pParticleSystem->simulatePipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipeline(*pDevice, pParticleSystem->emitPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipelineLayout(*pDevice, pParticleSystem->pipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+	vkDestroyDescriptorPool(*pDevice, pParticleSystem->descriptorPool, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+	vkDestroyDescriptorSetLayout(*pDevice, pParticleSystem->descriptorSetLayout, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+	if(pParticleSystem->pFrameData != VK_NULL_HANDLE){
+		vkUnmapMemory(*pDevice, pParticleSystem->frameMemory);
+	}
+	vkFreeMemory(*pDevice, pParticleSystem->frameMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->frameBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->indexMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->indexBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->drawMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->drawBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->visibleListMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->visibleListBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->stateMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->stateBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->aliveListMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->aliveListBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->freeListMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->freeListBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkFreeMemory(*pDevice, pParticleSystem->particleMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pParticleSystem->particleBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	pParticleSystem->drawPipeline = VK_NULL_HANDLE;
+}
+
+void emitParticles(ParticleSystem *pParticleSystem, float x, float y, uint32_t count, float speed, float life, uint32_t color){
+	ParticleFrame *pFrame = &pParticleSystem->pendingFrame;
+	if(pFrame->burstNumber >= PARTICLE_MAX_BURSTS || pFrame->emitNumber >= PARTICLE_MAX_EMIT){
+		return;
+	}
+	if(count > PARTICLE_MAX_EMIT - pFrame->emitNumber){
+		count = PARTICLE_MAX_EMIT - pFrame->emitNumber;
+	}
+
+	ParticleBurst *pBurst = &pFrame->bursts[pFrame->burstNumber++];
+	pBurst->x = x;
+	pBurst->y = y;
+	pBurst->speed = speed;
+	pBurst->life = life;
+	pBurst->color = color;
+	pBurst->count = count;
+	pFrame->emitNumber += count;
+}
+
+void updateParticles(ParticleSystem *pParticleSystem, uint32_t frameIndex, float deltaTime){
+	ParticleFrame *pFrame = &pParticleSystem->pendingFrame;
+	pFrame->deltaTime = deltaTime;
+	pFrame->seed = pParticleSystem->frameCounter++;
+	memcpy(pFrame->viewTransforms, pParticleSystem->viewConstants.transforms, sizeof(pFrame->viewTransforms));
+
+	// Seules quelques centaines d'octets traversent le bus, le reste du travail est sur le GPU
+	memcpy(pParticleSystem->pFrameData + frameIndex * pParticleSystem->frameStride, pFrame, sizeof(ParticleFrame));
+	pFrame->burstNumber = 0;
+	pFrame->emitNumber = 0;
+}
+
+void recordParticleUpdate(ParticleSystem *pParticleSystem, VkCommandBuffer *pCommandBuffer, uint32_t frameIndex){
+	uint32_t dynamicOffset = (uint32_t)(frameIndex * pParticleSystem->frameStride);
+
+	vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pParticleSystem->pipelineLayout, 0, 1, &pParticleSystem->descriptorSet, 1, &dynamicOffset);
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pParticleSystem->emitPipeline);
+	vkCmdDispatch(*pCommandBuffer, PARTICLE_MAX_EMIT / PARTICLE_WORKGROUP_SIZE, 1, 1);
+
+	// La simulation lit les particules émises et le compteur remis à zéro par l'émission
+	VkMemoryBarrier memoryBarrier = {
+		VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		VK_NULL_HANDLE,
+		VK_ACCESS_SHADER_WRITE_BIT,
+		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	};
+	vkCmdPipelineBarrier(*pCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pParticleSystem->simulatePipeline);
+	vkCmdDispatch(*pCommandBuffer, (pParticleSystem->capacity + PARTICLE_WORKGROUP_SIZE - 1) / PARTICLE_WORKGROUP_SIZE, 1, 1);
+
+	// Le culling lit la liste des vivantes complète, les invocations au-delà de leur nombre sortent tout de suite
+	vkCmdPipelineBarrier(*pCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pParticleSystem->cullPipeline);
+	vkCmdDispatch(*pCommandBuffer, (pParticleSystem->capacity + PARTICLE_WORKGROUP_SIZE - 1) / PARTICLE_WORKGROUP_SIZE, 1, 1);
+}
+
+void recordParticleDraw(ParticleSystem *pParticleSystem, VkCommandBuffer *pCommandBuffer, uint32_t frameIndex){
+	uint32_t dynamicOffset = (uint32_t)(frameIndex * pParticleSystem->frameStride);
+
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pParticleSystem->drawPipeline);
+	vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pParticleSystem->pipelineLayout, 0, 1, &pParticleSystem->descriptorSet, 1, &dynamicOffset);
+	recordViewConstants(pCommandBuffer, &pParticleSystem->pipelineLayout, &pParticleSystem->viewConstants);
+	vkCmdBindIndexBuffer(*pCommandBuffer, pParticleSystem->indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	if(pParticleSystem->cmdDrawIndexedIndirectCount != VK_NULL_HANDLE){
+		pParticleSystem->cmdDrawIndexedIndirectCount(*pCommandBuffer, pParticleSystem->drawBuffer, 0, pParticleSystem->drawBuffer,
+			PARTICLE_DRAW_COUNT_OFFSET, 1, sizeof(VkDrawIndexedIndirectCommand));
+	}else{
+		vkCmdDrawIndexedIndirect(*pCommandBuffer, pParticleSystem->drawBuffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
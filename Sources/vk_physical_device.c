@@ -18,10 +18,11 @@ void deletePhysicalDevices(VkPhysicalDevice **ppPhysicalDevices){
 }
 
 uint32_t getBestPhysicalDeviceIndex(VkPhysicalDevice *pPhysicalDevices, uint32_t physicalDeviceNumber){
-	VkPhysicalDeviceProperties *physicalDeviceProperties = (VkPhysicalDeviceProperties *)malloc(physicalDeviceNumber * sizeof(VkPhysicalDeviceProperties));
-	VkPhysicalDeviceMemoryProperties *physicalDeviceMemoryProperties = (VkPhysicalDeviceMemoryProperties *)malloc(physicalDeviceNumber * sizeof(VkPhysicalDeviceMemoryProperties));
+	size_t scratchMark = getScratchMark();
+	VkPhysicalDeviceProperties *physicalDeviceProperties = (VkPhysicalDeviceProperties *)allocateScratch(physicalDeviceNumber * sizeof(VkPhysicalDeviceProperties));
+	VkPhysicalDeviceMemoryProperties *physicalDeviceMemoryProperties = (VkPhysicalDeviceMemoryProperties *)allocateScratch(physicalDeviceNumber * sizeof(VkPhysicalDeviceMemoryProperties));
 
-	uint32_t discreteGPUNumber = 0, integratedGPUNumber = 0, *discreteGPUIndices = (uint32_t *)malloc(physicalDeviceNumber * sizeof(uint32_t)), *integratedGPUIndices = (uint32_t *)malloc(physicalDeviceNumber * sizeof(uint32_t));
+	uint32_t discreteGPUNumber = 0, integratedGPUNumber = 0, *discreteGPUIndices = (uint32_t *)allocateScratch(physicalDeviceNumber * sizeof(uint32_t)), *integratedGPUIndices = (uint32_t *)allocateScratch(physicalDeviceNumber * sizeof(uint32_t));
 
 	for(uint32_t i = 0; i < physicalDeviceNumber; i++){
 		vkGetPhysicalDeviceProperties(pPhysicalDevices[i], &physicalDeviceProperties[i]);
@@ -56,10 +57,7 @@ uint32_t getBestPhysicalDeviceIndex(VkPhysicalDevice *pPhysicalDevices, uint32_t
 		}
 	}
 
-	free(discreteGPUIndices);
-	free(integratedGPUIndices);
-	free(physicalDeviceMemoryProperties);
-	free(physicalDeviceProperties);
+	resetScratch(scratchMark);
 
 	return bestPhysicalDeviceIndex;
 }
@@ -73,3 +71,165 @@ uint32_t getPhysicalDeviceTotalMemory(VkPhysicalDeviceMemoryProperties *pPhysica
 	}
 	return physicalDeviceTotalMemory;
 }
+
+VkBool32 getDeviceExtensionSupport(VkPhysicalDevice *pPhysicalDevice, const char *extensionName){
+	uint32_t extensionNumber = 0;
+	vkEnumerateDeviceExtensionProperties(*pPhysicalDevice, VK_NULL_HANDLE, &extensionNumber, VK_NULL_HANDLE);
+	size_t scratchMark = getScratchMark();
+	VkExtensionProperties *extensionProperties = (VkExtensionProperties *)allocateScratch(extensionNumber * sizeof(VkExtensionProperties));
+	vkEnumerateDeviceExtensionProperties(*pPhysicalDevice, VK_NULL_HANDLE, &extensionNumber, extensionProperties);
+
+	VkBool32 isSupported = VK_FALSE;
+	for(uint32_t i = 0; i < extensionNumber; i++){
+		if(strcmp(extensionProperties[i].extensionName, extensionName) == 0){
+			isSupported = VK_TRUE;
+		}
+	}
+	resetScratch(scratchMark);
+	return isSupported;
+}
+
+VkBool32 getSynchronization2Support(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// vkGetPhysicalDeviceFeatures2 demande un device 1.1
+	if(physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1 || !getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)){
+		return VK_FALSE;
+	}
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+		VK_NULL_HANDLE,
+		VK_FALSE
+	};
+	VkPhysicalDeviceFeatures2 physicalDeviceFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		&synchronization2Features
+	};
+	vkGetPhysicalDeviceFeatures2(*pPhysicalDevice, &physicalDeviceFeatures);
+	return synchronization2Features.synchronization2;
+}
+
+VkBool32 getGraphicsPipelineLibrarySupport(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// L'extension dépend de VK_KHR_pipeline_library qui doit être activée avec elle
+	if(physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1 ||
+	   !getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+	   !getDeviceExtensionSupport(pPhysicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)){
+		return VK_FALSE;
+	}
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+		VK_NULL_HANDLE,
+		VK_FALSE
+	};
+	VkPhysicalDeviceFeatures2 physicalDeviceFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		&graphicsPipelineLibraryFeatures
+	};
+	vkGetPhysicalDeviceFeatures2(*pPhysicalDevice, &physicalDeviceFeatures);
+	return graphicsPipelineLibraryFeatures.graphicsPipelineLibrary;
+}
+
+VkBool32 getMultiviewSupport(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// Multiview fait partie du cœur depuis 1.1, aucune extension à activer
+	if(physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1){
+		return VK_FALSE;
+	}
+
+	VkPhysicalDeviceMultiviewFeatures multiviewFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES,
+		VK_NULL_HANDLE,
+		VK_FALSE,
+		VK_FALSE,
+		VK_FALSE
+	};
+	VkPhysicalDeviceFeatures2 physicalDeviceFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		&multiviewFeatures
+	};
+	vkGetPhysicalDeviceFeatures2(*pPhysicalDevice, &physicalDeviceFeatures);
+	return multiviewFeatures.multiview;
+}
+
+VkBool32 getTimelineSemaphoreSupport(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// Cœur en 1.2, l'instance ne demande que 1.1 : on passe toujours par l'extension
+	if(physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1 || !getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)){
+		return VK_FALSE;
+	}
+
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+		VK_NULL_HANDLE,
+		VK_FALSE
+	};
+	VkPhysicalDeviceFeatures2 physicalDeviceFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		&timelineSemaphoreFeatures
+	};
+	vkGetPhysicalDeviceFeatures2(*pPhysicalDevice, &physicalDeviceFeatures);
+	return timelineSemaphoreFeatures.timelineSemaphore;
+}
+
+VkBool32 getDescriptorIndexingSupport(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// Cœur en 1.2 lui aussi, VK_KHR_maintenance3 dont il dépend est déjà dans le cœur 1.1
+	if(physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1 || !getDeviceExtensionSupport(pPhysicalDevice, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)){
+		return VK_FALSE;
+	}
+
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures;
+	memset(&descriptorIndexingFeatures, 0, sizeof(VkPhysicalDeviceDescriptorIndexingFeaturesEXT));
+	descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+	VkPhysicalDeviceFeatures2 physicalDeviceFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		&descriptorIndexingFeatures
+	};
+	vkGetPhysicalDeviceFeatures2(*pPhysicalDevice, &physicalDeviceFeatures);
+	// Seules les fonctionnalités utilisées par la table de descripteurs globale sont exigées
+	return descriptorIndexingFeatures.runtimeDescriptorArray &&
+		descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+		descriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+		descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+		descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+		descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind;
+}
+
+VkBool32 getDrawIndirectCountSupport(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// Cœur en 1.2 derrière la fonctionnalité drawIndirectCount, l'extension n'en a aucune à activer
+	return physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1 &&
+		getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+}
+
+VkBool32 getDynamicRenderingSupport(VkPhysicalDevice *pPhysicalDevice){
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(*pPhysicalDevice, &physicalDeviceProperties);
+	// Cœur en 1.3, l'extension dépend de VK_KHR_depth_stencil_resolve qui dépend lui-même de VK_KHR_create_renderpass2
+	if(physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1 ||
+	   !getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) ||
+	   !getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME) ||
+	   !getDeviceExtensionSupport(pPhysicalDevice, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)){
+		return VK_FALSE;
+	}
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+		VK_NULL_HANDLE,
+		VK_FALSE
+	};
+	VkPhysicalDeviceFeatures2 physicalDeviceFeatures = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		&dynamicRenderingFeatures
+	};
+	vkGetPhysicalDeviceFeatures2(*pPhysicalDevice, &physicalDeviceFeatures);
+	return dynamicRenderingFeatures.dynamicRendering;
+}
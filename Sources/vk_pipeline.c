@@ -12,12 +12,28 @@ VkPipelineLayout createPipelineLayout(VkDevice *pDevice){
 	};
 
 	VkPipelineLayout pipelineLayout;
-	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &pipelineLayout);
+	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &pipelineLayout);
+	return pipelineLayout;
+}
+
+VkPipelineLayout createTexturePipelineLayout(VkDevice *pDevice, VkDescriptorSetLayout *pDescriptorSetLayout){
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		pDescriptorSetLayout,
+		0,
+		VK_NULL_HANDLE
+	};
+
+	VkPipelineLayout pipelineLayout;
+	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &pipelineLayout);
 	return pipelineLayout;
 }
 
 void deletePipelineLayout(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout){
-	vkDestroyPipelineLayout(*pDevice, *pPipelineLayout, VK_NULL_HANDLE);
+	vkDestroyPipelineLayout(*pDevice, *pPipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
 }
 
 VkPipelineShaderStageCreateInfo configureVertexShaderStageCreateInfo(VkShaderModule *pVertexShaderModule, const char *entryName){
@@ -195,7 +211,45 @@ VkPipelineColorBlendStateCreateInfo configureColorBlendStateCreateInfo(VkPipelin
 	return colorBlendStateCreateInfo;
 }
 
-VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, VkRenderPass *pRenderPass, VkExtent2D *pExtent){
+VkPipelineDynamicStateCreateInfo configureDynamicStateCreateInfo(){
+	static const VkDynamicState dynamicStates[] = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		2,
+		dynamicStates
+	};
+
+	return dynamicStateCreateInfo;
+}
+
+void recordViewport(VkCommandBuffer *pCommandBuffer, VkExtent2D *pExtent){
+	VkViewport viewport = configureViewport(pExtent);
+	VkRect2D scissor = configureScissor(pExtent, 0, 0, 0, 0);
+	vkCmdSetViewport(*pCommandBuffer, 0, 1, &viewport);
+	vkCmdSetScissor(*pCommandBuffer, 0, 1, &scissor);
+}
+
+ViewConstants createViewConstants(){
+	ViewConstants viewConstants;
+	for(uint32_t i = 0; i < VIEW_MAX_NUMBER; i++){
+		viewConstants.transforms[i][0] = 1.0f;
+		viewConstants.transforms[i][1] = 1.0f;
+		viewConstants.transforms[i][2] = 0.0f;
+		viewConstants.transforms[i][3] = 0.0f;
+	}
+	return viewConstants;
+}
+
+void recordViewConstants(VkCommandBuffer *pCommandBuffer, VkPipelineLayout *pPipelineLayout, ViewConstants *pViewConstants){
+	vkCmdPushConstants(*pCommandBuffer, *pPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ViewConstants), pViewConstants);
+}
+
+VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipelineLayout, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, RenderTarget *pRenderTarget, VkExtent2D *pExtent){
 	char entryName[] = "main";
 
 	VkPipelineShaderStageCreateInfo shaderStageCreateInfo[] = {
@@ -211,10 +265,12 @@ VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipeline
 	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = configureMultisampleStateCreateInfo();
 	VkPipelineColorBlendAttachmentState colorBlendAttachmentState = configureColorBlendAttachmentState();
 	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = configureColorBlendStateCreateInfo(&colorBlendAttachmentState);
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = configureDynamicStateCreateInfo();
+	VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
 
 	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
 		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-		VK_NULL_HANDLE,
+		chainRenderingCreateInfo(pRenderTarget, &renderingCreateInfo, VK_NULL_HANDLE),
 		0,
 		2,
 		shaderStageCreateInfo,
@@ -226,19 +282,19 @@ VkPipeline createGraphicsPipeline(VkDevice *pDevice, VkPipelineLayout *pPipeline
 		&multisampleStateCreateInfo,
 		VK_NULL_HANDLE,
 		&colorBlendStateCreateInfo,
-		VK_NULL_HANDLE,
+		&dynamicStateCreateInfo,
 		*pPipelineLayout,
-		*pRenderPass,
+		pRenderTarget->renderPass,
 		0,
 		VK_NULL_HANDLE,
 		-1
 	};
 
 	VkPipeline graphicsPipeline;
-	vkCreateGraphicsPipelines(*pDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, VK_NULL_HANDLE, &graphicsPipeline);
+	vkCreateGraphicsPipelines(*pDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &graphicsPipeline);
 	return graphicsPipeline;
 }
 
 void deleteGraphicsPipeline(VkDevice *pDevice, VkPipeline *pGraphicsPipeline){
-	vkDestroyPipeline(*pDevice, *pGraphicsPipeline, VK_NULL_HANDLE);
+	vkDestroyPipeline(*pDevice, *pGraphicsPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
 }
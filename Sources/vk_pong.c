@@ -1,11 +1,35 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <string.h>
 
 #include "../Headers/std_c.h"
 #include "../Headers/ext.h"
 #include "../Headers/vk_fun.h"
 #include "../Headers/glfw_fun.h"
+#include "../Headers/text_fun.h"
+#include "../Headers/particle_fun.h"
+#include "../Headers/post_fun.h"
+#include "../Headers/reload_fun.h"
+#include "../Headers/library_fun.h"
+#include "../Headers/capture_fun.h"
+#include "../Headers/split_fun.h"
+#include "../Headers/hud_fun.h"
+#include "../Headers/trace_fun.h"
+#include "../Headers/audio_fun.h"
+#include "../Headers/stream_fun.h"
+#include "../Headers/submit_fun.h"
+#include "../Headers/bindless_fun.h"
+#include "../Headers/sim_fun.h"
+#include "../Headers/job_fun.h"
+
+#ifndef VK_PONG_SHADER_DIR
+#define VK_PONG_SHADER_DIR "../Shaders"
+#endif
+
+#define VK_PONG_MAX_SKINS 4
+// Le retard accumulé est plafonné à un quart de seconde, une frame ne joue jamais plus de pas que ça
+#define VK_PONG_MAX_TICKS (SIM_TICK_RATE / 4 + 1)
 
 void signal_handler(int signal) {
     if(signal == SIGTERM){
@@ -14,13 +38,466 @@ void signal_handler(int signal) {
     }
 }
 
-int main() {
+/**
+ * Événements d'un pas joué sur un worker, rejoués par le thread de rendu pour le son et les particules
+ */
+typedef struct PongTick {
+    uint32_t events;
+    float ballX;
+    float ballY;
+} PongTick;
+
+/**
+ * Match affiché dans la fenêtre, joué par deux IA à la fréquence de la simulation
+ */
+typedef struct PongScene {
+    PongMatch match;
+    JobSystem *pJobSystem;
+    JobCounter simulationCounter;
+    JobCounter recordCounter;
+    uint32_t recordImageIndex;
+    uint32_t tickNumber;
+    PongTick ticks[VK_PONG_MAX_TICKS];
+    double simulationTime;
+    VkPipeline *pTrianglePipeline;
+    TextRenderer *pTextRenderer;
+    ParticleSystem *pParticleSystem;
+    RenderGraph *pRenderGraph;
+    PostChain *pPostChain;
+    SplitScreen *pSplitScreen;
+    DeletionQueue *pDeletionQueue;
+    ShaderReloader *pShaderReloader;
+    PipelineLibrary *pPipelineLibrary;
+    FrameCapture *pFrameCapture;
+    FrameLimiter *pFrameLimiter;
+    RedrawState *pRedrawState;
+    PerfHud *pPerfHud;
+    AudioMixer *pAudioMixer;
+    uint32_t sounds[3];
+    TextureStreamer *pTextureStreamer;
+    const char **skinFileNames;
+    uint32_t skinNumber;
+    uint32_t skinIndex;
+    uint32_t skinTextures[VK_PONG_MAX_SKINS];
+    uint32_t skinSprites[VK_PONG_MAX_SKINS];
+    BindlessTable *pBindlessTable;
+    VkDescriptorSet skinSet;
+    VkPipeline skinPipeline;
+    VkPipelineLayout skinPipelineLayout;
+    GLFWwindow *pWindow;
+    int isStatsKeyDown;
+    int isSkinKeyDown;
+    int isHudKeyDown;
+    int isPauseKeyDown;
+    int isPaused;
+    uint32_t pipelineGeneration;
+    uint32_t recordedGenerations[GRAPH_MAX_IMAGES];
+    uint32_t imageNumber;
+    uint32_t scenePass;
+    VkCommandBuffer *pCommandBuffers;
+    VkExtent2D recordedExtents[GRAPH_MAX_IMAGES];
+    VkExtent2D extent;
+    double lastTime;
+    double accumulator;
+    double frameStartTime;
+    uint64_t allocationNumber;
+} PongScene;
+
+/**
+ * Ce qu'il faut pour reconstruire un pipeline de la scène quand ses shaders changent
+ */
+typedef struct PipelineRecipe {
+    VkPipelineLayout *pPipelineLayout;
+    RenderTarget *pRenderTarget;
+    VkExtent2D *pExtent;
+} PipelineRecipe;
+
+static VkShaderModule loadShaderModule(VkDevice *pDevice, const char *fileName) {
+    uint32_t shaderSize = 0;
+    char *shaderCode = getShaderCode(fileName, &shaderSize);
+    if (shaderCode == VK_NULL_HANDLE) {
+        printf("VkShaderException : shader %s not found!\n", fileName);
+        return VK_NULL_HANDLE;
+    }
+    VkShaderModule shaderModule = createShaderModule(pDevice, shaderCode, shaderSize);
+    deleteShaderCode(&shaderCode);
+    return shaderModule;
+}
+
+static VkPipeline buildPongPipeline(VkDevice *pDevice, VkShaderModule *pShaderModules, void *pUserData) {
+    PipelineRecipe *pRecipe = (PipelineRecipe *)pUserData;
+    return createGraphicsPipeline(pDevice, pRecipe->pPipelineLayout, &pShaderModules[0], &pShaderModules[1],
+                                  pRecipe->pRenderTarget, pRecipe->pExtent);
+}
+
+/**
+ * Pas fixes de la frame, joués sur un worker pendant que le thread de rendu enregistre ses commandes
+ */
+static void runPongSimulation(void *pData) {
+    PongScene *pScene = (PongScene *)pData;
+    TRACE_ZONE("simulation");
+    double simulationStartTime = glfwGetTime();
+    for (uint32_t i = 0; i < pScene->tickNumber; i++) {
+        float leftAction = getAIAction(&pScene->match, 0, 0.8f);
+        float rightAction = getAIAction(&pScene->match, 1, 0.8f);
+        PongTick *pTick = &pScene->ticks[i];
+        pTick->events = stepMatch(&pScene->match, leftAction, rightAction);
+        pTick->ballX = pScene->match.ballX;
+        pTick->ballY = pScene->match.ballY;
+        if (isMatchOver(&pScene->match)) {
+            initMatch(&pScene->match, pScene->match.rngState);
+        }
+    }
+    pScene->simulationTime = glfwGetTime() - simulationStartTime;
+}
+
+/**
+ * Réenregistrement du command buffer d'une image sur un worker, il ne lit que les pipelines et la forme du graphe
+ */
+static void recordPongCommands(void *pData) {
+    PongScene *pScene = (PongScene *)pData;
+    TRACE_ZONE("record commands");
+    recordRenderGraphCommandBuffer(pScene->pRenderGraph, &pScene->pCommandBuffers[pScene->recordImageIndex], pScene->recordImageIndex);
+}
+
+static void updatePongScene(uint32_t imageIndex, void *pUserData) {
+    PongScene *pScene = (PongScene *)pUserData;
+    double frameStartTime = glfwGetTime();
+    // La soumission précédente de cette image est terminée, ses timestamps sont lisibles
+    readRenderGraphTimestamps(pScene->pRenderGraph, imageIndex);
+    // Sa copie de capture aussi, elle part à l'écriture et la frame suivante prend un nouvel emplacement
+    if (pScene->pFrameCapture != VK_NULL_HANDLE) {
+        updateFrameCapture(pScene->pFrameCapture, imageIndex);
+    }
+    // Hot reload : les pipelines reconstruits en arrière-plan ne sont échangés qu'entre deux frames
+    if (pScene->pShaderReloader != VK_NULL_HANDLE && applyShaderReload(pScene->pShaderReloader)) {
+        pScene->pipelineGeneration++;
+    }
+    // Les variantes optimisées en arrière-plan remplacent de la même façon celles liées rapidement
+    if (applyPipelineLibrary(pScene->pPipelineLibrary)) {
+        pScene->pipelineGeneration++;
+    }
+    // Les textures décodées partent à la copie et celles copiées deviennent utilisables dès cette frame
+    if (pScene->pTextureStreamer != VK_NULL_HANDLE) {
+        updateTextureStreamer(pScene->pTextureStreamer);
+        // T passe au fond suivant, demandé à la première sélection, l'ancien reste affiché jusqu'à ce qu'il soit prêt
+        int isSkinKeyDown = glfwGetKey(pScene->pWindow, GLFW_KEY_T) == GLFW_PRESS;
+        if (isSkinKeyDown && !pScene->isSkinKeyDown) {
+            pScene->skinIndex = (pScene->skinIndex + 1) % pScene->skinNumber;
+            if (pScene->skinTextures[pScene->skinIndex] == STREAM_INVALID_TEXTURE) {
+                pScene->skinTextures[pScene->skinIndex] = requestTexture(pScene->pTextureStreamer,
+                                                                         pScene->skinFileNames[pScene->skinIndex]);
+            }
+        }
+        pScene->isSkinKeyDown = isSkinKeyDown;
+        // Chaque fond prêt prend aussi un emplacement de la table globale, les raquettes le lisent par indice
+        for (uint32_t i = 0; i < pScene->skinNumber && pScene->pBindlessTable != VK_NULL_HANDLE; i++) {
+            VkDescriptorImageInfo skinImageInfo = getTextureImageInfo(pScene->pTextureStreamer, pScene->skinTextures[i]);
+            if (pScene->skinSprites[i] == BINDLESS_INVALID_INDEX && skinImageInfo.imageView != VK_NULL_HANDLE) {
+                pScene->skinSprites[i] = addBindlessTexture(pScene->pBindlessTable, &skinImageInfo);
+            }
+        }
+        VkDescriptorSet skinSet = getTextureDescriptorSet(pScene->pTextureStreamer, pScene->skinTextures[pScene->skinIndex]);
+        if (skinSet != VK_NULL_HANDLE && skinSet != pScene->skinSet) {
+            pScene->skinSet = skinSet;
+            pScene->pipelineGeneration++;
+        }
+    }
+    // P met le match en pause, en mode à la demande plus rien ne change et la boucle s'endort
+    int isPauseKeyDown = glfwGetKey(pScene->pWindow, GLFW_KEY_P) == GLFW_PRESS;
+    if (isPauseKeyDown && !pScene->isPauseKeyDown) {
+        pScene->isPaused = !pScene->isPaused;
+    }
+    pScene->isPauseKeyDown = isPauseKeyDown;
+    double now = glfwGetTime();
+    float deltaTime = pScene->isPaused ? 0.0f : (float)(now - pScene->lastTime);
+    pScene->accumulator = pScene->isPaused ? 0.0 : pScene->accumulator + now - pScene->lastTime;
+    pScene->lastTime = now;
+    // Pas fixe, on abandonne le retard accumulé après une longue pause
+    if (pScene->accumulator > 0.25) {
+        pScene->accumulator = 0.25;
+    }
+    pScene->tickNumber = 0;
+    while (pScene->accumulator >= 1.0 / SIM_TICK_RATE && pScene->tickNumber < VK_PONG_MAX_TICKS) {
+        pScene->tickNumber++;
+        pScene->accumulator -= 1.0 / SIM_TICK_RATE;
+    }
+    // Résolution dynamique : le command buffer de l'image n'est réenregistré que si l'échelle ou un pipeline a changé depuis,
+    // ou à chaque frame pendant une capture puisque l'emplacement de copie change
+    updatePostChainScale(pScene->pPostChain, pScene->pRenderGraph->gpuTime);
+    VkExtent2D *pRecordedExtent = &pScene->recordedExtents[imageIndex];
+    int isRecorded = 0;
+    if (pRecordedExtent->width != pScene->pPostChain->renderExtent.width ||
+        pRecordedExtent->height != pScene->pPostChain->renderExtent.height ||
+        pScene->recordedGenerations[imageIndex] != pScene->pipelineGeneration ||
+        pScene->pFrameCapture != VK_NULL_HANDLE) {
+        // En écran partagé les deux vues se partagent la zone rendue
+        if (pScene->pSplitScreen != VK_NULL_HANDLE) {
+            setSplitScreenRenderArea(pScene->pSplitScreen, pScene->pRenderGraph, &pScene->pPostChain->renderExtent);
+        } else {
+            setGraphPassRenderArea(pScene->pRenderGraph, pScene->scenePass, &pScene->pPostChain->renderExtent);
+        }
+        // Le graphe ne change plus jusqu'à la fin de la frame, l'enregistrement part sur un worker
+        pScene->recordImageIndex = imageIndex;
+        if (pScene->pJobSystem != VK_NULL_HANDLE) {
+            runJob(pScene->pJobSystem, recordPongCommands, pScene, &pScene->recordCounter);
+        } else {
+            recordPongCommands(pScene);
+        }
+        *pRecordedExtent = pScene->pPostChain->renderExtent;
+        pScene->recordedGenerations[imageIndex] = pScene->pipelineGeneration;
+        isRecorded = 1;
+    }
+    // Les pas partent en dernier sur la deque du thread de rendu, c'est le premier job qu'il reprend s'il doit les attendre
+    pScene->simulationTime = 0.0;
+    if (pScene->pJobSystem != VK_NULL_HANDLE) {
+        runJob(pScene->pJobSystem, runPongSimulation, pScene, &pScene->simulationCounter);
+    } else {
+        runPongSimulation(pScene);
+    }
+    // F2 affiche les allocations du driver à la demande, pour voir lesquelles reviennent à chaque frame
+    int isStatsKeyDown = glfwGetKey(pScene->pWindow, GLFW_KEY_F2) == GLFW_PRESS;
+    if (isStatsKeyDown && !pScene->isStatsKeyDown) {
+        printHostAllocator();
+    }
+    pScene->isStatsKeyDown = isStatsKeyDown;
+    // F3 masque l'overlay de performance, sa passe reste enregistrée et dessine zéro quad
+    int isHudKeyDown = glfwGetKey(pScene->pWindow, GLFW_KEY_F3) == GLFW_PRESS;
+    if (isHudKeyDown && !pScene->isHudKeyDown && pScene->pPerfHud != VK_NULL_HANDLE) {
+        pScene->pPerfHud->isVisible = !pScene->pPerfHud->isVisible;
+    }
+    pScene->isHudKeyDown = isHudKeyDown;
+    // Le match n'est lu qu'après les pas de la frame, le thread de rendu aide le worker s'il ne les a pas finis
+    if (pScene->pJobSystem != VK_NULL_HANDLE) {
+        TRACE_BEGIN("wait simulation");
+        waitJobCounter(pScene->pJobSystem, &pScene->simulationCounter);
+        TRACE_END();
+    }
+    for (uint32_t i = 0; i < pScene->tickNumber; i++) {
+        uint32_t events = pScene->ticks[i].events;
+        float ballX = pScene->ticks[i].ballX, ballY = pScene->ticks[i].ballY;
+        // Le CPU ne fait qu'enregistrer des salves, émission et simulation sont sur le GPU
+        // Le son part à la fin du bloc audio en cours, quelques millisecondes plus tard, sans jamais bloquer la boucle
+        if (pScene->pAudioMixer != VK_NULL_HANDLE) {
+            if (events & SIM_EVENT_PADDLE_HIT) {
+                playAudioSound(pScene->pAudioMixer, pScene->sounds[0], 0.8f, ballX);
+            } else if (events & SIM_EVENT_WALL_HIT) {
+                playAudioSound(pScene->pAudioMixer, pScene->sounds[1], 0.5f, ballX);
+            }
+            if (events & (SIM_EVENT_GOAL_LEFT | SIM_EVENT_GOAL_RIGHT)) {
+                playAudioSound(pScene->pAudioMixer, pScene->sounds[2], 1.0f, events & SIM_EVENT_GOAL_LEFT ? 1.0f : -1.0f);
+            }
+        }
+        if (events & SIM_EVENT_PADDLE_HIT) {
+            emitParticles(pScene->pParticleSystem, ballX, ballY, 512, 1.2f, 0.6f, TEXT_COLOR(255, 200, 80, 255));
+        }
+        if (events & (SIM_EVENT_GOAL_LEFT | SIM_EVENT_GOAL_RIGHT)) {
+            emitParticles(pScene->pParticleSystem, events & SIM_EVENT_GOAL_LEFT ? 1.0f : -1.0f, 0.0f, 8192, 2.0f, 1.5f,
+                          TEXT_COLOR(80, 160, 255, 255));
+        }
+    }
+    double simulationTime = pScene->simulationTime;
+
+    // Terrain, raquettes, balle et score : tout passe par le même draw instancié
+    float width = (float)pScene->extent.width, height = (float)pScene->extent.height;
+    float paddleWidth = 0.02f * width, paddleHeight = SIM_PADDLE_HALF_HEIGHT * height;
+    float ballSize = SIM_BALL_RADIUS * width;
+    uint32_t white = TEXT_COLOR(255, 255, 255, 255), grey = TEXT_COLOR(255, 255, 255, 96);
+    TextRenderer *pTextRenderer = pScene->pTextRenderer;
+
+    // Avec des fonds chargés chaque raquette porte le sien, une texture différente par quad dans le même draw
+    uint32_t paddleSprites[2] = {BINDLESS_INVALID_INDEX, BINDLESS_INVALID_INDEX};
+    if (pScene->skinNumber > 0) {
+        paddleSprites[0] = pScene->skinSprites[pScene->skinIndex];
+        paddleSprites[1] = pScene->skinSprites[(pScene->skinIndex + 1) % pScene->skinNumber];
+    }
+
+    beginText(pTextRenderer, imageIndex);
+    for (float y = 0.0f; y < height; y += 0.05f * height) {
+        drawTextRect(pTextRenderer, 0.5f * width - 2.0f, y, 4.0f, 0.025f * height, grey);
+    }
+    for (uint32_t side = 0; side < 2; side++) {
+        float paddleX = (side == 0 ? -SIM_PADDLE_X : SIM_PADDLE_X) + 1.0f;
+        drawTextSprite(pTextRenderer, paddleX * 0.5f * width - 0.5f * paddleWidth,
+                       (pScene->match.paddleY[side] + 1.0f) * 0.5f * height - 0.5f * paddleHeight,
+                       paddleWidth, paddleHeight, paddleSprites[side], white);
+    }
+    drawTextRect(pTextRenderer, (pScene->match.ballX + 1.0f) * 0.5f * width - 0.5f * ballSize,
+                 (pScene->match.ballY + 1.0f) * 0.5f * height - 0.5f * ballSize, ballSize, ballSize, white);
+
+    char scoreText[32];
+    snprintf(scoreText, sizeof(scoreText), "%2u  %-2u", pScene->match.score[0], pScene->match.score[1]);
+    drawText(pTextRenderer, 0.5f * width - 3.0f * 6.0f * 4.0f, 16.0f, 4.0f, white, scoreText);
+    snprintf(scoreText, sizeof(scoreText), "rally %u", pScene->match.rally);
+    drawText(pTextRenderer, 8.0f, height - 24.0f, 2.0f, grey, scoreText);
+    if (pScene->isPaused) {
+        drawText(pTextRenderer, 0.5f * width - 3.0f * 6.0f * 4.0f, 0.5f * height - 16.0f, 4.0f, white, "PAUSED");
+    }
+
+    // Coût GPU de chaque passe pour budgéter les effets selon la machine
+    float timingY = 8.0f;
+    if (pScene->pPostChain->stages & POST_STAGE_UPSCALE) {
+        snprintf(scoreText, sizeof(scoreText), "scale %3.0f%% %ux%u", 100.0f * pScene->pPostChain->renderScale,
+                 pScene->pPostChain->renderExtent.width, pScene->pPostChain->renderExtent.height);
+        drawText(pTextRenderer, 8.0f, timingY, 2.0f, grey, scoreText);
+        timingY += 18.0f;
+    }
+    if (pScene->pFrameLimiter != VK_NULL_HANDLE) {
+        snprintf(scoreText, sizeof(scoreText), "pace %3.0f Hz jit %.3f", 1e9 / (double)pScene->pFrameLimiter->period,
+                 getFrameLimiterJitter(pScene->pFrameLimiter));
+        drawText(pTextRenderer, 8.0f, timingY, 2.0f, grey, scoreText);
+        timingY += 18.0f;
+    }
+    for (uint32_t i = 0; i < pScene->pRenderGraph->passNumber; i++) {
+        GraphPass *pPass = &pScene->pRenderGraph->passes[i];
+        if (!pPass->isCulled) {
+            snprintf(scoreText, sizeof(scoreText), "%-12s %6.3f ms", pPass->name, pPass->gpuTime);
+            drawText(pTextRenderer, 8.0f, timingY, 2.0f, grey, scoreText);
+            timingY += 18.0f;
+        }
+    }
+    endText(pTextRenderer);
+
+    updateParticles(pScene->pParticleSystem, imageIndex, deltaTime < 0.1f ? deltaTime : 0.1f);
+
+    // Overlay : chaque passe graphique fait un draw plein écran, sauf la scène qui en fait trois, quatre avec un fond
+    if (pScene->pPerfHud != VK_NULL_HANDLE) {
+        HudFrame hudFrame;
+        hudFrame.drawNumber = 0;
+        for (uint32_t i = 0; i < pScene->pRenderGraph->passNumber; i++) {
+            GraphPass *pPass = &pScene->pRenderGraph->passes[i];
+            if (!pPass->isCulled && pPass->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS) {
+                hudFrame.drawNumber += i == pScene->scenePass ? (pScene->skinSet != VK_NULL_HANDLE ? 4 : 3) : 1;
+            }
+        }
+        hudFrame.instanceNumber = pTextRenderer->glyphNumber + pScene->pPerfHud->textRenderer.glyphNumber;
+        uint64_t allocationNumber = getHostAllocationNumber() + getHeapAllocationNumber();
+        hudFrame.allocationNumber = allocationNumber - pScene->allocationNumber;
+        pScene->allocationNumber = allocationNumber;
+        hudFrame.times[HUD_GRAPH_CPU] = (float)((glfwGetTime() - frameStartTime) * 1e3);
+        hudFrame.times[HUD_GRAPH_GPU] = pScene->pRenderGraph->gpuTime;
+        hudFrame.times[HUD_GRAPH_SIMULATION] = (float)(simulationTime * 1e3);
+        hudFrame.times[HUD_GRAPH_PRESENT] = pScene->frameStartTime != 0.0 ? (float)((frameStartTime - pScene->frameStartTime) * 1e3) : 0.0f;
+        pushPerfHudFrame(pScene->pPerfHud, &hudFrame);
+        updatePerfHud(pScene->pPerfHud, pScene->pRenderGraph, imageIndex);
+    }
+    pScene->frameStartTime = frameStartTime;
+    // Le command buffer doit être fermé avant que la frame parte à la soumission
+    if (pScene->pJobSystem != VK_NULL_HANDLE) {
+        TRACE_BEGIN("wait record");
+        waitJobCounter(pScene->pJobSystem, &pScene->recordCounter);
+        TRACE_END();
+    }
+    // Les anciens pipelines partent à la destruction quand plus aucun command buffer ne les référence
+    if (isRecorded) {
+        uint32_t staleImageNumber = 0;
+        for (uint32_t i = 0; i < pScene->imageNumber; i++) {
+            staleImageNumber += pScene->recordedGenerations[i] != pScene->pipelineGeneration;
+        }
+        if (staleImageNumber == 0) {
+            if (pScene->pShaderReloader != VK_NULL_HANDLE) {
+                releaseShaderReload(pScene->pShaderReloader, pScene->pDeletionQueue);
+            }
+            releasePipelineLibrary(pScene->pPipelineLibrary, pScene->pDeletionQueue);
+        }
+    }
+    // Un match en cours change à chaque frame, la suivante est demandée tout de suite
+    if (!pScene->isPaused) {
+        markRedraw(pScene->pRedrawState, REDRAW_SIMULATION);
+    }
+}
+
+static void recordPongSceneUpdate(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData) {
+    PongScene *pScene = (PongScene *)pUserData;
+    recordParticleUpdate(pScene->pParticleSystem, pCommandBuffer, commandBufferIndex);
+}
+
+static void recordPongScene(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData) {
+    PongScene *pScene = (PongScene *)pUserData;
+    // Le fond n'est dessiné qu'une fois sa texture prête, le triangle plein écran passe sous tout le reste
+    if (pScene->skinSet != VK_NULL_HANDLE) {
+        vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pScene->skinPipeline);
+        vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pScene->skinPipelineLayout, 0, 1,
+                                &pScene->skinSet, 0, VK_NULL_HANDLE);
+        vkCmdDraw(*pCommandBuffer, 3, 1, 0, 0);
+    }
+    vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *pScene->pTrianglePipeline);
+    vkCmdDraw(*pCommandBuffer, 3, 1, 0, 0);
+    recordParticleDraw(pScene->pParticleSystem, pCommandBuffer, commandBufferIndex);
+    recordTextDraw(pScene->pTextRenderer, pCommandBuffer, commandBufferIndex);
+}
+
+int main(int argc, char **argv) {
     signal(SIGTERM, signal_handler);
+    // Chaque étape du post-traitement peut être désactivée depuis la ligne de commande
+    // La résolution de la scène s'adapte pour tenir le budget GPU, en millisecondes
+    uint32_t postStages = POST_STAGE_ALL | POST_STAGE_UPSCALE;
+    float gpuBudget = 8.0f;
+    // Mode développement : les shaders modifiés sont recompilés et remplacés sans redémarrer
+    int hotReload = 0;
+    // Enregistrement du match dans un fichier vidéo, Y4M si le nom se termine par .y4m, RGBA brut sinon
+    const char *captureFileName = NULL;
+    uint32_t captureRate = 60;
+    // Fréquence imposée à la boucle principale, 0 pour laisser le mode de présentation décider
+    double frameLimit = 0.0;
+    // Écran partagé : les deux vues sont dessinées en une seule passe multiview puis composées côte à côte
+    int useSplitScreen = 0;
+    int onDemand = 0;
+    int useHud = 0;
+    // Table de descripteurs globale pour le texte et les sprites, si le GPU gère le descriptor indexing
+    int useBindless = 1;
+    // Acquisition, soumission et présentation sur un thread dédié, le thread principal enchaîne sur la frame suivante
+    int useSubmitThread = 1;
+    // Rendu dynamique sur les vues des images, sans render pass ni frame buffer, si le GPU gère VK_KHR_dynamic_rendering
+    int useDynamicRendering = 1;
+    // Zones CPU de chaque thread exportées au format Chrome trace-event, seulement si compilé avec VK_PONG_TRACE
+    const char *traceFileName = NULL;
+    // Effets sonores : "alsa" pour la carte son, "null" pour mélanger sans sortie, sinon un fichier WAV
+    const char *audioOutput = NULL;
+    // Fonds du terrain au format PPM ou PGM binaire, décodés et envoyés au GPU en arrière-plan, T passe au suivant
+    const char *skinFileNames[VK_PONG_MAX_SKINS];
+    uint32_t skinNumber = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-bloom") == 0) postStages &= ~POST_STAGE_BLOOM;
+        if (strcmp(argv[i], "--no-vignette") == 0) postStages &= ~POST_STAGE_VIGNETTE;
+        if (strcmp(argv[i], "--no-crt") == 0) postStages &= ~POST_STAGE_CRT;
+        if (strcmp(argv[i], "--no-dynamic-resolution") == 0) postStages &= ~POST_STAGE_UPSCALE;
+        if (strcmp(argv[i], "--hot-reload") == 0) hotReload = 1;
+        if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) gpuBudget = strtof(argv[++i], NULL);
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) captureFileName = argv[++i];
+        if (strcmp(argv[i], "--capture-rate") == 0 && i + 1 < argc) captureRate = (uint32_t)strtoul(argv[++i], NULL, 10);
+        if (strcmp(argv[i], "--frame-limit") == 0 && i + 1 < argc) frameLimit = strtod(argv[++i], NULL);
+        if (strcmp(argv[i], "--split-screen") == 0) useSplitScreen = 1;
+        if (strcmp(argv[i], "--on-demand") == 0) onDemand = 1;
+        if (strcmp(argv[i], "--hud") == 0) useHud = 1;
+        if (strcmp(argv[i], "--no-bindless") == 0) useBindless = 0;
+        if (strcmp(argv[i], "--no-submit-thread") == 0) useSubmitThread = 0;
+        if (strcmp(argv[i], "--no-dynamic-rendering") == 0) useDynamicRendering = 0;
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) traceFileName = argv[++i];
+        if (strcmp(argv[i], "--audio") == 0 && i + 1 < argc) audioOutput = argv[++i];
+        if (strcmp(argv[i], "--skin") == 0 && i + 1 < argc && skinNumber < VK_PONG_MAX_SKINS) skinFileNames[skinNumber++] = argv[++i];
+    }
+    if (traceFileName != NULL) {
+#ifdef VK_PONG_TRACE
+        // Le fichier est fermé à la sortie, y compris par les chemins d'erreur qui passent par exit
+        if (createTracer(traceFileName) == 0) {
+            atexit(deleteTracer);
+        }
+        setTraceThreadName("main");
+#else
+        printf("VkTraceException : tracing is compiled out, configure with -DVK_PONG_TRACE=ON\n");
+#endif
+    }
     glfwInit();
+    // Les allocations du driver passent par nos pools et sont comptées par type d'objet jusqu'à la fin du programme
+    if (createHostAllocator() != 0) {
+        printf("VkAllocatorException : the driver allocates on its own\n");
+    }
 
     /**
      * ------------- Étape n°1 Instance et sélection du physical device -------------
      */
+    TRACE_BEGIN("step 1 instance");
 
     // Création de l'instance de notre app
     VkInstance instance = createInstance("vk_pong", VK_MAKE_VERSION(0, 0, 1), "NO ENGINE", VK_MAKE_VERSION(0, 0, 0));
@@ -32,9 +509,11 @@ int main() {
     // Création du physical device et selection de la meilleure carte graphique compatible
     VkPhysicalDevice *pBestPhysicalDevice = &physicalDevices[bestPhysicalDeviceIndex];
 
+    TRACE_END();
     /**
       * ------------- Étape n°2 Logical device et famille de queues -------------
       */
+    TRACE_BEGIN("step 2 device");
 
     // Sélection d'une famille de queue compatible
     uint32_t queueFamilyNumber = getQueueFamilyNumber(pBestPhysicalDevice);
@@ -47,12 +526,22 @@ int main() {
     // Création de queues pour nos différentes opérations asynchrones
     VkQueue drawingQueue = getDrawingQueue(&device, bestGraphicsQueueFamilyindex);
     VkQueue presentingQueue = getPresentingQueue(&device, bestGraphicsQueueFamilyindex, graphicsQueueMode);
+    // Les copies de textures passent par une famille de transfert dédiée quand le GPU en a une
+    uint32_t transferQueueFamilyIndex = getTransferQueueFamilyIndex(queueFamilyProperties, queueFamilyNumber, bestGraphicsQueueFamilyindex);
+    VkQueue transferQueue = transferQueueFamilyIndex != bestGraphicsQueueFamilyindex ?
+                            getDrawingQueue(&device, transferQueueFamilyIndex) : drawingQueue;
     // Libération de la structure sur les properiétés des familles de queues de notre physical device
     deleteQueueFamilyProperties(&queueFamilyProperties);
+    if (useSplitScreen && !getMultiviewSupport(pBestPhysicalDevice)) {
+        printf("VkSplitException : multiview not supported, the split screen is disabled\n");
+        useSplitScreen = 0;
+    }
 
+    TRACE_END();
     /**
    * ------------- Étape n°3 Création de la surface d'affichage et swap chain -------------
    */
+    TRACE_BEGIN("step 3 surface and swapchain");
     char windowTitle[] = "Vulkan Triangle";
     // Création d'une fenêtre de taille fixe 600 * 600 pixels
     GLFWwindow *window = createVulkanWindow(600, 600, windowTitle);
@@ -69,6 +558,7 @@ int main() {
         deleteDevice(&device);
         deletePhysicalDevices(&physicalDevices);
         deleteInstance(&instance);
+        deleteHostAllocator();
 
         raise(SIGTERM);
     }
@@ -90,26 +580,34 @@ int main() {
     uint32_t swapchainImageNumber = getSwapchainImageNumber(&device, &swapchain);
     VkImage *swapchainImages = getSwapchainImages(&device, &swapchain, swapchainImageNumber);
 
+    TRACE_END();
     /**
    * ------------- Étape n°4 Image views et frame buffers -------------
    */
+    TRACE_BEGIN("step 4 image views");
 
     // Pour dessiner les images de la swapchain on doit l'encapsuler dans un VkImageView
     VkImageView *swapchainImageViews = createImageViews(&device, &swapchainImages, &bestSurfaceFormat,
                                                         swapchainImageNumber, imageArrayLayers);
 
+    TRACE_END();
     /**
   * ------------- Étape n5 Render passe -------------
   */
-  // Création de la render passe pour décrire le type d'images utilisées et comment les traiter
-    VkRenderPass renderPass = createRenderPass(&device, &bestSurfaceFormat);
-    // Encapsulation du VkImageView dans un VkFramebuffer
-    VkFramebuffer *framebuffers = createFramebuffers(&device, &renderPass, &bestSwapchainExtent, &swapchainImageViews,
-                                                     swapchainImageNumber);
+    TRACE_BEGIN("step 5 render pass");
+  // Description des images dans lesquelles dessinent les pipelines
+    // Sans rendu dynamique c'est une render passe qui ne sert qu'à créer des pipelines compatibles, le graphe crée les siennes
+    VkBool32 dynamicRendering = useDynamicRendering && getDynamicRenderingSupport(pBestPhysicalDevice);
+    RenderTarget renderTarget = createRenderTarget(&device, &bestSurfaceFormat, 0, dynamicRendering);
+    // Les pipelines de la scène doivent avoir le masque de vues de la passe qui les dessine, pas ceux du post-traitement
+    RenderTarget sceneRenderTarget = createRenderTarget(&device, &bestSurfaceFormat, useSplitScreen ? SPLIT_VIEW_MASK : 0,
+                                                        dynamicRendering);
 
+    TRACE_END();
     /**
   * ------------- Étape n°6 Compilation des shaders en sprv et création du pipeline graphique -------------
   */
+    TRACE_BEGIN("step 6 shaders and pipeline");
     uint32_t vertexShaderSize = 0;
     char vertexShaderFileName[] = "Shaders/triangle_vertex.spv";
     // Chargement du bytecode de notre vertex shader
@@ -118,8 +616,8 @@ int main() {
     if (vertexShaderCode == VK_NULL_HANDLE) {
         printf("VkShaderException : vertex %s shader not found!", vertexShaderFileName);
 
-        deleteFramebuffers(&device, &framebuffers, swapchainImageNumber);
-        deleteRenderPass(&device, &renderPass);
+        deleteRenderTarget(&device, &sceneRenderTarget);
+        deleteRenderTarget(&device, &renderTarget);
         deleteImageViews(&device, &swapchainImageViews, swapchainImageNumber);
         deleteSwapchainImages(&swapchainImages);
         deleteSwapchain(&device, &swapchain);
@@ -128,6 +626,7 @@ int main() {
         deleteDevice(&device);
         deletePhysicalDevices(&physicalDevices);
         deleteInstance(&instance);
+        deleteHostAllocator();
 
         raise(SIGTERM);
     }
@@ -145,8 +644,8 @@ int main() {
         deleteShaderModule(&device, &vertexShaderModule);
         deleteShaderCode(&vertexShaderCode);
 
-        deleteFramebuffers(&device, &framebuffers, swapchainImageNumber);
-        deleteRenderPass(&device, &renderPass);
+        deleteRenderTarget(&device, &sceneRenderTarget);
+        deleteRenderTarget(&device, &renderTarget);
         deleteImageViews(&device, &swapchainImageViews, swapchainImageNumber);
         deleteSwapchainImages(&swapchainImages);
         deleteSwapchain(&device, &swapchain);
@@ -155,6 +654,7 @@ int main() {
         deleteDevice(&device);
         deletePhysicalDevices(&physicalDevices);
         deleteInstance(&instance);
+        deleteHostAllocator();
 
         return 1;
     }
@@ -162,57 +662,474 @@ int main() {
     VkShaderModule fragmentShaderModule = createShaderModule(&device, fragmentShaderCode, fragmentShaderSize);
     // Création d'un pipeline layout pour héberger nos pipelines graphique mais ici nous n'en avons qu'un seul
     VkPipelineLayout pipelineLayout = createPipelineLayout(&device);
-    // Création du pipeline graphique principal, on lui passe nos shader modules, sont layout, la render passe ainsi que les extensions de la swap chain
-    VkPipeline graphicsPipeline = createGraphicsPipeline(&device, &pipelineLayout, &vertexShaderModule,
-                                                         &fragmentShaderModule, &renderPass, &bestSwapchainExtent);
+    // Bibliothèque de pipelines : les parties sont compilées une fois, chaque variante n'est qu'une édition de liens
+    PipelineLibrary *pipelineLibrary = createPipelineLibrary(pBestPhysicalDevice, &device);
+    if (pipelineLibrary == VK_NULL_HANDLE)   raise(SIGTERM);
+    // La bibliothèque garde nos shader modules, elle les détruit une fois compilés en parties
+    uint32_t triangleShaders = addPipelineShaders(pipelineLibrary, &pipelineLayout, &sceneRenderTarget, &vertexShaderModule,
+                                                  &fragmentShaderModule);
+    // Création du pipeline graphique principal, sa version optimisée le remplacera entre deux frames
+    VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+    createPipelineVariant(pipelineLibrary, triangleShaders, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, PIPELINE_BLEND_OPAQUE,
+                          &graphicsPipeline);
 
-    // Une fois le byte code de nos shaders injecté dans le pipeline graphique on peut libérer les ressources
-    // On retire à notre logical device le module fragment shader
-    deleteShaderModule(&device, &fragmentShaderModule);
+    // Une fois le byte code de nos shaders injecté dans les modules on peut libérer les ressources
     // On supprime le byte code du fragment shader
     deleteShaderCode(&fragmentShaderCode);
-    // On retire à notre logical device le module vertex shader
-    deleteShaderModule(&device, &vertexShaderModule);
     // On supprime le byte code du vertex shader
     deleteShaderCode(&vertexShaderCode);
 
+    TRACE_END();
     /**
   * ------------- Étape n°7 Command Pool et Command Buffers -------------
   */
+    TRACE_BEGIN("step 7 scene resources");
 
     // Allocateur principal pour nous command buffer
     VkCommandPool commandPool = createCommandPool(&device, bestGraphicsQueueFamilyindex);
     // Allocation d'un command buffer à partir du pool
     VkCommandBuffer *commandBuffers = createCommandBuffers(&device, &commandPool, swapchainImageNumber);
-    recordCommandBuffers(&commandBuffers, &renderPass, &framebuffers, &bestSwapchainExtent, &graphicsPipeline,
-                         swapchainImageNumber);
+
+    // Rendu du texte : un atlas de glyphes et un seul draw indirect instancié par image
+    VkShaderModule textVertexShaderModule = loadShaderModule(&device, "Shaders/text_vertex.spv");
+    VkShaderModule textFragmentShaderModule = loadShaderModule(&device, "Shaders/text_fragment.spv");
+    TextRenderer textRenderer = createTextRenderer(pBestPhysicalDevice, &device, &drawingQueue, &commandPool, &sceneRenderTarget,
+                                                   &bestSwapchainExtent, &textVertexShaderModule,
+                                                   &textFragmentShaderModule, swapchainImageNumber, 4096);
+    deleteShaderModule(&device, &textFragmentShaderModule);
+    deleteShaderModule(&device, &textVertexShaderModule);
+    // Table globale : l'atlas puis chaque texture chargée y prennent un emplacement, liée une fois par le draw du texte
+    BindlessTable *bindlessTable = VK_NULL_HANDLE;
+    if (useBindless && textRenderer.pipeline != VK_NULL_HANDLE) {
+        bindlessTable = createBindlessTable(pBestPhysicalDevice, &device);
+    }
+    if (bindlessTable != VK_NULL_HANDLE) {
+        VkShaderModule spriteShaderModules[] = {
+            loadShaderModule(&device, "Shaders/sprite_vertex.spv"),
+            loadShaderModule(&device, "Shaders/sprite_fragment.spv")
+        };
+        if (spriteShaderModules[0] == VK_NULL_HANDLE || spriteShaderModules[1] == VK_NULL_HANDLE ||
+            useTextBindlessTable(&device, &textRenderer, bindlessTable, &sceneRenderTarget, &spriteShaderModules[0],
+                                 &spriteShaderModules[1]) != 0) {
+            deleteBindlessTable(&device, &bindlessTable);
+        }
+        for (uint32_t i = 0; i < 2; i++) {
+            deleteShaderModule(&device, &spriteShaderModules[i]);
+        }
+    }
+
+    // Particules : émission, intégration, recyclage et culling en compute, un seul draw indirect
+    const char *particleShaderFileNames[] = {
+        "Shaders/particle_emit.spv", "Shaders/particle_simulate.spv", "Shaders/particle_cull.spv",
+        "Shaders/particle_vertex.spv", "Shaders/particle_fragment.spv"
+    };
+    VkShaderModule particleShaderModules[5];
+    for (uint32_t i = 0; i < 5; i++) {
+        particleShaderModules[i] = loadShaderModule(&device, particleShaderFileNames[i]);
+    }
+    ParticleSystem particleSystem = createParticleSystem(pBestPhysicalDevice, &device, &drawingQueue, &commandPool,
+                                                         &sceneRenderTarget, &bestSwapchainExtent, particleShaderModules,
+                                                         swapchainImageNumber, 1 << 20);
+    for (uint32_t i = 0; i < 5; i++) {
+        deleteShaderModule(&device, &particleShaderModules[i]);
+    }
+
+    // Post-traitement : bloom, vignette et scanlines CRT, chaque étape est une passe du graphe
+    VkShaderModule postShaderModules[] = {
+        loadShaderModule(&device, "Shaders/post_vertex.spv"),
+        loadShaderModule(&device, "Shaders/post_bloom.spv"),
+        loadShaderModule(&device, "Shaders/post_composite.spv")
+    };
+    PostChain postChain = createPostChain(&device, &renderTarget, &bestSwapchainExtent, postShaderModules, postStages,
+                                          gpuBudget);
+    for (uint32_t i = 0; i < 3; i++) {
+        deleteShaderModule(&device, &postShaderModules[i]);
+    }
+
+    // Écran partagé : le texte et les particules prennent les transformations des deux vues
+    SplitScreen splitScreen;
+    memset(&splitScreen, 0, sizeof(SplitScreen));
+    if (useSplitScreen) {
+        VkShaderModule splitShaderModules[] = {
+            loadShaderModule(&device, "Shaders/post_vertex.spv"),
+            loadShaderModule(&device, "Shaders/split_composite.spv")
+        };
+        splitScreen = createSplitScreen(&device, &renderTarget, &bestSwapchainExtent, splitShaderModules);
+        for (uint32_t i = 0; i < 2; i++) {
+            deleteShaderModule(&device, &splitShaderModules[i]);
+        }
+        textRenderer.viewConstants = splitScreen.viewConstants;
+        particleSystem.viewConstants = splitScreen.viewConstants;
+    }
+
+    // Overlay de performance : dessiné sur la swapchain après le post-traitement, hors écran partagé
+    PerfHud perfHud;
+    memset(&perfHud, 0, sizeof(PerfHud));
+    if (useHud) {
+        VkShaderModule hudShaderModules[] = {
+            loadShaderModule(&device, "Shaders/text_vertex.spv"),
+            loadShaderModule(&device, "Shaders/text_fragment.spv")
+        };
+        perfHud = createPerfHud(pBestPhysicalDevice, &device, &drawingQueue, &commandPool, &renderTarget,
+                                &bestSwapchainExtent, hudShaderModules, swapchainImageNumber);
+        for (uint32_t i = 0; i < 2; i++) {
+            deleteShaderModule(&device, &hudShaderModules[i]);
+        }
+    }
+
+    if (textRenderer.pipeline == VK_NULL_HANDLE || particleSystem.drawPipeline == VK_NULL_HANDLE ||
+        (postStages != 0 && postChain.compositePipeline == VK_NULL_HANDLE) ||
+        (useSplitScreen && splitScreen.pipeline == VK_NULL_HANDLE) ||
+        (useHud && perfHud.textRenderer.pipeline == VK_NULL_HANDLE)) {
+        printf("VkSceneException : unable to create the text renderer, the particle system, the post-processing chain, the split screen or the overlay\n");
+
+        deletePerfHud(&device, &perfHud);
+        deleteSplitScreen(&device, &splitScreen);
+        deletePostChain(&device, &postChain);
+        deleteParticleSystem(&device, &particleSystem);
+        deleteTextRenderer(&device, &textRenderer);
+        if (bindlessTable != VK_NULL_HANDLE) {
+            deleteBindlessTable(&device, &bindlessTable);
+        }
+        deleteCommandBuffers(&device, &commandBuffers, &commandPool, swapchainImageNumber);
+        deleteCommandPool(&device, &commandPool);
+        deleteGraphicsPipeline(&device, &graphicsPipeline);
+        deletePipelineLibrary(&device, &pipelineLibrary);
+        deletePipelineLayout(&device, &pipelineLayout);
+        deleteRenderTarget(&device, &sceneRenderTarget);
+        deleteRenderTarget(&device, &renderTarget);
+        deleteImageViews(&device, &swapchainImageViews, swapchainImageNumber);
+        deleteSwapchainImages(&swapchainImages);
+        deleteSwapchain(&device, &swapchain);
+        deleteSurface(&surface, &instance);
+        deleteWindow(window);
+        deleteDevice(&device);
+        deletePhysicalDevices(&physicalDevices);
+        deleteInstance(&instance);
+        deleteHostAllocator();
+
+        return 1;
+    }
+
+    PongScene scene;
+    initMatch(&scene.match, (uint64_t)time(NULL));
+    scene.pTrianglePipeline = &graphicsPipeline;
+    scene.pPipelineLibrary = pipelineLibrary;
+    scene.pTextRenderer = &textRenderer;
+    scene.pParticleSystem = &particleSystem;
+    scene.pWindow = window;
+    scene.isStatsKeyDown = 0;
+    scene.isPauseKeyDown = 0;
+    scene.isPaused = 0;
+    scene.isHudKeyDown = 0;
+    scene.frameStartTime = 0.0;
+    scene.allocationNumber = getHostAllocationNumber() + getHeapAllocationNumber();
+    scene.pRedrawState = VK_NULL_HANDLE;
+    scene.pAudioMixer = VK_NULL_HANDLE;
+    scene.pTextureStreamer = VK_NULL_HANDLE;
+    scene.skinFileNames = skinFileNames;
+    scene.skinNumber = skinNumber;
+    scene.skinIndex = 0;
+    for (uint32_t i = 0; i < VK_PONG_MAX_SKINS; i++) {
+        scene.skinTextures[i] = STREAM_INVALID_TEXTURE;
+        scene.skinSprites[i] = BINDLESS_INVALID_INDEX;
+    }
+    scene.pBindlessTable = bindlessTable;
+    scene.skinSet = VK_NULL_HANDLE;
+    scene.skinPipeline = VK_NULL_HANDLE;
+    scene.skinPipelineLayout = VK_NULL_HANDLE;
+    scene.isSkinKeyDown = 0;
+    scene.extent = bestSwapchainExtent;
+    scene.lastTime = glfwGetTime();
+    scene.accumulator = 0.0;
+
+    // Graphe de rendu : chaque passe déclare ce qu'elle lit et écrit, le graphe en déduit les barrières
+    RenderGraph *renderGraph = createRenderGraph(&device, getSynchronization2Support(pBestPhysicalDevice), dynamicRendering);
+    if (renderGraph == VK_NULL_HANDLE)   raise(SIGTERM);
+    scene.pRenderGraph = renderGraph;
+    scene.pPostChain = &postChain;
+    scene.pSplitScreen = useSplitScreen ? &splitScreen : VK_NULL_HANDLE;
+    scene.pCommandBuffers = commandBuffers;
+    uint32_t backbuffer = importGraphImage(renderGraph, "backbuffer", bestSurfaceFormat.format, &bestSwapchainExtent,
+                                           swapchainImages, swapchainImageViews, swapchainImageNumber,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    uint32_t particleBuffers[] = {
+        importGraphBuffer(renderGraph, "particles", particleSystem.particleBuffer),
+        importGraphBuffer(renderGraph, "particle free list", particleSystem.freeListBuffer),
+        importGraphBuffer(renderGraph, "particle alive list", particleSystem.aliveListBuffer),
+        importGraphBuffer(renderGraph, "particle state", particleSystem.stateBuffer),
+        importGraphBuffer(renderGraph, "particle visible list", particleSystem.visibleListBuffer),
+        importGraphBuffer(renderGraph, "particle draw", particleSystem.drawBuffer)
+    };
+
+    uint32_t particlePass = addGraphPass(renderGraph, "particles", VK_PIPELINE_BIND_POINT_COMPUTE,
+                                         recordPongSceneUpdate, &scene);
+    for (uint32_t i = 0; i < 6; i++) {
+        addGraphPassUse(renderGraph, particlePass, particleBuffers[i], GRAPH_USE_COMPUTE_STORAGE_WRITE);
+    }
+
+    // La scène est dessinée dans l'image d'entrée du post-traitement, ou directement dans la swapchain sans étape
+    uint32_t sceneTarget = addPostChainInput(&postChain, renderGraph, bestSurfaceFormat.format, backbuffer);
+    if (useSplitScreen) {
+        sceneTarget = addSplitScreenInput(&splitScreen, renderGraph, bestSurfaceFormat.format, sceneTarget);
+    }
+    uint32_t scenePass = addGraphPass(renderGraph, "scene", VK_PIPELINE_BIND_POINT_GRAPHICS, recordPongScene, &scene);
+    scene.scenePass = scenePass;
+    VkClearValue clearValue = {{{0.6f, 0.2f, 0.8f, 0.0f}}};
+    addGraphColorAttachment(renderGraph, scenePass, sceneTarget, VK_ATTACHMENT_LOAD_OP_CLEAR, &clearValue);
+    addGraphPassUse(renderGraph, scenePass, particleBuffers[0], GRAPH_USE_VERTEX_STORAGE_READ);
+    addGraphPassUse(renderGraph, scenePass, particleBuffers[4], GRAPH_USE_VERTEX_STORAGE_READ);
+    addGraphPassUse(renderGraph, scenePass, particleBuffers[5], GRAPH_USE_INDIRECT_READ);
+    if (useSplitScreen) {
+        addSplitScreenPasses(&splitScreen, renderGraph, scenePass);
+    }
+    addPostChainPasses(&postChain, renderGraph);
+    scene.pPerfHud = VK_NULL_HANDLE;
+    if (useHud && addPerfHudPass(&perfHud, renderGraph, backbuffer) != GRAPH_INVALID_INDEX) {
+        scene.pPerfHud = &perfHud;
+    }
+
+    // La capture copie l'image finale après le post-traitement, la swapchain doit pouvoir servir de source de copie
+    scene.pFrameCapture = VK_NULL_HANDLE;
+    if (captureFileName != NULL) {
+        if (surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+            uint32_t captureSlotNumber = 2 * swapchainImageNumber;
+            scene.pFrameCapture = createFrameCapture(pBestPhysicalDevice, &device, bestSurfaceFormat.format,
+                                                     &bestSwapchainExtent, captureFileName, captureRate,
+                                                     captureSlotNumber > CAPTURE_MAX_SLOTS ? CAPTURE_MAX_SLOTS : captureSlotNumber);
+        } else {
+            printf("VkCaptureException : the swapchain images cannot be copied on this surface\n");
+        }
+        if (scene.pFrameCapture != VK_NULL_HANDLE) {
+            addFrameCapturePass(scene.pFrameCapture, renderGraph, backbuffer);
+        }
+    }
+
+    if (compileRenderGraph(pBestPhysicalDevice, renderGraph) != 0) {
+        printf("VkGraphException : unable to compile the render graph\n");
+
+        if (scene.pFrameCapture != VK_NULL_HANDLE) {
+            deleteFrameCapture(&device, &scene.pFrameCapture);
+        }
+        deleteRenderGraph(&device, &renderGraph);
+        deletePerfHud(&device, &perfHud);
+        deleteSplitScreen(&device, &splitScreen);
+        deletePostChain(&device, &postChain);
+        deleteParticleSystem(&device, &particleSystem);
+        deleteTextRenderer(&device, &textRenderer);
+        if (bindlessTable != VK_NULL_HANDLE) {
+            deleteBindlessTable(&device, &bindlessTable);
+        }
+        deleteCommandBuffers(&device, &commandBuffers, &commandPool, swapchainImageNumber);
+        deleteCommandPool(&device, &commandPool);
+        deleteGraphicsPipeline(&device, &graphicsPipeline);
+        deletePipelineLibrary(&device, &pipelineLibrary);
+        deletePipelineLayout(&device, &pipelineLayout);
+        deleteRenderTarget(&device, &sceneRenderTarget);
+        deleteRenderTarget(&device, &renderTarget);
+        deleteImageViews(&device, &swapchainImageViews, swapchainImageNumber);
+        deleteSwapchainImages(&swapchainImages);
+        deleteSwapchain(&device, &swapchain);
+        deleteSurface(&surface, &instance);
+        deleteWindow(window);
+        deleteDevice(&device);
+        deletePhysicalDevices(&physicalDevices);
+        deleteInstance(&instance);
+        deleteHostAllocator();
+
+        return 1;
+    }
+    bindPostChainImages(&device, &postChain, renderGraph);
+    if (useSplitScreen) {
+        bindSplitScreenImages(&device, &splitScreen, renderGraph);
+    }
+    printRenderGraph(renderGraph);
+    recordRenderGraphCommandBuffers(renderGraph, &commandBuffers, swapchainImageNumber);
+    for (uint32_t i = 0; i < swapchainImageNumber; i++) {
+        scene.recordedExtents[i] = bestSwapchainExtent;
+        scene.recordedGenerations[i] = 0;
+    }
+    scene.pipelineGeneration = 0;
+    scene.imageNumber = swapchainImageNumber;
     // Nombre maximum d'opérations authorisées sur les images
     uint32_t maxFrames = 2;
     // Création de sémaphore pour synchroniser la génération d'image et le rendu comme les command buffers sont asynchrones
     VkSemaphore *waitSemaphores = createSemaphores(&device, maxFrames), *signalSemaphores = createSemaphores(&device,maxFrames);
     // On créer des barrières qui servent à abriter le résultat de nos calculs sont les objects synchronisé entre les threads de génération et rendu
     VkFence *frontFences = createFences(&device, maxFrames), *backFences = createEmptyFences(swapchainImageNumber);
+    // Les objets remplacés en cours de route sont détruits quand le GPU a fini la frame qui les utilisait
+    DeletionQueue *deletionQueue = createDeletionQueue(&device, maxFrames);
+    if (deletionQueue == VK_NULL_HANDLE)   raise(SIGTERM);
+    scene.pDeletionQueue = deletionQueue;
+    // Le thread de surveillance reconstruit les pipelines dont un shader source a été sauvegardé
+    PipelineRecipe pipelineRecipes[] = {
+        {&pipelineLayout, &sceneRenderTarget, &bestSwapchainExtent},
+        {&postChain.pipelineLayout, &renderTarget, &postChain.bloomExtent},
+        {&postChain.pipelineLayout, &renderTarget, &bestSwapchainExtent},
+        {&splitScreen.pipelineLayout, &renderTarget, &bestSwapchainExtent}
+    };
+    scene.pShaderReloader = hotReload ? createShaderReloader(&device, VK_PONG_SHADER_DIR) : VK_NULL_HANDLE;
+    if (scene.pShaderReloader != VK_NULL_HANDLE) {
+        addReloadPipeline(scene.pShaderReloader, "triangle.vert", "triangle.frag", buildPongPipeline,
+                          &pipelineRecipes[0], &graphicsPipeline);
+        if (postChain.stages & POST_STAGE_BLOOM) {
+            addReloadPipeline(scene.pShaderReloader, "post.vert", "post_bloom.frag", buildPongPipeline,
+                              &pipelineRecipes[1], &postChain.bloomPipeline);
+        }
+        if (postChain.stages != 0) {
+            addReloadPipeline(scene.pShaderReloader, "post.vert", "post_composite.frag", buildPongPipeline,
+                              &pipelineRecipes[2], &postChain.compositePipeline);
+        }
+        if (useSplitScreen) {
+            addReloadPipeline(scene.pShaderReloader, "post.vert", "split.frag", buildPongPipeline,
+                              &pipelineRecipes[3], &splitScreen.pipeline);
+        }
+        if (startShaderReloader(scene.pShaderReloader) != 0) {
+            deleteShaderReloader(&device, &scene.pShaderReloader);
+        }
+    }
+    // Un worker par coeur, le thread principal est le worker 0 et ne fait tourner des jobs que pendant ses attentes,
+    // le streamer a besoin d'au moins un autre worker
+    scene.pJobSystem = createJobSystem(getHardwareThreadNumber() > 1 ? 0 : 2);
+    scene.simulationCounter.value = 0;
+    scene.tickNumber = 0;
+    scene.simulationTime = 0.0;
+    if (scene.pJobSystem == VK_NULL_HANDLE) {
+        printf("JobException : unable to create the job system, the simulation runs on the main thread\n");
+    }
+    // Le premier fond est demandé tout de suite, le match démarre sans l'attendre
+    if (skinNumber > 0) {
+        scene.pTextureStreamer = createTextureStreamer(pBestPhysicalDevice, &device, bestGraphicsQueueFamilyindex, &drawingQueue,
+                                                       transferQueueFamilyIndex, &transferQueue, scene.pJobSystem);
+    }
+    if (scene.pTextureStreamer != VK_NULL_HANDLE) {
+        VkShaderModule skinShaderModules[] = {
+            loadShaderModule(&device, "Shaders/post_vertex.spv"),
+            loadShaderModule(&device, "Shaders/skin_fragment.spv")
+        };
+        scene.skinPipelineLayout = createTexturePipelineLayout(&device, getTextureSetLayout(scene.pTextureStreamer));
+        if (scene.skinPipelineLayout != VK_NULL_HANDLE && skinShaderModules[0] != VK_NULL_HANDLE &&
+            skinShaderModules[1] != VK_NULL_HANDLE) {
+            scene.skinPipeline = createGraphicsPipeline(&device, &scene.skinPipelineLayout, &skinShaderModules[0],
+                                                        &skinShaderModules[1], &sceneRenderTarget, &bestSwapchainExtent);
+        }
+        for (uint32_t i = 0; i < 2; i++) {
+            deleteShaderModule(&device, &skinShaderModules[i]);
+        }
+        if (scene.skinPipeline != VK_NULL_HANDLE) {
+            scene.skinTextures[0] = requestTexture(scene.pTextureStreamer, skinFileNames[0]);
+        } else {
+            printf("VkStreamException : unable to create the skin pipeline, the field keeps its color\n");
+            deleteTextureStreamer(&device, &scene.pTextureStreamer);
+        }
+    }
 
+    TRACE_END();
     /**
   * ------------- Étape n°8 Boucle principale -------------
   */
+    TRACE_BEGIN("step 8 main loop");
   // Boucle principal du programme
+    FrameLimiter frameLimiter = createFrameLimiter(frameLimit);
+    scene.pFrameLimiter = frameLimiter.period != 0 ? &frameLimiter : VK_NULL_HANDLE;
+    // Rendu à la demande : une touche relâchée pendant le sommeil reste visible pour glfwGetKey
+    if (onDemand) {
+        glfwSetInputMode(window, GLFW_STICKY_KEYS, GLFW_TRUE);
+        scene.pRedrawState = createRedrawState(window, REDRAW_IDLE_TIMEOUT);
+    }
+    if (audioOutput != NULL) {
+        AudioSinkType sinkType = strcmp(audioOutput, "alsa") == 0 ? AUDIO_SINK_ALSA :
+                                 strcmp(audioOutput, "null") == 0 ? AUDIO_SINK_NULL : AUDIO_SINK_WAV;
+        scene.pAudioMixer = createAudioMixer(sinkType, audioOutput);
+    }
+    if (scene.pAudioMixer != VK_NULL_HANDLE) {
+        // Pas de fichiers sons : raquette, mur et but sont synthétisés une fois avant le démarrage du mixeur
+        scene.sounds[0] = addAudioTone(scene.pAudioMixer, 660.0f, 440.0f, 0.08f);
+        scene.sounds[1] = addAudioTone(scene.pAudioMixer, 330.0f, 300.0f, 0.06f);
+        scene.sounds[2] = addAudioTone(scene.pAudioMixer, 220.0f, 880.0f, 0.5f);
+        if (scene.sounds[0] == AUDIO_INVALID_SOUND || scene.sounds[1] == AUDIO_INVALID_SOUND ||
+            scene.sounds[2] == AUDIO_INVALID_SOUND || startAudioMixer(scene.pAudioMixer) != 0) {
+            deleteAudioMixer(&scene.pAudioMixer);
+        }
+    }
+    FrameSubmitter *pFrameSubmitter = VK_NULL_HANDLE;
+    if (useSubmitThread) {
+        pFrameSubmitter = createFrameSubmitter(&device, &swapchain, &drawingQueue, &presentingQueue, commandBuffers,
+                                               frontFences, backFences, waitSemaphores, signalSemaphores, maxFrames);
+    }
+    if (scene.pTextureStreamer != VK_NULL_HANDLE) {
+        setTextureStreamerSubmitter(scene.pTextureStreamer, pFrameSubmitter);
+    }
     presentImage(&device, window, commandBuffers, frontFences, backFences, waitSemaphores, signalSemaphores, &swapchain,
-                 &drawingQueue, &presentingQueue, maxFrames);
+                 &drawingQueue, &presentingQueue, maxFrames, updatePongScene, &scene, deletionQueue, scene.pFrameLimiter,
+                 scene.pRedrawState, pFrameSubmitter);
+    if (pFrameSubmitter != VK_NULL_HANDLE) {
+        if (scene.pTextureStreamer != VK_NULL_HANDLE) {
+            setTextureStreamerSubmitter(scene.pTextureStreamer, VK_NULL_HANDLE);
+        }
+        deleteFrameSubmitter(&pFrameSubmitter);
+    }
+    if (scene.pFrameLimiter != VK_NULL_HANDLE) {
+        printFrameLimiter(&frameLimiter);
+    }
+    if (scene.pJobSystem != VK_NULL_HANDLE) {
+        printJobSystem(scene.pJobSystem);
+    }
+    printRedrawState(scene.pRedrawState);
+    if (scene.pPerfHud != VK_NULL_HANDLE) {
+        printPerfHud(scene.pPerfHud);
+    }
+    deleteRedrawState(window, &scene.pRedrawState);
+    if (scene.pAudioMixer != VK_NULL_HANDLE) {
+        deleteAudioMixer(&scene.pAudioMixer);
+    }
 
+    TRACE_END();
     /**
   * ------------- Étape n°9 Gros ménage -------------
   */
+    TRACE_BEGIN("step 9 cleanup");
+    if (scene.pFrameCapture != VK_NULL_HANDLE) {
+        deleteFrameCapture(&device, &scene.pFrameCapture);
+    }
+    if (scene.pShaderReloader != VK_NULL_HANDLE) {
+        deleteShaderReloader(&device, &scene.pShaderReloader);
+    }
+    if (scene.pTextureStreamer != VK_NULL_HANDLE) {
+        deleteTextureStreamer(&device, &scene.pTextureStreamer);
+    }
+    if (scene.skinPipeline != VK_NULL_HANDLE) {
+        deleteGraphicsPipeline(&device, &scene.skinPipeline);
+    }
+    if (scene.skinPipelineLayout != VK_NULL_HANDLE) {
+        deletePipelineLayout(&device, &scene.skinPipelineLayout);
+    }
+    if (scene.pJobSystem != VK_NULL_HANDLE) {
+        deleteJobSystem(&scene.pJobSystem);
+    }
+    deleteDeletionQueue(&device, &deletionQueue);
     deleteEmptyFences(&backFences);
     deleteFences(&device, &frontFences, maxFrames);
     deleteSemaphores(&device, &signalSemaphores, maxFrames);
     deleteSemaphores(&device, &waitSemaphores, maxFrames);
+    printRenderGraph(renderGraph);
+    deleteRenderGraph(&device, &renderGraph);
+    deletePerfHud(&device, &perfHud);
+    deleteSplitScreen(&device, &splitScreen);
+    deletePostChain(&device, &postChain);
+    deleteParticleSystem(&device, &particleSystem);
+    deleteTextRenderer(&device, &textRenderer);
+    if (bindlessTable != VK_NULL_HANDLE) {
+        deleteBindlessTable(&device, &bindlessTable);
+    }
     deleteCommandBuffers(&device, &commandBuffers, &commandPool, swapchainImageNumber);
     deleteCommandPool(&device, &commandPool);
     deleteGraphicsPipeline(&device, &graphicsPipeline);
+    printPipelineLibrary(pipelineLibrary);
+    deletePipelineLibrary(&device, &pipelineLibrary);
     deletePipelineLayout(&device, &pipelineLayout);
-    deleteFramebuffers(&device, &framebuffers, swapchainImageNumber);
-    deleteRenderPass(&device, &renderPass);
+    deleteRenderTarget(&device, &sceneRenderTarget);
+    deleteRenderTarget(&device, &renderTarget);
     deleteImageViews(&device, &swapchainImageViews, swapchainImageNumber);
     deleteSwapchainImages(&swapchainImages);
     deleteSwapchain(&device, &swapchain);
@@ -221,6 +1138,9 @@ int main() {
     deleteDevice(&device);
     deletePhysicalDevices(&physicalDevices);
     deleteInstance(&instance);
+    printHostAllocator();
+    deleteHostAllocator();
+    TRACE_END();
 
     glfwTerminate();
     return 0;
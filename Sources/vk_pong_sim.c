@@ -0,0 +1,344 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../Headers/std_c.h"
+#include "../Headers/sim_fun.h"
+
+static double getSeconds(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/**
+ * Mesure du débit de stepBatch avec un contrôleur qui suit la balle
+ */
+static int runBatchBenchmark(uint32_t matchNumber, uint32_t stepNumber) {
+    PongBatch batch = createBatch(matchNumber, 1);
+    float *observations = (float *)malloc(SIM_OBSERVATION_SIZE * matchNumber * sizeof(float));
+    float *actions = (float *)malloc(2 * matchNumber * sizeof(float));
+    float *rewards = (float *)malloc(matchNumber * sizeof(float));
+    uint8_t *dones = (uint8_t *)malloc(matchNumber * sizeof(uint8_t));
+    if(batch.memory == NULL || observations == NULL || actions == NULL || rewards == NULL || dones == NULL){
+        printf("SimException : unable to allocate a batch of %u matches\n", matchNumber);
+        free(dones);
+        free(rewards);
+        free(actions);
+        free(observations);
+        deleteBatch(&batch);
+        return 1;
+    }
+
+    getBatchObservations(&batch, observations);
+    const float *ballY = observations + SIM_OBSERVATION_BALL_Y * matchNumber;
+    const float *leftPaddleY = observations + SIM_OBSERVATION_LEFT_PADDLE_Y * matchNumber;
+    const float *rightPaddleY = observations + SIM_OBSERVATION_RIGHT_PADDLE_Y * matchNumber;
+
+    uint64_t doneNumber = 0;
+    double start = getSeconds();
+    for(uint32_t step = 0; step < stepNumber; step++){
+        for(uint32_t i = 0; i < matchNumber; i++){
+            actions[i] = ballY[i] > leftPaddleY[i] ? 0.4f : -0.4f;
+            actions[matchNumber + i] = (ballY[i] - rightPaddleY[i]) / SIM_PADDLE_SPEED;
+        }
+        stepBatch(&batch, actions, observations, rewards, dones);
+        for(uint32_t i = 0; i < matchNumber; i++){
+            doneNumber += dones[i];
+        }
+    }
+    double seconds = getSeconds() - start;
+
+    double stepsPerSecond = seconds > 0.0 ? (double)matchNumber * stepNumber / seconds : 0.0;
+    printf("%u matches x %u steps in %.3f s : %.1f M steps/s, %llu matches finished\n",
+           matchNumber, stepNumber, seconds, stepsPerSecond * 1e-6, (unsigned long long)doneNumber);
+
+    free(dones);
+    free(rewards);
+    free(actions);
+    free(observations);
+    deleteBatch(&batch);
+    return 0;
+}
+
+/**
+ * Joue les mêmes matchs avec stepBatch et stepMatch et compare leurs états bit à bit après chaque pas
+ */
+static int runBatchCheck(uint32_t matchNumber, uint32_t stepNumber) {
+    const uint64_t baseSeed = 1;
+    PongBatch batch = createBatch(matchNumber, baseSeed);
+    PongMatch *matches = (PongMatch *)malloc(matchNumber * sizeof(PongMatch));
+    uint64_t *seeds = (uint64_t *)malloc(matchNumber * sizeof(uint64_t));
+    float *observations = (float *)malloc(SIM_OBSERVATION_SIZE * matchNumber * sizeof(float));
+    float *actions = (float *)malloc(2 * matchNumber * sizeof(float));
+    float *rewards = (float *)malloc(matchNumber * sizeof(float));
+    uint8_t *dones = (uint8_t *)malloc(matchNumber * sizeof(uint8_t));
+    if(batch.memory == NULL || matches == NULL || seeds == NULL || observations == NULL || actions == NULL || rewards == NULL || dones == NULL){
+        printf("SimException : unable to allocate a batch of %u matches\n", matchNumber);
+        free(dones);
+        free(rewards);
+        free(actions);
+        free(observations);
+        free(seeds);
+        free(matches);
+        deleteBatch(&batch);
+        return 1;
+    }
+
+    uint64_t nextSeed = baseSeed + matchNumber;
+    for(uint32_t i = 0; i < matchNumber; i++){
+        seeds[i] = baseSeed + i;
+        initMatch(&matches[i], seeds[i]);
+    }
+
+    int result = 0;
+    uint64_t hitNumber = 0, doneNumber = 0;
+    for(uint32_t step = 0; step < stepNumber && result == 0; step++){
+        // Les deux côtés reçoivent les commandes de l'IA calculées sur l'état de référence
+        for(uint32_t i = 0; i < matchNumber; i++){
+            actions[i] = getAIAction(&matches[i], 0, 0.8f);
+            actions[matchNumber + i] = getAIAction(&matches[i], 1, 0.8f);
+        }
+        stepBatch(&batch, actions, observations, rewards, dones);
+
+        for(uint32_t i = 0; i < matchNumber; i++){
+            uint32_t events = stepMatch(&matches[i], actions[i], actions[matchNumber + i]);
+            float reward = (events & SIM_EVENT_GOAL_LEFT) ? 1.0f : (events & SIM_EVENT_GOAL_RIGHT) ? -1.0f : 0.0f;
+            uint8_t done = (events & SIM_EVENT_MATCH_OVER) != 0;
+            hitNumber += (events & SIM_EVENT_PADDLE_HIT) != 0;
+            doneNumber += done;
+            // Un match fini repart avec la graine suivante, dans l'ordre des lignes comme stepBatch
+            if(done){
+                seeds[i] = nextSeed++;
+                initMatch(&matches[i], seeds[i]);
+            }
+
+            PongMatch batchMatch;
+            getBatchMatch(&batch, i, &batchMatch);
+            if(memcmp(&batchMatch, &matches[i], sizeof(PongMatch)) != 0 || rewards[i] != reward || dones[i] != done){
+                printf("SimException : stepBatch diverges from stepMatch on match %u (seed %llu) at step %u\n"
+                       "  stepMatch : ball %a %a %a %a, ai error %a %a, score %u-%u, tick %u, hits %u, rally %u, rng %llx\n"
+                       "  stepBatch : ball %a %a %a %a, ai error %a %a, score %u-%u, tick %u, hits %u, rally %u, rng %llx\n",
+                       i, (unsigned long long)seeds[i], step,
+                       matches[i].ballX, matches[i].ballY, matches[i].ballVX, matches[i].ballVY,
+                       matches[i].aiError[0], matches[i].aiError[1], matches[i].score[0], matches[i].score[1],
+                       matches[i].tick, matches[i].hits, matches[i].rally, (unsigned long long)matches[i].rngState,
+                       batchMatch.ballX, batchMatch.ballY, batchMatch.ballVX, batchMatch.ballVY,
+                       batchMatch.aiError[0], batchMatch.aiError[1], batchMatch.score[0], batchMatch.score[1],
+                       batchMatch.tick, batchMatch.hits, batchMatch.rally, (unsigned long long)batchMatch.rngState);
+                result = 1;
+                break;
+            }
+        }
+    }
+
+    if(result == 0){
+        printf("%u matches x %u steps : stepBatch matches stepMatch bit for bit, %llu paddle hits, %llu matches finished\n",
+               matchNumber, stepNumber, (unsigned long long)hitNumber, (unsigned long long)doneNumber);
+    }
+
+    free(dones);
+    free(rewards);
+    free(actions);
+    free(observations);
+    free(seeds);
+    free(matches);
+    deleteBatch(&batch);
+    return result;
+}
+
+#define JOB_BENCHMARK_BATCH 1024
+#define JOB_BENCHMARK_INDICES (1u << 20)
+#define JOB_BENCHMARK_GRAIN 1024
+
+static void runEmptyJob(void *pData){
+    (void)pData;
+}
+
+/**
+ * Quelques dizaines de cycles par indice : assez pour que le découpage compte, pas assez pour le cacher
+ */
+static void hashRange(void *pData, uint32_t begin, uint32_t end){
+    uint32_t *values = (uint32_t *)pData;
+    for(uint32_t i = begin; i < end; i++){
+        uint32_t value = i;
+        for(uint32_t j = 0; j < 16; j++){
+            value ^= value >> 16;
+            value *= 0x7feb352du;
+            value ^= value >> 15;
+        }
+        values[i] = value;
+    }
+}
+
+/**
+ * Surcoût d'ordonnancement d'un job vide et passage à l'échelle d'un parallel for, de 1 à maxThreads workers
+ */
+static int runJobBenchmark(uint32_t maxThreads, uint32_t jobNumber) {
+    uint32_t *values = (uint32_t *)malloc(JOB_BENCHMARK_INDICES * sizeof(uint32_t));
+    if(values == NULL){
+        printf("JobException : unable to allocate %u values\n", JOB_BENCHMARK_INDICES);
+        return 1;
+    }
+    if(maxThreads > JOB_MAX_WORKERS){
+        maxThreads = JOB_MAX_WORKERS;
+    }
+
+    double singleSeconds = 0.0;
+    for(uint32_t threadNumber = 1; threadNumber <= maxThreads; threadNumber *= 2){
+        JobSystem *pJobSystem = createJobSystem(threadNumber);
+        if(pJobSystem == NULL){
+            printf("JobException : unable to create a job system of %u workers\n", threadNumber);
+            free(values);
+            return 1;
+        }
+
+        // Les jobs vides partent par lots, le worker 0 les pousse puis aide à les vider
+        double start = getSeconds();
+        for(uint32_t done = 0; done < jobNumber; done += JOB_BENCHMARK_BATCH){
+            JobCounter counter = {0};
+            for(uint32_t i = done; i < jobNumber && i < done + JOB_BENCHMARK_BATCH; i++){
+                runJob(pJobSystem, runEmptyJob, NULL, &counter);
+            }
+            waitJobCounter(pJobSystem, &counter);
+        }
+        double emptySeconds = getSeconds() - start;
+
+        // Un premier passage réveille les workers et touche les pages
+        parallelFor(pJobSystem, JOB_BENCHMARK_INDICES, JOB_BENCHMARK_GRAIN, hashRange, values);
+        start = getSeconds();
+        for(uint32_t i = 0; i < 16; i++){
+            parallelFor(pJobSystem, JOB_BENCHMARK_INDICES, JOB_BENCHMARK_GRAIN, hashRange, values);
+        }
+        double forSeconds = (getSeconds() - start) / 16.0;
+        if(threadNumber == 1){
+            singleSeconds = forSeconds;
+        }
+
+        printf("%2u workers : %.1f ns per empty job, parallel for of %u indices in %.3f ms (x%.2f), %llu steals\n",
+               getJobWorkerNumber(pJobSystem), jobNumber != 0 ? emptySeconds * 1e9 / jobNumber : 0.0, JOB_BENCHMARK_INDICES,
+               forSeconds * 1e3, forSeconds > 0.0 ? singleSeconds / forSeconds : 0.0,
+               (unsigned long long)getJobStealNumber(pJobSystem));
+        deleteJobSystem(&pJobSystem);
+    }
+
+    free(values);
+    return 0;
+}
+
+#define BATCH_BENCHMARK_MAX_MATCHES (1u << 24)
+
+static void printUsage(){
+    printf("Usage : vk_pong_sim [matches] [threads] [summary-file] [seed]\n"
+           "        vk_pong_sim batch [matches] [steps]\n"
+           "        vk_pong_sim check [matches] [steps]\n"
+           "        vk_pong_sim jobs [max-threads] [empty-jobs]\n");
+}
+
+/**
+ * Lecture d'un entier décimal, tout le texte doit être consommé et la valeur rester dans [minValue, maxValue]
+ */
+static int parseArgument(const char *text, const char *name, uint64_t minValue, uint64_t maxValue, uint64_t *pValue){
+    // strtoull accepte les espaces et le signe moins, qui donneraient silencieusement une autre valeur
+    char *end = NULL;
+    errno = 0;
+    unsigned long long value = text[0] >= '0' && text[0] <= '9' ? strtoull(text, &end, 10) : 0;
+    if(end == NULL || end == text || *end != '\0' || errno == ERANGE || value < minValue || value > maxValue){
+        printf("SimException : invalid %s '%s', expected an integer from %llu to %llu\n",
+               name, text, (unsigned long long)minValue, (unsigned long long)maxValue);
+        return -1;
+    }
+    *pValue = (uint64_t)value;
+    return 0;
+}
+
+static int parseCount(int argc, char **argv, int index, const char *name, uint32_t minValue, uint32_t maxValue, uint32_t *pValue){
+    uint64_t value = *pValue;
+    if(index < argc && parseArgument(argv[index], name, minValue, maxValue, &value) != 0){
+        return -1;
+    }
+    *pValue = (uint32_t)value;
+    return 0;
+}
+
+/**
+ * Usage : vk_pong_sim [matches] [threads] [summary-file] [seed]
+ *         vk_pong_sim batch [matches] [steps]
+ *         vk_pong_sim check [matches] [steps]
+ *         vk_pong_sim jobs [max-threads] [empty-jobs]
+ */
+int main(int argc, char **argv) {
+    if(argc > 1 && strcmp(argv[1], "batch") == 0){
+        uint32_t batchSize = 4096;
+        uint32_t stepNumber = 10000;
+        if(argc > 4
+           || parseCount(argc, argv, 2, "matches", 1, BATCH_BENCHMARK_MAX_MATCHES, &batchSize) != 0
+           || parseCount(argc, argv, 3, "steps", 1, UINT32_MAX, &stepNumber) != 0){
+            printUsage();
+            return 1;
+        }
+        return runBatchBenchmark(batchSize, stepNumber);
+    }
+    if(argc > 1 && strcmp(argv[1], "check") == 0){
+        uint32_t matchNumber = 64;
+        uint32_t stepNumber = 50000;
+        if(argc > 4
+           || parseCount(argc, argv, 2, "matches", 1, BATCH_BENCHMARK_MAX_MATCHES, &matchNumber) != 0
+           || parseCount(argc, argv, 3, "steps", 1, UINT32_MAX, &stepNumber) != 0){
+            printUsage();
+            return 1;
+        }
+        return runBatchCheck(matchNumber, stepNumber);
+    }
+    if(argc > 1 && strcmp(argv[1], "jobs") == 0){
+        uint32_t maxThreads = JOB_MAX_WORKERS;
+        uint32_t jobNumber = 1000000;
+        if(argc > 4
+           || parseCount(argc, argv, 2, "max-threads", 1, JOB_MAX_WORKERS, &maxThreads) != 0
+           || parseCount(argc, argv, 3, "empty-jobs", 1, UINT32_MAX, &jobNumber) != 0){
+            printUsage();
+            return 1;
+        }
+        return runJobBenchmark(maxThreads, jobNumber);
+    }
+
+    // Un argument invalide, --help compris, n'écrit aucun fichier de résumé
+    uint32_t matchNumber = 10000;
+    uint32_t threadNumber = 0;
+    const char *summaryFileName = argc > 3 ? argv[3] : "vk_pong_sim_summary.txt";
+    uint64_t baseSeed = 1;
+    if(argc > 5
+       || parseCount(argc, argv, 1, "matches", 1, UINT32_MAX, &matchNumber) != 0
+       || parseCount(argc, argv, 2, "threads", 0, JOB_MAX_WORKERS, &threadNumber) != 0
+       || (argc > 4 && parseArgument(argv[4], "seed", 0, UINT64_MAX, &baseSeed) != 0)){
+        printUsage();
+        return 1;
+    }
+
+    if(threadNumber == 0){
+        threadNumber = getHardwareThreadNumber();
+    }
+
+    // Les matchs sont indépendants, aucune fenêtre ni device Vulkan n'est créé
+    uint32_t stealNumber = 0;
+    double start = getSeconds();
+    PongMatchResult *results = runMatches(matchNumber, baseSeed, 0.8f, 0.8f, threadNumber, &stealNumber);
+    double seconds = getSeconds() - start;
+
+    if(results == NULL){
+        printf("SimException : unable to allocate %u match results\n", matchNumber);
+        return 1;
+    }
+
+    printf("%u matches on %u threads in %.3f s : %.1f matches/s, %u steals\n",
+           matchNumber, threadNumber, seconds, seconds > 0.0 ? matchNumber / seconds : 0.0, stealNumber);
+
+    if(writeMatchSummary(summaryFileName, results, matchNumber, seconds, threadNumber) != 0){
+        printf("SimException : unable to write summary file %s\n", summaryFileName);
+        deleteMatchResults(&results);
+        return 1;
+    }
+
+    deleteMatchResults(&results);
+    return 0;
+}
@@ -0,0 +1,279 @@
+#include <math.h>
+
+#include "../Headers/post_fun.h"
+
+static void createPostDescriptorSets(VkDevice *pDevice, PostChain *pPostChain){
+	// Source de la passe puis bloom, seule la composition lit le second
+	VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
+		{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE},
+		{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_NULL_HANDLE}
+	};
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		2,
+		descriptorSetLayoutBindings
+	};
+	vkCreateDescriptorSetLayout(*pDevice, &descriptorSetLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &pPostChain->descriptorSetLayout);
+
+	VkDescriptorPoolSize descriptorPoolSize = {
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		6
+	};
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		3,
+		1,
+		&descriptorPoolSize
+	};
+	vkCreateDescriptorPool(*pDevice, &descriptorPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pPostChain->descriptorPool);
+
+	VkDescriptorSetLayout descriptorSetLayouts[] = {
+		pPostChain->descriptorSetLayout,
+		pPostChain->descriptorSetLayout,
+		pPostChain->descriptorSetLayout
+	};
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pPostChain->descriptorPool,
+		3,
+		descriptorSetLayouts
+	};
+	VkDescriptorSet descriptorSets[3];
+	vkAllocateDescriptorSets(*pDevice, &descriptorSetAllocateInfo, descriptorSets);
+	pPostChain->brightDescriptorSet = descriptorSets[0];
+	pPostChain->blurDescriptorSet = descriptorSets[1];
+	pPostChain->compositeDescriptorSet = descriptorSets[2];
+}
+
+PostChain createPostChain(VkDevice *pDevice, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules, uint32_t stages, float gpuBudget){
+	PostChain postChain;
+	memset(&postChain, 0, sizeof(PostChain));
+	postChain.stages = stages & (POST_STAGE_ALL | POST_STAGE_UPSCALE);
+	postChain.extent = *pExtent;
+	postChain.renderExtent = *pExtent;
+	postChain.renderScale = 1.0f;
+	postChain.gpuBudget = gpuBudget;
+	postChain.bloomExtent.width = pExtent->width > 1 ? pExtent->width / 2 : 1;
+	postChain.bloomExtent.height = pExtent->height > 1 ? pExtent->height / 2 : 1;
+	postChain.bloomThreshold = 0.6f;
+	postChain.bloomIntensity = 1.5f;
+	postChain.sceneImage = GRAPH_INVALID_INDEX;
+	postChain.bloomImages[0] = GRAPH_INVALID_INDEX;
+	postChain.bloomImages[1] = GRAPH_INVALID_INDEX;
+	postChain.outputImage = GRAPH_INVALID_INDEX;
+	if(postChain.stages == 0){
+		return postChain;
+	}
+
+	postChain.sampler = createSampler(pDevice, VK_FILTER_LINEAR);
+	createPostDescriptorSets(pDevice, &postChain);
+
+	VkPushConstantRange pushConstantRange = {
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+		0,
+		sizeof(PostConstants)
+	};
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&postChain.descriptorSetLayout,
+		1,
+		&pushConstantRange
+	};
+	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &postChain.pipelineLayout);
+
+	// Triangle plein écran sans vertex buffer, le pipeline du triangle convient tel quel
+	if(postChain.stages & POST_STAGE_BLOOM){
+		postChain.bloomPipeline = createGraphicsPipeline(pDevice, &postChain.pipelineLayout, &pShaderModules[0], &pShaderModules[1], pRenderTarget, &postChain.bloomExtent);
+	}
+	postChain.compositePipeline = createGraphicsPipeline(pDevice, &postChain.pipelineLayout, &pShaderModules[0], &pShaderModules[2], pRenderTarget, pExtent);
+	if((postChain.stages & POST_STAGE_BLOOM && postChain.bloomPipeline == VK_NULL_HANDLE) || postChain.compositePipeline == VK_NULL_HANDLE){
+		printf("VkPostException : unable to create the post-processing pipelines\n");
+		deletePostChain(pDevice, &postChain);
+	}
+	return postChain;
+}
+
+void deletePostChain(VkDevice *pDevice, PostChain *pPostChain){
+	vkDestroyPipeline(*pDevice, pPostChain->compositePipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipeline(*pDevice, pPostChain->bloomPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipelineLayout(*pDevice, pPostChain->pipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+	vkDestroyDescriptorPool(*pDevice, pPostChain->descriptorPool, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+	vkDestroyDescriptorSetLayout(*pDevice, pPostChain->descriptorSetLayout, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+	vkDestroySampler(*pDevice, pPostChain->sampler, getHostAllocator(VK_OBJECT_TYPE_SAMPLER));
+	pPostChain->compositePipeline = VK_NULL_HANDLE;
+	pPostChain->bloomPipeline = VK_NULL_HANDLE;
+	pPostChain->pipelineLayout = VK_NULL_HANDLE;
+	pPostChain->descriptorPool = VK_NULL_HANDLE;
+	pPostChain->descriptorSetLayout = VK_NULL_HANDLE;
+	pPostChain->sampler = VK_NULL_HANDLE;
+}
+
+VkBool32 setPostChainScale(PostChain *pPostChain, float scale){
+	if(!(pPostChain->stages & POST_STAGE_UPSCALE)){
+		return VK_FALSE;
+	}
+	scale = scale < POST_MIN_SCALE ? POST_MIN_SCALE : (scale > 1.0f ? 1.0f : scale);
+	pPostChain->renderScale = scale;
+
+	// Arrondi à quelques pixels : de petites variations de l'échelle ne réenregistrent rien
+	VkExtent2D renderExtent;
+	renderExtent.width = ((uint32_t)(scale * pPostChain->extent.width) + POST_SCALE_ALIGNMENT - 1) / POST_SCALE_ALIGNMENT * POST_SCALE_ALIGNMENT;
+	renderExtent.height = ((uint32_t)(scale * pPostChain->extent.height) + POST_SCALE_ALIGNMENT - 1) / POST_SCALE_ALIGNMENT * POST_SCALE_ALIGNMENT;
+	renderExtent.width = renderExtent.width < pPostChain->extent.width ? renderExtent.width : pPostChain->extent.width;
+	renderExtent.height = renderExtent.height < pPostChain->extent.height ? renderExtent.height : pPostChain->extent.height;
+	if(renderExtent.width == pPostChain->renderExtent.width && renderExtent.height == pPostChain->renderExtent.height){
+		return VK_FALSE;
+	}
+	pPostChain->renderExtent = renderExtent;
+	return VK_TRUE;
+}
+
+VkBool32 updatePostChainScale(PostChain *pPostChain, float gpuTime){
+	if(!(pPostChain->stages & POST_STAGE_UPSCALE) || gpuTime <= 0.0f){
+		return VK_FALSE;
+	}
+	// On vise 90 % du budget et on ne bouge pas à moins de 10 % de la cible, sinon l'échelle oscille
+	float target = 0.9f * pPostChain->gpuBudget;
+	if(fabsf(gpuTime - target) < 0.1f * pPostChain->gpuBudget){
+		return VK_FALSE;
+	}
+	// Le coût de la scène suit le nombre de pixels, soit le carré de l'échelle, et la mesure a plusieurs frames de retard
+	float scale = pPostChain->renderScale * sqrtf(target / gpuTime);
+	return setPostChainScale(pPostChain, pPostChain->renderScale + 0.25f * (scale - pPostChain->renderScale));
+}
+
+uint32_t addPostChainInput(PostChain *pPostChain, RenderGraph *pRenderGraph, VkFormat format, uint32_t output){
+	pPostChain->outputImage = output;
+	if(pPostChain->stages == 0){
+		return output;
+	}
+	// Même format que la sortie : les pipelines de la scène restent compatibles avec la cible de rendu de référence
+	pPostChain->sceneImage = createGraphImage(pRenderGraph, "scene color", format, &pPostChain->extent, 1);
+	if(pPostChain->stages & POST_STAGE_BLOOM){
+		pPostChain->bloomImages[0] = createGraphImage(pRenderGraph, "bloom bright", format, &pPostChain->bloomExtent, 1);
+		pPostChain->bloomImages[1] = createGraphImage(pRenderGraph, "bloom blur", format, &pPostChain->bloomExtent, 1);
+	}
+	return pPostChain->sceneImage;
+}
+
+static void recordPostPass(VkCommandBuffer *pCommandBuffer, PostChain *pPostChain, VkPipeline pipeline, VkDescriptorSet descriptorSet, PostConstants *pConstants){
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPostChain->pipelineLayout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
+	vkCmdPushConstants(*pCommandBuffer, pPostChain->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PostConstants), pConstants);
+	vkCmdDraw(*pCommandBuffer, 3, 1, 0, 0);
+}
+
+static void recordBloomBrightPass(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData){
+	PostChain *pPostChain = (PostChain *)pUserData;
+	// Demi résolution : les échantillons sont espacés de deux texels de la scène
+	PostConstants constants = {
+		{1.0f / (float)pPostChain->extent.width, 1.0f / (float)pPostChain->extent.height},
+		{2.0f, 0.0f},
+		{(float)pPostChain->renderExtent.width / (float)pPostChain->extent.width, (float)pPostChain->renderExtent.height / (float)pPostChain->extent.height},
+		pPostChain->bloomThreshold,
+		1.0f,
+		pPostChain->stages,
+		0
+	};
+	recordPostPass(pCommandBuffer, pPostChain, pPostChain->bloomPipeline, pPostChain->brightDescriptorSet, &constants);
+}
+
+static void recordBloomBlurPass(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData){
+	PostChain *pPostChain = (PostChain *)pUserData;
+	PostConstants constants = {
+		{1.0f / (float)pPostChain->bloomExtent.width, 1.0f / (float)pPostChain->bloomExtent.height},
+		{0.0f, 1.0f},
+		{1.0f, 1.0f},
+		0.0f,
+		1.0f,
+		pPostChain->stages,
+		0
+	};
+	recordPostPass(pCommandBuffer, pPostChain, pPostChain->bloomPipeline, pPostChain->blurDescriptorSet, &constants);
+}
+
+static void recordCompositePass(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData){
+	PostChain *pPostChain = (PostChain *)pUserData;
+	PostConstants constants = {
+		{1.0f / (float)pPostChain->extent.width, 1.0f / (float)pPostChain->extent.height},
+		{0.0f, 0.0f},
+		{(float)pPostChain->renderExtent.width / (float)pPostChain->extent.width, (float)pPostChain->renderExtent.height / (float)pPostChain->extent.height},
+		0.0f,
+		pPostChain->bloomIntensity,
+		pPostChain->stages,
+		0
+	};
+	recordPostPass(pCommandBuffer, pPostChain, pPostChain->compositePipeline, pPostChain->compositeDescriptorSet, &constants);
+}
+
+void addPostChainPasses(PostChain *pPostChain, RenderGraph *pRenderGraph){
+	if(pPostChain->stages == 0){
+		return;
+	}
+	// Les passes plein écran recouvrent toute l'image, son contenu précédent est inutile
+	if(pPostChain->stages & POST_STAGE_BLOOM){
+		uint32_t brightPass = addGraphPass(pRenderGraph, "bloom bright", VK_PIPELINE_BIND_POINT_GRAPHICS, recordBloomBrightPass, pPostChain);
+		addGraphColorAttachment(pRenderGraph, brightPass, pPostChain->bloomImages[0], VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_NULL_HANDLE);
+		addGraphPassUse(pRenderGraph, brightPass, pPostChain->sceneImage, GRAPH_USE_FRAGMENT_SAMPLED);
+
+		uint32_t blurPass = addGraphPass(pRenderGraph, "bloom blur", VK_PIPELINE_BIND_POINT_GRAPHICS, recordBloomBlurPass, pPostChain);
+		addGraphColorAttachment(pRenderGraph, blurPass, pPostChain->bloomImages[1], VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_NULL_HANDLE);
+		addGraphPassUse(pRenderGraph, blurPass, pPostChain->bloomImages[0], GRAPH_USE_FRAGMENT_SAMPLED);
+	}
+
+	uint32_t compositePass = addGraphPass(pRenderGraph, "composite", VK_PIPELINE_BIND_POINT_GRAPHICS, recordCompositePass, pPostChain);
+	addGraphColorAttachment(pRenderGraph, compositePass, pPostChain->outputImage, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_NULL_HANDLE);
+	addGraphPassUse(pRenderGraph, compositePass, pPostChain->sceneImage, GRAPH_USE_FRAGMENT_SAMPLED);
+	if(pPostChain->stages & POST_STAGE_BLOOM){
+		addGraphPassUse(pRenderGraph, compositePass, pPostChain->bloomImages[1], GRAPH_USE_FRAGMENT_SAMPLED);
+	}
+}
+
+void bindPostChainImages(VkDevice *pDevice, PostChain *pPostChain, RenderGraph *pRenderGraph){
+	if(pPostChain->stages == 0){
+		return;
+	}
+	VkImageView sceneImageView = pRenderGraph->resources[pPostChain->sceneImage].imageViews[0];
+	VkImageView bloomImageViews[2] = {sceneImageView, sceneImageView};
+	if(pPostChain->stages & POST_STAGE_BLOOM){
+		bloomImageViews[0] = pRenderGraph->resources[pPostChain->bloomImages[0]].imageViews[0];
+		bloomImageViews[1] = pRenderGraph->resources[pPostChain->bloomImages[1]].imageViews[0];
+	}
+
+	// Sans bloom le second binding pointe sur la scène, il n'est jamais lu
+	VkDescriptorImageInfo descriptorImageInfos[] = {
+		{pPostChain->sampler, sceneImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+		{pPostChain->sampler, bloomImageViews[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+		{pPostChain->sampler, bloomImageViews[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}
+	};
+	VkDescriptorSet descriptorSets[] = {
+		pPostChain->brightDescriptorSet,
+		pPostChain->blurDescriptorSet,
+		pPostChain->compositeDescriptorSet
+	};
+	uint32_t sources[] = {0, 1, 0};
+	uint32_t blooms[] = {0, 1, 2};
+
+	VkWriteDescriptorSet writeDescriptorSets[6];
+	for(uint32_t i = 0; i < 6; i++){
+		writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptorSets[i].pNext = VK_NULL_HANDLE;
+		writeDescriptorSets[i].dstSet = descriptorSets[i / 2];
+		writeDescriptorSets[i].dstBinding = i % 2;
+		writeDescriptorSets[i].dstArrayElement = 0;
+		writeDescriptorSets[i].descriptorCount = 1;
+		writeDescriptorSets[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writeDescriptorSets[i].pImageInfo = &descriptorImageInfos[i % 2 == 0 ? sources[i / 2] : blooms[i / 2]];
+		writeDescriptorSets[i].pBufferInfo = VK_NULL_HANDLE;
+		writeDescriptorSets[i].pTexelBufferView = VK_NULL_HANDLE;
+	}
+	vkUpdateDescriptorSets(*pDevice, 6, writeDescriptorSets, 0, VK_NULL_HANDLE);
+}
@@ -1,18 +1,97 @@
 #include "../Headers/glfw_fun.h"
 #include "../Headers/vk_fun.h"
+#include "../Headers/submit_fun.h"
+#include "../Headers/trace_fun.h"
 
-void presentImage(VkDevice *pDevice, GLFWwindow *window, VkCommandBuffer *pCommandBuffers, VkFence *pFrontFences, VkFence *pBackFences, VkSemaphore *pWaitSemaphores, VkSemaphore *pSignalSemaphores, VkSwapchainKHR *pSwapchain, VkQueue *pDrawingQueue, VkQueue *pPresentingQueue, uint32_t maxFrames){
+void presentImage(VkDevice *pDevice, GLFWwindow *window, VkCommandBuffer *pCommandBuffers, VkFence *pFrontFences, VkFence *pBackFences, VkSemaphore *pWaitSemaphores, VkSemaphore *pSignalSemaphores, VkSwapchainKHR *pSwapchain, VkQueue *pDrawingQueue, VkQueue *pPresentingQueue, uint32_t maxFrames, UpdateFrameCallback updateFrame, void *pUserData, DeletionQueue *pDeletionQueue, FrameLimiter *pFrameLimiter, RedrawState *pRedrawState, FrameSubmitter *pFrameSubmitter){
 	uint32_t currentFrame = 0;
+	// Numéro de la dernière soumission faite avec chaque barrière, 0 tant qu'elle n'a jamais servi
+	size_t scratchMark = getScratchMark();
+	uint64_t *frameSerials = (uint64_t *)allocateScratch(maxFrames * sizeof(uint64_t));
+	memset(frameSerials, 0, maxFrames * sizeof(uint64_t));
+#ifdef VK_PONG_HEAP_CHECK
+	uint64_t frameNumber = 0;
+	uint64_t heapAllocationNumber = getHeapAllocationNumber();
+#endif
 	while( ! glfwWindowShouldClose(window)){
+		TRACE_ZONE("frame");
+		// Sans changement, rien n'est acquis ni soumis : la boucle dort dans la file d'événements
+		if(pRedrawState != VK_NULL_HANDLE){
+			TRACE_BEGIN("wait redraw");
+			uint32_t redrawFlags = waitRedraw(window, pRedrawState);
+			TRACE_END();
+			if(redrawFlags == 0){
+				continue;
+			}
+			// Après un sommeil, l'échéance repart de maintenant au lieu de compter le temps d'inactivité comme un retard
+			if(pFrameLimiter != VK_NULL_HANDLE && pRedrawState->sleepTime > 0.0){
+				pFrameLimiter->deadline = 0;
+				pFrameLimiter->lastFrameTime = 0;
+			}
+		}
+#ifdef VK_PONG_HEAP_CHECK
+		// Passé les premières frames, rien ne doit toucher au tas d'un début de frame au suivant, sur aucun thread
+		uint64_t frameAllocationNumber = getHeapAllocationNumber() - heapAllocationNumber;
+		heapAllocationNumber += frameAllocationNumber;
+		if(++frameNumber > HEAP_CHECK_WARMUP_FRAMES && frameAllocationNumber != 0){
+			printf("VkHeapException : %llu heap allocations in frame %llu\n", (unsigned long long)frameAllocationNumber, (unsigned long long)frameNumber - 1);
+			abort();
+		}
+#endif
+		// L'attente se fait avant les entrées pour que la frame parte avec les événements les plus récents
+		if(pFrameLimiter != VK_NULL_HANDLE){
+			TRACE_BEGIN("frame limiter");
+			waitFrameLimiter(pFrameLimiter);
+			TRACE_END();
+		}
+		TRACE_BEGIN("poll events");
 		glfwPollEvents();
+		TRACE_END();
 
-		vkWaitForFences(*pDevice, 1, &pFrontFences[currentFrame], VK_TRUE, UINT64_MAX);
 		uint32_t imageIndex = 0;
-		vkAcquireNextImageKHR(*pDevice, *pSwapchain, UINT64_MAX, pWaitSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-		if(pBackFences[imageIndex] != VK_NULL_HANDLE){
-			vkWaitForFences(*pDevice, 1, &pBackFences[imageIndex], VK_TRUE, UINT64_MAX);
+		if(pFrameSubmitter != VK_NULL_HANDLE){
+			// Le thread de soumission a déjà attendu la barrière de ce slot et celle de l'image avant de l'acquérir
+			TRACE_BEGIN("take image");
+			imageIndex = takeSubmitterImage(pFrameSubmitter, &currentFrame);
+			TRACE_END();
+			if(pDeletionQueue != VK_NULL_HANDLE){
+				collectDeletionQueue(pDeletionQueue, frameSerials[currentFrame]);
+			}
+		}else{
+			TRACE_BEGIN("fence wait");
+			vkWaitForFences(*pDevice, 1, &pFrontFences[currentFrame], VK_TRUE, UINT64_MAX);
+			TRACE_END();
+			// Tout ce qui a été retiré avant cette soumission n'est plus utilisé par le GPU
+			if(pDeletionQueue != VK_NULL_HANDLE){
+				collectDeletionQueue(pDeletionQueue, frameSerials[currentFrame]);
+			}
+			TRACE_BEGIN("acquire");
+			vkAcquireNextImageKHR(*pDevice, *pSwapchain, UINT64_MAX, pWaitSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+			if(pBackFences[imageIndex] != VK_NULL_HANDLE){
+				vkWaitForFences(*pDevice, 1, &pBackFences[imageIndex], VK_TRUE, UINT64_MAX);
+			}
+			TRACE_END();
+			pBackFences[imageIndex] = pFrontFences[currentFrame];
+		}
+
+		// Le command buffer de cette image n'est plus utilisé par le GPU, ses données par frame peuvent être réécrites
+		if(updateFrame != VK_NULL_HANDLE){
+			TRACE_BEGIN("update frame");
+			updateFrame(imageIndex, pUserData);
+			TRACE_END();
+		}
+
+		// La soumission et la présentation se font sur l'autre thread pendant que celui-ci commence la frame suivante
+		if(pFrameSubmitter != VK_NULL_HANDLE){
+			TRACE_BEGIN("push frame");
+			pushSubmitterFrame(pFrameSubmitter, currentFrame, imageIndex);
+			TRACE_END();
+			// Le slot de la frame suivante est donné par le thread de soumission avec son image
+			if(pDeletionQueue != VK_NULL_HANDLE){
+				frameSerials[currentFrame] = advanceDeletionQueue(pDeletionQueue);
+			}
+			continue;
 		}
-		pBackFences[imageIndex] = pFrontFences[currentFrame];
 
 		VkPipelineStageFlags pipelineStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
@@ -27,8 +106,13 @@ void presentImage(VkDevice *pDevice, GLFWwindow *window, VkCommandBuffer *pComma
 			1,
 			&pSignalSemaphores[currentFrame]
 		};
+		TRACE_BEGIN("submit");
 		vkResetFences(*pDevice, 1, &pFrontFences[currentFrame]);
 		vkQueueSubmit(*pDrawingQueue, 1, &submitInfo, pFrontFences[currentFrame]);
+		TRACE_END();
+		if(pDeletionQueue != VK_NULL_HANDLE){
+			frameSerials[currentFrame] = advanceDeletionQueue(pDeletionQueue);
+		}
 
 		VkPresentInfoKHR presentInfo = {
 			VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -40,9 +124,19 @@ void presentImage(VkDevice *pDevice, GLFWwindow *window, VkCommandBuffer *pComma
 			&imageIndex,
 			VK_NULL_HANDLE
 		};
+		TRACE_BEGIN("present");
 		vkQueuePresentKHR(*pPresentingQueue, &presentInfo);
+		TRACE_END();
 
 		currentFrame = (currentFrame + 1) % maxFrames;
 	}
+	if(pFrameSubmitter != VK_NULL_HANDLE){
+		waitFrameSubmitter(pFrameSubmitter);
+	}
+	// Seule attente complète du programme, à la fermeture, avant de vider la file de destruction
 	vkDeviceWaitIdle(*pDevice);
+	if(pDeletionQueue != VK_NULL_HANDLE){
+		collectDeletionQueue(pDeletionQueue, pDeletionQueue->submitSerial);
+	}
+	resetScratch(scratchMark);
 }
@@ -18,7 +18,8 @@ void deleteQueueFamilyProperties(VkQueueFamilyProperties **ppQueueFamilyProperti
 
 uint32_t getBestGraphicsQueueFamilyindex(VkQueueFamilyProperties *pQueueFamilyProperties, uint32_t queueFamilyNumber){
 	uint32_t graphicsQueueFamilyNumber = 0;
-	uint32_t *graphicsQueueFamilyIndices = (uint32_t *)malloc(queueFamilyNumber * sizeof(uint32_t));
+	size_t scratchMark = getScratchMark();
+	uint32_t *graphicsQueueFamilyIndices = (uint32_t *)allocateScratch(queueFamilyNumber * sizeof(uint32_t));
 
 	for(uint32_t i = 0; i < queueFamilyNumber; i++){
 		if((pQueueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0){
@@ -36,7 +37,7 @@ uint32_t getBestGraphicsQueueFamilyindex(VkQueueFamilyProperties *pQueueFamilyPr
 		}
 	}
 
-	free(graphicsQueueFamilyIndices);
+	resetScratch(scratchMark);
 	return bestGraphicsQueueFamilyIndex;
 }
 
@@ -65,3 +66,14 @@ VkQueue getPresentingQueue(VkDevice *pDevice, uint32_t graphicsQueueFamilyindex,
 	}
 	return presentingQueue;
 }
+
+uint32_t getTransferQueueFamilyIndex(VkQueueFamilyProperties *pQueueFamilyProperties, uint32_t queueFamilyNumber, uint32_t graphicsQueueFamilyindex){
+	// Une famille sans graphique ni calcul est servie par les moteurs de copie, qui tournent en parallèle du rendu
+	for(uint32_t i = 0; i < queueFamilyNumber; i++){
+		VkQueueFlags queueFlags = pQueueFamilyProperties[i].queueFlags;
+		if((queueFlags & VK_QUEUE_TRANSFER_BIT) != 0 && (queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0 && pQueueFamilyProperties[i].queueCount > 0){
+			return i;
+		}
+	}
+	return graphicsQueueFamilyindex;
+}
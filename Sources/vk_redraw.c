@@ -0,0 +1,114 @@
+#include "../Headers/glfw_fun.h"
+#include "../Headers/vk_fun.h"
+
+static void redrawKeyCallback(GLFWwindow *pWindow, int key, int scancode, int action, int mods){
+	(void)key;
+	(void)scancode;
+	(void)action;
+	(void)mods;
+	markRedraw((RedrawState *)glfwGetWindowUserPointer(pWindow), REDRAW_INPUT);
+}
+
+static void redrawMouseButtonCallback(GLFWwindow *pWindow, int button, int action, int mods){
+	(void)button;
+	(void)action;
+	(void)mods;
+	markRedraw((RedrawState *)glfwGetWindowUserPointer(pWindow), REDRAW_INPUT);
+}
+
+static void redrawFramebufferSizeCallback(GLFWwindow *pWindow, int width, int height){
+	(void)width;
+	(void)height;
+	markRedraw((RedrawState *)glfwGetWindowUserPointer(pWindow), REDRAW_WINDOW);
+}
+
+static void redrawRefreshCallback(GLFWwindow *pWindow){
+	markRedraw((RedrawState *)glfwGetWindowUserPointer(pWindow), REDRAW_WINDOW);
+}
+
+static void redrawFocusCallback(GLFWwindow *pWindow, int focused){
+	(void)focused;
+	markRedraw((RedrawState *)glfwGetWindowUserPointer(pWindow), REDRAW_WINDOW);
+}
+
+RedrawState *createRedrawState(GLFWwindow *pWindow, double idleTimeout){
+	RedrawState *pRedrawState = (RedrawState *)calloc(1, sizeof(RedrawState));
+	if(pRedrawState == VK_NULL_HANDLE){
+		printf("VkRedrawException : unable to allocate the redraw state\n");
+		return VK_NULL_HANDLE;
+	}
+	pRedrawState->idleTimeout = idleTimeout;
+	// La première frame est toujours rendue, la fenêtre n'a encore rien affiché
+	pRedrawState->dirtyFlags = REDRAW_WINDOW;
+
+	glfwSetWindowUserPointer(pWindow, pRedrawState);
+	glfwSetKeyCallback(pWindow, redrawKeyCallback);
+	glfwSetMouseButtonCallback(pWindow, redrawMouseButtonCallback);
+	glfwSetFramebufferSizeCallback(pWindow, redrawFramebufferSizeCallback);
+	glfwSetWindowRefreshCallback(pWindow, redrawRefreshCallback);
+	glfwSetWindowFocusCallback(pWindow, redrawFocusCallback);
+	return pRedrawState;
+}
+
+void deleteRedrawState(GLFWwindow *pWindow, RedrawState **ppRedrawState){
+	if(*ppRedrawState == VK_NULL_HANDLE){
+		return;
+	}
+	glfwSetKeyCallback(pWindow, VK_NULL_HANDLE);
+	glfwSetMouseButtonCallback(pWindow, VK_NULL_HANDLE);
+	glfwSetFramebufferSizeCallback(pWindow, VK_NULL_HANDLE);
+	glfwSetWindowRefreshCallback(pWindow, VK_NULL_HANDLE);
+	glfwSetWindowFocusCallback(pWindow, VK_NULL_HANDLE);
+	glfwSetWindowUserPointer(pWindow, VK_NULL_HANDLE);
+	free(*ppRedrawState);
+	*ppRedrawState = VK_NULL_HANDLE;
+}
+
+void markRedraw(RedrawState *pRedrawState, uint32_t flags){
+	if(pRedrawState == VK_NULL_HANDLE){
+		return;
+	}
+	// Seul le premier drapeau levé réveille la boucle, les suivants trouvent la demande déjà en attente
+	uint32_t previousFlags = __atomic_fetch_or(&pRedrawState->dirtyFlags, flags, __ATOMIC_RELEASE);
+	if(previousFlags == 0){
+		glfwPostEmptyEvent();
+	}
+}
+
+uint32_t waitRedraw(GLFWwindow *pWindow, RedrawState *pRedrawState){
+	glfwPollEvents();
+	uint32_t flags = __atomic_exchange_n(&pRedrawState->dirtyFlags, 0, __ATOMIC_ACQUIRE);
+	double now = glfwGetTime();
+	double sleepStart = now;
+	while(flags == 0 && ! glfwWindowShouldClose(pWindow)){
+		double remaining = pRedrawState->lastFrameTime + pRedrawState->idleTimeout - now;
+		if(remaining <= 0.0){
+			flags = REDRAW_IDLE;
+			pRedrawState->idleFrameNumber++;
+			break;
+		}
+		glfwWaitEventsTimeout(remaining);
+		flags = __atomic_exchange_n(&pRedrawState->dirtyFlags, 0, __ATOMIC_ACQUIRE);
+		now = glfwGetTime();
+		// Un mouvement de souris ou un événement vide sans demande ne vaut pas une frame
+		if(flags == 0 && now < pRedrawState->lastFrameTime + pRedrawState->idleTimeout){
+			pRedrawState->emptyWakeNumber++;
+		}
+	}
+	pRedrawState->sleepTime = now - sleepStart;
+	pRedrawState->totalSleepTime += pRedrawState->sleepTime;
+	if(flags != 0){
+		pRedrawState->lastFrameTime = now;
+		pRedrawState->frameNumber++;
+	}
+	return flags;
+}
+
+void printRedrawState(RedrawState *pRedrawState){
+	if(pRedrawState == VK_NULL_HANDLE){
+		return;
+	}
+	printf("on-demand rendering : %llu frames rendered, %llu idle refreshes, %llu wake-ups without change, %.3f s asleep\n",
+		(unsigned long long)pRedrawState->frameNumber, (unsigned long long)pRedrawState->idleFrameNumber,
+		(unsigned long long)pRedrawState->emptyWakeNumber, pRedrawState->totalSleepTime);
+}
@@ -0,0 +1,264 @@
+#include <pthread.h>
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+#ifdef VK_PONG_SHADERC
+#include <shaderc/shaderc.h>
+#endif
+
+#include "../Headers/reload_fun.h"
+#include "../Headers/trace_fun.h"
+
+struct ShaderReloader {
+	VkDevice device;
+	char directory[RELOAD_MAX_PATH];
+	uint32_t pipelineNumber;
+	ReloadPipeline pipelines[RELOAD_MAX_PIPELINES];
+	uint32_t retiredNumber;
+	VkPipeline retiredPipelines[RELOAD_MAX_RETIRED];
+	int inotifyFd;
+	int isRunning;
+	int isStarted;
+	pthread_t thread;
+#ifdef VK_PONG_SHADERC
+	shaderc_compiler_t compiler;
+#endif
+};
+
+static VkBool32 isShaderSource(const char *fileName){
+	size_t length = strlen(fileName);
+	return length > 5 && (strcmp(&fileName[length - 5], ".vert") == 0 || strcmp(&fileName[length - 5], ".frag") == 0);
+}
+
+static char *compileShader(ShaderReloader *pShaderReloader, const char *fileName, uint32_t *pShaderSize){
+	char path[RELOAD_MAX_PATH + 64];
+	snprintf(path, sizeof(path), "%s/%s", pShaderReloader->directory, fileName);
+#ifdef VK_PONG_SHADERC
+	uint32_t sourceSize = 0;
+	char *source = getShaderCode(path, &sourceSize);
+	if(source == VK_NULL_HANDLE){
+		printf("VkReloadException : shader source %s not found\n", path);
+		return VK_NULL_HANDLE;
+	}
+	shaderc_shader_kind kind = strstr(fileName, ".vert") != VK_NULL_HANDLE ? shaderc_vertex_shader : shaderc_fragment_shader;
+	shaderc_compilation_result_t result = shaderc_compile_into_spv(pShaderReloader->compiler, source, sourceSize, kind, fileName, "main", VK_NULL_HANDLE);
+	deleteShaderCode(&source);
+	if(shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success){
+		printf("VkReloadException : %s", shaderc_result_get_error_message(result));
+		shaderc_result_release(result);
+		return VK_NULL_HANDLE;
+	}
+	*pShaderSize = (uint32_t)shaderc_result_get_length(result);
+	char *shaderCode = (char *)malloc(*pShaderSize);
+	if(shaderCode != VK_NULL_HANDLE){
+		memcpy(shaderCode, shaderc_result_get_bytes(result), *pShaderSize);
+	}
+	shaderc_result_release(result);
+	return shaderCode;
+#else
+	// Sans libshaderc on passe par le compilateur utilisé par le build, toujours hors du thread de rendu
+	// Le SPIR-V va à côté de sa source, quel que soit le répertoire courant, puis est supprimé une fois lu
+	char outputPath[RELOAD_MAX_PATH + 128];
+	snprintf(outputPath, sizeof(outputPath), "%s/.%s.reload.spv", pShaderReloader->directory, fileName);
+	char command[3 * RELOAD_MAX_PATH + 512];
+	snprintf(command, sizeof(command), "glslangValidator --quiet -V \"%s\" -o \"%s\"", path, outputPath);
+	if(system(command) != 0){
+		printf("VkReloadException : unable to compile %s\n", path);
+		unlink(outputPath);
+		return VK_NULL_HANDLE;
+	}
+	char *shaderCode = getShaderCode(outputPath, pShaderSize);
+	unlink(outputPath);
+	return shaderCode;
+#endif
+}
+
+static void rebuildPipeline(ShaderReloader *pShaderReloader, ReloadPipeline *pReloadPipeline){
+	uint32_t shaderSizes[2] = {0, 0};
+	char *shaderCodes[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+	shaderCodes[0] = compileShader(pShaderReloader, pReloadPipeline->vertexFileName, &shaderSizes[0]);
+	if(shaderCodes[0] != VK_NULL_HANDLE){
+		shaderCodes[1] = compileShader(pShaderReloader, pReloadPipeline->fragmentFileName, &shaderSizes[1]);
+	}
+	if(shaderCodes[1] == VK_NULL_HANDLE){
+		free(shaderCodes[0]);
+		printf("VkReloadException : %s and %s not rebuilt, the previous pipeline is kept\n", pReloadPipeline->vertexFileName, pReloadPipeline->fragmentFileName);
+		return;
+	}
+
+	VkShaderModule shaderModules[2] = {
+		createShaderModule(&pShaderReloader->device, shaderCodes[0], shaderSizes[0]),
+		createShaderModule(&pShaderReloader->device, shaderCodes[1], shaderSizes[1])
+	};
+	VkPipeline pipeline = pReloadPipeline->build(&pShaderReloader->device, shaderModules, pReloadPipeline->pUserData);
+	deleteShaderModule(&pShaderReloader->device, &shaderModules[1]);
+	deleteShaderModule(&pShaderReloader->device, &shaderModules[0]);
+	deleteShaderCode(&shaderCodes[1]);
+	deleteShaderCode(&shaderCodes[0]);
+	if(pipeline == VK_NULL_HANDLE){
+		printf("VkReloadException : unable to rebuild the pipeline of %s and %s, the previous one is kept\n", pReloadPipeline->vertexFileName, pReloadPipeline->fragmentFileName);
+		return;
+	}
+
+	// Un pipeline publié que le thread de rendu n'a pas encore pris n'a jamais servi, il est détruit tout de suite
+	VkPipeline unusedPipeline = __atomic_exchange_n(&pReloadPipeline->pendingPipeline, pipeline, __ATOMIC_ACQ_REL);
+	if(unusedPipeline != VK_NULL_HANDLE){
+		vkDestroyPipeline(pShaderReloader->device, unusedPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	}
+	printf("pipeline of %s and %s reloaded\n", pReloadPipeline->vertexFileName, pReloadPipeline->fragmentFileName);
+}
+
+#ifdef __linux__
+static void *runShaderWatcher(void *pArg){
+	ShaderReloader *pShaderReloader = (ShaderReloader *)pArg;
+	char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct pollfd pollFd = {pShaderReloader->inotifyFd, POLLIN, 0};
+	TRACE_THREAD("shader watcher");
+	// La compilation d'un shader modifié alloue, elle ne fait partie d'aucune frame
+	ignoreHeapAllocations();
+	while(__atomic_load_n(&pShaderReloader->isRunning, __ATOMIC_ACQUIRE)){
+		// Réveil régulier pour remarquer la demande d'arrêt
+		if(poll(&pollFd, 1, 100) <= 0){
+			continue;
+		}
+		// Un éditeur produit souvent plusieurs événements par sauvegarde, chaque pipeline n'est reconstruit qu'une fois
+		VkBool32 isChanged[RELOAD_MAX_PIPELINES];
+		memset(isChanged, 0, sizeof(isChanged));
+		ssize_t length = 0;
+		while((length = read(pShaderReloader->inotifyFd, events, sizeof(events))) > 0){
+			for(char *pEvent = events; pEvent < events + length; pEvent += sizeof(struct inotify_event) + ((struct inotify_event *)pEvent)->len){
+				struct inotify_event *pInotifyEvent = (struct inotify_event *)pEvent;
+				if(pInotifyEvent->len == 0 || !isShaderSource(pInotifyEvent->name)){
+					continue;
+				}
+				for(uint32_t i = 0; i < pShaderReloader->pipelineNumber; i++){
+					if(strcmp(pShaderReloader->pipelines[i].vertexFileName, pInotifyEvent->name) == 0 ||
+					   strcmp(pShaderReloader->pipelines[i].fragmentFileName, pInotifyEvent->name) == 0){
+						isChanged[i] = VK_TRUE;
+					}
+				}
+			}
+		}
+		for(uint32_t i = 0; i < pShaderReloader->pipelineNumber; i++){
+			if(isChanged[i]){
+				TRACE_BEGIN("rebuild pipeline");
+				rebuildPipeline(pShaderReloader, &pShaderReloader->pipelines[i]);
+				TRACE_END();
+			}
+		}
+	}
+	return VK_NULL_HANDLE;
+}
+#endif
+
+ShaderReloader *createShaderReloader(VkDevice *pDevice, const char *directory){
+#ifdef __linux__
+	ShaderReloader *pShaderReloader = (ShaderReloader *)malloc(sizeof(ShaderReloader));
+	if(pShaderReloader == VK_NULL_HANDLE){
+		printf("VkReloadException : unable to allocate the shader reloader\n");
+		return VK_NULL_HANDLE;
+	}
+	memset(pShaderReloader, 0, sizeof(ShaderReloader));
+	pShaderReloader->device = *pDevice;
+	snprintf(pShaderReloader->directory, RELOAD_MAX_PATH, "%s", directory);
+
+	// Le dossier est surveillé plutôt que les fichiers, les éditeurs remplacent souvent le fichier par un renommage
+	pShaderReloader->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(pShaderReloader->inotifyFd < 0 || inotify_add_watch(pShaderReloader->inotifyFd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+		printf("VkReloadException : unable to watch %s\n", directory);
+		if(pShaderReloader->inotifyFd >= 0){
+			close(pShaderReloader->inotifyFd);
+		}
+		free(pShaderReloader);
+		return VK_NULL_HANDLE;
+	}
+#ifdef VK_PONG_SHADERC
+	pShaderReloader->compiler = shaderc_compiler_initialize();
+#endif
+	return pShaderReloader;
+#else
+	(void)pDevice;
+	printf("VkReloadException : shader hot reload needs inotify, %s is not watched\n", directory);
+	return VK_NULL_HANDLE;
+#endif
+}
+
+void deleteShaderReloader(VkDevice *pDevice, ShaderReloader **ppShaderReloader){
+	ShaderReloader *pShaderReloader = *ppShaderReloader;
+	if(pShaderReloader->isStarted){
+		__atomic_store_n(&pShaderReloader->isRunning, 0, __ATOMIC_RELEASE);
+		pthread_join(pShaderReloader->thread, VK_NULL_HANDLE);
+	}
+#ifdef __linux__
+	close(pShaderReloader->inotifyFd);
+#endif
+#ifdef VK_PONG_SHADERC
+	shaderc_compiler_release(pShaderReloader->compiler);
+#endif
+	for(uint32_t i = 0; i < pShaderReloader->pipelineNumber; i++){
+		vkDestroyPipeline(*pDevice, pShaderReloader->pipelines[i].pendingPipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	}
+	for(uint32_t i = 0; i < pShaderReloader->retiredNumber; i++){
+		vkDestroyPipeline(*pDevice, pShaderReloader->retiredPipelines[i], getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	}
+	free(pShaderReloader);
+	*ppShaderReloader = VK_NULL_HANDLE;
+}
+
+void addReloadPipeline(ShaderReloader *pShaderReloader, const char *vertexFileName, const char *fragmentFileName, BuildPipelineCallback build, void *pUserData, VkPipeline *pPipeline){
+	if(pShaderReloader->isStarted || pShaderReloader->pipelineNumber == RELOAD_MAX_PIPELINES){
+		printf("VkReloadException : pipeline of %s and %s not registered\n", vertexFileName, fragmentFileName);
+		return;
+	}
+	ReloadPipeline *pReloadPipeline = &pShaderReloader->pipelines[pShaderReloader->pipelineNumber++];
+	snprintf(pReloadPipeline->vertexFileName, sizeof(pReloadPipeline->vertexFileName), "%s", vertexFileName);
+	snprintf(pReloadPipeline->fragmentFileName, sizeof(pReloadPipeline->fragmentFileName), "%s", fragmentFileName);
+	pReloadPipeline->build = build;
+	pReloadPipeline->pUserData = pUserData;
+	pReloadPipeline->pPipeline = pPipeline;
+	pReloadPipeline->pendingPipeline = VK_NULL_HANDLE;
+}
+
+int startShaderReloader(ShaderReloader *pShaderReloader){
+#ifdef __linux__
+	pShaderReloader->isRunning = 1;
+	if(pthread_create(&pShaderReloader->thread, VK_NULL_HANDLE, runShaderWatcher, pShaderReloader) != 0){
+		printf("VkReloadException : unable to start the shader watcher thread\n");
+		pShaderReloader->isRunning = 0;
+		return -1;
+	}
+	pShaderReloader->isStarted = 1;
+	return 0;
+#else
+	(void)pShaderReloader;
+	return -1;
+#endif
+}
+
+VkBool32 applyShaderReload(ShaderReloader *pShaderReloader){
+	VkBool32 isSwapped = VK_FALSE;
+	for(uint32_t i = 0; i < pShaderReloader->pipelineNumber; i++){
+		ReloadPipeline *pReloadPipeline = &pShaderReloader->pipelines[i];
+		// Faute de place l'ancien pipeline ne pourrait pas être gardé, l'échange attend la prochaine frame
+		if(pShaderReloader->retiredNumber == RELOAD_MAX_RETIRED){
+			break;
+		}
+		if(__atomic_load_n(&pReloadPipeline->pendingPipeline, __ATOMIC_ACQUIRE) == VK_NULL_HANDLE){
+			continue;
+		}
+		VkPipeline pipeline = __atomic_exchange_n(&pReloadPipeline->pendingPipeline, VK_NULL_HANDLE, __ATOMIC_ACQ_REL);
+		pShaderReloader->retiredPipelines[pShaderReloader->retiredNumber++] = *pReloadPipeline->pPipeline;
+		*pReloadPipeline->pPipeline = pipeline;
+		isSwapped = VK_TRUE;
+	}
+	return isSwapped;
+}
+
+void releaseShaderReload(ShaderReloader *pShaderReloader, DeletionQueue *pDeletionQueue){
+	for(uint32_t i = 0; i < pShaderReloader->retiredNumber; i++){
+		retireObject(pDeletionQueue, VK_OBJECT_TYPE_PIPELINE, (uint64_t)pShaderReloader->retiredPipelines[i]);
+	}
+	pShaderReloader->retiredNumber = 0;
+}
@@ -0,0 +1,91 @@
+#include <pthread.h>
+
+#include "../Headers/vk_fun.h"
+
+static __thread char *pScratchArena;
+static __thread size_t scratchOffset;
+static pthread_key_t scratchKey;
+static pthread_once_t scratchOnce = PTHREAD_ONCE_INIT;
+
+static void deleteScratchArena(void *pArena){
+	free(pArena);
+}
+
+static void createScratchKey(){
+	pthread_key_create(&scratchKey, deleteScratchArena);
+}
+
+void *allocateScratch(size_t size){
+	// L'arène d'un thread est allouée une seule fois, à sa première utilisation, et libérée quand il se termine
+	if(pScratchArena == VK_NULL_HANDLE){
+		pthread_once(&scratchOnce, createScratchKey);
+		pScratchArena = (char *)malloc(SCRATCH_ARENA_SIZE);
+		if(pScratchArena == VK_NULL_HANDLE){
+			printf("VkScratchException : unable to allocate the scratch arena\n");
+			return VK_NULL_HANDLE;
+		}
+		pthread_setspecific(scratchKey, pScratchArena);
+	}
+	size_t offset = (scratchOffset + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+	if(size > SCRATCH_ARENA_SIZE - offset){
+		printf("VkScratchException : %lu bytes requested, %lu left in the scratch arena\n", (unsigned long)size, (unsigned long)(SCRATCH_ARENA_SIZE - offset));
+		return VK_NULL_HANDLE;
+	}
+	scratchOffset = offset + size;
+	return &pScratchArena[offset];
+}
+
+size_t getScratchMark(){
+	return scratchOffset;
+}
+
+void resetScratch(size_t scratchMark){
+	scratchOffset = scratchMark;
+}
+
+#if defined(VK_PONG_HEAP_CHECK) && defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t number, size_t size);
+extern void *__libc_realloc(void *pMemory, size_t size);
+
+// Un seul compteur pour tous les threads : soumission, workers, streamer, mixeur et traces font aussi le travail d'une frame
+static uint64_t heapAllocationNumber;
+static __thread int isHeapIgnored;
+
+// Ces définitions remplacent celles de la libc pour tout le programme, le driver compris
+void *malloc(size_t size){
+	if(!isHeapIgnored){
+		__atomic_add_fetch(&heapAllocationNumber, 1, __ATOMIC_RELAXED);
+	}
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t number, size_t size){
+	if(!isHeapIgnored){
+		__atomic_add_fetch(&heapAllocationNumber, 1, __ATOMIC_RELAXED);
+	}
+	return __libc_calloc(number, size);
+}
+
+void *realloc(void *pMemory, size_t size){
+	if(!isHeapIgnored){
+		__atomic_add_fetch(&heapAllocationNumber, 1, __ATOMIC_RELAXED);
+	}
+	return __libc_realloc(pMemory, size);
+}
+
+uint64_t getHeapAllocationNumber(){
+	return __atomic_load_n(&heapAllocationNumber, __ATOMIC_RELAXED);
+}
+
+void ignoreHeapAllocations(){
+	isHeapIgnored = 1;
+}
+#else
+uint64_t getHeapAllocationNumber(){
+	return 0;
+}
+
+void ignoreHeapAllocations(){
+}
+#endif
@@ -34,10 +34,10 @@ VkShaderModule createShaderModule(VkDevice *pDevice, char *pShaderCode, uint32_t
 	};
 
 	VkShaderModule shaderModule;
-	vkCreateShaderModule(*pDevice, &shaderModuleCreateInfo, VK_NULL_HANDLE, &shaderModule);
+	vkCreateShaderModule(*pDevice, &shaderModuleCreateInfo, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE), &shaderModule);
 	return shaderModule;
 }
 
 void deleteShaderModule(VkDevice *pDevice, VkShaderModule *pShaderModule){
-	vkDestroyShaderModule(*pDevice, *pShaderModule, VK_NULL_HANDLE);
+	vkDestroyShaderModule(*pDevice, *pShaderModule, getHostAllocator(VK_OBJECT_TYPE_SHADER_MODULE));
 }
@@ -0,0 +1,163 @@
+#include "../Headers/split_fun.h"
+
+static void createSplitDescriptorSet(VkDevice *pDevice, SplitScreen *pSplitScreen){
+	VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {
+		0,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		1,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+		VK_NULL_HANDLE
+	};
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&descriptorSetLayoutBinding
+	};
+	vkCreateDescriptorSetLayout(*pDevice, &descriptorSetLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &pSplitScreen->descriptorSetLayout);
+
+	VkDescriptorPoolSize descriptorPoolSize = {
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		1
+	};
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		1,
+		&descriptorPoolSize
+	};
+	vkCreateDescriptorPool(*pDevice, &descriptorPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pSplitScreen->descriptorPool);
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pSplitScreen->descriptorPool,
+		1,
+		&pSplitScreen->descriptorSetLayout
+	};
+	vkAllocateDescriptorSets(*pDevice, &descriptorSetAllocateInfo, &pSplitScreen->descriptorSet);
+}
+
+SplitScreen createSplitScreen(VkDevice *pDevice, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pShaderModules){
+	SplitScreen splitScreen;
+	memset(&splitScreen, 0, sizeof(SplitScreen));
+	splitScreen.extent = *pExtent;
+	splitScreen.renderExtent = *pExtent;
+	splitScreen.viewExtent.width = (pExtent->width + 1) / 2;
+	splitScreen.viewExtent.height = pExtent->height;
+	splitScreen.viewRenderExtent = splitScreen.viewExtent;
+	splitScreen.viewImage = GRAPH_INVALID_INDEX;
+	splitScreen.outputImage = GRAPH_INVALID_INDEX;
+	splitScreen.scenePass = GRAPH_INVALID_INDEX;
+	splitScreen.composePass = GRAPH_INVALID_INDEX;
+
+	// La vue de gauche garde le bord gauche du terrain à sa place, celle de droite le bord droit
+	splitScreen.viewConstants = createViewConstants();
+	for(uint32_t i = 0; i < SPLIT_VIEW_NUMBER; i++){
+		splitScreen.viewConstants.transforms[i][0] = SPLIT_VIEW_ZOOM;
+		splitScreen.viewConstants.transforms[i][2] = i == 0 ? SPLIT_VIEW_ZOOM - 1.0f : 1.0f - SPLIT_VIEW_ZOOM;
+	}
+
+	splitScreen.sampler = createSampler(pDevice, VK_FILTER_LINEAR);
+	createSplitDescriptorSet(pDevice, &splitScreen);
+
+	VkPushConstantRange pushConstantRange = {
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+		0,
+		sizeof(SplitConstants)
+	};
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&splitScreen.descriptorSetLayout,
+		1,
+		&pushConstantRange
+	};
+	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &splitScreen.pipelineLayout);
+
+	splitScreen.pipeline = createGraphicsPipeline(pDevice, &splitScreen.pipelineLayout, &pShaderModules[0], &pShaderModules[1], pRenderTarget, pExtent);
+	if(splitScreen.pipeline == VK_NULL_HANDLE){
+		printf("VkSplitException : unable to create the split screen pipeline\n");
+		deleteSplitScreen(pDevice, &splitScreen);
+	}
+	return splitScreen;
+}
+
+void deleteSplitScreen(VkDevice *pDevice, SplitScreen *pSplitScreen){
+	vkDestroyPipeline(*pDevice, pSplitScreen->pipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipelineLayout(*pDevice, pSplitScreen->pipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+	vkDestroyDescriptorPool(*pDevice, pSplitScreen->descriptorPool, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+	vkDestroyDescriptorSetLayout(*pDevice, pSplitScreen->descriptorSetLayout, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+	vkDestroySampler(*pDevice, pSplitScreen->sampler, getHostAllocator(VK_OBJECT_TYPE_SAMPLER));
+	pSplitScreen->pipeline = VK_NULL_HANDLE;
+	pSplitScreen->pipelineLayout = VK_NULL_HANDLE;
+	pSplitScreen->descriptorPool = VK_NULL_HANDLE;
+	pSplitScreen->descriptorSetLayout = VK_NULL_HANDLE;
+	pSplitScreen->sampler = VK_NULL_HANDLE;
+}
+
+uint32_t addSplitScreenInput(SplitScreen *pSplitScreen, RenderGraph *pRenderGraph, VkFormat format, uint32_t output){
+	pSplitScreen->outputImage = output;
+	// Une couche par vue, le graphe la crée avec une vue tableau que la composition lit en sampler2DArray
+	pSplitScreen->viewImage = createGraphImage(pRenderGraph, "split views", format, &pSplitScreen->viewExtent, SPLIT_VIEW_NUMBER);
+	return pSplitScreen->viewImage;
+}
+
+static void recordSplitComposePass(VkCommandBuffer *pCommandBuffer, uint32_t commandBufferIndex, void *pUserData){
+	SplitScreen *pSplitScreen = (SplitScreen *)pUserData;
+	SplitConstants constants = {
+		{1.0f / (float)pSplitScreen->viewExtent.width, 1.0f / (float)pSplitScreen->viewExtent.height},
+		{(float)pSplitScreen->viewRenderExtent.width / (float)pSplitScreen->viewExtent.width, (float)pSplitScreen->viewRenderExtent.height / (float)pSplitScreen->viewExtent.height},
+		0.5f * SPLIT_DIVIDER_WIDTH / (float)pSplitScreen->renderExtent.width
+	};
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pSplitScreen->pipeline);
+	vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pSplitScreen->pipelineLayout, 0, 1, &pSplitScreen->descriptorSet, 0, VK_NULL_HANDLE);
+	vkCmdPushConstants(*pCommandBuffer, pSplitScreen->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SplitConstants), &constants);
+	vkCmdDraw(*pCommandBuffer, 3, 1, 0, 0);
+}
+
+void addSplitScreenPasses(SplitScreen *pSplitScreen, RenderGraph *pRenderGraph, uint32_t scenePass){
+	pSplitScreen->scenePass = scenePass;
+	setGraphPassViewMask(pRenderGraph, scenePass, SPLIT_VIEW_MASK);
+
+	// La composition recouvre toute sa zone, le contenu précédent de la sortie est inutile
+	pSplitScreen->composePass = addGraphPass(pRenderGraph, "split compose", VK_PIPELINE_BIND_POINT_GRAPHICS, recordSplitComposePass, pSplitScreen);
+	addGraphColorAttachment(pRenderGraph, pSplitScreen->composePass, pSplitScreen->outputImage, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_NULL_HANDLE);
+	addGraphPassUse(pRenderGraph, pSplitScreen->composePass, pSplitScreen->viewImage, GRAPH_USE_FRAGMENT_SAMPLED);
+}
+
+void bindSplitScreenImages(VkDevice *pDevice, SplitScreen *pSplitScreen, RenderGraph *pRenderGraph){
+	VkDescriptorImageInfo descriptorImageInfo = {
+		pSplitScreen->sampler,
+		pRenderGraph->resources[pSplitScreen->viewImage].imageViews[0],
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	};
+	VkWriteDescriptorSet writeDescriptorSet = {
+		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		VK_NULL_HANDLE,
+		pSplitScreen->descriptorSet,
+		0,
+		0,
+		1,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		&descriptorImageInfo,
+		VK_NULL_HANDLE,
+		VK_NULL_HANDLE
+	};
+	vkUpdateDescriptorSets(*pDevice, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+}
+
+void setSplitScreenRenderArea(SplitScreen *pSplitScreen, RenderGraph *pRenderGraph, VkExtent2D *pExtent){
+	pSplitScreen->renderExtent.width = pExtent->width < pSplitScreen->extent.width ? pExtent->width : pSplitScreen->extent.width;
+	pSplitScreen->renderExtent.height = pExtent->height < pSplitScreen->extent.height ? pExtent->height : pSplitScreen->extent.height;
+	// Chaque vue couvre la moitié de la zone composée, arrondie au pixel supérieur
+	pSplitScreen->viewRenderExtent.width = (pSplitScreen->renderExtent.width + 1) / 2;
+	pSplitScreen->viewRenderExtent.height = pSplitScreen->renderExtent.height;
+	setGraphPassRenderArea(pRenderGraph, pSplitScreen->scenePass, &pSplitScreen->viewRenderExtent);
+	setGraphPassRenderArea(pRenderGraph, pSplitScreen->composePass, &pSplitScreen->renderExtent);
+}
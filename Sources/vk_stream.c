@@ -0,0 +1,850 @@
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Headers/glfw_fun.h"
+#include "../Headers/stream_fun.h"
+#include "../Headers/trace_fun.h"
+
+#define STREAM_BATCH_FREE 0
+#define STREAM_BATCH_TRANSFERRING 1
+#define STREAM_BATCH_ACQUIRING 2
+
+typedef struct StreamTexture {
+	char fileName[STREAM_MAX_PATH];
+	struct TextureStreamer *pTextureStreamer;
+	VkImage image;
+	VkImageView imageView;
+	VkDescriptorSet descriptorSet;
+	VkExtent2D extent;
+	uint32_t mipLevelNumber;
+	uint32_t state;
+	int fileDescriptor;
+	uint32_t channelNumber;
+	uint32_t pixelOffset;
+	uint32_t chunkNumber;
+	uint32_t nextChunk;
+	uint32_t remainingChunks;
+	uint32_t isDecodeFailed;
+	VkDeviceSize stagingOffset;
+	uint64_t stagingEnd;
+	int isStagingReleased;
+	double requestTime;
+	double decodeStartTime;
+	double decodeTime;
+} StreamTexture;
+
+/**
+ * Lot de textures copiées par la même soumission de transfert puis acquises par la même soumission graphique
+ */
+typedef struct StreamBatch {
+	uint32_t state;
+	uint32_t textures[STREAM_BATCH_TEXTURES];
+	uint32_t textureNumber;
+	uint64_t transferValue;
+	uint64_t graphicsValue;
+} StreamBatch;
+
+struct TextureStreamer {
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	uint32_t graphicsQueueFamilyIndex;
+	uint32_t transferQueueFamilyIndex;
+	VkQueue graphicsQueue;
+	VkQueue transferQueue;
+	FrameSubmitter *pFrameSubmitter;
+	JobSystem *pJobSystem;
+	JobCounter jobCounter;
+	uint32_t isStopping;
+	VkBool32 isBlitSupported;
+	PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue;
+	PFN_vkWaitSemaphoresKHR waitSemaphores;
+	VkSemaphore transferTimeline;
+	VkSemaphore graphicsTimeline;
+	uint64_t transferValue;
+	uint64_t graphicsValue;
+	VkCommandPool transferCommandPool;
+	VkCommandPool graphicsCommandPool;
+	VkCommandBuffer *pTransferCommandBuffers;
+	VkCommandBuffer *pGraphicsCommandBuffers;
+	StreamBatch batches[STREAM_MAX_BATCHES];
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	uint8_t *pStagingData;
+	VkDeviceMemory imageMemory;
+	VkDeviceSize imageMemoryHead;
+	uint64_t stagingHead;
+	uint64_t stagingTail;
+	uint32_t stagingOrder[STREAM_MAX_TEXTURES];
+	uint32_t stagingOrderFirst;
+	uint32_t stagingOrderNumber;
+	VkSampler sampler;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	StreamTexture textures[STREAM_MAX_TEXTURES];
+	uint32_t textureNumber;
+	uint32_t headerOrder[STREAM_MAX_TEXTURES];
+	uint32_t headerFirst;
+	uint32_t headerNumber;
+	uint32_t decodedOrder[STREAM_MAX_TEXTURES];
+	uint32_t decodedFirst;
+	uint32_t decodedNumber;
+	uint32_t readyNumber;
+	uint32_t failedNumber;
+	uint64_t uploadedBytes;
+	double decodeTimeSum;
+	double latencySum;
+	double maxLatency;
+	double updateTimeSum;
+	double maxUpdateTime;
+	uint64_t updateNumber;
+	pthread_mutex_t mutex;
+};
+
+static int readPnmCharacter(const uint8_t *pHeader, uint32_t headerSize, uint32_t *pPosition){
+	return *pPosition < headerSize ? pHeader[(*pPosition)++] : EOF;
+}
+
+static int readPnmNumber(const uint8_t *pHeader, uint32_t headerSize, uint32_t *pPosition, uint32_t *pNumber){
+	int character = readPnmCharacter(pHeader, headerSize, pPosition);
+	// Espaces et commentaires jusqu'à la fin de ligne entre les champs de l'en-tête
+	while(character == '#' || character == ' ' || character == '\t' || character == '\r' || character == '\n'){
+		if(character == '#'){
+			while(character != '\n' && character != EOF){
+				character = readPnmCharacter(pHeader, headerSize, pPosition);
+			}
+		}
+		character = readPnmCharacter(pHeader, headerSize, pPosition);
+	}
+	if(character < '0' || character > '9'){
+		return -1;
+	}
+	uint32_t number = 0;
+	while(character >= '0' && character <= '9'){
+		if(number > 100000){
+			return -1;
+		}
+		number = number * 10 + (uint32_t)(character - '0');
+		character = readPnmCharacter(pHeader, headerSize, pPosition);
+	}
+	// Un seul blanc sépare le dernier champ des pixels
+	if(character != ' ' && character != '\t' && character != '\r' && character != '\n'){
+		return -1;
+	}
+	*pNumber = number;
+	return 0;
+}
+
+/**
+ * L'en-tête, commentaires compris, doit tenir dans les STREAM_HEADER_SIZE premiers octets du fichier
+ */
+static int readPnmHeader(const uint8_t *pHeader, uint32_t headerSize, uint32_t *pChannelNumber, VkExtent2D *pExtent, uint32_t *pPixelOffset){
+	uint32_t position = 2;
+	uint32_t maxValue = 0;
+	if(headerSize < 2 || pHeader[0] != 'P' || (pHeader[1] != '5' && pHeader[1] != '6')){
+		return -1;
+	}
+	if(readPnmNumber(pHeader, headerSize, &position, &pExtent->width) != 0 || readPnmNumber(pHeader, headerSize, &position, &pExtent->height) != 0 ||
+		readPnmNumber(pHeader, headerSize, &position, &maxValue) != 0){
+		return -1;
+	}
+	if(maxValue != 255 || pExtent->width == 0 || pExtent->height == 0 || pExtent->width > STREAM_MAX_EXTENT || pExtent->height > STREAM_MAX_EXTENT){
+		return -1;
+	}
+	*pChannelNumber = pHeader[1] == '6' ? 3 : 1;
+	*pPixelOffset = position;
+	return 0;
+}
+
+/**
+ * Appelée sous le verrou par le thread de rendu : la place est prise en tête de l'anneau, sans jamais couper une texture en deux ni attendre
+ */
+static int reserveStaging(TextureStreamer *pTextureStreamer, uint32_t texture, VkDeviceSize size){
+	StreamTexture *pTexture = &pTextureStreamer->textures[texture];
+	size = (size + STREAM_STAGING_ALIGNMENT - 1) & ~(VkDeviceSize)(STREAM_STAGING_ALIGNMENT - 1);
+	uint64_t offset = pTextureStreamer->stagingHead % STREAM_STAGING_SIZE;
+	uint64_t padding = offset + size > STREAM_STAGING_SIZE ? STREAM_STAGING_SIZE - offset : 0;
+	if(pTextureStreamer->stagingHead + padding + size - pTextureStreamer->stagingTail > STREAM_STAGING_SIZE){
+		return -1;
+	}
+	pTexture->stagingOffset = (pTextureStreamer->stagingHead + padding) % STREAM_STAGING_SIZE;
+	pTextureStreamer->stagingHead += padding + size;
+	pTexture->stagingEnd = pTextureStreamer->stagingHead;
+	pTexture->isStagingReleased = 0;
+	pTextureStreamer->stagingOrder[pTextureStreamer->stagingOrderNumber++] = texture;
+	return 0;
+}
+
+/**
+ * Appelée sous le verrou : les copies finissent dans le désordre, la queue de l'anneau n'avance que sur les zones libérées à la suite
+ */
+static void releaseStaging(TextureStreamer *pTextureStreamer, uint32_t texture){
+	pTextureStreamer->textures[texture].isStagingReleased = 1;
+	while(pTextureStreamer->stagingOrderFirst < pTextureStreamer->stagingOrderNumber){
+		StreamTexture *pTexture = &pTextureStreamer->textures[pTextureStreamer->stagingOrder[pTextureStreamer->stagingOrderFirst]];
+		if(!pTexture->isStagingReleased){
+			break;
+		}
+		pTextureStreamer->stagingTail = pTexture->stagingEnd;
+		pTextureStreamer->stagingOrderFirst++;
+	}
+}
+
+/**
+ * Appelée par le job d'en-tête : l'image est placée dans le bloc alloué au démarrage et son set, alloué lui aussi au démarrage, est écrit ici
+ */
+static int createStreamImage(TextureStreamer *pTextureStreamer, StreamTexture *pTexture){
+	pTexture->mipLevelNumber = 1;
+	if(pTextureStreamer->isBlitSupported){
+		uint32_t size = pTexture->extent.width > pTexture->extent.height ? pTexture->extent.width : pTexture->extent.height;
+		while(size > 1){
+			size >>= 1;
+			pTexture->mipLevelNumber++;
+		}
+	}
+	VkDevice *pDevice = &pTextureStreamer->device;
+	pTexture->image = createMipImage(pDevice, STREAM_TEXTURE_FORMAT, &pTexture->extent, STREAM_IMAGE_USAGE, pTexture->mipLevelNumber);
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(*pDevice, pTexture->image, &memoryRequirements);
+	pthread_mutex_lock(&pTextureStreamer->mutex);
+	VkDeviceSize offset = (pTextureStreamer->imageMemoryHead + memoryRequirements.alignment - 1) & ~(memoryRequirements.alignment - 1);
+	int isPlaced = offset + memoryRequirements.size <= STREAM_IMAGE_MEMORY_SIZE;
+	if(isPlaced){
+		pTextureStreamer->imageMemoryHead = offset + memoryRequirements.size;
+	}
+	pthread_mutex_unlock(&pTextureStreamer->mutex);
+	if(!isPlaced){
+		printf("VkStreamException : %s does not fit in the %u MiB of texture memory\n", pTexture->fileName, STREAM_IMAGE_MEMORY_SIZE >> 20);
+		return -1;
+	}
+	vkBindImageMemory(*pDevice, pTexture->image, pTextureStreamer->imageMemory, offset);
+	pTexture->imageView = createMipImageView(pDevice, &pTexture->image, STREAM_TEXTURE_FORMAT, pTexture->mipLevelNumber);
+
+	// Le set ne sera lié qu'une fois la texture prête, aucun autre thread ne le lit avant
+	VkDescriptorImageInfo descriptorImageInfo = {
+		pTextureStreamer->sampler,
+		pTexture->imageView,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	};
+	VkWriteDescriptorSet writeDescriptorSet = {
+		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		VK_NULL_HANDLE,
+		pTexture->descriptorSet,
+		0,
+		0,
+		1,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		&descriptorImageInfo,
+		VK_NULL_HANDLE,
+		VK_NULL_HANDLE
+	};
+	vkUpdateDescriptorSets(*pDevice, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+	return 0;
+}
+
+static void closeStreamFile(StreamTexture *pTexture){
+	if(pTexture->fileDescriptor >= 0){
+		close(pTexture->fileDescriptor);
+		pTexture->fileDescriptor = -1;
+	}
+}
+
+static void failStreamTexture(TextureStreamer *pTextureStreamer, StreamTexture *pTexture, int isStagingReserved){
+	closeStreamFile(pTexture);
+	pthread_mutex_lock(&pTextureStreamer->mutex);
+	if(isStagingReserved){
+		releaseStaging(pTextureStreamer, (uint32_t)(pTexture - pTextureStreamer->textures));
+	}
+	pTextureStreamer->failedNumber++;
+	__atomic_store_n(&pTexture->state, STREAM_TEXTURE_FAILED, __ATOMIC_RELEASE);
+	if(!__atomic_load_n(&pTextureStreamer->isStopping, __ATOMIC_ACQUIRE)){
+		printf("VkStreamException : unable to decode %s, binary PPM or PGM up to %ux%u expected\n", pTexture->fileName, STREAM_MAX_EXTENT, STREAM_MAX_EXTENT);
+	}
+	pthread_mutex_unlock(&pTextureStreamer->mutex);
+}
+
+/**
+ * Premier job d'une texture : l'en-tête donne sa taille, son image est créée puis elle attend sa place dans l'anneau
+ */
+static void readStreamHeader(void *pData){
+	StreamTexture *pTexture = (StreamTexture *)pData;
+	TextureStreamer *pTextureStreamer = pTexture->pTextureStreamer;
+	TRACE_ZONE("read texture header");
+	double startTime = glfwGetTime();
+	uint8_t header[STREAM_HEADER_SIZE];
+	int result = -1;
+	if(!__atomic_load_n(&pTextureStreamer->isStopping, __ATOMIC_ACQUIRE)){
+		pTexture->fileDescriptor = open(pTexture->fileName, O_RDONLY);
+	}
+	if(pTexture->fileDescriptor >= 0){
+		ssize_t headerSize = pread(pTexture->fileDescriptor, header, STREAM_HEADER_SIZE, 0);
+		if(headerSize > 0 && readPnmHeader(header, (uint32_t)headerSize, &pTexture->channelNumber, &pTexture->extent, &pTexture->pixelOffset) == 0 &&
+			createStreamImage(pTextureStreamer, pTexture) == 0){
+			result = 0;
+		}
+	}
+	pTexture->decodeTime = glfwGetTime() - startTime;
+	if(result != 0){
+		failStreamTexture(pTextureStreamer, pTexture, 0);
+		return;
+	}
+	pthread_mutex_lock(&pTextureStreamer->mutex);
+	pTextureStreamer->headerOrder[pTextureStreamer->headerNumber++] = (uint32_t)(pTexture - pTextureStreamer->textures);
+	pthread_mutex_unlock(&pTextureStreamer->mutex);
+}
+
+/**
+ * Un job par bloc de STREAM_DECODE_ROWS lignes, chacun prend le bloc suivant et le dernier à finir publie la texture
+ */
+static void decodeStreamRows(void *pData){
+	StreamTexture *pTexture = (StreamTexture *)pData;
+	TextureStreamer *pTextureStreamer = pTexture->pTextureStreamer;
+	TRACE_ZONE("decode texture rows");
+	uint32_t chunk = __atomic_fetch_add(&pTexture->nextChunk, 1, __ATOMIC_RELAXED);
+	uint32_t width = pTexture->extent.width, channelNumber = pTexture->channelNumber;
+	uint32_t rowSize = width * channelNumber, readRowNumber = STREAM_READ_SIZE / rowSize;
+	uint32_t firstRow = chunk * STREAM_DECODE_ROWS;
+	uint32_t endRow = firstRow + STREAM_DECODE_ROWS < pTexture->extent.height ? firstRow + STREAM_DECODE_ROWS : pTexture->extent.height;
+	uint8_t buffer[STREAM_READ_SIZE];
+	// Décodage directement dans la zone réservée de l'anneau mappé, sans copie intermédiaire de l'image entière
+	uint8_t *pPixels = &pTextureStreamer->pStagingData[pTexture->stagingOffset];
+	for(uint32_t y = firstRow; y < endRow && !__atomic_load_n(&pTexture->isDecodeFailed, __ATOMIC_RELAXED); y += readRowNumber){
+		uint32_t rowNumber = endRow - y < readRowNumber ? endRow - y : readRowNumber;
+		size_t size = (size_t)rowNumber * rowSize;
+		if(__atomic_load_n(&pTextureStreamer->isStopping, __ATOMIC_ACQUIRE) ||
+			pread(pTexture->fileDescriptor, buffer, size, (off_t)pTexture->pixelOffset + (off_t)y * rowSize) != (ssize_t)size){
+			__atomic_store_n(&pTexture->isDecodeFailed, 1, __ATOMIC_RELAXED);
+			break;
+		}
+		for(uint32_t row = 0; row < rowNumber; row++){
+			const uint8_t *pRow = &buffer[(size_t)row * rowSize];
+			uint8_t *pTexel = &pPixels[(size_t)(y + row) * width * 4];
+			for(uint32_t x = 0; x < width; x++){
+				pTexel[4 * x] = pRow[channelNumber * x];
+				pTexel[4 * x + 1] = pRow[channelNumber * x + (channelNumber == 3 ? 1 : 0)];
+				pTexel[4 * x + 2] = pRow[channelNumber * x + (channelNumber == 3 ? 2 : 0)];
+				pTexel[4 * x + 3] = 255;
+			}
+		}
+	}
+	if(__atomic_sub_fetch(&pTexture->remainingChunks, 1, __ATOMIC_ACQ_REL) != 0){
+		return;
+	}
+
+	if(__atomic_load_n(&pTexture->isDecodeFailed, __ATOMIC_RELAXED)){
+		failStreamTexture(pTextureStreamer, pTexture, 1);
+		return;
+	}
+	closeStreamFile(pTexture);
+	pthread_mutex_lock(&pTextureStreamer->mutex);
+	pTexture->decodeTime += glfwGetTime() - pTexture->decodeStartTime;
+	pTextureStreamer->decodedOrder[pTextureStreamer->decodedNumber++] = (uint32_t)(pTexture - pTextureStreamer->textures);
+	__atomic_store_n(&pTexture->state, STREAM_TEXTURE_DECODED, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&pTextureStreamer->mutex);
+}
+
+/**
+ * Appelée par le thread de rendu : les textures dont l'en-tête est lu prennent leur place dans l'anneau dans l'ordre,
+ * la première qui ne tient pas attend une frame suivante, puis leurs lignes partent au décodage
+ */
+static void startStreamDecodes(TextureStreamer *pTextureStreamer, double startTime){
+	uint32_t textures[STREAM_MAX_TEXTURES];
+	uint32_t textureNumber = 0;
+	pthread_mutex_lock(&pTextureStreamer->mutex);
+	while(pTextureStreamer->headerFirst < pTextureStreamer->headerNumber){
+		uint32_t texture = pTextureStreamer->headerOrder[pTextureStreamer->headerFirst];
+		StreamTexture *pTexture = &pTextureStreamer->textures[texture];
+		if(reserveStaging(pTextureStreamer, texture, (VkDeviceSize)pTexture->extent.width * pTexture->extent.height * 4) != 0){
+			break;
+		}
+		pTextureStreamer->headerFirst++;
+		textures[textureNumber++] = texture;
+	}
+	pthread_mutex_unlock(&pTextureStreamer->mutex);
+
+	for(uint32_t i = 0; i < textureNumber; i++){
+		StreamTexture *pTexture = &pTextureStreamer->textures[textures[i]];
+		pTexture->chunkNumber = (pTexture->extent.height + STREAM_DECODE_ROWS - 1) / STREAM_DECODE_ROWS;
+		pTexture->nextChunk = 0;
+		pTexture->remainingChunks = pTexture->chunkNumber;
+		pTexture->isDecodeFailed = 0;
+		pTexture->decodeStartTime = startTime;
+		for(uint32_t j = 0; j < pTexture->chunkNumber; j++){
+			runBackgroundJob(pTextureStreamer->pJobSystem, decodeStreamRows, pTexture, &pTextureStreamer->jobCounter);
+		}
+	}
+}
+
+static VkSemaphore createTimelineSemaphore(VkDevice *pDevice){
+	VkSemaphoreTypeCreateInfoKHR semaphoreTypeCreateInfo = {
+		VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+		VK_NULL_HANDLE,
+		VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+		0
+	};
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {
+		VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		&semaphoreTypeCreateInfo,
+		0
+	};
+
+	VkSemaphore semaphore = VK_NULL_HANDLE;
+	vkCreateSemaphore(*pDevice, &semaphoreCreateInfo, getHostAllocator(VK_OBJECT_TYPE_SEMAPHORE), &semaphore);
+	return semaphore;
+}
+
+static int createStreamDescriptors(VkDevice *pDevice, TextureStreamer *pTextureStreamer){
+	VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {
+		0,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		1,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+		VK_NULL_HANDLE
+	};
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&descriptorSetLayoutBinding
+	};
+	vkCreateDescriptorSetLayout(*pDevice, &descriptorSetLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &pTextureStreamer->descriptorSetLayout);
+
+	VkDescriptorPoolSize descriptorPoolSize = {
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		STREAM_MAX_TEXTURES
+	};
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		STREAM_MAX_TEXTURES,
+		1,
+		&descriptorPoolSize
+	};
+	vkCreateDescriptorPool(*pDevice, &descriptorPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pTextureStreamer->descriptorPool);
+
+	// Un set par texture possible, alloués d'avance pour que les jobs d'en-tête n'aient qu'à les écrire
+	VkDescriptorSetLayout descriptorSetLayouts[STREAM_MAX_TEXTURES];
+	VkDescriptorSet descriptorSets[STREAM_MAX_TEXTURES];
+	for(uint32_t i = 0; i < STREAM_MAX_TEXTURES; i++){
+		descriptorSetLayouts[i] = pTextureStreamer->descriptorSetLayout;
+	}
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pTextureStreamer->descriptorPool,
+		STREAM_MAX_TEXTURES,
+		descriptorSetLayouts
+	};
+	if(vkAllocateDescriptorSets(*pDevice, &descriptorSetAllocateInfo, descriptorSets) != VK_SUCCESS){
+		return -1;
+	}
+	for(uint32_t i = 0; i < STREAM_MAX_TEXTURES; i++){
+		pTextureStreamer->textures[i].descriptorSet = descriptorSets[i];
+	}
+	return 0;
+}
+
+/**
+ * Les images de même format, tiling et usage acceptent les mêmes types de mémoire quelle que soit leur taille, une image d'un texel suffit à les connaître
+ */
+static VkDeviceMemory allocateStreamImageMemory(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice){
+	VkExtent2D extent = {1, 1};
+	VkImage image = createMipImage(pDevice, STREAM_TEXTURE_FORMAT, &extent, STREAM_IMAGE_USAGE, 1);
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(*pDevice, image, &memoryRequirements);
+	vkDestroyImage(*pDevice, image, getHostAllocator(VK_OBJECT_TYPE_IMAGE));
+
+	uint32_t memoryTypeIndex = getMemoryTypeIndex(pPhysicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if(memoryTypeIndex == UINT32_MAX){
+		return VK_NULL_HANDLE;
+	}
+	VkMemoryAllocateInfo memoryAllocateInfo = {
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		STREAM_IMAGE_MEMORY_SIZE,
+		memoryTypeIndex
+	};
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if(vkAllocateMemory(*pDevice, &memoryAllocateInfo, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY), &memory) != VK_SUCCESS){
+		return VK_NULL_HANDLE;
+	}
+	return memory;
+}
+
+TextureStreamer *createTextureStreamer(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, uint32_t graphicsQueueFamilyIndex, VkQueue *pGraphicsQueue, uint32_t transferQueueFamilyIndex, VkQueue *pTransferQueue, JobSystem *pJobSystem){
+	if(!getTimelineSemaphoreSupport(pPhysicalDevice)){
+		printf("VkStreamException : timeline semaphores not supported, textures are not streamed\n");
+		return VK_NULL_HANDLE;
+	}
+	// Le thread de rendu ne décode jamais, il faut au moins un autre worker
+	if(pJobSystem == VK_NULL_HANDLE || getJobWorkerNumber(pJobSystem) < 2){
+		printf("VkStreamException : no job worker besides the render thread, textures are not streamed\n");
+		return VK_NULL_HANDLE;
+	}
+	TextureStreamer *pTextureStreamer = (TextureStreamer *)calloc(1, sizeof(TextureStreamer));
+	if(pTextureStreamer == VK_NULL_HANDLE){
+		return VK_NULL_HANDLE;
+	}
+	pthread_mutex_init(&pTextureStreamer->mutex, NULL);
+	pTextureStreamer->pJobSystem = pJobSystem;
+	pTextureStreamer->physicalDevice = *pPhysicalDevice;
+	pTextureStreamer->device = *pDevice;
+	pTextureStreamer->graphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
+	pTextureStreamer->transferQueueFamilyIndex = transferQueueFamilyIndex;
+	pTextureStreamer->graphicsQueue = *pGraphicsQueue;
+	pTextureStreamer->transferQueue = *pTransferQueue;
+	pTextureStreamer->getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(*pDevice, "vkGetSemaphoreCounterValueKHR");
+	pTextureStreamer->waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(*pDevice, "vkWaitSemaphoresKHR");
+
+	// Les mips sont générés par blits linéaires, sinon la texture n'a que son premier niveau
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(*pPhysicalDevice, STREAM_TEXTURE_FORMAT, &formatProperties);
+	VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	pTextureStreamer->isBlitSupported = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+
+	pTextureStreamer->transferTimeline = createTimelineSemaphore(pDevice);
+	pTextureStreamer->graphicsTimeline = createTimelineSemaphore(pDevice);
+	pTextureStreamer->transferCommandPool = createCommandPool(pDevice, transferQueueFamilyIndex);
+	pTextureStreamer->graphicsCommandPool = createCommandPool(pDevice, graphicsQueueFamilyIndex);
+	pTextureStreamer->pTransferCommandBuffers = createCommandBuffers(pDevice, &pTextureStreamer->transferCommandPool, STREAM_MAX_BATCHES);
+	pTextureStreamer->pGraphicsCommandBuffers = createCommandBuffers(pDevice, &pTextureStreamer->graphicsCommandPool, STREAM_MAX_BATCHES);
+	pTextureStreamer->sampler = createSampler(pDevice, VK_FILTER_LINEAR);
+	int isDescriptorCreated = createStreamDescriptors(pDevice, pTextureStreamer) == 0;
+	pTextureStreamer->imageMemory = allocateStreamImageMemory(pPhysicalDevice, pDevice);
+	if(!isDescriptorCreated || pTextureStreamer->imageMemory == VK_NULL_HANDLE){
+		printf("VkStreamException : unable to allocate the %u descriptor sets and the %u MiB of texture memory\n", STREAM_MAX_TEXTURES, STREAM_IMAGE_MEMORY_SIZE >> 20);
+		deleteTextureStreamer(pDevice, &pTextureStreamer);
+		return VK_NULL_HANDLE;
+	}
+
+	// L'anneau reste mappé pendant toute la vie du streamer, les jobs de décodage y écrivent directement
+	pTextureStreamer->stagingBuffer = createBuffer(pDevice, STREAM_STAGING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	pTextureStreamer->stagingMemory = allocateBufferMemory(pPhysicalDevice, pDevice, &pTextureStreamer->stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if(pTextureStreamer->stagingMemory == VK_NULL_HANDLE || pTextureStreamer->transferTimeline == VK_NULL_HANDLE || pTextureStreamer->graphicsTimeline == VK_NULL_HANDLE){
+		printf("VkStreamException : unable to create the staging ring and the timelines\n");
+		deleteTextureStreamer(pDevice, &pTextureStreamer);
+		return VK_NULL_HANDLE;
+	}
+	vkMapMemory(*pDevice, pTextureStreamer->stagingMemory, 0, VK_WHOLE_SIZE, 0, (void **)&pTextureStreamer->pStagingData);
+	return pTextureStreamer;
+}
+
+void deleteTextureStreamer(VkDevice *pDevice, TextureStreamer **ppTextureStreamer){
+	TextureStreamer *pTextureStreamer = *ppTextureStreamer;
+	// Les jobs encore en attente abandonnent leur texture dès leur début, ceux en cours après leur lecture suivante
+	__atomic_store_n(&pTextureStreamer->isStopping, 1, __ATOMIC_RELEASE);
+	waitJobCounter(pTextureStreamer->pJobSystem, &pTextureStreamer->jobCounter);
+	pthread_mutex_destroy(&pTextureStreamer->mutex);
+
+	// Les copies et acquisitions encore en vol doivent finir avant de détruire leurs images
+	if(pTextureStreamer->transferTimeline != VK_NULL_HANDLE && pTextureStreamer->graphicsTimeline != VK_NULL_HANDLE){
+		VkSemaphore semaphores[] = {pTextureStreamer->transferTimeline, pTextureStreamer->graphicsTimeline};
+		uint64_t values[] = {pTextureStreamer->transferValue, pTextureStreamer->graphicsValue};
+		VkSemaphoreWaitInfoKHR semaphoreWaitInfo = {
+			VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+			VK_NULL_HANDLE,
+			0,
+			2,
+			semaphores,
+			values
+		};
+		pTextureStreamer->waitSemaphores(*pDevice, &semaphoreWaitInfo, UINT64_MAX);
+	}
+
+	if(pTextureStreamer->updateNumber != 0){
+		printf("texture streamer : %u textures ready, %u failed, %.1f MiB uploaded on the %s queue\n", pTextureStreamer->readyNumber, pTextureStreamer->failedNumber,
+			(double)pTextureStreamer->uploadedBytes / (1024.0 * 1024.0), pTextureStreamer->transferQueueFamilyIndex != pTextureStreamer->graphicsQueueFamilyIndex ? "transfer" : "graphics");
+		if(pTextureStreamer->readyNumber != 0){
+			printf("  request to ready %.2f ms average, %.2f ms max, decode %.2f ms average\n", pTextureStreamer->latencySum * 1e3 / pTextureStreamer->readyNumber,
+				pTextureStreamer->maxLatency * 1e3, pTextureStreamer->decodeTimeSum * 1e3 / pTextureStreamer->readyNumber);
+		}
+		printf("  render thread %.3f ms average, %.3f ms max per frame\n", pTextureStreamer->updateTimeSum * 1e3 / (double)pTextureStreamer->updateNumber, pTextureStreamer->maxUpdateTime * 1e3);
+	}
+
+	for(uint32_t i = 0; i < pTextureStreamer->textureNumber; i++){
+		StreamTexture *pTexture = &pTextureStreamer->textures[i];
+		// Une texture dont l'en-tête est lu attendait encore sa place dans l'anneau, son fichier est resté ouvert
+		closeStreamFile(pTexture);
+		vkDestroyImageView(*pDevice, pTexture->imageView, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+		vkDestroyImage(*pDevice, pTexture->image, getHostAllocator(VK_OBJECT_TYPE_IMAGE));
+	}
+	vkFreeMemory(*pDevice, pTextureStreamer->imageMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	if(pTextureStreamer->pStagingData != VK_NULL_HANDLE){
+		vkUnmapMemory(*pDevice, pTextureStreamer->stagingMemory);
+	}
+	vkFreeMemory(*pDevice, pTextureStreamer->stagingMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pTextureStreamer->stagingBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkDestroyDescriptorPool(*pDevice, pTextureStreamer->descriptorPool, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+	vkDestroyDescriptorSetLayout(*pDevice, pTextureStreamer->descriptorSetLayout, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+	vkDestroySampler(*pDevice, pTextureStreamer->sampler, getHostAllocator(VK_OBJECT_TYPE_SAMPLER));
+	deleteCommandBuffers(pDevice, &pTextureStreamer->pGraphicsCommandBuffers, &pTextureStreamer->graphicsCommandPool, STREAM_MAX_BATCHES);
+	deleteCommandBuffers(pDevice, &pTextureStreamer->pTransferCommandBuffers, &pTextureStreamer->transferCommandPool, STREAM_MAX_BATCHES);
+	deleteCommandPool(pDevice, &pTextureStreamer->graphicsCommandPool);
+	deleteCommandPool(pDevice, &pTextureStreamer->transferCommandPool);
+	vkDestroySemaphore(*pDevice, pTextureStreamer->graphicsTimeline, getHostAllocator(VK_OBJECT_TYPE_SEMAPHORE));
+	vkDestroySemaphore(*pDevice, pTextureStreamer->transferTimeline, getHostAllocator(VK_OBJECT_TYPE_SEMAPHORE));
+	free(pTextureStreamer);
+	*ppTextureStreamer = VK_NULL_HANDLE;
+}
+
+uint32_t requestTexture(TextureStreamer *pTextureStreamer, const char *fileName){
+	if(pTextureStreamer->textureNumber == STREAM_MAX_TEXTURES){
+		printf("VkStreamException : %s not requested, %u textures already\n", fileName, STREAM_MAX_TEXTURES);
+		return STREAM_INVALID_TEXTURE;
+	}
+	uint32_t texture = pTextureStreamer->textureNumber++;
+	StreamTexture *pTexture = &pTextureStreamer->textures[texture];
+	snprintf(pTexture->fileName, STREAM_MAX_PATH, "%s", fileName);
+	pTexture->pTextureStreamer = pTextureStreamer;
+	pTexture->fileDescriptor = -1;
+	pTexture->state = STREAM_TEXTURE_QUEUED;
+	pTexture->requestTime = glfwGetTime();
+	// Jamais sur la deque du thread de rendu : l'image passe par l'allocateur de l'hôte et un décodage prendrait le temps de la frame
+	runBackgroundJob(pTextureStreamer->pJobSystem, readStreamHeader, pTexture, &pTextureStreamer->jobCounter);
+	return texture;
+}
+
+static void recordStreamBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t baseMipLevel, uint32_t mipLevelNumber, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex){
+	VkImageMemoryBarrier imageMemoryBarrier = {
+		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		VK_NULL_HANDLE,
+		srcAccessMask,
+		dstAccessMask,
+		oldLayout,
+		newLayout,
+		srcQueueFamilyIndex,
+		dstQueueFamilyIndex,
+		image,
+		{
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			baseMipLevel,
+			mipLevelNumber,
+			0,
+			1
+		}
+	};
+	vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &imageMemoryBarrier);
+}
+
+static void recordStreamTransfer(TextureStreamer *pTextureStreamer, VkCommandBuffer commandBuffer, StreamTexture *pTexture){
+	VkBool32 isTransferred = pTextureStreamer->transferQueueFamilyIndex != pTextureStreamer->graphicsQueueFamilyIndex;
+	uint32_t srcQueueFamilyIndex = isTransferred ? pTextureStreamer->transferQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	uint32_t dstQueueFamilyIndex = isTransferred ? pTextureStreamer->graphicsQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	// Sans chaîne de mips le premier niveau part directement en lecture shader
+	VkImageLayout releaseLayout = pTexture->mipLevelNumber > 1 ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkBufferImageCopy bufferImageCopy = {
+		pTexture->stagingOffset,
+		0,
+		0,
+		{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+		{0, 0, 0},
+		{pTexture->extent.width, pTexture->extent.height, 1}
+	};
+	recordStreamBarrier(commandBuffer, pTexture->image, 0, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+	vkCmdCopyBufferToImage(commandBuffer, pTextureStreamer->stagingBuffer, pTexture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+	// Libération : la moitié transfert du changement de propriétaire, la même barrière est répétée à l'acquisition
+	recordStreamBarrier(commandBuffer, pTexture->image, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, releaseLayout,
+		VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, srcQueueFamilyIndex, dstQueueFamilyIndex);
+}
+
+static void recordStreamAcquire(TextureStreamer *pTextureStreamer, VkCommandBuffer commandBuffer, StreamTexture *pTexture){
+	VkImage image = pTexture->image;
+	uint32_t mipLevelNumber = pTexture->mipLevelNumber;
+	VkImageLayout releaseLayout = mipLevelNumber > 1 ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	VkAccessFlags dstAccessMask = mipLevelNumber > 1 ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_SHADER_READ_BIT;
+	VkPipelineStageFlags dstStageMask = mipLevelNumber > 1 ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	// La source de l'acquisition est l'étape attendue sur le sémaphore, la barrière prolonge l'attente jusqu'aux frames suivantes
+	if(pTextureStreamer->transferQueueFamilyIndex != pTextureStreamer->graphicsQueueFamilyIndex){
+		recordStreamBarrier(commandBuffer, image, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, releaseLayout, 0, dstAccessMask,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, pTextureStreamer->transferQueueFamilyIndex, pTextureStreamer->graphicsQueueFamilyIndex);
+	}else if(mipLevelNumber == 1){
+		// Même famille : aucun propriétaire à changer, seulement la visibilité pour les shaders des frames suivantes
+		recordStreamBarrier(commandBuffer, image, 0, 1, releaseLayout, releaseLayout, 0, dstAccessMask,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+	}
+	if(mipLevelNumber == 1){
+		return;
+	}
+
+	// Chaque niveau est réduit de moitié depuis le précédent, puis devient la source du suivant
+	recordStreamBarrier(commandBuffer, image, 1, mipLevelNumber - 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+	int32_t width = (int32_t)pTexture->extent.width, height = (int32_t)pTexture->extent.height;
+	for(uint32_t level = 1; level < mipLevelNumber; level++){
+		int32_t mipWidth = width > 1 ? width / 2 : 1, mipHeight = height > 1 ? height / 2 : 1;
+		VkImageBlit imageBlit = {
+			{VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1},
+			{{0, 0, 0}, {width, height, 1}},
+			{VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1},
+			{{0, 0, 0}, {mipWidth, mipHeight, 1}}
+		};
+		vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
+		recordStreamBarrier(commandBuffer, image, level, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+		width = mipWidth;
+		height = mipHeight;
+	}
+	recordStreamBarrier(commandBuffer, image, 0, mipLevelNumber, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+}
+
+static void submitStreamCommands(TextureStreamer *pTextureStreamer, VkQueue queue, VkCommandBuffer *pCommandBuffer, VkSemaphore waitSemaphore, uint64_t waitValue, VkSemaphore signalSemaphore, uint64_t signalValue){
+	VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	VkTimelineSemaphoreSubmitInfoKHR timelineSemaphoreSubmitInfo = {
+		VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+		VK_NULL_HANDLE,
+		waitSemaphore != VK_NULL_HANDLE ? 1 : 0,
+		&waitValue,
+		1,
+		&signalValue
+	};
+	VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		&timelineSemaphoreSubmitInfo,
+		waitSemaphore != VK_NULL_HANDLE ? 1 : 0,
+		&waitSemaphore,
+		&waitStageMask,
+		1,
+		pCommandBuffer,
+		1,
+		&signalSemaphore
+	};
+	// Le thread de soumission des frames peut utiliser la même queue au même moment
+	lockSubmitQueue(pTextureStreamer->pFrameSubmitter, queue);
+	vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+	unlockSubmitQueue(pTextureStreamer->pFrameSubmitter, queue);
+}
+
+static void beginStreamBatch(TextureStreamer *pTextureStreamer, uint32_t batch){
+	StreamBatch *pBatch = &pTextureStreamer->batches[batch];
+	VkCommandBuffer transferCommandBuffer = pTextureStreamer->pTransferCommandBuffers[batch];
+	VkCommandBuffer graphicsCommandBuffer = pTextureStreamer->pGraphicsCommandBuffers[batch];
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		VK_NULL_HANDLE,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		VK_NULL_HANDLE
+	};
+	vkBeginCommandBuffer(transferCommandBuffer, &commandBufferBeginInfo);
+	vkBeginCommandBuffer(graphicsCommandBuffer, &commandBufferBeginInfo);
+
+	// L'image, sa mémoire et son set sont prêts depuis le job d'en-tête, il ne reste qu'à enregistrer les commandes
+	for(uint32_t i = 0; i < pBatch->textureNumber; i++){
+		uint32_t texture = pBatch->textures[i];
+		StreamTexture *pTexture = &pTextureStreamer->textures[texture];
+		recordStreamTransfer(pTextureStreamer, transferCommandBuffer, pTexture);
+		// L'acquisition est enregistrée tout de suite, elle ne sera soumise qu'une fois la copie terminée
+		recordStreamAcquire(pTextureStreamer, graphicsCommandBuffer, pTexture);
+		__atomic_store_n(&pTexture->state, STREAM_TEXTURE_UPLOADING, __ATOMIC_RELEASE);
+		pTextureStreamer->uploadedBytes += (uint64_t)pTexture->extent.width * pTexture->extent.height * 4;
+	}
+	vkEndCommandBuffer(transferCommandBuffer);
+	vkEndCommandBuffer(graphicsCommandBuffer);
+
+	pBatch->transferValue = ++pTextureStreamer->transferValue;
+	submitStreamCommands(pTextureStreamer, pTextureStreamer->transferQueue, &pTextureStreamer->pTransferCommandBuffers[batch], VK_NULL_HANDLE, 0,
+		pTextureStreamer->transferTimeline, pBatch->transferValue);
+	pBatch->state = STREAM_BATCH_TRANSFERRING;
+}
+
+VkBool32 updateTextureStreamer(TextureStreamer *pTextureStreamer){
+	TRACE_ZONE("stream textures");
+	double startTime = glfwGetTime();
+	VkBool32 isReady = VK_FALSE;
+	// Simple lecture des compteurs : le thread de rendu n'attend jamais une copie
+	uint64_t transferValue = 0, graphicsValue = 0;
+	pTextureStreamer->getSemaphoreCounterValue(pTextureStreamer->device, pTextureStreamer->transferTimeline, &transferValue);
+	pTextureStreamer->getSemaphoreCounterValue(pTextureStreamer->device, pTextureStreamer->graphicsTimeline, &graphicsValue);
+
+	uint32_t freeBatch = STREAM_MAX_BATCHES;
+	for(uint32_t i = 0; i < STREAM_MAX_BATCHES; i++){
+		StreamBatch *pBatch = &pTextureStreamer->batches[i];
+		if(pBatch->state == STREAM_BATCH_TRANSFERRING && pBatch->transferValue <= transferValue){
+			// Copie terminée : l'acquisition et les mips passent avant la frame sur la queue graphique
+			pBatch->graphicsValue = ++pTextureStreamer->graphicsValue;
+			submitStreamCommands(pTextureStreamer, pTextureStreamer->graphicsQueue, &pTextureStreamer->pGraphicsCommandBuffers[i], pTextureStreamer->transferTimeline,
+				pBatch->transferValue, pTextureStreamer->graphicsTimeline, pBatch->graphicsValue);
+			pBatch->state = STREAM_BATCH_ACQUIRING;
+			pthread_mutex_lock(&pTextureStreamer->mutex);
+			for(uint32_t j = 0; j < pBatch->textureNumber; j++){
+				releaseStaging(pTextureStreamer, pBatch->textures[j]);
+			}
+			pthread_mutex_unlock(&pTextureStreamer->mutex);
+			for(uint32_t j = 0; j < pBatch->textureNumber; j++){
+				StreamTexture *pTexture = &pTextureStreamer->textures[pBatch->textures[j]];
+				double latency = startTime - pTexture->requestTime;
+				pTextureStreamer->latencySum += latency;
+				pTextureStreamer->maxLatency = latency > pTextureStreamer->maxLatency ? latency : pTextureStreamer->maxLatency;
+				pTextureStreamer->decodeTimeSum += pTexture->decodeTime;
+				pTextureStreamer->readyNumber++;
+				__atomic_store_n(&pTexture->state, STREAM_TEXTURE_READY, __ATOMIC_RELEASE);
+			}
+			isReady = VK_TRUE;
+		}else if(pBatch->state == STREAM_BATCH_ACQUIRING && pBatch->graphicsValue <= graphicsValue){
+			pBatch->state = STREAM_BATCH_FREE;
+		}
+		if(pBatch->state == STREAM_BATCH_FREE && freeBatch == STREAM_MAX_BATCHES){
+			freeBatch = i;
+		}
+	}
+
+	startStreamDecodes(pTextureStreamer, startTime);
+
+	// Au plus un nouveau lot par frame, ses command buffers ne sont réutilisés qu'une fois l'acquisition précédente terminée
+	if(freeBatch != STREAM_MAX_BATCHES){
+		StreamBatch *pBatch = &pTextureStreamer->batches[freeBatch];
+		pBatch->textureNumber = 0;
+		pthread_mutex_lock(&pTextureStreamer->mutex);
+		while(pTextureStreamer->decodedFirst < pTextureStreamer->decodedNumber && pBatch->textureNumber < STREAM_BATCH_TEXTURES){
+			pBatch->textures[pBatch->textureNumber++] = pTextureStreamer->decodedOrder[pTextureStreamer->decodedFirst++];
+		}
+		pthread_mutex_unlock(&pTextureStreamer->mutex);
+		if(pBatch->textureNumber != 0){
+			beginStreamBatch(pTextureStreamer, freeBatch);
+		}
+	}
+
+	double updateTime = glfwGetTime() - startTime;
+	pTextureStreamer->updateTimeSum += updateTime;
+	pTextureStreamer->maxUpdateTime = updateTime > pTextureStreamer->maxUpdateTime ? updateTime : pTextureStreamer->maxUpdateTime;
+	pTextureStreamer->updateNumber++;
+	return isReady;
+}
+
+void setTextureStreamerSubmitter(TextureStreamer *pTextureStreamer, FrameSubmitter *pFrameSubmitter){
+	pTextureStreamer->pFrameSubmitter = pFrameSubmitter;
+}
+
+uint32_t getTextureState(TextureStreamer *pTextureStreamer, uint32_t texture){
+	if(texture >= STREAM_MAX_TEXTURES){
+		return STREAM_TEXTURE_FAILED;
+	}
+	return __atomic_load_n(&pTextureStreamer->textures[texture].state, __ATOMIC_ACQUIRE);
+}
+
+VkDescriptorSet getTextureDescriptorSet(TextureStreamer *pTextureStreamer, uint32_t texture){
+	if(getTextureState(pTextureStreamer, texture) != STREAM_TEXTURE_READY){
+		return VK_NULL_HANDLE;
+	}
+	return pTextureStreamer->textures[texture].descriptorSet;
+}
+
+VkDescriptorImageInfo getTextureImageInfo(TextureStreamer *pTextureStreamer, uint32_t texture){
+	VkDescriptorImageInfo descriptorImageInfo = {
+		pTextureStreamer->sampler,
+		VK_NULL_HANDLE,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	};
+	if(getTextureState(pTextureStreamer, texture) == STREAM_TEXTURE_READY){
+		descriptorImageInfo.imageView = pTextureStreamer->textures[texture].imageView;
+	}
+	return descriptorImageInfo;
+}
+
+VkDescriptorSetLayout *getTextureSetLayout(TextureStreamer *pTextureStreamer){
+	return &pTextureStreamer->descriptorSetLayout;
+}
@@ -0,0 +1,335 @@
+#include <pthread.h>
+
+#include "../Headers/glfw_fun.h"
+#include "../Headers/submit_fun.h"
+#include "../Headers/trace_fun.h"
+
+typedef struct SubmitFrame {
+	uint32_t frame;
+	uint32_t imageIndex;
+} SubmitFrame;
+
+struct FrameSubmitter {
+	VkDevice device;
+	VkSwapchainKHR swapchain;
+	VkQueue drawingQueue;
+	VkQueue presentingQueue;
+	VkCommandBuffer *pCommandBuffers;
+	VkFence *pFrontFences;
+	VkFence *pBackFences;
+	VkSemaphore *pWaitSemaphores;
+	VkSemaphore *pSignalSemaphores;
+	uint32_t maxFrames;
+	uint32_t acquireFrame;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t imageCondition;
+	pthread_cond_t frameCondition;
+	pthread_mutex_t drawingQueueMutex;
+	pthread_mutex_t presentingQueueMutex;
+	SubmitFrame images[SUBMIT_QUEUE_CAPACITY];
+	uint32_t imageFirst;
+	uint32_t imageNumber;
+	SubmitFrame frames[SUBMIT_QUEUE_CAPACITY];
+	uint32_t frameFirst;
+	uint32_t frameNumber;
+	uint64_t pushedNumber;
+	uint64_t presentedNumber;
+	int isRunning;
+	int isStopped;
+	// Temps d'attente du thread de rendu, puis temps passés dans les appels bloquants du thread de soumission
+	double imageWaitSum;
+	double maxImageWait;
+	double pushWaitSum;
+	double acquireTimeSum;
+	double maxAcquireTime;
+	double presentTimeSum;
+	double maxPresentTime;
+};
+
+/**
+ * Un verrou par queue : une présentation sur sa propre queue ne retient pas les soumissions des autres threads sur celle de dessin
+ */
+static pthread_mutex_t *getSubmitQueueMutex(FrameSubmitter *pFrameSubmitter, VkQueue queue){
+	if(queue == pFrameSubmitter->drawingQueue){
+		return &pFrameSubmitter->drawingQueueMutex;
+	}
+	if(queue == pFrameSubmitter->presentingQueue){
+		return &pFrameSubmitter->presentingQueueMutex;
+	}
+	return NULL;
+}
+
+static void acquireSubmitterImage(FrameSubmitter *pFrameSubmitter){
+	TRACE_ZONE("acquire");
+	uint32_t frame = pFrameSubmitter->acquireFrame;
+	pFrameSubmitter->acquireFrame = (frame + 1) % pFrameSubmitter->maxFrames;
+
+	// Le sémaphore d'acquisition du slot n'est libre qu'une fois la soumission qui l'attendait terminée
+	vkWaitForFences(pFrameSubmitter->device, 1, &pFrameSubmitter->pFrontFences[frame], VK_TRUE, UINT64_MAX);
+	uint32_t imageIndex = 0;
+	double startTime = glfwGetTime();
+	vkAcquireNextImageKHR(pFrameSubmitter->device, pFrameSubmitter->swapchain, UINT64_MAX, pFrameSubmitter->pWaitSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
+	double acquireTime = glfwGetTime() - startTime;
+	// Seul ce thread remet les barrières à zéro, l'attente de celle de l'image se fait donc ici aussi
+	if(pFrameSubmitter->pBackFences[imageIndex] != VK_NULL_HANDLE){
+		vkWaitForFences(pFrameSubmitter->device, 1, &pFrameSubmitter->pBackFences[imageIndex], VK_TRUE, UINT64_MAX);
+	}
+	pFrameSubmitter->pBackFences[imageIndex] = pFrameSubmitter->pFrontFences[frame];
+
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	pFrameSubmitter->acquireTimeSum += acquireTime;
+	pFrameSubmitter->maxAcquireTime = acquireTime > pFrameSubmitter->maxAcquireTime ? acquireTime : pFrameSubmitter->maxAcquireTime;
+	SubmitFrame *pImage = &pFrameSubmitter->images[(pFrameSubmitter->imageFirst + pFrameSubmitter->imageNumber) % SUBMIT_QUEUE_CAPACITY];
+	pImage->frame = frame;
+	pImage->imageIndex = imageIndex;
+	pFrameSubmitter->imageNumber++;
+	pthread_cond_signal(&pFrameSubmitter->imageCondition);
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+}
+
+static void submitSubmitterFrame(FrameSubmitter *pFrameSubmitter, SubmitFrame *pFrame){
+	VkPipelineStageFlags pipelineStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	VkSubmitInfo submitInfo = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		VK_NULL_HANDLE,
+		1,
+		&pFrameSubmitter->pWaitSemaphores[pFrame->frame],
+		&pipelineStage,
+		1,
+		&pFrameSubmitter->pCommandBuffers[pFrame->imageIndex],
+		1,
+		&pFrameSubmitter->pSignalSemaphores[pFrame->frame]
+	};
+	VkPresentInfoKHR presentInfo = {
+		VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+		VK_NULL_HANDLE,
+		1,
+		&pFrameSubmitter->pSignalSemaphores[pFrame->frame],
+		1,
+		&pFrameSubmitter->swapchain,
+		&pFrame->imageIndex,
+		VK_NULL_HANDLE
+	};
+
+	TRACE_BEGIN("submit");
+	pthread_mutex_lock(&pFrameSubmitter->drawingQueueMutex);
+	vkResetFences(pFrameSubmitter->device, 1, &pFrameSubmitter->pFrontFences[pFrame->frame]);
+	vkQueueSubmit(pFrameSubmitter->drawingQueue, 1, &submitInfo, pFrameSubmitter->pFrontFences[pFrame->frame]);
+	pthread_mutex_unlock(&pFrameSubmitter->drawingQueueMutex);
+	TRACE_END();
+
+	// Une présentation bloquée sur une swapchain FIFO ne garde la queue de dessin que si c'est aussi celle de présentation
+	TRACE_BEGIN("present");
+	double startTime = glfwGetTime();
+	pthread_mutex_t *pPresentingQueueMutex = getSubmitQueueMutex(pFrameSubmitter, pFrameSubmitter->presentingQueue);
+	pthread_mutex_lock(pPresentingQueueMutex);
+	vkQueuePresentKHR(pFrameSubmitter->presentingQueue, &presentInfo);
+	pthread_mutex_unlock(pPresentingQueueMutex);
+	double presentTime = glfwGetTime() - startTime;
+	TRACE_END();
+
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	pFrameSubmitter->presentTimeSum += presentTime;
+	pFrameSubmitter->maxPresentTime = presentTime > pFrameSubmitter->maxPresentTime ? presentTime : pFrameSubmitter->maxPresentTime;
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+}
+
+/**
+ * Les images acquises d'avance ne seront jamais dessinées : une soumission vide attend leur sémaphore d'acquisition
+ * pour le laisser non signalé, et signale la barrière du slot comme une frame l'aurait fait
+ */
+static void releaseSubmitterImages(FrameSubmitter *pFrameSubmitter){
+	VkPipelineStageFlags pipelineStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	while(pFrameSubmitter->imageNumber != 0){
+		SubmitFrame *pImage = &pFrameSubmitter->images[pFrameSubmitter->imageFirst];
+		VkSubmitInfo submitInfo = {
+			VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			VK_NULL_HANDLE,
+			1,
+			&pFrameSubmitter->pWaitSemaphores[pImage->frame],
+			&pipelineStage,
+			0,
+			VK_NULL_HANDLE,
+			0,
+			VK_NULL_HANDLE
+		};
+		pthread_mutex_lock(&pFrameSubmitter->drawingQueueMutex);
+		vkResetFences(pFrameSubmitter->device, 1, &pFrameSubmitter->pFrontFences[pImage->frame]);
+		vkQueueSubmit(pFrameSubmitter->drawingQueue, 1, &submitInfo, pFrameSubmitter->pFrontFences[pImage->frame]);
+		pthread_mutex_unlock(&pFrameSubmitter->drawingQueueMutex);
+		pFrameSubmitter->imageFirst = (pFrameSubmitter->imageFirst + 1) % SUBMIT_QUEUE_CAPACITY;
+		pFrameSubmitter->imageNumber--;
+	}
+	pFrameSubmitter->isStopped = 1;
+	pthread_cond_broadcast(&pFrameSubmitter->frameCondition);
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+}
+
+static void *runFrameSubmitter(void *pArgument){
+	FrameSubmitter *pFrameSubmitter = (FrameSubmitter *)pArgument;
+	TRACE_THREAD("frame submitter");
+
+	// Une image pour la frame en cours d'enregistrement et une d'avance, pas plus que de slots
+	uint32_t aheadNumber = pFrameSubmitter->maxFrames < SUBMIT_QUEUE_CAPACITY ? pFrameSubmitter->maxFrames : SUBMIT_QUEUE_CAPACITY;
+	for(uint32_t i = 0; i < aheadNumber; i++){
+		acquireSubmitterImage(pFrameSubmitter);
+	}
+
+	for(;;){
+		pthread_mutex_lock(&pFrameSubmitter->mutex);
+		while(pFrameSubmitter->frameNumber == 0 && pFrameSubmitter->isRunning){
+			pthread_cond_wait(&pFrameSubmitter->frameCondition, &pFrameSubmitter->mutex);
+		}
+		// Les frames déjà poussées partent même après la demande d'arrêt
+		if(pFrameSubmitter->frameNumber == 0){
+			pthread_mutex_unlock(&pFrameSubmitter->mutex);
+			break;
+		}
+		SubmitFrame frame = pFrameSubmitter->frames[pFrameSubmitter->frameFirst];
+		pFrameSubmitter->frameFirst = (pFrameSubmitter->frameFirst + 1) % SUBMIT_QUEUE_CAPACITY;
+		pFrameSubmitter->frameNumber--;
+		pthread_cond_broadcast(&pFrameSubmitter->frameCondition);
+		pthread_mutex_unlock(&pFrameSubmitter->mutex);
+
+		submitSubmitterFrame(pFrameSubmitter, &frame);
+
+		// Une fois l'arrêt demandé plus aucune image n'est acquise d'avance, aucune frame ne viendrait attendre son sémaphore
+		pthread_mutex_lock(&pFrameSubmitter->mutex);
+		int isRunning = pFrameSubmitter->isRunning;
+		pthread_mutex_unlock(&pFrameSubmitter->mutex);
+		if(isRunning){
+			acquireSubmitterImage(pFrameSubmitter);
+		}
+		// La frame ne compte comme partie qu'une fois l'acquisition suivante faite, plus rien ne touche alors au GPU
+		pthread_mutex_lock(&pFrameSubmitter->mutex);
+		pFrameSubmitter->presentedNumber++;
+		pthread_cond_broadcast(&pFrameSubmitter->frameCondition);
+		pthread_mutex_unlock(&pFrameSubmitter->mutex);
+	}
+	releaseSubmitterImages(pFrameSubmitter);
+	return NULL;
+}
+
+FrameSubmitter *createFrameSubmitter(VkDevice *pDevice, VkSwapchainKHR *pSwapchain, VkQueue *pDrawingQueue, VkQueue *pPresentingQueue, VkCommandBuffer *pCommandBuffers, VkFence *pFrontFences, VkFence *pBackFences, VkSemaphore *pWaitSemaphores, VkSemaphore *pSignalSemaphores, uint32_t maxFrames){
+	FrameSubmitter *pFrameSubmitter = (FrameSubmitter *)calloc(1, sizeof(FrameSubmitter));
+	if(pFrameSubmitter == VK_NULL_HANDLE){
+		return VK_NULL_HANDLE;
+	}
+	pFrameSubmitter->device = *pDevice;
+	pFrameSubmitter->swapchain = *pSwapchain;
+	pFrameSubmitter->drawingQueue = *pDrawingQueue;
+	pFrameSubmitter->presentingQueue = *pPresentingQueue;
+	pFrameSubmitter->pCommandBuffers = pCommandBuffers;
+	pFrameSubmitter->pFrontFences = pFrontFences;
+	pFrameSubmitter->pBackFences = pBackFences;
+	pFrameSubmitter->pWaitSemaphores = pWaitSemaphores;
+	pFrameSubmitter->pSignalSemaphores = pSignalSemaphores;
+	pFrameSubmitter->maxFrames = maxFrames;
+	pFrameSubmitter->isRunning = 1;
+	pthread_mutex_init(&pFrameSubmitter->mutex, NULL);
+	pthread_cond_init(&pFrameSubmitter->imageCondition, NULL);
+	pthread_cond_init(&pFrameSubmitter->frameCondition, NULL);
+	pthread_mutex_init(&pFrameSubmitter->drawingQueueMutex, NULL);
+	pthread_mutex_init(&pFrameSubmitter->presentingQueueMutex, NULL);
+
+	if(pthread_create(&pFrameSubmitter->thread, NULL, runFrameSubmitter, pFrameSubmitter) != 0){
+		printf("VkSubmitException : unable to start the submit thread, frames are submitted by the render thread\n");
+		pthread_mutex_destroy(&pFrameSubmitter->presentingQueueMutex);
+		pthread_mutex_destroy(&pFrameSubmitter->drawingQueueMutex);
+		pthread_cond_destroy(&pFrameSubmitter->frameCondition);
+		pthread_cond_destroy(&pFrameSubmitter->imageCondition);
+		pthread_mutex_destroy(&pFrameSubmitter->mutex);
+		free(pFrameSubmitter);
+		return VK_NULL_HANDLE;
+	}
+	return pFrameSubmitter;
+}
+
+void deleteFrameSubmitter(FrameSubmitter **ppFrameSubmitter){
+	FrameSubmitter *pFrameSubmitter = *ppFrameSubmitter;
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	pFrameSubmitter->isRunning = 0;
+	pthread_cond_broadcast(&pFrameSubmitter->frameCondition);
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+	pthread_join(pFrameSubmitter->thread, NULL);
+	// Sans waitFrameSubmitter avant, les soumissions vides des images d'avance peuvent encore être en cours
+	vkWaitForFences(pFrameSubmitter->device, pFrameSubmitter->maxFrames, pFrameSubmitter->pFrontFences, VK_TRUE, UINT64_MAX);
+
+	if(pFrameSubmitter->presentedNumber != 0){
+		double frameNumber = (double)pFrameSubmitter->presentedNumber;
+		printf("frame submitter : %llu frames, render thread waited %.3f ms average, %.3f ms max for an image and %.3f ms average for room in the queue\n",
+			(unsigned long long)pFrameSubmitter->presentedNumber, pFrameSubmitter->imageWaitSum * 1e3 / frameNumber, pFrameSubmitter->maxImageWait * 1e3,
+			pFrameSubmitter->pushWaitSum * 1e3 / frameNumber);
+		printf("  submit thread spent %.3f ms average, %.3f ms max in acquire and %.3f ms average, %.3f ms max in present\n",
+			pFrameSubmitter->acquireTimeSum * 1e3 / frameNumber, pFrameSubmitter->maxAcquireTime * 1e3,
+			pFrameSubmitter->presentTimeSum * 1e3 / frameNumber, pFrameSubmitter->maxPresentTime * 1e3);
+	}
+	pthread_mutex_destroy(&pFrameSubmitter->presentingQueueMutex);
+	pthread_mutex_destroy(&pFrameSubmitter->drawingQueueMutex);
+	pthread_cond_destroy(&pFrameSubmitter->frameCondition);
+	pthread_cond_destroy(&pFrameSubmitter->imageCondition);
+	pthread_mutex_destroy(&pFrameSubmitter->mutex);
+	free(pFrameSubmitter);
+	*ppFrameSubmitter = VK_NULL_HANDLE;
+}
+
+uint32_t takeSubmitterImage(FrameSubmitter *pFrameSubmitter, uint32_t *pFrame){
+	double startTime = glfwGetTime();
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	while(pFrameSubmitter->imageNumber == 0){
+		pthread_cond_wait(&pFrameSubmitter->imageCondition, &pFrameSubmitter->mutex);
+	}
+	// Le slot vient avec l'image : c'est son sémaphore d'acquisition qui attend cette image
+	*pFrame = pFrameSubmitter->images[pFrameSubmitter->imageFirst].frame;
+	uint32_t imageIndex = pFrameSubmitter->images[pFrameSubmitter->imageFirst].imageIndex;
+	pFrameSubmitter->imageFirst = (pFrameSubmitter->imageFirst + 1) % SUBMIT_QUEUE_CAPACITY;
+	pFrameSubmitter->imageNumber--;
+	double imageWait = glfwGetTime() - startTime;
+	pFrameSubmitter->imageWaitSum += imageWait;
+	pFrameSubmitter->maxImageWait = imageWait > pFrameSubmitter->maxImageWait ? imageWait : pFrameSubmitter->maxImageWait;
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+	return imageIndex;
+}
+
+void pushSubmitterFrame(FrameSubmitter *pFrameSubmitter, uint32_t frame, uint32_t imageIndex){
+	double startTime = glfwGetTime();
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	while(pFrameSubmitter->frameNumber == SUBMIT_QUEUE_CAPACITY){
+		pthread_cond_wait(&pFrameSubmitter->frameCondition, &pFrameSubmitter->mutex);
+	}
+	SubmitFrame *pFrame = &pFrameSubmitter->frames[(pFrameSubmitter->frameFirst + pFrameSubmitter->frameNumber) % SUBMIT_QUEUE_CAPACITY];
+	pFrame->frame = frame;
+	pFrame->imageIndex = imageIndex;
+	pFrameSubmitter->frameNumber++;
+	pFrameSubmitter->pushedNumber++;
+	pFrameSubmitter->pushWaitSum += glfwGetTime() - startTime;
+	pthread_cond_broadcast(&pFrameSubmitter->frameCondition);
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+}
+
+void waitFrameSubmitter(FrameSubmitter *pFrameSubmitter){
+	pthread_mutex_lock(&pFrameSubmitter->mutex);
+	// Le thread vide sa file, rend ses images d'avance puis s'arrête : tout est soumis avant l'attente de fin du device
+	pFrameSubmitter->isRunning = 0;
+	pthread_cond_broadcast(&pFrameSubmitter->frameCondition);
+	while( ! pFrameSubmitter->isStopped){
+		pthread_cond_wait(&pFrameSubmitter->frameCondition, &pFrameSubmitter->mutex);
+	}
+	pthread_mutex_unlock(&pFrameSubmitter->mutex);
+}
+
+void lockSubmitQueue(FrameSubmitter *pFrameSubmitter, VkQueue queue){
+	pthread_mutex_t *pQueueMutex = pFrameSubmitter != VK_NULL_HANDLE ? getSubmitQueueMutex(pFrameSubmitter, queue) : NULL;
+	if(pQueueMutex != NULL){
+		pthread_mutex_lock(pQueueMutex);
+	}
+}
+
+void unlockSubmitQueue(FrameSubmitter *pFrameSubmitter, VkQueue queue){
+	pthread_mutex_t *pQueueMutex = pFrameSubmitter != VK_NULL_HANDLE ? getSubmitQueueMutex(pFrameSubmitter, queue) : NULL;
+	if(pQueueMutex != NULL){
+		pthread_mutex_unlock(pQueueMutex);
+	}
+}
@@ -18,12 +18,12 @@ void deleteWindow(GLFWwindow *pWindow){
 
 VkSurfaceKHR createSurface(GLFWwindow *pWindow, VkInstance *pInstance){
 	VkSurfaceKHR surface;
-	glfwCreateWindowSurface(*pInstance, pWindow, VK_NULL_HANDLE, &surface);
+	glfwCreateWindowSurface(*pInstance, pWindow, getHostAllocator(VK_OBJECT_TYPE_SURFACE_KHR), &surface);
 	return surface;
 }
 
 void deleteSurface(VkSurfaceKHR *pSurface, VkInstance *pInstance){
-	vkDestroySurfaceKHR(*pInstance, *pSurface, VK_NULL_HANDLE);
+	vkDestroySurfaceKHR(*pInstance, *pSurface, getHostAllocator(VK_OBJECT_TYPE_SURFACE_KHR));
 }
 
 VkBool32 getSurfaceSupport(VkSurfaceKHR *pSurface, VkPhysicalDevice *pPhysicalDevice, uint32_t graphicsQueueFamilyindex){
@@ -41,18 +41,20 @@ VkSurfaceCapabilitiesKHR getSurfaceCapabilities(VkSurfaceKHR *pSurface, VkPhysic
 VkSurfaceFormatKHR getBestSurfaceFormat(VkSurfaceKHR *pSurface, VkPhysicalDevice *pPhysicalDevice){
 	uint32_t surfaceFormatNumber = 0;
 	vkGetPhysicalDeviceSurfaceFormatsKHR(*pPhysicalDevice, *pSurface, &surfaceFormatNumber, VK_NULL_HANDLE);
-	VkSurfaceFormatKHR *surfaceFormats = (VkSurfaceFormatKHR *)malloc(surfaceFormatNumber * sizeof(VkSurfaceFormatKHR));
+	size_t scratchMark = getScratchMark();
+	VkSurfaceFormatKHR *surfaceFormats = (VkSurfaceFormatKHR *)allocateScratch(surfaceFormatNumber * sizeof(VkSurfaceFormatKHR));
 	vkGetPhysicalDeviceSurfaceFormatsKHR(*pPhysicalDevice, *pSurface, &surfaceFormatNumber, surfaceFormats);
 	VkSurfaceFormatKHR bestSurfaceFormat = surfaceFormats[0];
 
-	free(surfaceFormats);
+	resetScratch(scratchMark);
 	return bestSurfaceFormat;
 }
 
 VkPresentModeKHR getBestPresentMode(VkSurfaceKHR *pSurface, VkPhysicalDevice *pPhysicalDevice){
 	uint32_t presentModeNumber = 0;
 	vkGetPhysicalDeviceSurfacePresentModesKHR(*pPhysicalDevice, *pSurface, &presentModeNumber, VK_NULL_HANDLE);
-	VkPresentModeKHR *presentModes = (VkPresentModeKHR *)malloc(presentModeNumber * sizeof(VkPresentModeKHR));
+	size_t scratchMark = getScratchMark();
+	VkPresentModeKHR *presentModes = (VkPresentModeKHR *)allocateScratch(presentModeNumber * sizeof(VkPresentModeKHR));
 	vkGetPhysicalDeviceSurfacePresentModesKHR(*pPhysicalDevice, *pSurface, &presentModeNumber, presentModes);
 
 	VkPresentModeKHR bestPresentMode = VK_PRESENT_MODE_FIFO_KHR;
@@ -63,7 +65,7 @@ VkPresentModeKHR getBestPresentMode(VkSurfaceKHR *pSurface, VkPhysicalDevice *pP
 		}
 	}
 
-	free(presentModes);
+	resetScratch(scratchMark);
 	return bestPresentMode;
 }
 
@@ -98,6 +100,12 @@ VkSwapchainKHR createSwapChain(VkDevice *pDevice, VkSurfaceKHR *pSurface, VkSurf
 		pQueueFamilyIndices = queueFamilyIndices;
 	}
 
+	// Les images peuvent aussi être copiées, pour la capture vidéo, quand la surface le permet
+	VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	if(pSurfaceCapabilities->supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT){
+		imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+
 	VkSwapchainCreateInfoKHR swapchainCreateInfo = {
 		VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
 		VK_NULL_HANDLE,
@@ -108,7 +116,7 @@ VkSwapchainKHR createSwapChain(VkDevice *pDevice, VkSurfaceKHR *pSurface, VkSurf
 		pSurfaceFormat->colorSpace,
 		*pSwapchainExtent,
 		imageArrayLayers,
-		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+		imageUsage,
 		imageSharingMode,
 		queueFamilyIndexCount,
 		pQueueFamilyIndices,
@@ -120,10 +128,10 @@ VkSwapchainKHR createSwapChain(VkDevice *pDevice, VkSurfaceKHR *pSurface, VkSurf
 	};
 
 	VkSwapchainKHR swapchain;
-	vkCreateSwapchainKHR(*pDevice, &swapchainCreateInfo, VK_NULL_HANDLE, &swapchain);
+	vkCreateSwapchainKHR(*pDevice, &swapchainCreateInfo, getHostAllocator(VK_OBJECT_TYPE_SWAPCHAIN_KHR), &swapchain);
 	return swapchain;
 }
 
 void deleteSwapchain(VkDevice *pDevice, VkSwapchainKHR *pSwapchain){
-	vkDestroySwapchainKHR(*pDevice, *pSwapchain, VK_NULL_HANDLE);
+	vkDestroySwapchainKHR(*pDevice, *pSwapchain, getHostAllocator(VK_OBJECT_TYPE_SWAPCHAIN_KHR));
 }
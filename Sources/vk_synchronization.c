@@ -9,14 +9,14 @@ VkSemaphore *createSemaphores(VkDevice *pDevice, uint32_t maxFrames){
 
 	VkSemaphore *semaphore = (VkSemaphore *)malloc(maxFrames * sizeof(VkSemaphore));
 	for(uint32_t i = 0; i < maxFrames; i++){
-		vkCreateSemaphore(*pDevice, &semaphoreCreateInfo, VK_NULL_HANDLE, &semaphore[i]);
+		vkCreateSemaphore(*pDevice, &semaphoreCreateInfo, getHostAllocator(VK_OBJECT_TYPE_SEMAPHORE), &semaphore[i]);
 	}
 	return semaphore;
 }
 
 void deleteSemaphores(VkDevice *pDevice, VkSemaphore **ppSemaphores, uint32_t maxFrames){
 	for(uint32_t i = 0; i < maxFrames; i++){
-		vkDestroySemaphore(*pDevice, (*ppSemaphores)[i], VK_NULL_HANDLE);
+		vkDestroySemaphore(*pDevice, (*ppSemaphores)[i], getHostAllocator(VK_OBJECT_TYPE_SEMAPHORE));
 	}
 	free(*ppSemaphores);
 }
@@ -30,14 +30,14 @@ VkFence *createFences(VkDevice *pDevice, uint32_t maxFrames){
 
 	VkFence *fence = (VkFence *)malloc(maxFrames * sizeof(VkFence));
 	for(uint32_t i = 0; i < maxFrames; i++){
-		vkCreateFence(*pDevice, &fenceCreateInfo, VK_NULL_HANDLE, &fence[i]);
+		vkCreateFence(*pDevice, &fenceCreateInfo, getHostAllocator(VK_OBJECT_TYPE_FENCE), &fence[i]);
 	}
 	return fence;
 }
 
 void deleteFences(VkDevice *pDevice, VkFence **ppFences, uint32_t maxFrames){
 	for(uint32_t i = 0; i < maxFrames; i++){
-		vkDestroyFence(*pDevice, (*ppFences)[i], VK_NULL_HANDLE);
+		vkDestroyFence(*pDevice, (*ppFences)[i], getHostAllocator(VK_OBJECT_TYPE_FENCE));
 	}
 	free(*ppFences);
 }
@@ -0,0 +1,488 @@
+#include "../Headers/text_fun.h"
+
+// Les glyphes commencent après la commande indirecte de chaque image
+#define TEXT_GLYPH_OFFSET 64
+#define TEXT_GLYPH_WIDTH 5
+#define TEXT_GLYPH_HEIGHT 7
+#define TEXT_ADVANCE 6
+
+/*
+ * 5x7 font from ASCII 0x20 to 0x5F, one byte per row from top to bottom,
+ * bit 4 is the leftmost pixel
+ */
+static const uint8_t fontGlyphs[TEXT_GLYPH_NUMBER][TEXT_GLYPH_HEIGHT] = {
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+	{0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}, // '!'
+	{0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00}, // '"'
+	{0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}, // '#'
+	{0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04}, // '$'
+	{0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, // '%'
+	{0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D}, // '&'
+	{0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00}, // '''
+	{0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, // '('
+	{0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, // ')'
+	{0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}, // '*'
+	{0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}, // '+'
+	{0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}, // ','
+	{0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, // '-'
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, // '.'
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, // '/'
+	{0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, // '0'
+	{0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, // '1'
+	{0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, // '2'
+	{0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, // '3'
+	{0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, // '4'
+	{0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, // '5'
+	{0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, // '6'
+	{0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, // '7'
+	{0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, // '8'
+	{0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, // '9'
+	{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, // ':'
+	{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}, // ';'
+	{0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}, // '<'
+	{0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}, // '='
+	{0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}, // '>'
+	{0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}, // '?'
+	{0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E}, // '@'
+	{0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}, // 'A'
+	{0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // 'B'
+	{0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // 'C'
+	{0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // 'D'
+	{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // 'E'
+	{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // 'F'
+	{0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // 'G'
+	{0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 'H'
+	{0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 'I'
+	{0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // 'J'
+	{0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // 'K'
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // 'L'
+	{0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // 'M'
+	{0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // 'N'
+	{0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'O'
+	{0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // 'P'
+	{0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // 'Q'
+	{0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // 'R'
+	{0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // 'S'
+	{0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // 'T'
+	{0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // 'U'
+	{0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // 'V'
+	{0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // 'W'
+	{0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // 'X'
+	{0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, // 'Y'
+	{0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // 'Z'
+	{0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}, // '['
+	{0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}, // '\'
+	{0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}, // ']'
+	{0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00}, // '^'
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}  // '_'
+};
+
+static void buildAtlas(uint8_t *pPixels, uint32_t atlasWidth){
+	for(uint32_t glyph = 0; glyph <= TEXT_SOLID_GLYPH; glyph++){
+		uint32_t cellX = (glyph % TEXT_ATLAS_COLUMNS) * TEXT_CELL_SIZE;
+		uint32_t cellY = (glyph / TEXT_ATLAS_COLUMNS) * TEXT_CELL_SIZE;
+		for(uint32_t y = 0; y < TEXT_CELL_SIZE; y++){
+			for(uint32_t x = 0; x < TEXT_CELL_SIZE; x++){
+				uint8_t value = 0;
+				if(glyph == TEXT_SOLID_GLYPH){
+					value = 255;
+				}else if(x < TEXT_GLYPH_WIDTH && y < TEXT_GLYPH_HEIGHT && (fontGlyphs[glyph][y] & (0x10 >> x)) != 0){
+					value = 255;
+				}
+				pPixels[(cellY + y) * atlasWidth + cellX + x] = value;
+			}
+		}
+	}
+}
+
+static int uploadAtlas(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, TextRenderer *pTextRenderer){
+	VkExtent2D atlasExtent = {
+		TEXT_ATLAS_COLUMNS * TEXT_CELL_SIZE,
+		TEXT_ATLAS_ROWS * TEXT_CELL_SIZE
+	};
+	VkDeviceSize atlasSize = atlasExtent.width * atlasExtent.height;
+
+	pTextRenderer->atlasImage = createImage(pDevice, VK_FORMAT_R8_UNORM, &atlasExtent, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
+	pTextRenderer->atlasMemory = allocateImageMemory(pPhysicalDevice, pDevice, &pTextRenderer->atlasImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if(pTextRenderer->atlasMemory == VK_NULL_HANDLE){
+		return -1;
+	}
+
+	VkBuffer stagingBuffer = createBuffer(pDevice, atlasSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	VkDeviceMemory stagingMemory = allocateBufferMemory(pPhysicalDevice, pDevice, &stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if(stagingMemory == VK_NULL_HANDLE){
+		deleteBuffer(pDevice, &stagingBuffer);
+		return -1;
+	}
+
+	void *pStagingData = VK_NULL_HANDLE;
+	vkMapMemory(*pDevice, stagingMemory, 0, atlasSize, 0, &pStagingData);
+	buildAtlas((uint8_t *)pStagingData, atlasExtent.width);
+	vkUnmapMemory(*pDevice, stagingMemory);
+
+	VkBufferImageCopy bufferImageCopy = {
+		0,
+		0,
+		0,
+		{
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			0,
+			0,
+			1
+		},
+		{0, 0, 0},
+		{atlasExtent.width, atlasExtent.height, 1}
+	};
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(pDevice, pCommandPool);
+	recordImageLayoutTransition(&commandBuffer, &pTextRenderer->atlasImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, pTextRenderer->atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+	recordImageLayoutTransition(&commandBuffer, &pTextRenderer->atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	endSingleTimeCommands(pDevice, pCommandPool, pQueue, &commandBuffer);
+
+	freeMemory(pDevice, &stagingMemory);
+	deleteBuffer(pDevice, &stagingBuffer);
+
+	pTextRenderer->atlasImageView = createImageView(pDevice, &pTextRenderer->atlasImage, VK_FORMAT_R8_UNORM, 1);
+	pTextRenderer->sampler = createSampler(pDevice, VK_FILTER_NEAREST);
+	return 0;
+}
+
+static void createTextDescriptorSet(VkDevice *pDevice, TextRenderer *pTextRenderer){
+	VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {
+		0,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		1,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+		VK_NULL_HANDLE
+	};
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&descriptorSetLayoutBinding
+	};
+	vkCreateDescriptorSetLayout(*pDevice, &descriptorSetLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &pTextRenderer->descriptorSetLayout);
+
+	VkDescriptorPoolSize descriptorPoolSize = {
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		1
+	};
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		1,
+		&descriptorPoolSize
+	};
+	vkCreateDescriptorPool(*pDevice, &descriptorPoolCreateInfo, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pTextRenderer->descriptorPool);
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		VK_NULL_HANDLE,
+		pTextRenderer->descriptorPool,
+		1,
+		&pTextRenderer->descriptorSetLayout
+	};
+	vkAllocateDescriptorSets(*pDevice, &descriptorSetAllocateInfo, &pTextRenderer->descriptorSet);
+
+	VkDescriptorImageInfo descriptorImageInfo = {
+		pTextRenderer->sampler,
+		pTextRenderer->atlasImageView,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	};
+	VkWriteDescriptorSet writeDescriptorSet = {
+		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		VK_NULL_HANDLE,
+		pTextRenderer->descriptorSet,
+		0,
+		0,
+		1,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		&descriptorImageInfo,
+		VK_NULL_HANDLE,
+		VK_NULL_HANDLE
+	};
+	vkUpdateDescriptorSets(*pDevice, 1, &writeDescriptorSet, 0, VK_NULL_HANDLE);
+}
+
+static void createTextPipeline(VkDevice *pDevice, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkDescriptorSetLayout *pDescriptorSetLayout, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, TextRenderer *pTextRenderer){
+	VkPushConstantRange pushConstantRange = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		0,
+		sizeof(ViewConstants)
+	};
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		pDescriptorSetLayout,
+		1,
+		&pushConstantRange
+	};
+	vkCreatePipelineLayout(*pDevice, &pipelineLayoutCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &pTextRenderer->pipelineLayout);
+
+	char entryName[] = "main";
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfo[] = {
+		configureVertexShaderStageCreateInfo(pVertexShaderModule, entryName),
+		configureFragmentShaderStageCreateInfo(pFragmentShaderModule, entryName)
+	};
+
+	// Un quad par instance : les attributs avancent une fois par glyphe
+	VkVertexInputBindingDescription vertexInputBindingDescription = {
+		0,
+		sizeof(TextGlyph),
+		VK_VERTEX_INPUT_RATE_INSTANCE
+	};
+	VkVertexInputAttributeDescription vertexInputAttributeDescriptions[] = {
+		{0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(TextGlyph, rect)},
+		{1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(TextGlyph, uv)},
+		{2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(TextGlyph, color)},
+		{3, 0, VK_FORMAT_R32_UINT, offsetof(TextGlyph, texture)}
+	};
+	VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {
+		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		1,
+		&vertexInputBindingDescription,
+		4,
+		vertexInputAttributeDescriptions
+	};
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = configureInputAssemblyStateCreateInfo();
+	inputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+	VkViewport viewport = configureViewport(pExtent);
+	VkRect2D scissor = configureScissor(pExtent, 0, 0, 0, 0);
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo = configureViewportStateCreateInfo(&viewport, &scissor);
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = configureRasterizationStateCreateInfo();
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = configureMultisampleStateCreateInfo();
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachmentState = configureColorBlendAttachmentState();
+	colorBlendAttachmentState.blendEnable = VK_TRUE;
+	colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	colorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = configureColorBlendStateCreateInfo(&colorBlendAttachmentState);
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = configureDynamicStateCreateInfo();
+	VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+
+	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		chainRenderingCreateInfo(pRenderTarget, &renderingCreateInfo, VK_NULL_HANDLE),
+		0,
+		2,
+		shaderStageCreateInfo,
+		&vertexInputStateCreateInfo,
+		&inputAssemblyStateCreateInfo,
+		VK_NULL_HANDLE,
+		&viewportStateCreateInfo,
+		&rasterizationStateCreateInfo,
+		&multisampleStateCreateInfo,
+		VK_NULL_HANDLE,
+		&colorBlendStateCreateInfo,
+		&dynamicStateCreateInfo,
+		pTextRenderer->pipelineLayout,
+		pRenderTarget->renderPass,
+		0,
+		VK_NULL_HANDLE,
+		-1
+	};
+	vkCreateGraphicsPipelines(*pDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, getHostAllocator(VK_OBJECT_TYPE_PIPELINE), &pTextRenderer->pipeline);
+}
+
+TextRenderer createTextRenderer(VkPhysicalDevice *pPhysicalDevice, VkDevice *pDevice, VkQueue *pQueue, VkCommandPool *pCommandPool, RenderTarget *pRenderTarget, VkExtent2D *pExtent, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule, uint32_t frameNumber, uint32_t glyphCapacity){
+	TextRenderer textRenderer;
+	memset(&textRenderer, 0, sizeof(TextRenderer));
+	textRenderer.frameNumber = frameNumber;
+	textRenderer.glyphCapacity = glyphCapacity;
+	textRenderer.extent = *pExtent;
+	textRenderer.viewConstants = createViewConstants();
+
+	if(uploadAtlas(pPhysicalDevice, pDevice, pQueue, pCommandPool, &textRenderer) != 0){
+		printf("VkTextException : unable to upload the glyph atlas\n");
+		deleteTextRenderer(pDevice, &textRenderer);
+		return textRenderer;
+	}
+
+	// Une tranche par image de la swapchain : commande indirecte puis glyphes, mappée en permanence
+	textRenderer.frameStride = (TEXT_GLYPH_OFFSET + glyphCapacity * sizeof(TextGlyph) + 255) & ~(VkDeviceSize)255;
+	textRenderer.frameBuffer = createBuffer(pDevice, textRenderer.frameStride * frameNumber, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+	textRenderer.frameMemory = allocateBufferMemory(pPhysicalDevice, pDevice, &textRenderer.frameBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if(textRenderer.frameMemory == VK_NULL_HANDLE){
+		printf("VkTextException : unable to allocate the glyph buffers\n");
+		deleteTextRenderer(pDevice, &textRenderer);
+		return textRenderer;
+	}
+	vkMapMemory(*pDevice, textRenderer.frameMemory, 0, VK_WHOLE_SIZE, 0, (void **)&textRenderer.pFrameData);
+	for(uint32_t i = 0; i < frameNumber; i++){
+		textRenderer.currentFrame = i;
+		textRenderer.glyphNumber = 0;
+		endText(&textRenderer);
+	}
+
+	createTextDescriptorSet(pDevice, &textRenderer);
+	createTextPipeline(pDevice, pRenderTarget, pExtent, &textRenderer.descriptorSetLayout, pVertexShaderModule, pFragmentShaderModule, &textRenderer);
+	return textRenderer;
+}
+
+void deleteTextRenderer(VkDevice *pDevice, TextRenderer *pTextRenderer){
+	vkDestroyPipeline(*pDevice, pTextRenderer->pipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipelineLayout(*pDevice, pTextRenderer->pipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+	vkDestroyDescriptorPool(*pDevice, pTextRenderer->descriptorPool, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+	vkDestroyDescriptorSetLayout(*pDevice, pTextRenderer->descriptorSetLayout, getHostAllocator(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+	if(pTextRenderer->pFrameData != VK_NULL_HANDLE){
+		vkUnmapMemory(*pDevice, pTextRenderer->frameMemory);
+	}
+	vkFreeMemory(*pDevice, pTextRenderer->frameMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyBuffer(*pDevice, pTextRenderer->frameBuffer, getHostAllocator(VK_OBJECT_TYPE_BUFFER));
+	vkDestroySampler(*pDevice, pTextRenderer->sampler, getHostAllocator(VK_OBJECT_TYPE_SAMPLER));
+	vkDestroyImageView(*pDevice, pTextRenderer->bindlessAtlasView, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+	vkDestroyImageView(*pDevice, pTextRenderer->atlasImageView, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+	vkFreeMemory(*pDevice, pTextRenderer->atlasMemory, getHostAllocator(VK_OBJECT_TYPE_DEVICE_MEMORY));
+	vkDestroyImage(*pDevice, pTextRenderer->atlasImage, getHostAllocator(VK_OBJECT_TYPE_IMAGE));
+	pTextRenderer->pipeline = VK_NULL_HANDLE;
+}
+
+int useTextBindlessTable(VkDevice *pDevice, TextRenderer *pTextRenderer, BindlessTable *pBindlessTable, RenderTarget *pRenderTarget, VkShaderModule *pVertexShaderModule, VkShaderModule *pFragmentShaderModule){
+	VkPipelineLayout pipelineLayout = pTextRenderer->pipelineLayout;
+	VkPipeline pipeline = pTextRenderer->pipeline;
+	pTextRenderer->pipelineLayout = VK_NULL_HANDLE;
+	pTextRenderer->pipeline = VK_NULL_HANDLE;
+	createTextPipeline(pDevice, pRenderTarget, &pTextRenderer->extent, getBindlessSetLayout(pBindlessTable), pVertexShaderModule, pFragmentShaderModule, pTextRenderer);
+
+	// L'atlas n'a qu'un canal : la vue le lit en blanc avec sa couverture en alpha, comme une texture RGBA ordinaire
+	VkImageViewCreateInfo imageViewCreateInfo = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		VK_NULL_HANDLE,
+		0,
+		pTextRenderer->atlasImage,
+		VK_IMAGE_VIEW_TYPE_2D,
+		VK_FORMAT_R8_UNORM,
+		{VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_ONE, VK_COMPONENT_SWIZZLE_R},
+		{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+	};
+	if(pTextRenderer->pipeline != VK_NULL_HANDLE){
+		vkCreateImageView(*pDevice, &imageViewCreateInfo, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW), &pTextRenderer->bindlessAtlasView);
+	}
+	VkDescriptorImageInfo descriptorImageInfo = {
+		pTextRenderer->sampler,
+		pTextRenderer->bindlessAtlasView,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	};
+	uint32_t atlasTexture = pTextRenderer->bindlessAtlasView != VK_NULL_HANDLE ? addBindlessTexture(pBindlessTable, &descriptorImageInfo) : BINDLESS_INVALID_INDEX;
+	if(atlasTexture == BINDLESS_INVALID_INDEX){
+		printf("VkTextException : unable to draw the text from the bindless table\n");
+		vkDestroyPipeline(*pDevice, pTextRenderer->pipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+		vkDestroyPipelineLayout(*pDevice, pTextRenderer->pipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+		vkDestroyImageView(*pDevice, pTextRenderer->bindlessAtlasView, getHostAllocator(VK_OBJECT_TYPE_IMAGE_VIEW));
+		pTextRenderer->bindlessAtlasView = VK_NULL_HANDLE;
+		pTextRenderer->pipelineLayout = pipelineLayout;
+		pTextRenderer->pipeline = pipeline;
+		return -1;
+	}
+
+	vkDestroyPipeline(*pDevice, pipeline, getHostAllocator(VK_OBJECT_TYPE_PIPELINE));
+	vkDestroyPipelineLayout(*pDevice, pipelineLayout, getHostAllocator(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+	pTextRenderer->pBindlessTable = pBindlessTable;
+	pTextRenderer->atlasTexture = atlasTexture;
+	return 0;
+}
+
+void beginText(TextRenderer *pTextRenderer, uint32_t frameIndex){
+	pTextRenderer->currentFrame = frameIndex;
+	pTextRenderer->glyphNumber = 0;
+	pTextRenderer->pGlyphs = (TextGlyph *)(pTextRenderer->pFrameData + frameIndex * pTextRenderer->frameStride + TEXT_GLYPH_OFFSET);
+}
+
+static void appendQuad(TextRenderer *pTextRenderer, float x, float y, float width, float height, float u0, float v0, float u1, float v1, uint32_t texture, uint32_t color){
+	if(pTextRenderer->glyphNumber >= pTextRenderer->glyphCapacity){
+		return;
+	}
+
+	// On écrit directement dans la mémoire mappée, sans tampon intermédiaire
+	TextGlyph *pGlyph = &pTextRenderer->pGlyphs[pTextRenderer->glyphNumber++];
+	pGlyph->rect[0] = x * 2.0f / pTextRenderer->extent.width - 1.0f;
+	pGlyph->rect[1] = y * 2.0f / pTextRenderer->extent.height - 1.0f;
+	pGlyph->rect[2] = width * 2.0f / pTextRenderer->extent.width;
+	pGlyph->rect[3] = height * 2.0f / pTextRenderer->extent.height;
+	pGlyph->uv[0] = u0;
+	pGlyph->uv[1] = v0;
+	pGlyph->uv[2] = u1;
+	pGlyph->uv[3] = v1;
+	pGlyph->color = color;
+	pGlyph->texture = texture;
+}
+
+static void appendGlyph(TextRenderer *pTextRenderer, float x, float y, float width, float height, uint32_t glyph, float glyphWidth, float glyphHeight, uint32_t color){
+	float atlasWidth = TEXT_ATLAS_COLUMNS * TEXT_CELL_SIZE, atlasHeight = TEXT_ATLAS_ROWS * TEXT_CELL_SIZE;
+	float u = (float)((glyph % TEXT_ATLAS_COLUMNS) * TEXT_CELL_SIZE), v = (float)((glyph / TEXT_ATLAS_COLUMNS) * TEXT_CELL_SIZE);
+	appendQuad(pTextRenderer, x, y, width, height, u / atlasWidth, v / atlasHeight, (u + glyphWidth) / atlasWidth, (v + glyphHeight) / atlasHeight,
+		pTextRenderer->atlasTexture, color);
+}
+
+void drawText(TextRenderer *pTextRenderer, float x, float y, float scale, uint32_t color, const char *text){
+	float cursorX = x;
+	for(const char *pCharacter = text; *pCharacter != '\0'; pCharacter++){
+		char character = *pCharacter;
+		if(character == '\n'){
+			cursorX = x;
+			y += TEXT_CELL_SIZE * scale;
+			continue;
+		}
+		if(character >= 'a' && character <= 'z'){
+			character = (char)(character - 'a' + 'A');
+		}
+		if(character < TEXT_FIRST_CHARACTER || character >= TEXT_FIRST_CHARACTER + TEXT_GLYPH_NUMBER){
+			character = '?';
+		}
+		if(character != ' '){
+			appendGlyph(pTextRenderer, cursorX, y, TEXT_ADVANCE * scale, TEXT_CELL_SIZE * scale, (uint32_t)(character - TEXT_FIRST_CHARACTER), TEXT_ADVANCE, TEXT_CELL_SIZE, color);
+		}
+		cursorX += TEXT_ADVANCE * scale;
+	}
+}
+
+void drawTextRect(TextRenderer *pTextRenderer, float x, float y, float width, float height, uint32_t color){
+	appendGlyph(pTextRenderer, x, y, width, height, TEXT_SOLID_GLYPH, TEXT_CELL_SIZE, TEXT_CELL_SIZE, color);
+}
+
+void drawTextSprite(TextRenderer *pTextRenderer, float x, float y, float width, float height, uint32_t texture, uint32_t color){
+	// Sans table le pipeline ne lit que l'atlas, le sprite reste un rectangle de sa couleur
+	if(pTextRenderer->pBindlessTable == VK_NULL_HANDLE || texture == BINDLESS_INVALID_INDEX){
+		drawTextRect(pTextRenderer, x, y, width, height, color);
+		return;
+	}
+	appendQuad(pTextRenderer, x, y, width, height, 0.0f, 0.0f, 1.0f, 1.0f, texture, color);
+}
+
+void endText(TextRenderer *pTextRenderer){
+	VkDrawIndirectCommand *pDrawIndirectCommand = (VkDrawIndirectCommand *)(pTextRenderer->pFrameData + pTextRenderer->currentFrame * pTextRenderer->frameStride);
+	pDrawIndirectCommand->vertexCount = 4;
+	pDrawIndirectCommand->instanceCount = pTextRenderer->glyphNumber;
+	pDrawIndirectCommand->firstVertex = 0;
+	pDrawIndirectCommand->firstInstance = 0;
+}
+
+void recordTextDraw(TextRenderer *pTextRenderer, VkCommandBuffer *pCommandBuffer, uint32_t frameIndex){
+	VkDeviceSize frameOffset = frameIndex * pTextRenderer->frameStride;
+	VkDeviceSize glyphOffset = frameOffset + TEXT_GLYPH_OFFSET;
+
+	vkCmdBindPipeline(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTextRenderer->pipeline);
+	// Avec une table, un seul set pour l'atlas et toutes les textures des sprites
+	if(pTextRenderer->pBindlessTable != VK_NULL_HANDLE){
+		recordBindlessTable(pTextRenderer->pBindlessTable, pCommandBuffer, &pTextRenderer->pipelineLayout);
+	}else{
+		vkCmdBindDescriptorSets(*pCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pTextRenderer->pipelineLayout, 0, 1, &pTextRenderer->descriptorSet, 0, VK_NULL_HANDLE);
+	}
+	recordViewConstants(pCommandBuffer, &pTextRenderer->pipelineLayout, &pTextRenderer->viewConstants);
+	vkCmdBindVertexBuffers(*pCommandBuffer, 0, 1, &pTextRenderer->frameBuffer, &glyphOffset);
+	vkCmdDrawIndirect(*pCommandBuffer, pTextRenderer->frameBuffer, frameOffset, 1, sizeof(VkDrawIndirectCommand));
+}
@@ -0,0 +1,251 @@
+#ifdef VK_PONG_TRACE
+#include <pthread.h>
+#include <sched.h>
+
+#include "../Headers/trace_fun.h"
+
+/**
+ * Zone terminée, horodatée en nanosecondes depuis la création du traceur
+ */
+typedef struct TraceEvent {
+	const char *name;
+	uint64_t startTime;
+	uint64_t duration;
+} TraceEvent;
+
+/**
+ * Anneau d'un thread : seul ce thread avance head, seul le thread d'écriture avance tail
+ */
+typedef struct TraceBuffer {
+	TraceEvent events[TRACE_RING_SIZE];
+	uint64_t head;
+	uint64_t tail;
+	uint64_t droppedNumber;
+	uint64_t zoneStarts[TRACE_MAX_DEPTH];
+	const char *zoneNames[TRACE_MAX_DEPTH];
+	uint32_t depth;
+	uint32_t threadId;
+	char threadName[TRACE_MAX_THREAD_NAME];
+	struct TraceBuffer *pNext;
+} TraceBuffer;
+
+typedef struct Tracer {
+	FILE *pFile;
+	pthread_t thread;
+	TraceBuffer *pBuffers;
+	uint64_t startTime;
+	uint32_t threadNumber;
+	uint32_t writerNumber;
+	// Numéro du traceur courant, un anneau gardé par un thread ne sert que s'il a été pris sous ce même numéro
+	uint32_t generation;
+	int isFirstEvent;
+	int isRunning;
+	int isCreated;
+} Tracer;
+
+static Tracer tracer;
+static __thread TraceBuffer *pThreadBuffer;
+static __thread uint32_t threadGeneration;
+
+static uint64_t getTraceTime(){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Entrée d'un thread dans le traceur, le compteur vit hors des anneaux pour rester valide après deleteTracer
+ * Un thread qui incrémente après la fermeture voit isCreated à 0 et ressort sans toucher à son anneau
+ */
+static int enterTracer(){
+	if(!__atomic_load_n(&tracer.isCreated, __ATOMIC_ACQUIRE)){
+		return 0;
+	}
+	__atomic_add_fetch(&tracer.writerNumber, 1, __ATOMIC_SEQ_CST);
+	if(!__atomic_load_n(&tracer.isCreated, __ATOMIC_SEQ_CST)){
+		__atomic_sub_fetch(&tracer.writerNumber, 1, __ATOMIC_RELEASE);
+		return 0;
+	}
+	return 1;
+}
+
+static void leaveTracer(){
+	__atomic_sub_fetch(&tracer.writerNumber, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Anneau du thread pour le traceur courant, NULL s'il date d'un traceur déjà fermé et donc libéré
+ */
+static TraceBuffer *getCachedTraceBuffer(){
+	if(threadGeneration != __atomic_load_n(&tracer.generation, __ATOMIC_ACQUIRE)){
+		return NULL;
+	}
+	return pThreadBuffer;
+}
+
+static TraceBuffer *getTraceBuffer(){
+	TraceBuffer *pCachedBuffer = getCachedTraceBuffer();
+	if(pCachedBuffer != NULL){
+		return pCachedBuffer;
+	}
+	// Un anneau par thread, alloué à sa première zone et gardé jusqu'à la fermeture du fichier
+	TraceBuffer *pBuffer = (TraceBuffer *)calloc(1, sizeof(TraceBuffer));
+	if(pBuffer == NULL){
+		return NULL;
+	}
+	pBuffer->threadId = __atomic_add_fetch(&tracer.threadNumber, 1, __ATOMIC_RELAXED);
+	snprintf(pBuffer->threadName, TRACE_MAX_THREAD_NAME, "thread %u", pBuffer->threadId);
+	// Insertion sans verrou en tête de la liste que parcourt le thread d'écriture
+	pBuffer->pNext = __atomic_load_n(&tracer.pBuffers, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(&tracer.pBuffers, &pBuffer->pNext, pBuffer, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)){
+	}
+	pThreadBuffer = pBuffer;
+	threadGeneration = __atomic_load_n(&tracer.generation, __ATOMIC_ACQUIRE);
+	return pBuffer;
+}
+
+static void writeTraceEvents(TraceBuffer *pBuffer){
+	uint64_t head = __atomic_load_n(&pBuffer->head, __ATOMIC_ACQUIRE);
+	uint64_t tail = pBuffer->tail;
+	for(; tail < head; tail++){
+		TraceEvent *pEvent = &pBuffer->events[tail % TRACE_RING_SIZE];
+		fprintf(tracer.pFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+			tracer.isFirstEvent ? "\n" : ",\n", pEvent->name, (double)pEvent->startTime * 1e-3, (double)pEvent->duration * 1e-3, pBuffer->threadId);
+		tracer.isFirstEvent = 0;
+	}
+	// L'emplacement n'est rendu au thread qu'une fois l'événement écrit
+	__atomic_store_n(&pBuffer->tail, tail, __ATOMIC_RELEASE);
+}
+
+static void *runTraceFlusher(void *pArg){
+	(void)pArg;
+	TRACE_THREAD("trace flusher");
+	struct timespec period = {0, TRACE_FLUSH_PERIOD_MS * 1000000l};
+	while(__atomic_load_n(&tracer.isRunning, __ATOMIC_ACQUIRE)){
+		nanosleep(&period, NULL);
+		for(TraceBuffer *pBuffer = __atomic_load_n(&tracer.pBuffers, __ATOMIC_ACQUIRE); pBuffer != NULL; pBuffer = pBuffer->pNext){
+			writeTraceEvents(pBuffer);
+		}
+		fflush(tracer.pFile);
+	}
+	return NULL;
+}
+
+int createTracer(const char *fileName){
+	if(tracer.isCreated){
+		return 0;
+	}
+	tracer.pFile = fopen(fileName, "w");
+	if(tracer.pFile == NULL){
+		printf("VkTraceException : unable to open %s\n", fileName);
+		return -1;
+	}
+	fprintf(tracer.pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	tracer.startTime = getTraceTime();
+	tracer.isFirstEvent = 1;
+	tracer.isRunning = 1;
+	// Les anneaux gardés par les threads depuis un traceur précédent ne correspondent plus à ce numéro
+	__atomic_add_fetch(&tracer.generation, 1, __ATOMIC_RELEASE);
+	if(pthread_create(&tracer.thread, NULL, runTraceFlusher, NULL) != 0){
+		printf("VkTraceException : unable to start the trace flusher\n");
+		fclose(tracer.pFile);
+		tracer.pFile = NULL;
+		return -1;
+	}
+	__atomic_store_n(&tracer.isCreated, 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+void deleteTracer(){
+	// Appelé depuis atexit, d'autres threads peuvent encore ouvrir et fermer des zones
+	if(!__atomic_exchange_n(&tracer.isCreated, 0, __ATOMIC_SEQ_CST)){
+		return;
+	}
+	__atomic_store_n(&tracer.isRunning, 0, __ATOMIC_RELEASE);
+	pthread_join(tracer.thread, NULL);
+	// Les zones commencées avant la fermeture finissent d'écrire dans leur anneau avant qu'il soit libéré
+	while(__atomic_load_n(&tracer.writerNumber, __ATOMIC_ACQUIRE) != 0){
+		sched_yield();
+	}
+
+	uint64_t eventNumber = 0, droppedNumber = 0;
+	TraceBuffer *pBuffer = __atomic_exchange_n(&tracer.pBuffers, NULL, __ATOMIC_ACQ_REL);
+	for(TraceBuffer *pIterator = pBuffer; pIterator != NULL; pIterator = pIterator->pNext){
+		writeTraceEvents(pIterator);
+		eventNumber += pIterator->tail;
+		droppedNumber += pIterator->droppedNumber;
+	}
+	// Les noms des threads sont des métadonnées, placées à la fin pour ne les écrire qu'une fois
+	while(pBuffer != NULL){
+		fprintf(tracer.pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			tracer.isFirstEvent ? "\n" : ",\n", pBuffer->threadId, pBuffer->threadName);
+		tracer.isFirstEvent = 0;
+		TraceBuffer *pNext = pBuffer->pNext;
+		free(pBuffer);
+		pBuffer = pNext;
+	}
+	fprintf(tracer.pFile, "\n]}\n");
+	fclose(tracer.pFile);
+	tracer.pFile = NULL;
+	printf("trace : %llu zones written, %llu dropped on full rings\n", (unsigned long long)eventNumber, (unsigned long long)droppedNumber);
+}
+
+void setTraceThreadName(const char *name){
+	if(!enterTracer()){
+		return;
+	}
+	TraceBuffer *pBuffer = getTraceBuffer();
+	if(pBuffer != NULL){
+		snprintf(pBuffer->threadName, TRACE_MAX_THREAD_NAME, "%s", name);
+	}
+	leaveTracer();
+}
+
+void beginTraceZone(const char *name){
+	if(!enterTracer()){
+		return;
+	}
+	TraceBuffer *pBuffer = getTraceBuffer();
+	// Au-delà de la profondeur maximale la zone est comptée pour rester appariée mais pas horodatée
+	if(pBuffer != NULL){
+		if(pBuffer->depth < TRACE_MAX_DEPTH){
+			pBuffer->zoneNames[pBuffer->depth] = name;
+			pBuffer->zoneStarts[pBuffer->depth] = getTraceTime();
+		}
+		pBuffer->depth++;
+	}
+	leaveTracer();
+}
+
+void endTraceZone(){
+	// L'anneau du thread peut déjà être libéré, le traceur est testé avant de le lire
+	if(!enterTracer()){
+		return;
+	}
+	TraceBuffer *pBuffer = getCachedTraceBuffer();
+	if(pBuffer == NULL || pBuffer->depth == 0){
+		leaveTracer();
+		return;
+	}
+	uint32_t depth = --pBuffer->depth;
+	if(depth < TRACE_MAX_DEPTH){
+		uint64_t endTime = getTraceTime();
+		uint64_t head = pBuffer->head;
+		if(head - __atomic_load_n(&pBuffer->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_SIZE){
+			pBuffer->droppedNumber++;
+		}else{
+			TraceEvent *pEvent = &pBuffer->events[head % TRACE_RING_SIZE];
+			pEvent->name = pBuffer->zoneNames[depth];
+			pEvent->startTime = pBuffer->zoneStarts[depth] - tracer.startTime;
+			pEvent->duration = endTime - pBuffer->zoneStarts[depth];
+			__atomic_store_n(&pBuffer->head, head + 1, __ATOMIC_RELEASE);
+		}
+	}
+	leaveTracer();
+}
+
+void endTraceScope(const char **ppName){
+	(void)ppName;
+	endTraceZone();
+}
+#endif